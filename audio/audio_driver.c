@@ -42,6 +42,8 @@
 #include "../retroarch.h"
 #include "../verbosity.h"
 #include "../list_special.h"
+#include "../performance_counters.h"
+#include "../frame_statistics.h"
 
 #define AUDIO_BUFFER_FREE_SAMPLES_COUNT (8 * 1024)
 
@@ -141,6 +143,7 @@ static size_t audio_driver_rewind_size                   = 0;
 
 static int16_t *audio_driver_rewind_buf                  = NULL;
 static int16_t *audio_driver_output_samples_conv_buf     = NULL;
+static int16_t *audio_driver_output_samples_fused_buf    = NULL;
 
 static unsigned audio_driver_free_samples_buf[AUDIO_BUFFER_FREE_SAMPLES_COUNT];
 static uint64_t audio_driver_free_samples_count          = 0;
@@ -155,6 +158,7 @@ static bool audio_driver_use_float                       = false;
 static bool audio_driver_active                          = false;
 static bool audio_driver_data_own                        = false;
 static bool audio_mixer_active                           = false;
+static bool audio_driver_fused_enable                    = false;
 
 static float audio_driver_rate_control_delta             = 0.0f;
 static float audio_driver_input                          = 0.0f;
@@ -378,6 +382,11 @@ static bool audio_driver_deinit_internal(void)
       free(audio_driver_output_samples_buf);
    audio_driver_output_samples_buf = NULL;
 
+   if (audio_driver_output_samples_fused_buf)
+      free(audio_driver_output_samples_fused_buf);
+   audio_driver_output_samples_fused_buf = NULL;
+   audio_driver_fused_enable             = false;
+
    command_event(CMD_EVENT_DSP_FILTER_DEINIT, NULL);
 
    report_audio_buffer_statistics();
@@ -535,6 +544,17 @@ static bool audio_driver_init_internal(bool audio_cb_inited)
    audio_driver_output_samples_buf = samples_buf;
    audio_driver_control            = false;
 
+   /* The fused path can't convert to s16 in place,
+    * since the conversion buffer also holds the input. */
+   audio_driver_fused_enable       = settings->bools.audio_fused_pipeline;
+   if (audio_driver_fused_enable)
+   {
+      audio_driver_output_samples_fused_buf = (int16_t*)
+         malloc(outsamples_max * sizeof(int16_t));
+      if (!audio_driver_output_samples_fused_buf)
+         audio_driver_fused_enable = false;
+   }
+
    if (
          !audio_cb_inited
          && audio_driver_active
@@ -556,6 +576,7 @@ static bool audio_driver_init_internal(bool audio_cb_inited)
    command_event(CMD_EVENT_DSP_FILTER_INIT, NULL);
 
    audio_driver_free_samples_count = 0;
+   frame_statistics_reset_audio();
 
    audio_driver_mixer_init(settings->uints.audio_out_rate);
 
@@ -588,6 +609,88 @@ void audio_driver_set_nonblocking_state(bool enable)
       audio_driver_chunk_block_size;
 }
 
+/**
+ * audio_driver_process_fused:
+ * @data                 : s16 input samples.
+ * @samples              : amount of input samples.
+ * @gain                 : volume gain.
+ * @ratio                : resampling ratio.
+ * @output_data          : set to the output buffer.
+ *
+ * Runs conversion, DSP, resampling, mixing and output conversion
+ * AUDIO_FUSED_TILE_FRAMES at a time instead of making one full pass
+ * per stage, so each tile stays in cache through the whole chain.
+ * All stages are streaming, so the result is the same.
+ *
+ * Returns: amount of output frames.
+ **/
+static size_t audio_driver_process_fused(const int16_t *data,
+      size_t samples, float gain, double ratio, const void **output_data)
+{
+   size_t frames_in      = samples >> 1;
+   size_t out_frames     = 0;
+   bool mixer_override   = audio_driver_mixer_mute_enable ? true :
+      (audio_driver_mixer_volume_gain != 1.0f) ? true : false;
+   float mixer_gain      = !audio_driver_mixer_mute_enable ?
+      audio_driver_mixer_volume_gain : 0.0f;
+
+   while (frames_in)
+   {
+      struct resampler_data src_data;
+      size_t tile_frames = MIN(frames_in, AUDIO_FUSED_TILE_FRAMES);
+      float *tile_out    = audio_driver_output_samples_buf + out_frames * 2;
+
+      convert_s16_to_float(audio_driver_input_data, data,
+            tile_frames * 2, gain);
+
+      src_data.data_in      = audio_driver_input_data;
+      src_data.input_frames = tile_frames;
+
+      if (audio_driver_dsp)
+      {
+         struct retro_dsp_data dsp_data;
+
+         dsp_data.input         = audio_driver_input_data;
+         dsp_data.input_frames  = (unsigned)tile_frames;
+         dsp_data.output        = NULL;
+         dsp_data.output_frames = 0;
+
+         retro_dsp_filter_process(audio_driver_dsp, &dsp_data);
+
+         if (dsp_data.output)
+         {
+            src_data.data_in      = dsp_data.output;
+            src_data.input_frames = dsp_data.output_frames;
+         }
+      }
+
+      src_data.data_out      = tile_out;
+      src_data.output_frames = 0;
+      src_data.ratio         = ratio;
+
+      audio_driver_resampler->process(audio_driver_resampler_data, &src_data);
+
+      if (audio_mixer_active)
+         audio_mixer_mix(tile_out, src_data.output_frames,
+               mixer_gain, mixer_override);
+
+      if (!audio_driver_use_float)
+         convert_float_to_s16(
+               audio_driver_output_samples_fused_buf + out_frames * 2,
+               tile_out, src_data.output_frames * 2);
+
+      out_frames += src_data.output_frames;
+      data       += tile_frames * 2;
+      frames_in  -= tile_frames;
+   }
+
+   *output_data = audio_driver_use_float
+      ? (const void*)audio_driver_output_samples_buf
+      : (const void*)audio_driver_output_samples_fused_buf;
+
+   return out_frames;
+}
+
 /**
  * audio_driver_flush:
  * @data                 : pointer to audio buffer.
@@ -623,35 +726,7 @@ static void audio_driver_flush(const int16_t *data, size_t samples)
 		   !audio_driver_output_samples_buf)
       return;
 
-   convert_s16_to_float(audio_driver_input_data, data, samples,
-         audio_volume_gain);
-
-   src_data.data_in                  = audio_driver_input_data;
-   src_data.input_frames             = samples >> 1;
-
-
-   if (audio_driver_dsp)
-   {
-      struct retro_dsp_data dsp_data;
-
-      dsp_data.input                 = NULL;
-      dsp_data.input_frames          = 0;
-      dsp_data.output                = NULL;
-      dsp_data.output_frames         = 0;
-
-      dsp_data.input                 = audio_driver_input_data;
-      dsp_data.input_frames          = (unsigned)(samples >> 1);
-
-      retro_dsp_filter_process(audio_driver_dsp, &dsp_data);
-
-      if (dsp_data.output)
-      {
-         src_data.data_in            = dsp_data.output;
-         src_data.input_frames       = dsp_data.output_frames;
-      }
-   }
-
-   src_data.data_out = audio_driver_output_samples_buf;
+   rarch_profile_begin(RARCH_PROFILE_AUDIO_FLUSH);
 
    if (audio_driver_control)
    {
@@ -667,6 +742,7 @@ static void audio_driver_flush(const int16_t *data, size_t samples)
 
       audio_driver_free_samples_buf
          [write_idx]               = avail;
+      frame_statistics_push_audio(avail, audio_driver_buffer_size);
       audio_source_ratio_current   =
          audio_source_ratio_original * adjust;
 
@@ -690,35 +766,77 @@ static void audio_driver_flush(const int16_t *data, size_t samples)
       src_data.ratio       *= settings->floats.slowmotion_ratio;
    }
 
-   audio_driver_resampler->process(audio_driver_resampler_data, &src_data);
-
-   if (audio_mixer_active)
+   if (audio_driver_fused_enable)
    {
-      bool override     = audio_driver_mixer_mute_enable ? true :
-         (audio_driver_mixer_volume_gain != 1.0f) ? true : false;
-      float mixer_gain  = !audio_driver_mixer_mute_enable ?
-         audio_driver_mixer_volume_gain : 0.0f;
-      audio_mixer_mix(audio_driver_output_samples_buf,
-            src_data.output_frames, mixer_gain, override);
+      output_frames = (unsigned)audio_driver_process_fused(data, samples,
+            audio_volume_gain, src_data.ratio, &output_data);
+      output_frames *= audio_driver_use_float
+         ? sizeof(float) : sizeof(int16_t);
    }
-
-   output_data        = audio_driver_output_samples_buf;
-   output_frames      = (unsigned)src_data.output_frames;
-
-   if (audio_driver_use_float)
-      output_frames  *= sizeof(float);
    else
    {
-      convert_float_to_s16(audio_driver_output_samples_conv_buf,
-            (const float*)output_data, output_frames * 2);
+      convert_s16_to_float(audio_driver_input_data, data, samples,
+            audio_volume_gain);
+
+      src_data.data_in                  = audio_driver_input_data;
+      src_data.input_frames             = samples >> 1;
+
+
+      if (audio_driver_dsp)
+      {
+         struct retro_dsp_data dsp_data;
+
+         dsp_data.input                 = NULL;
+         dsp_data.input_frames          = 0;
+         dsp_data.output                = NULL;
+         dsp_data.output_frames         = 0;
 
-      output_data     = audio_driver_output_samples_conv_buf;
-      output_frames  *= sizeof(int16_t);
+         dsp_data.input                 = audio_driver_input_data;
+         dsp_data.input_frames          = (unsigned)(samples >> 1);
+
+         retro_dsp_filter_process(audio_driver_dsp, &dsp_data);
+
+         if (dsp_data.output)
+         {
+            src_data.data_in            = dsp_data.output;
+            src_data.input_frames       = dsp_data.output_frames;
+         }
+      }
+
+      src_data.data_out = audio_driver_output_samples_buf;
+
+      audio_driver_resampler->process(audio_driver_resampler_data, &src_data);
+
+      if (audio_mixer_active)
+      {
+         bool override     = audio_driver_mixer_mute_enable ? true :
+            (audio_driver_mixer_volume_gain != 1.0f) ? true : false;
+         float mixer_gain  = !audio_driver_mixer_mute_enable ?
+            audio_driver_mixer_volume_gain : 0.0f;
+         audio_mixer_mix(audio_driver_output_samples_buf,
+               src_data.output_frames, mixer_gain, override);
+      }
+
+      output_data        = audio_driver_output_samples_buf;
+      output_frames      = (unsigned)src_data.output_frames;
+
+      if (audio_driver_use_float)
+         output_frames  *= sizeof(float);
+      else
+      {
+         convert_float_to_s16(audio_driver_output_samples_conv_buf,
+               (const float*)output_data, output_frames * 2);
+
+         output_data     = audio_driver_output_samples_conv_buf;
+         output_frames  *= sizeof(int16_t);
+      }
    }
 
    if (current_audio->write(audio_driver_context_audio_data,
             output_data, output_frames * 2) < 0)
       audio_driver_active = false;
+
+   rarch_profile_end(RARCH_PROFILE_AUDIO_FLUSH);
 }
 
 /**
@@ -35,6 +35,9 @@ RETRO_BEGIN_DECLS
 
 #define AUDIO_MAX_RATIO                16
 
+/* Frames per tile processed by the fused audio pipeline. */
+#define AUDIO_FUSED_TILE_FRAMES        256
+
 #define AUDIO_MIXER_MAX_STREAMS        16
 
 enum audio_action
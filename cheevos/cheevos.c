@@ -2205,6 +2205,8 @@ bool cheevos_unload(void)
    cheevos_locals.core.count         = 0;
    cheevos_locals.unofficial.count   = 0;
 
+   cheevos_var_reset_memrefs();
+
    cheevos_loaded     = false;
 
    return true;
@@ -2273,6 +2275,7 @@ static void cheevos_patch_addresses(cheevoset_t* set)
                case CHEEVOS_VAR_TYPE_DELTA_MEM:
                   cheevos_var_patch_addr(&cond->source,
                         cheevos_locals.console_id);
+                  cheevos_var_register_memref(&cond->source);
 #ifdef CHEEVOS_DUMP_ADDRS
                   CHEEVOS_LOG("[CHEEVOS]: s-var %03d:%08X\n",
                         cond->source.bank_id + 1, cond->source.value);
@@ -2289,6 +2292,7 @@ static void cheevos_patch_addresses(cheevoset_t* set)
                case CHEEVOS_VAR_TYPE_DELTA_MEM:
                   cheevos_var_patch_addr(&cond->target,
                         cheevos_locals.console_id);
+                  cheevos_var_register_memref(&cond->target);
 #ifdef CHEEVOS_DUMP_ADDRS
                   CHEEVOS_LOG("[CHEEVOS]: t-var %03d:%08X\n",
                         cond->target.bank_id + 1, cond->target.value);
@@ -2326,6 +2330,7 @@ static void cheevos_patch_lb_conditions(cheevos_condition_t* condition)
             case CHEEVOS_VAR_TYPE_DELTA_MEM:
                cheevos_var_patch_addr(&cond->source,
                      cheevos_locals.console_id);
+               cheevos_var_register_memref(&cond->source);
 #ifdef CHEEVOS_DUMP_ADDRS
                CHEEVOS_LOG("[CHEEVOS]: s-var %03d:%08X\n",
                      cond->source.bank_id + 1, cond->source.value);
@@ -2340,6 +2345,7 @@ static void cheevos_patch_lb_conditions(cheevos_condition_t* condition)
             case CHEEVOS_VAR_TYPE_DELTA_MEM:
                cheevos_var_patch_addr(&cond->target,
                      cheevos_locals.console_id);
+               cheevos_var_register_memref(&cond->target);
 #ifdef CHEEVOS_DUMP_ADDRS
                CHEEVOS_LOG("[CHEEVOS]: t-var %03d:%08X\n",
                      cond->target.bank_id + 1, cond->target.value);
@@ -2369,6 +2375,7 @@ static void cheevos_patch_lb_expressions(cheevos_expr_t* expression)
          case CHEEVOS_VAR_TYPE_ADDRESS:
          case CHEEVOS_VAR_TYPE_DELTA_MEM:
             cheevos_var_patch_addr(&term->var, cheevos_locals.console_id);
+            cheevos_var_register_memref(&term->var);
 #ifdef CHEEVOS_DUMP_ADDRS
             CHEEVOS_LOG("[CHEEVOS]: s-var %03d:%08X\n",
                   term->var.bank_id + 1, term->var.value);
@@ -2404,6 +2411,7 @@ void cheevos_test(void)
 
    if (!cheevos_locals.addrs_patched)
    {
+      cheevos_var_reset_memrefs();
       cheevos_patch_addresses(&cheevos_locals.core);
       cheevos_patch_addresses(&cheevos_locals.unofficial);
       cheevos_patch_lbs(cheevos_locals.leaderboards);
@@ -2411,6 +2419,9 @@ void cheevos_test(void)
       cheevos_locals.addrs_patched = true;
    }
 
+   /* Fetch every distinct memory reference once for all the tests below. */
+   cheevos_var_update_memrefs();
+
    cheevos_test_cheevo_set(&cheevos_locals.core);
 
    if (settings)
@@ -15,6 +15,8 @@
 
 #include <ctype.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <libretro.h>
 
@@ -24,6 +26,282 @@
 #include "../core.h"
 #include "../verbosity.h"
 
+/*****************************************************************************
+Memory references
+*****************************************************************************/
+
+enum
+{
+   CHEEVOS_VAR_FETCH_8 = 0, /* bits, nibbles and bytes: (m[0] >> shift) & mask */
+   CHEEVOS_VAR_FETCH_16,
+   CHEEVOS_VAR_FETCH_32
+};
+
+typedef struct
+{
+   int                bank_id;
+   unsigned           address;
+   cheevos_var_size_t size;
+} cheevos_memref_key_t;
+
+/* Every distinct (bank, address, size) read by the loaded sets. The arrays
+ * walked each frame are kept apart from the lookup keys so the fetch loop
+ * only touches what it needs. The cached pointers are rebuilt whenever the
+ * base of a bank moves, the core may reallocate its memory or change its
+ * memory maps at any time. */
+static struct
+{
+   const uint8_t        **memory; /* pre-resolved, NULL while unmapped */
+   uint8_t               *kernel;
+   uint8_t               *shift;
+   uint8_t               *mask;
+   unsigned              *value;  /* latched by cheevos_var_update_memrefs */
+   cheevos_memref_key_t  *keys;
+   unsigned               count;
+   unsigned               capacity;
+   const uint8_t        **banks;  /* base of each bank when last resolved */
+   unsigned               num_banks;
+   bool                   stale;
+} cheevos_memrefs;
+
+static unsigned cheevos_var_fetch(const uint8_t* memory,
+      cheevos_var_size_t size)
+{
+   unsigned value = memory[0];
+
+   switch (size)
+   {
+      case CHEEVOS_VAR_SIZE_BIT_0:
+      case CHEEVOS_VAR_SIZE_BIT_1:
+      case CHEEVOS_VAR_SIZE_BIT_2:
+      case CHEEVOS_VAR_SIZE_BIT_3:
+      case CHEEVOS_VAR_SIZE_BIT_4:
+      case CHEEVOS_VAR_SIZE_BIT_5:
+      case CHEEVOS_VAR_SIZE_BIT_6:
+      case CHEEVOS_VAR_SIZE_BIT_7:
+         value = (value >> (size - CHEEVOS_VAR_SIZE_BIT_0)) & 1;
+         break;
+      case CHEEVOS_VAR_SIZE_NIBBLE_LOWER:
+         value &= 0x0f;
+         break;
+      case CHEEVOS_VAR_SIZE_NIBBLE_UPPER:
+         value = (value >> 4) & 0x0f;
+         break;
+      case CHEEVOS_VAR_SIZE_EIGHT_BITS:
+         break;
+      case CHEEVOS_VAR_SIZE_SIXTEEN_BITS:
+         value |= memory[1] << 8;
+         break;
+      case CHEEVOS_VAR_SIZE_THIRTYTWO_BITS:
+         value |= memory[1] << 8;
+         value |= memory[2] << 16;
+         value |= (unsigned)memory[3] << 24;
+         break;
+   }
+
+   return value;
+}
+
+static const uint8_t* cheevos_var_resolve_bank(unsigned bank_id)
+{
+   cheevos_var_t var;
+
+   var.bank_id = (int)bank_id;
+   var.value   = 0;
+
+   return cheevos_var_get_memory(&var);
+}
+
+static int cheevos_var_add_memref(const cheevos_var_t* var)
+{
+   unsigned i;
+
+   if (var->bank_id < 0)
+      return -1;
+
+   /* Load time only, a linear scan is fine for the few thousand distinct
+    * references even the largest sets have. */
+   for (i = 0; i < cheevos_memrefs.count; i++)
+   {
+      const cheevos_memref_key_t *key = cheevos_memrefs.keys + i;
+
+      if (     key->bank_id == var->bank_id
+            && key->address == var->value
+            && key->size    == var->size)
+         return (int)i;
+   }
+
+   if ((unsigned)var->bank_id >= cheevos_memrefs.num_banks)
+   {
+      unsigned num_banks    = var->bank_id + 1;
+      const uint8_t **banks = (const uint8_t**)realloc(
+            (void*)cheevos_memrefs.banks, num_banks * sizeof(*banks));
+
+      if (!banks)
+         return -1;
+
+      for (i = cheevos_memrefs.num_banks; i < num_banks; i++)
+         banks[i] = NULL;
+
+      cheevos_memrefs.banks     = banks;
+      cheevos_memrefs.num_banks = num_banks;
+   }
+
+   if (cheevos_memrefs.count == cheevos_memrefs.capacity)
+   {
+      unsigned capacity = cheevos_memrefs.capacity ?
+         cheevos_memrefs.capacity * 2 : 64;
+      const uint8_t **memory     = (const uint8_t**)realloc(
+            (void*)cheevos_memrefs.memory, capacity * sizeof(*memory));
+      uint8_t *kernel            = NULL;
+      uint8_t *shift             = NULL;
+      uint8_t *mask              = NULL;
+      unsigned *value            = NULL;
+      cheevos_memref_key_t *keys = NULL;
+
+      if (memory)
+         cheevos_memrefs.memory = memory;
+      if ((kernel = (uint8_t*)realloc(cheevos_memrefs.kernel, capacity)))
+         cheevos_memrefs.kernel = kernel;
+      if ((shift = (uint8_t*)realloc(cheevos_memrefs.shift, capacity)))
+         cheevos_memrefs.shift  = shift;
+      if ((mask = (uint8_t*)realloc(cheevos_memrefs.mask, capacity)))
+         cheevos_memrefs.mask   = mask;
+      if ((value = (unsigned*)realloc(cheevos_memrefs.value,
+                  capacity * sizeof(*value))))
+         cheevos_memrefs.value  = value;
+      if ((keys = (cheevos_memref_key_t*)realloc(cheevos_memrefs.keys,
+                  capacity * sizeof(*keys))))
+         cheevos_memrefs.keys   = keys;
+
+      /* The variable falls back to reading memory itself. */
+      if (!memory || !kernel || !shift || !mask || !value || !keys)
+         return -1;
+
+      cheevos_memrefs.capacity = capacity;
+   }
+
+   i = cheevos_memrefs.count++;
+
+   cheevos_memrefs.keys[i].bank_id = var->bank_id;
+   cheevos_memrefs.keys[i].address = var->value;
+   cheevos_memrefs.keys[i].size    = var->size;
+   cheevos_memrefs.value[i]        = 0;
+   cheevos_memrefs.shift[i]        = 0;
+   cheevos_memrefs.mask[i]         = 0xff;
+
+   switch (var->size)
+   {
+      case CHEEVOS_VAR_SIZE_SIXTEEN_BITS:
+         cheevos_memrefs.kernel[i] = CHEEVOS_VAR_FETCH_16;
+         break;
+      case CHEEVOS_VAR_SIZE_THIRTYTWO_BITS:
+         cheevos_memrefs.kernel[i] = CHEEVOS_VAR_FETCH_32;
+         break;
+      case CHEEVOS_VAR_SIZE_NIBBLE_LOWER:
+         cheevos_memrefs.kernel[i] = CHEEVOS_VAR_FETCH_8;
+         cheevos_memrefs.mask[i]   = 0x0f;
+         break;
+      case CHEEVOS_VAR_SIZE_NIBBLE_UPPER:
+         cheevos_memrefs.kernel[i] = CHEEVOS_VAR_FETCH_8;
+         cheevos_memrefs.shift[i]  = 4;
+         cheevos_memrefs.mask[i]   = 0x0f;
+         break;
+      case CHEEVOS_VAR_SIZE_EIGHT_BITS:
+         cheevos_memrefs.kernel[i] = CHEEVOS_VAR_FETCH_8;
+         break;
+      default: /* single bits */
+         cheevos_memrefs.kernel[i] = CHEEVOS_VAR_FETCH_8;
+         cheevos_memrefs.shift[i]  = var->size - CHEEVOS_VAR_SIZE_BIT_0;
+         cheevos_memrefs.mask[i]   = 1;
+         break;
+   }
+
+   cheevos_memrefs.memory[i] = NULL;
+   cheevos_memrefs.stale     = true;
+   return (int)i;
+}
+
+void cheevos_var_register_memref(cheevos_var_t* var)
+{
+   var->memref = cheevos_var_add_memref(var);
+}
+
+void cheevos_var_update_memrefs(void)
+{
+   unsigned i;
+   unsigned count          = cheevos_memrefs.count;
+   const uint8_t **memory  = cheevos_memrefs.memory;
+   const uint8_t **banks   = cheevos_memrefs.banks;
+   const uint8_t *kernel   = cheevos_memrefs.kernel;
+   unsigned *value         = cheevos_memrefs.value;
+
+   /* One lookup per bank instead of one per reference. */
+   for (i = 0; i < cheevos_memrefs.num_banks; i++)
+   {
+      const uint8_t *base = cheevos_var_resolve_bank(i);
+
+      if (base != banks[i])
+      {
+         banks[i]              = base;
+         cheevos_memrefs.stale = true;
+      }
+   }
+
+   if (cheevos_memrefs.stale)
+   {
+      for (i = 0; i < count; i++)
+      {
+         const cheevos_memref_key_t *key = cheevos_memrefs.keys + i;
+         const uint8_t *base             = banks[key->bank_id];
+
+         memory[i] = base ? base + key->address : NULL;
+      }
+
+      cheevos_memrefs.stale = false;
+   }
+
+   for (i = 0; i < count; i++)
+   {
+      const uint8_t *m = memory[i];
+
+      if (!m)
+      {
+         /* The core may expose the region later on. */
+         value[i] = 0;
+         continue;
+      }
+
+      switch (kernel[i])
+      {
+         case CHEEVOS_VAR_FETCH_8:
+            value[i] = (m[0] >> cheevos_memrefs.shift[i])
+               & cheevos_memrefs.mask[i];
+            break;
+         case CHEEVOS_VAR_FETCH_16:
+            value[i] = m[0] | (m[1] << 8);
+            break;
+         case CHEEVOS_VAR_FETCH_32:
+            value[i] = m[0] | (m[1] << 8) | (m[2] << 16)
+               | ((unsigned)m[3] << 24);
+            break;
+      }
+   }
+}
+
+void cheevos_var_reset_memrefs(void)
+{
+   free((void*)cheevos_memrefs.memory);
+   free(cheevos_memrefs.kernel);
+   free(cheevos_memrefs.shift);
+   free(cheevos_memrefs.mask);
+   free(cheevos_memrefs.value);
+   free(cheevos_memrefs.keys);
+   free((void*)cheevos_memrefs.banks);
+
+   memset(&cheevos_memrefs, 0, sizeof(cheevos_memrefs));
+}
+
 /*****************************************************************************
 Parsing
 *****************************************************************************/
@@ -114,6 +392,7 @@ void cheevos_var_parse(cheevos_var_t* var, const char** memaddr)
    unsigned base   = 16;
 
    var->is_bcd = false;
+   var->memref = -1;
 
    if (toupper((unsigned char)*str) == 'D' && str[1] == '0' && toupper((unsigned char)str[2]) == 'X')
    {
@@ -163,6 +442,7 @@ void cheevos_var_patch_addr(cheevos_var_t* var, cheevos_console_t console)
    rarch_system_info_t *system = runloop_get_system_info();
 
    var->bank_id = -1;
+   var->memref  = -1;
 
    if (console == CHEEVOS_CONSOLE_NINTENDO)
    {
@@ -296,7 +576,12 @@ uint8_t* cheevos_var_get_memory(const cheevos_var_t* var)
       rarch_system_info_t* system = runloop_get_system_info();
 
       if (system->mmaps.num_descriptors != 0)
-         memory = (uint8_t*)system->mmaps.descriptors[var->bank_id].core.ptr;
+      {
+         /* The maps may have been replaced since the address was patched */
+         if ((unsigned)var->bank_id < system->mmaps.num_descriptors)
+            memory = (uint8_t*)
+               system->mmaps.descriptors[var->bank_id].core.ptr;
+      }
       else
       {
          retro_ctx_memory_info_t meminfo = {NULL, 0, 0};
@@ -344,56 +629,10 @@ unsigned cheevos_var_get_value(cheevos_var_t* var)
 
       case CHEEVOS_VAR_TYPE_ADDRESS:
       case CHEEVOS_VAR_TYPE_DELTA_MEM:
-         memory = cheevos_var_get_memory(var);
-
-         if (memory)
-         {
-            value = memory[0];
-
-            switch (var->size)
-            {
-               case CHEEVOS_VAR_SIZE_BIT_0:
-                  value &= 1;
-                  break;
-               case CHEEVOS_VAR_SIZE_BIT_1:
-                  value = (value >> 1) & 1;
-                  break;
-               case CHEEVOS_VAR_SIZE_BIT_2:
-                  value = (value >> 2) & 1;
-                  break;
-               case CHEEVOS_VAR_SIZE_BIT_3:
-                  value = (value >> 3) & 1;
-                  break;
-               case CHEEVOS_VAR_SIZE_BIT_4:
-                  value = (value >> 4) & 1;
-                  break;
-               case CHEEVOS_VAR_SIZE_BIT_5:
-                  value = (value >> 5) & 1;
-                  break;
-               case CHEEVOS_VAR_SIZE_BIT_6:
-                  value = (value >> 6) & 1;
-                  break;
-               case CHEEVOS_VAR_SIZE_BIT_7:
-                  value = (value >> 7) & 1;
-                  break;
-               case CHEEVOS_VAR_SIZE_NIBBLE_LOWER:
-                  value &= 0x0f;
-                  break;
-               case CHEEVOS_VAR_SIZE_NIBBLE_UPPER:
-                  value = (value >> 4) & 0x0f;
-                  break;
-               case CHEEVOS_VAR_SIZE_EIGHT_BITS:
-                  break;
-               case CHEEVOS_VAR_SIZE_SIXTEEN_BITS:
-                  value |= memory[1] << 8;
-                  break;
-               case CHEEVOS_VAR_SIZE_THIRTYTWO_BITS:
-                  value |= memory[1] << 8;
-                  value |= memory[2] << 16;
-                  value |= memory[3] << 24;
-                  break;
-            }
-         }
+         if (var->memref >= 0)
+            value = cheevos_memrefs.value[var->memref];
+         else if ((memory = cheevos_var_get_memory(var)))
+            value = cheevos_var_fetch(memory, var->size);
 
          if (var->type == CHEEVOS_VAR_TYPE_DELTA_MEM)
          {
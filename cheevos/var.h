@@ -65,6 +65,7 @@ typedef struct
    bool               is_bcd;
    unsigned           value;
    unsigned           previous;
+   int                memref;
 } cheevos_var_t;
 
 void cheevos_var_parse(cheevos_var_t* var, const char** memaddr);
@@ -73,6 +74,13 @@ void cheevos_var_patch_addr(cheevos_var_t* var, cheevos_console_t console);
 uint8_t* cheevos_var_get_memory(const cheevos_var_t* var);
 unsigned cheevos_var_get_value(cheevos_var_t* var);
 
+/* Memory references are registered once a variable has been patched,
+ * latched once per frame by cheevos_var_update_memrefs and released by
+ * cheevos_var_reset_memrefs. */
+void cheevos_var_register_memref(cheevos_var_t* var);
+void cheevos_var_update_memrefs(void);
+void cheevos_var_reset_memrefs(void);
+
 RETRO_END_DECLS
 
 #endif /* __RARCH_CHEEVOS_VAR_H */
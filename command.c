@@ -69,6 +69,7 @@
 #include "core_info.h"
 #include "core_type.h"
 #include "performance_counters.h"
+#include "frame_statistics.h"
 #include "dynamic.h"
 #include "content.h"
 #include "dirs.h"
@@ -128,12 +129,18 @@ struct command
 static bool command_read_ram(const char *arg);
 static bool command_write_ram(const char *arg);
 #endif
+static bool command_profile_export(const char *arg);
+static bool command_get_frame_stats(const char *arg);
+static bool command_reset_frame_stats(const char *arg);
 
 static const struct cmd_action_map action_map[] = {
-   { "SET_SHADER",      command_set_shader,  "<shader path>" },
+   { "SET_SHADER",        command_set_shader,        "<shader path>" },
+   { "PROFILE_EXPORT",    command_profile_export,    "<trace file name>" },
+   { "GET_FRAME_STATS",   command_get_frame_stats,   "" },
+   { "RESET_FRAME_STATS", command_reset_frame_stats, "" },
 #if defined(HAVE_COMMAND) && defined(HAVE_CHEEVOS)
-   { "READ_CORE_RAM",   command_read_ram,    "<address> <number of bytes>" },
-   { "WRITE_CORE_RAM",  command_write_ram,   "<address> <byte1> <byte2> ..." },
+   { "READ_CORE_RAM",     command_read_ram,          "<address> <number of bytes>" },
+   { "WRITE_CORE_RAM",    command_write_ram,         "<address> <byte1> <byte2> ..." },
 #endif
 };
 
@@ -188,8 +195,6 @@ static struct sockaddr_storage lastcmd_net_source;
 static socklen_t lastcmd_net_source_len;
 #endif
 
-#ifdef HAVE_CHEEVOS
-#if defined(HAVE_STDIN_CMD) || defined(HAVE_NETWORK_CMD) && defined(HAVE_NETWORKING)
 static bool command_reply(const char * data, size_t len)
 {
    switch (lastcmd_source)
@@ -215,8 +220,53 @@ static bool command_reply(const char * data, size_t len)
 
    return false;
 }
-#endif
-#endif
+
+static bool command_profile_export(const char *arg)
+{
+   char path[PATH_MAX_LENGTH];
+   settings_t *settings = config_get_ptr();
+
+   path[0]              = '\0';
+
+   /* Commands may come from any network peer, so only take a bare
+    * file name and keep the trace inside the cache directory. */
+   if (string_is_empty(arg) || arg[0] == '.' || strpbrk(arg, "/\\:"))
+   {
+      RARCH_ERR("[PERF]: Trace file must be a plain file name.\n");
+      return false;
+   }
+
+   if (!string_is_empty(settings->paths.directory_cache))
+      fill_pathname_join(path, settings->paths.directory_cache,
+            arg, sizeof(path));
+   else if (!path_is_empty(RARCH_PATH_CONFIG))
+   {
+      fill_pathname_basedir(path, path_get(RARCH_PATH_CONFIG),
+            sizeof(path));
+      fill_pathname_join(path, path, arg, sizeof(path));
+   }
+   else
+      return false;
+
+   return rarch_profile_export(path);
+}
+
+static bool command_get_frame_stats(const char *arg)
+{
+   char reply[1024];
+   size_t len = strlcpy(reply, "GET_FRAME_STATS ", sizeof(reply));
+
+   len += frame_statistics_get_report(reply + len, sizeof(reply) - len);
+   command_reply(reply, len);
+   return true;
+}
+
+static bool command_reset_frame_stats(const char *arg)
+{
+   frame_statistics_reset_video();
+   frame_statistics_reset_audio();
+   return true;
+}
 
 bool command_set_shader(const char *arg)
 {
@@ -326,11 +376,11 @@ static bool command_get_arg(const char *tok,
       if (str == tok)
       {
          const char *argument = str + strlen(action_map[i].str);
-         if (*argument != ' ')
+         if (*argument != ' ' && *argument != '\0')
             return false;
 
          if (arg)
-            *arg = argument + 1;
+            *arg = *argument ? argument + 1 : argument;
 
          if (index)
             *index = i;
@@ -1994,7 +2044,8 @@ TODO: Add a setting for these tweaks */
                if (!netplay_driver_ctl(RARCH_NETPLAY_CTL_IS_ENABLED, NULL))
 #endif
                {
-                  state_manager_event_init((unsigned)settings->rewind_buffer_size);
+                  state_manager_event_init((unsigned)settings->rewind_buffer_size,
+                        settings->bools.rewind_block_dedup);
                }
             }
          }
@@ -2205,18 +2256,30 @@ TODO: Add a setting for these tweaks */
       case CMD_EVENT_CORE_INFO_INIT:
          {
             char ext_name[255];
+            char dir_cache[PATH_MAX_LENGTH];
             settings_t *settings      = config_get_ptr();
 
             ext_name[0]               = '\0';
+            dir_cache[0]              = '\0';
 
             command_event(CMD_EVENT_CORE_INFO_DEINIT, NULL);
 
             if (!frontend_driver_get_core_extension(ext_name, sizeof(ext_name)))
                return false;
 
+            /* Without a cache directory, keep the core info cache
+             * next to the config file, which is always writable. */
+            if (!string_is_empty(settings->paths.directory_cache))
+               strlcpy(dir_cache, settings->paths.directory_cache,
+                     sizeof(dir_cache));
+            else if (!path_is_empty(RARCH_PATH_CONFIG))
+               fill_pathname_basedir(dir_cache,
+                     path_get(RARCH_PATH_CONFIG), sizeof(dir_cache));
+
             if (!string_is_empty(settings->paths.directory_libretro))
                core_info_init_list(settings->paths.path_libretro_info,
                      settings->paths.directory_libretro,
+                     dir_cache,
                      ext_name,
                      settings->bools.show_hidden_files
                      );
@@ -2236,6 +2299,7 @@ TODO: Add a setting for these tweaks */
          }
       case CMD_EVENT_CORE_INIT:
          content_reset_savestate_backups();
+         content_init_savestate_buffers();
          if (!command_event_init_core((enum rarch_core_type*)data))
             return false;
          break;
@@ -244,6 +244,10 @@ static bool config_save_on_exit = true;
 
 static bool show_hidden_files = false;
 
+/* Number of worker threads identifying content during a
+ * database scan. 0 scans one file at a time on the task thread. */
+static const unsigned database_scan_threads = 0;
+
 static const bool overlay_hide_in_menu = true;
 
 static const bool display_keyboard_overlay = false;
@@ -484,6 +488,10 @@ static const bool rate_control = true;
 static const bool rate_control = false;
 #endif
 
+/* Run conversion, DSP, resampling and mixing over small tiles
+ * of each audio batch instead of one full pass per stage. */
+static const bool audio_fused_pipeline = false;
+
 /* Rate control delta. Defines how much rate_control
  * is allowed to adjust input rate. */
 static const float rate_control_delta = 0.005;
@@ -524,6 +532,10 @@ static const unsigned rewind_buffer_size = 20 << 20; /* 20MiB */
 /* How many frames to rewind at a time. */
 static const unsigned rewind_granularity = 1;
 
+/* Store rewind history as deduplicated blocks and diff them
+ * on a worker thread. Helps cores with multi-megabyte savestates. */
+static const bool rewind_block_dedup = false;
+
 /* Pause gameplay when gameplay loses focus. */
 #ifdef EMSCRIPTEN
 static const bool pause_nonactive = false;
@@ -589,6 +601,10 @@ static const bool savestate_auto_load = false;
 
 static const bool savestate_thumbnail_enable = false;
 
+/* Compress savestates written to disk. Uncompressed states
+ * can still be loaded. */
+static const bool savestate_file_compression = true;
+
 /* Slowmotion ratio. */
 static const float slowmotion_ratio = 3.0;
 
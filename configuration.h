@@ -102,6 +102,7 @@ typedef struct settings
       bool audio_enable_menu;
       bool audio_sync;
       bool audio_rate_control;
+      bool audio_fused_pipeline;
       bool audio_wasapi_exclusive_mode;
       bool audio_wasapi_float_format;
 
@@ -235,14 +236,18 @@ typedef struct settings
       bool playlist_entry_remove;
       bool playlist_entry_rename;
       bool rewind_enable;
+      bool rewind_block_dedup;
       bool run_ahead_enabled;
       bool run_ahead_secondary_instance;
+      bool run_ahead_state_ring;
+      bool run_ahead_secondary_threaded;
       bool pause_nonactive;
       bool block_sram_overwrite;
       bool savestate_auto_index;
       bool savestate_auto_save;
       bool savestate_auto_load;
       bool savestate_thumbnail_enable;
+      bool savestate_file_compression;
       bool network_cmd_enable;
       bool stdin_cmd_enable;
       bool keymapper_enable;
@@ -399,6 +404,7 @@ typedef struct settings
       unsigned led_map[MAX_LEDS];
 
       unsigned run_ahead_frames;
+      unsigned database_scan_threads;
    } uints;
 
    struct
@@ -78,6 +78,9 @@ bool content_init(void);
 /* Resets the state and savefile backup buffers */
 bool content_reset_savestate_backups(void);
 
+/* Sets up the savestate buffer pool, freed by content_reset_savestate_backups() */
+void content_init_savestate_buffers(void);
+
 /* Checks if the buffers are empty */
 bool content_undo_load_buf_is_empty(void);
 bool content_undo_save_buf_is_empty(void);
@@ -170,6 +170,9 @@ bool core_set_poll_type(unsigned *type);
 /* Runs the core for one frame. */
 bool core_run(void);
 
+/* Runs the core for one frame, input was already polled for it */
+bool core_run_input_polled(void);
+
 /* Runs the core for one frame, but does not trigger any input polling */
 bool core_run_no_input_polling(void);
 
@@ -65,9 +65,12 @@ static void retro_input_poll_null(void)
 {
 }
 
+/* Set while running a frame the caller already polled input for */
+static bool core_input_polled_ahead = false;
+
 static void core_input_state_poll_maybe(void)
 {
-   if (current_core.poll_type == POLL_TYPE_NORMAL)
+   if (current_core.poll_type == POLL_TYPE_NORMAL && !core_input_polled_ahead)
       input_poll();
 }
 
@@ -402,14 +405,15 @@ bool core_unload_game(void)
    return true;
 }
 
-bool core_run(void)
+static bool core_run_frame(bool poll)
 {
 #ifdef HAVE_NETWORKING
    if (!netplay_driver_ctl(RARCH_NETPLAY_CTL_PRE_FRAME, NULL))
    {
       /* Paused due to netplay. We must poll and display something so that a
        * netplay peer pausing doesn't just hang. */
-      input_poll();
+      if (poll)
+         input_poll();
       video_driver_cached_frame();
       return true;
    }
@@ -418,16 +422,19 @@ bool core_run(void)
    switch (current_core.poll_type)
    {
       case POLL_TYPE_EARLY:
-         input_poll();
+         if (poll)
+            input_poll();
          break;
       case POLL_TYPE_LATE:
-         current_core.input_polled = false;
+         current_core.input_polled = !poll;
          break;
       default:
          break;
    }
 
+   core_input_polled_ahead = !poll;
    current_core.retro_run();
+   core_input_polled_ahead = false;
 
    if (current_core.poll_type == POLL_TYPE_LATE && !current_core.input_polled)
       input_poll();
@@ -439,6 +446,16 @@ bool core_run(void)
    return true;
 }
 
+bool core_run(void)
+{
+   return core_run_frame(true);
+}
+
+bool core_run_input_polled(void)
+{
+   return core_run_frame(false);
+}
+
 bool core_run_no_input_polling(void)
 {
    current_core.retro_run();
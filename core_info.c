@@ -78,63 +78,6 @@ static void core_info_list_resolve_all_extensions(
 #endif
 }
 
-static void core_info_list_resolve_all_firmware(
-      core_info_list_t *core_info_list)
-{
-   size_t i;
-   unsigned c;
-
-   for (i = 0; i < core_info_list->count; i++)
-   {
-      unsigned count                  = 0;
-      core_info_firmware_t *firmware  = NULL;
-      core_info_t *info               = (core_info_t*)&core_info_list->list[i];
-      config_file_t *config           = (config_file_t*)info->config_data;
-
-      if (!config || !config_get_uint(config, "firmware_count", &count))
-         continue;
-
-      firmware = (core_info_firmware_t*)calloc(count, sizeof(*firmware));
-
-      if (!firmware)
-         continue;
-
-      info->firmware = firmware;
-
-      for (c = 0; c < count; c++)
-      {
-         char path_key[64];
-         char desc_key[64];
-         char opt_key[64];
-         bool tmp_bool     = false;
-         char *tmp         = NULL;
-         path_key[0]       = desc_key[0] = opt_key[0] = '\0';
-
-         snprintf(path_key, sizeof(path_key), "firmware%u_path", c);
-         snprintf(desc_key, sizeof(desc_key), "firmware%u_desc", c);
-         snprintf(opt_key,  sizeof(opt_key),  "firmware%u_opt",  c);
-
-         if (config_get_string(config, path_key, &tmp) && !string_is_empty(tmp))
-         {
-            info->firmware[c].path = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
-         if (config_get_string(config, desc_key, &tmp) && !string_is_empty(tmp))
-         {
-            info->firmware[c].desc = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
-         if (tmp)
-            free(tmp);
-         tmp = NULL;
-         if (config_get_bool(config, opt_key , &tmp_bool))
-            info->firmware[c].optional = tmp_bool;
-      }
-   }
-}
-
 static void core_info_list_free(core_info_list_t *core_info_list)
 {
    size_t i, j;
@@ -166,12 +109,14 @@ static void core_info_list_free(core_info_list_t *core_info_list)
       string_list_free(info->licenses_list);
       string_list_free(info->categories_list);
       string_list_free(info->databases_list);
-      config_file_free((config_file_t*)info->config_data);
 
-      for (j = 0; j < info->firmware_count; j++)
+      if (info->firmware)
       {
-         free(info->firmware[j].path);
-         free(info->firmware[j].desc);
+         for (j = 0; j < info->firmware_count; j++)
+         {
+            free(info->firmware[j].path);
+            free(info->firmware[j].desc);
+         }
       }
       free(info->firmware);
    }
@@ -222,209 +167,632 @@ static bool core_info_list_iterate(
    return true;
 }
 
-static core_info_list_t *core_info_list_new(const char *path,
-      const char *libretro_info_dir,
-      const char *exts,
-      bool show_hidden_files)
+static char *core_info_config_strdup(config_file_t *conf, const char *key)
+{
+   char *tmp = NULL;
+   char *ret = NULL;
+
+   if (config_get_string(conf, key, &tmp) && !string_is_empty(tmp))
+      ret = strdup(tmp);
+   if (tmp)
+      free(tmp);
+
+   return ret;
+}
+
+static void core_info_parse_firmware(core_info_t *info,
+      config_file_t *conf)
+{
+   unsigned c;
+   core_info_firmware_t *firmware  = NULL;
+
+   if (!info->firmware_count)
+      return;
+
+   firmware = (core_info_firmware_t*)
+      calloc(info->firmware_count, sizeof(*firmware));
+
+   if (!firmware)
+      return;
+
+   info->firmware = firmware;
+
+   for (c = 0; c < info->firmware_count; c++)
+   {
+      char path_key[64];
+      char desc_key[64];
+      char opt_key[64];
+      bool tmp_bool     = false;
+      path_key[0]       = desc_key[0] = opt_key[0] = '\0';
+
+      snprintf(path_key, sizeof(path_key), "firmware%u_path", c);
+      snprintf(desc_key, sizeof(desc_key), "firmware%u_desc", c);
+      snprintf(opt_key,  sizeof(opt_key),  "firmware%u_opt",  c);
+
+      info->firmware[c].path = core_info_config_strdup(conf, path_key);
+      info->firmware[c].desc = core_info_config_strdup(conf, desc_key);
+
+      if (config_get_bool(conf, opt_key , &tmp_bool))
+         info->firmware[c].optional = tmp_bool;
+   }
+}
+
+static void core_info_parse_config_file(core_info_t *info,
+      config_file_t *conf)
+{
+   bool tmp_bool                = false;
+   unsigned count               = 0;
+
+   info->display_name           = core_info_config_strdup(conf, "display_name");
+   info->display_version        = core_info_config_strdup(conf, "display_version");
+   info->core_name              = core_info_config_strdup(conf, "corename");
+   info->systemname             = core_info_config_strdup(conf, "systemname");
+   info->system_manufacturer    = core_info_config_strdup(conf, "manufacturer");
+   info->supported_extensions   = core_info_config_strdup(conf, "supported_extensions");
+   info->authors                = core_info_config_strdup(conf, "authors");
+   info->permissions            = core_info_config_strdup(conf, "permissions");
+   info->licenses               = core_info_config_strdup(conf, "license");
+   info->categories             = core_info_config_strdup(conf, "categories");
+   info->databases              = core_info_config_strdup(conf, "database");
+   info->notes                  = core_info_config_strdup(conf, "notes");
+
+   config_get_uint(conf, "firmware_count", &count);
+   info->firmware_count         = count;
+
+   if (config_get_bool(conf, "supports_no_game",
+            &tmp_bool))
+      info->supports_no_game = tmp_bool;
+
+   if (config_get_bool(conf, "database_match_archive_member",
+            &tmp_bool))
+      info->database_match_archive_member = tmp_bool;
+
+   core_info_parse_firmware(info, conf);
+
+   info->has_info               = true;
+}
+
+/* Builds the '|'-separated lists out of the flat strings,
+ * shared by the .info parser and the cache loader. */
+static void core_info_resolve_lists(core_info_t *info)
+{
+   if (info->supported_extensions)
+      info->supported_extensions_list =
+         string_split(info->supported_extensions, "|");
+   if (info->authors)
+      info->authors_list     = string_split(info->authors, "|");
+   if (info->permissions)
+      info->permissions_list = string_split(info->permissions, "|");
+   if (info->licenses)
+      info->licenses_list    = string_split(info->licenses, "|");
+   if (info->categories)
+      info->categories_list  = string_split(info->categories, "|");
+   if (info->databases)
+      info->databases_list   = string_split(info->databases, "|");
+   if (info->notes)
+      info->note_list        = string_split(info->notes, "|");
+}
+
+/* Core info cache
+ *
+ * Parsing every .info file on each startup and core
+ * list refresh dominates core_info_init_list(). The
+ * parsed records are therefore serialized into a single
+ * file in the cache directory:
+ *
+ *   header | entries[count] | firmware[firmware_count] | strings
+ *
+ * String fields are stored as offsets into the string
+ * table (0 meaning NULL). The header records the info
+ * directory, each entry the size and modification time
+ * (in nanoseconds where the platform has them) of the
+ * .info file it was built from and the core path it
+ * belongs to; any difference against the current
+ * directory listing discards the whole cache and it is
+ * rebuilt from the .info files. The format is
+ * native-endian and only meant to be read back by the
+ * build that wrote it. */
+
+#define CORE_INFO_CACHE_MAGIC   0x49435241 /* "ARCI" */
+#define CORE_INFO_CACHE_VERSION 2
+
+enum core_info_cache_string
+{
+   CORE_INFO_CACHE_STRING_PATH = 0,
+   CORE_INFO_CACHE_STRING_DISPLAY_NAME,
+   CORE_INFO_CACHE_STRING_DISPLAY_VERSION,
+   CORE_INFO_CACHE_STRING_CORE_NAME,
+   CORE_INFO_CACHE_STRING_SYSTEM_MANUFACTURER,
+   CORE_INFO_CACHE_STRING_SYSTEMNAME,
+   CORE_INFO_CACHE_STRING_SUPPORTED_EXTENSIONS,
+   CORE_INFO_CACHE_STRING_AUTHORS,
+   CORE_INFO_CACHE_STRING_PERMISSIONS,
+   CORE_INFO_CACHE_STRING_LICENSES,
+   CORE_INFO_CACHE_STRING_CATEGORIES,
+   CORE_INFO_CACHE_STRING_DATABASES,
+   CORE_INFO_CACHE_STRING_NOTES,
+   CORE_INFO_CACHE_STRING_LAST
+};
+
+static const size_t core_info_cache_string_offsets[] = {
+   offsetof(core_info_t, path),
+   offsetof(core_info_t, display_name),
+   offsetof(core_info_t, display_version),
+   offsetof(core_info_t, core_name),
+   offsetof(core_info_t, system_manufacturer),
+   offsetof(core_info_t, systemname),
+   offsetof(core_info_t, supported_extensions),
+   offsetof(core_info_t, authors),
+   offsetof(core_info_t, permissions),
+   offsetof(core_info_t, licenses),
+   offsetof(core_info_t, categories),
+   offsetof(core_info_t, databases),
+   offsetof(core_info_t, notes)
+};
+
+#define CORE_INFO_CACHE_STRING(info, idx) \
+   (*(char**)((uint8_t*)(info) + core_info_cache_string_offsets[(idx)]))
+
+typedef struct
+{
+   uint32_t magic;
+   uint32_t version;
+   uint32_t entry_size;
+   uint32_t count;
+   uint32_t firmware_count;
+   uint32_t strings_size;
+   uint32_t info_dir;
+} core_info_cache_header_t;
+
+typedef struct
+{
+   int64_t info_mtime;
+   int32_t info_size;   /* -1 when the .info file is missing */
+   uint32_t strings[CORE_INFO_CACHE_STRING_LAST];
+   uint32_t firmware_count;
+   uint8_t has_info;
+   uint8_t supports_no_game;
+   uint8_t database_match_archive_member;
+   uint8_t pad;
+} core_info_cache_entry_t;
+
+typedef struct
+{
+   uint32_t path;
+   uint32_t desc;
+   uint32_t optional;
+} core_info_cache_firmware_t;
+
+/* Stat result of the .info file belonging to
+ * each core in the directory listing. */
+typedef struct
+{
+   int64_t mtime;
+   int32_t size;
+} core_info_cache_stat_t;
+
+static const char *core_info_cache_string(const char *strings,
+      uint32_t strings_size, uint32_t offset, bool *valid)
+{
+   if (!offset)
+      return NULL;
+   if (offset >= strings_size)
+   {
+      *valid = false;
+      return NULL;
+   }
+   return strings + offset;
+}
+
+static char *core_info_cache_strdup(const char *str)
+{
+   return str ? strdup(str) : NULL;
+}
+
+static core_info_list_t *core_info_cache_read(const char *cache_path,
+      const char *info_dir, const struct string_list *contents,
+      const core_info_cache_stat_t *stats)
 {
    size_t i;
-   core_info_t *core_info           = NULL;
-   core_info_list_t *core_info_list = NULL;
-   const char       *path_basedir   = libretro_info_dir;
-   struct string_list *contents     = dir_list_new(
-                                      path, exts,
-                                      false,
-                                      show_hidden_files,
-                                      false, false);
-   if (!contents)
+   core_info_cache_header_t header;
+   const uint8_t *entries                     = NULL;
+   const uint8_t *firmware                    = NULL;
+   const char *strings                        = NULL;
+   uint8_t *data                              = NULL;
+   core_info_t *core_info                     = NULL;
+   core_info_list_t *core_info_list           = NULL;
+   uint32_t firmware_pos                      = 0;
+   int64_t size                               = 0;
+   int64_t expected                           = 0;
+   bool valid                                 = true;
+   RFILE *file                                = filestream_open(cache_path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
       return NULL;
 
+   size = filestream_get_size(file);
+
+   if (size >= (int64_t)sizeof(header))
+      data = (uint8_t*)malloc((size_t)size);
+
+   if (!data || filestream_read(file, data, size) != size)
+   {
+      filestream_close(file);
+      goto error;
+   }
+
+   filestream_close(file);
+
+   memcpy(&header, data, sizeof(header));
+
+   if (     header.magic      != CORE_INFO_CACHE_MAGIC
+         || header.version    != CORE_INFO_CACHE_VERSION
+         || header.entry_size != sizeof(core_info_cache_entry_t)
+         || header.count      != contents->size
+         || header.strings_size == 0)
+      goto error;
+
+   expected = (int64_t)sizeof(header)
+      + (int64_t)header.count          * sizeof(core_info_cache_entry_t)
+      + (int64_t)header.firmware_count * sizeof(core_info_cache_firmware_t)
+      + (int64_t)header.strings_size;
+
+   if (expected != size)
+      goto error;
+
+   entries  = data + sizeof(header);
+   firmware = entries + header.count * sizeof(core_info_cache_entry_t);
+   strings  = (const char*)(firmware
+         + header.firmware_count * sizeof(core_info_cache_firmware_t));
+
+   if (strings[header.strings_size - 1] != '\0')
+      goto error;
+
+   /* The cache directory may be shared by several info directories */
+   if (!string_is_equal(info_dir, core_info_cache_string(strings,
+               header.strings_size, header.info_dir, &valid)))
+      goto error;
+
+   /* Validate everything against the current listing
+    * before allocating the list. */
+   for (i = 0; i < header.count; i++)
+   {
+      core_info_cache_entry_t entry;
+      const char *path = NULL;
+
+      memcpy(&entry, entries + i * sizeof(entry), sizeof(entry));
+
+      path = core_info_cache_string(strings, header.strings_size,
+            entry.strings[CORE_INFO_CACHE_STRING_PATH], &valid);
+
+      if (     !valid
+            || entry.info_size  != stats[i].size
+            || entry.info_mtime != stats[i].mtime
+            || !string_is_equal(path ? path : "", contents->elems[i].data)
+            || entry.firmware_count > header.firmware_count - firmware_pos)
+         goto error;
+
+      firmware_pos += entry.firmware_count;
+   }
+
    core_info_list = (core_info_list_t*)calloc(1, sizeof(*core_info_list));
    if (!core_info_list)
       goto error;
 
-   core_info = (core_info_t*)calloc(contents->size, sizeof(*core_info));
+   core_info      = (core_info_t*)calloc(header.count, sizeof(*core_info));
    if (!core_info)
       goto error;
 
    core_info_list->list  = core_info;
-   core_info_list->count = contents->size;
+   core_info_list->count = header.count;
+   firmware_pos          = 0;
 
-   for (i = 0; i < contents->size; i++)
+   for (i = 0; i < header.count; i++)
    {
-      size_t info_path_size = PATH_MAX_LENGTH * sizeof(char);
-      char *info_path       = (char*)malloc(PATH_MAX_LENGTH * sizeof(char));
+      unsigned j;
+      core_info_cache_entry_t entry;
+      core_info_t *info = &core_info[i];
 
-      info_path[0]          = '\0';
+      memcpy(&entry, entries + i * sizeof(entry), sizeof(entry));
 
-      if (
-            core_info_list_iterate(info_path, info_path_size,
-               path_basedir, contents, i)
-            && path_is_valid(info_path))
+      for (j = 0; j < CORE_INFO_CACHE_STRING_LAST; j++)
+         CORE_INFO_CACHE_STRING(info, j) = core_info_cache_strdup(
+               core_info_cache_string(strings, header.strings_size,
+                  entry.strings[j], &valid));
+
+      info->has_info                      = entry.has_info != 0;
+      info->supports_no_game              = entry.supports_no_game != 0;
+      info->database_match_archive_member =
+         entry.database_match_archive_member != 0;
+      info->firmware_count                = entry.firmware_count;
+
+      if (entry.firmware_count)
+         info->firmware = (core_info_firmware_t*)
+            calloc(entry.firmware_count, sizeof(*info->firmware));
+
+      for (j = 0; info->firmware && j < entry.firmware_count; j++)
       {
-         char *tmp           = NULL;
-         bool tmp_bool       = false;
-         unsigned count      = 0;
-         config_file_t *conf = config_file_new(info_path);
+         core_info_cache_firmware_t fw;
 
-         free(info_path);
+         memcpy(&fw, firmware + (firmware_pos + j) * sizeof(fw), sizeof(fw));
 
-         if (!conf)
-            continue;
+         info->firmware[j].path     = core_info_cache_strdup(
+               core_info_cache_string(strings, header.strings_size,
+                  fw.path, &valid));
+         info->firmware[j].desc     = core_info_cache_strdup(
+               core_info_cache_string(strings, header.strings_size,
+                  fw.desc, &valid));
+         info->firmware[j].optional = fw.optional != 0;
+      }
 
-         if (config_get_string(conf, "display_name", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].display_name = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
-         if (config_get_string(conf, "display_version", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].display_version = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
-         if (config_get_string(conf, "corename", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].core_name = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
+      firmware_pos += entry.firmware_count;
 
-         if (config_get_string(conf, "systemname", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].systemname = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
-         }
+      core_info_resolve_lists(info);
+   }
+
+   if (!valid)
+      goto error;
 
-         if (config_get_string(conf, "manufacturer", &tmp)
-               && !string_is_empty(tmp))
+   free(data);
+   return core_info_list;
+
+error:
+   free(data);
+   core_info_list_free(core_info_list);
+   return NULL;
+}
+
+/* Appends @str to the string table and returns its offset,
+ * or 0 for NULL. @strings may be NULL to only measure. */
+static uint32_t core_info_cache_put_string(char *strings,
+      uint32_t *strings_size, const char *str)
+{
+   uint32_t offset = *strings_size;
+   size_t len      = 0;
+
+   if (!str)
+      return 0;
+
+   len             = strlen(str) + 1;
+   if (strings)
+      memcpy(strings + offset, str, len);
+   *strings_size  += (uint32_t)len;
+
+   return offset;
+}
+
+static void core_info_cache_write(const char *cache_path,
+      const char *info_dir, const core_info_list_t *core_info_list,
+      const core_info_cache_stat_t *stats)
+{
+   size_t i, j;
+   size_t size                      = 0;
+   uint8_t *data                    = NULL;
+   uint8_t *entries                 = NULL;
+   uint8_t *firmware                = NULL;
+   char *strings                    = NULL;
+   uint32_t firmware_pos            = 0;
+   core_info_cache_header_t header;
+
+   header.magic          = CORE_INFO_CACHE_MAGIC;
+   header.version        = CORE_INFO_CACHE_VERSION;
+   header.entry_size     = sizeof(core_info_cache_entry_t);
+   header.count          = (uint32_t)core_info_list->count;
+   header.firmware_count = 0;
+   /* Offset 0 is reserved for NULL */
+   header.strings_size   = 1;
+   header.info_dir       = core_info_cache_put_string(NULL,
+         &header.strings_size, info_dir);
+
+   /* Measure */
+   for (i = 0; i < core_info_list->count; i++)
+   {
+      const core_info_t *info = &core_info_list->list[i];
+
+      for (j = 0; j < CORE_INFO_CACHE_STRING_LAST; j++)
+         core_info_cache_put_string(NULL, &header.strings_size,
+               CORE_INFO_CACHE_STRING(info, j));
+
+      header.firmware_count += (uint32_t)info->firmware_count;
+
+      for (j = 0; info->firmware && j < info->firmware_count; j++)
+      {
+         core_info_cache_put_string(NULL, &header.strings_size,
+               info->firmware[j].path);
+         core_info_cache_put_string(NULL, &header.strings_size,
+               info->firmware[j].desc);
+      }
+   }
+
+   size = sizeof(header)
+      + header.count          * sizeof(core_info_cache_entry_t)
+      + header.firmware_count * sizeof(core_info_cache_firmware_t)
+      + header.strings_size;
+
+   data = (uint8_t*)calloc(1, size);
+   if (!data)
+      return;
+
+   memcpy(data, &header, sizeof(header));
+
+   entries               = data + sizeof(header);
+   firmware              = entries
+      + header.count * sizeof(core_info_cache_entry_t);
+   strings               = (char*)(firmware
+      + header.firmware_count * sizeof(core_info_cache_firmware_t));
+   header.strings_size   = 1;
+   core_info_cache_put_string(strings, &header.strings_size, info_dir);
+
+   /* Fill */
+   for (i = 0; i < core_info_list->count; i++)
+   {
+      core_info_cache_entry_t entry;
+      const core_info_t *info = &core_info_list->list[i];
+
+      memset(&entry, 0, sizeof(entry));
+
+      entry.info_mtime     = stats[i].mtime;
+      entry.info_size      = stats[i].size;
+      entry.firmware_count = (uint32_t)info->firmware_count;
+      entry.has_info       = info->has_info;
+      entry.supports_no_game              = info->supports_no_game;
+      entry.database_match_archive_member =
+         info->database_match_archive_member;
+
+      for (j = 0; j < CORE_INFO_CACHE_STRING_LAST; j++)
+         entry.strings[j] = core_info_cache_put_string(strings,
+               &header.strings_size, CORE_INFO_CACHE_STRING(info, j));
+
+      for (j = 0; j < info->firmware_count; j++)
+      {
+         core_info_cache_firmware_t fw;
+
+         memset(&fw, 0, sizeof(fw));
+
+         if (info->firmware)
          {
-            core_info[i].system_manufacturer = strdup(tmp);
-            free(tmp);
-            tmp = NULL;
+            fw.path     = core_info_cache_put_string(strings,
+                  &header.strings_size, info->firmware[j].path);
+            fw.desc     = core_info_cache_put_string(strings,
+                  &header.strings_size, info->firmware[j].desc);
+            fw.optional = info->firmware[j].optional;
          }
 
-         config_get_uint(conf, "firmware_count", &count);
+         memcpy(firmware + (firmware_pos + j) * sizeof(fw),
+               &fw, sizeof(fw));
+      }
 
-         core_info[i].firmware_count = count;
+      firmware_pos += entry.firmware_count;
 
-         if (config_get_string(conf, "supported_extensions", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].supported_extensions      = strdup(tmp);
-            core_info[i].supported_extensions_list =
-               string_split(core_info[i].supported_extensions, "|");
+      memcpy(entries + i * sizeof(entry), &entry, sizeof(entry));
+   }
 
-            free(tmp);
-            tmp = NULL;
-         }
+   if (!filestream_write_file(cache_path, data, size))
+      RARCH_WARN("[Core Info]: Could not write cache \"%s\".\n", cache_path);
 
-         if (config_get_string(conf, "authors", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].authors      = strdup(tmp);
-            core_info[i].authors_list =
-               string_split(core_info[i].authors, "|");
+   free(data);
+}
 
-            free(tmp);
-            tmp = NULL;
-         }
+static core_info_list_t *core_info_list_new(const char *path,
+      const char *libretro_info_dir,
+      const char *cache_dir,
+      const char *exts,
+      bool show_hidden_files)
+{
+   size_t i;
+   char cache_path[PATH_MAX_LENGTH];
+   core_info_t *core_info           = NULL;
+   core_info_list_t *core_info_list = NULL;
+   core_info_cache_stat_t *stats    = NULL;
+   const char       *path_basedir   = libretro_info_dir;
+   struct string_list *contents     = dir_list_new(
+                                      path, exts,
+                                      false,
+                                      show_hidden_files,
+                                      false, false);
+   if (!contents)
+      return NULL;
 
-         if (config_get_string(conf, "permissions", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].permissions      = strdup(tmp);
-            core_info[i].permissions_list =
-               string_split(core_info[i].permissions, "|");
+   cache_path[0] = '\0';
 
-            free(tmp);
-            tmp = NULL;
-         }
+   stats = (core_info_cache_stat_t*)
+      calloc(contents->size + 1, sizeof(*stats));
+   if (!stats)
+      goto error;
 
-         if (config_get_string(conf, "license", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].licenses      = strdup(tmp);
-            core_info[i].licenses_list =
-               string_split(core_info[i].licenses, "|");
+   /* A single stat per .info file is all it takes
+    * to tell whether the cache is still current. */
+   for (i = 0; i < contents->size; i++)
+   {
+      char *info_path = (char*)malloc(PATH_MAX_LENGTH * sizeof(char));
 
-            free(tmp);
-            tmp = NULL;
-         }
+      stats[i].size   = -1;
+      stats[i].mtime  = 0;
+      info_path[0]    = '\0';
 
-         if (config_get_string(conf, "categories", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].categories      = strdup(tmp);
-            core_info[i].categories_list =
-               string_split(core_info[i].categories, "|");
+      if (core_info_list_iterate(info_path, PATH_MAX_LENGTH * sizeof(char),
+               path_basedir, contents, i)
+            && !path_get_size_mtime(info_path,
+               &stats[i].size, &stats[i].mtime))
+         stats[i].size = -1;
 
-            free(tmp);
-            tmp = NULL;
-         }
+      free(info_path);
+   }
 
-         if (config_get_string(conf, "database", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].databases      = strdup(tmp);
-            core_info[i].databases_list =
-               string_split(core_info[i].databases, "|");
+   /* The info directory is often read-only on system installs */
+   if (string_is_empty(cache_dir))
+      cache_dir = path_basedir;
 
-            free(tmp);
-            tmp = NULL;
-         }
+   if (!string_is_empty(cache_dir) && !string_is_empty(path_basedir))
+   {
+      fill_pathname_join(cache_path, cache_dir,
+            file_path_str(FILE_PATH_CORE_INFO_CACHE), sizeof(cache_path));
 
-         if (config_get_string(conf, "notes", &tmp)
-               && !string_is_empty(tmp))
-         {
-            core_info[i].notes     = strdup(tmp);
-            core_info[i].note_list = string_split(core_info[i].notes, "|");
+      core_info_list = core_info_cache_read(cache_path,
+            path_basedir, contents, stats);
+   }
 
-            free(tmp);
-            tmp = NULL;
-         }
+   if (core_info_list)
+      goto end;
 
-         if (tmp)
-            free(tmp);
-         tmp    = NULL;
+   core_info_list = (core_info_list_t*)calloc(1, sizeof(*core_info_list));
+   if (!core_info_list)
+      goto error;
 
-         if (config_get_bool(conf, "supports_no_game",
-               &tmp_bool))
-            core_info[i].supports_no_game = tmp_bool;
+   core_info = (core_info_t*)calloc(contents->size, sizeof(*core_info));
+   if (!core_info)
+      goto error;
 
-         if (config_get_bool(conf, "database_match_archive_member",
-               &tmp_bool))
-            core_info[i].database_match_archive_member = tmp_bool;
+   core_info_list->list  = core_info;
+   core_info_list->count = contents->size;
+
+   for (i = 0; i < contents->size; i++)
+   {
+      if (stats[i].size >= 0)
+      {
+         config_file_t *conf   = NULL;
+         size_t info_path_size = PATH_MAX_LENGTH * sizeof(char);
+         char *info_path       = (char*)malloc(PATH_MAX_LENGTH * sizeof(char));
+
+         info_path[0]          = '\0';
+
+         if (core_info_list_iterate(info_path, info_path_size,
+                  path_basedir, contents, i))
+            conf = config_file_new(info_path);
 
-         core_info[i].config_data = conf;
-      }
-      else
          free(info_path);
 
+         if (conf)
+         {
+            core_info_parse_config_file(&core_info[i], conf);
+            config_file_free(conf);
+         }
+      }
+
       if (!string_is_empty(contents->elems[i].data))
          core_info[i].path = strdup(contents->elems[i].data);
 
       if (!core_info[i].display_name)
          core_info[i].display_name =
             strdup(path_basename(core_info[i].path));
-   }
 
-   if (core_info_list)
-   {
-      core_info_list_resolve_all_extensions(core_info_list);
-      core_info_list_resolve_all_firmware(core_info_list);
+      core_info_resolve_lists(&core_info[i]);
    }
 
+   if (!string_is_empty(cache_path))
+      core_info_cache_write(cache_path, path_basedir, core_info_list, stats);
+
+end:
+   core_info_list_resolve_all_extensions(core_info_list);
+
+   free(stats);
    dir_list_free(contents);
    return core_info_list;
 
 error:
+   free(stats);
    if (contents)
       dir_list_free(contents);
    core_info_list_free(core_info_list);
@@ -643,10 +1011,11 @@ void core_info_deinit_list(void)
 }
 
 bool core_info_init_list(const char *path_info, const char *dir_cores,
-      const char *exts, bool show_hidden_files)
+      const char *dir_cache, const char *exts, bool show_hidden_files)
 {
    if (!(core_info_curr_list = core_info_list_new(dir_cores,
                !string_is_empty(path_info) ? path_info : dir_cores,
+               dir_cache,
                exts,
                show_hidden_files)))
       return false;
@@ -827,9 +1196,7 @@ size_t core_info_list_num_info_files(core_info_list_t *core_info_list)
 
    for (i = 0; i < core_info_list->count; i++)
    {
-      config_file_t *conf = (config_file_t*)
-         core_info_list->list[i].config_data;
-      num += !!conf;
+      num += core_info_list->list[i].has_info;
    }
 
    return num;
@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <assert.h>
 #include <stdarg.h>
+#include <time.h>
 
 #ifdef RARCH_INTERNAL
 #ifdef HAVE_CONFIG_H
@@ -20,6 +21,8 @@ extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libswscale/swscale.h>
 #include <libavutil/imgutils.h>
+#include <libavutil/cpu.h>
+#include <libavutil/pixdesc.h>
 #include <libavutil/time.h>
 #include <libavutil/opt.h>
 #include <libavdevice/avdevice.h>
@@ -129,7 +132,6 @@ static double pts_bias;
 
 /* Threaded FIFOs. */
 static volatile bool decode_thread_dead;
-static fifo_buffer_t *video_decode_fifo;
 static fifo_buffer_t *audio_decode_fifo;
 static scond_t *fifo_cond;
 static scond_t *fifo_decode_cond;
@@ -139,10 +141,63 @@ static sthread_t *decode_thread_handle;
 static double decode_last_video_time;
 static double decode_last_audio_time;
 
-static uint32_t *video_frame_temp_buffer;
-
 static bool main_sleeping;
 
+/* Decoded video frames.
+ * The decode thread converts straight into a free buffer of the pool
+ * and queues it, retro_run() takes it from the queue by pointer.
+ * Buffers are referenced while converted, queued or presented,
+ * and go back to the pool once the last reference is dropped.
+ * Protected by fifo_lock. */
+#define VIDEO_BUFFER_FRAMES 32
+
+struct video_buffer
+{
+   uint32_t *data;
+   int64_t pts;
+   unsigned refs;
+};
+
+static struct video_buffer video_buffers[VIDEO_BUFFER_FRAMES];
+static struct video_buffer *video_queue[VIDEO_BUFFER_FRAMES];
+static unsigned video_queue_head;
+static unsigned video_queue_size;
+/* Last buffer passed to video_cb, kept alive for dupes. */
+static struct video_buffer *video_current;
+static unsigned video_frames_decoded;
+static unsigned video_frames_dropped;
+/* Wall clock and process CPU time at load, for the unload report. */
+static int64_t play_start_time;
+static clock_t play_start_clock;
+
+/* Colour conversion.
+ * Frames are split into horizontal bands with an SwsContext each,
+ * the bands are converted by the decode thread and the conversion
+ * threads in parallel. Owned by the decode thread. */
+#define CONV_MAX_BANDS      8
+#define CONV_MIN_BAND_LINES 128
+
+struct conv_band
+{
+   struct SwsContext *sws;
+   sthread_t *thread;
+   unsigned y;
+   unsigned height;
+};
+
+static struct conv_band conv_bands[CONV_MAX_BANDS];
+static unsigned conv_bands_num;
+static slock_t *conv_lock;
+static scond_t *conv_cond;
+static scond_t *conv_done_cond;
+static unsigned conv_job;
+static unsigned conv_next;
+static unsigned conv_done;
+static bool conv_quit;
+static const AVFrame *conv_src;
+static AVFrame *conv_dst;
+static int64_t conv_time;
+
 /* Seeking. */
 static bool do_seek;
 static double seek_time;
@@ -388,6 +443,57 @@ static void check_variables(void)
    }
 }
 
+/* Video buffer pool, all called with fifo_lock held. */
+static struct video_buffer *video_buffer_get(void)
+{
+   unsigned i;
+
+   for (i = 0; i < VIDEO_BUFFER_FRAMES; i++)
+   {
+      if (!video_buffers[i].refs)
+      {
+         video_buffers[i].refs = 1;
+         return &video_buffers[i];
+      }
+   }
+
+   return NULL;
+}
+
+static void video_buffer_unref(struct video_buffer *buf)
+{
+   if (buf && buf->refs && --buf->refs == 0)
+      scond_signal(fifo_decode_cond);
+}
+
+static void video_queue_push(struct video_buffer *buf)
+{
+   video_queue[(video_queue_head + video_queue_size)
+      % VIDEO_BUFFER_FRAMES] = buf;
+   video_queue_size++;
+}
+
+static struct video_buffer *video_queue_pop(void)
+{
+   struct video_buffer *buf = NULL;
+
+   if (!video_queue_size)
+      return NULL;
+
+   buf              = video_queue[video_queue_head];
+   video_queue_head = (video_queue_head + 1) % VIDEO_BUFFER_FRAMES;
+   video_queue_size--;
+
+   return buf;
+}
+
+static void video_queue_clear(void)
+{
+   while (video_queue_size)
+      video_buffer_unref(video_queue_pop());
+   video_queue_head = 0;
+}
+
 static void seek_frame(int seek_frames)
 {
    char msg[256];
@@ -416,8 +522,7 @@ static void seek_frame(int seek_frames)
    }
    audio_frames = frame_cnt * media.sample_rate / media.interpolate_fps;
 
-   if (video_decode_fifo)
-      fifo_clear(video_decode_fifo);
+   video_queue_clear();
    if (audio_decode_fifo)
       fifo_clear(audio_decode_fifo);
    scond_signal(fifo_decode_cond);
@@ -610,13 +715,13 @@ void CORE_PREFIX(retro_run)(void)
 
       while (!decode_thread_dead && min_pts > frames[1].pts)
       {
-         size_t to_read_frame_bytes;
-         int64_t pts = 0;
+         double pts;
+         bool superseded;
+         struct video_buffer *buf = NULL;
 
          slock_lock(fifo_lock);
-         to_read_frame_bytes = media.width * media.height * sizeof(uint32_t) + sizeof(int64_t);
 
-         while (!decode_thread_dead && fifo_read_avail(video_decode_fifo) < to_read_frame_bytes)
+         while (!decode_thread_dead && !video_queue_size)
          {
             main_sleeping = true;
             scond_signal(fifo_decode_cond);
@@ -625,52 +730,77 @@ void CORE_PREFIX(retro_run)(void)
          }
 
          if (!decode_thread_dead)
+            buf = video_queue_pop();
+
+         if (!buf)
          {
-            uint32_t *data = video_frame_temp_buffer;
-            fifo_read(video_decode_fifo, &pts, sizeof(int64_t));
+            slock_unlock(fifo_lock);
+            break;
+         }
+
+         pts = av_q2d(fctx->streams[video_stream]->time_base) * buf->pts;
+
+         /* Too late to be shown, the loop moves on to the next one. */
+         superseded = min_pts > pts;
+         if (superseded)
+            video_frames_dropped++;
+
+         /* Nobody is going to see this one, don't bother uploading it. */
+         if (superseded && video_queue_size)
+         {
+            video_buffer_unref(buf);
+            slock_unlock(fifo_lock);
+            frames[1].pts = pts;
+            continue;
+         }
+
+         slock_unlock(fifo_lock);
+
 #if defined(HAVE_OPENGL) || defined(HAVE_OPENGLES)
-            if (use_gl)
-            {
+         if (use_gl)
+         {
+            uint32_t *data = buf->data;
 #ifndef HAVE_OPENGLES
-               glBindBuffer(GL_PIXEL_UNPACK_BUFFER, frames[1].pbo);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, frames[1].pbo);
 #ifdef __MACH__
-               data = (uint32_t*)glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+            data = (uint32_t*)glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
 #else
-               data = (uint32_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
-                     0, media.width * media.height * sizeof(uint32_t), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+            data = (uint32_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+                  0, media.width * media.height * sizeof(uint32_t), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
 #endif
+            memcpy(data, buf->data, media.width * media.height * sizeof(uint32_t));
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
 #endif
-
-               fifo_read(video_decode_fifo, data, media.width * media.height * sizeof(uint32_t));
-
-#ifndef HAVE_OPENGLES
-               glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
-#endif
-               glBindTexture(GL_TEXTURE_2D, frames[1].tex);
+            glBindTexture(GL_TEXTURE_2D, frames[1].tex);
 #if defined(HAVE_OPENGLES)
-               glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
-                     media.width, media.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
+                  media.width, media.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
 #else
-               glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
-                     media.width, media.height, 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, NULL);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA,
+                  media.width, media.height, 0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, NULL);
 #endif
-               glBindTexture(GL_TEXTURE_2D, 0);
+            glBindTexture(GL_TEXTURE_2D, 0);
 #ifndef HAVE_OPENGLES
-               glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 #endif
-            }
-            else
+
+            slock_lock(fifo_lock);
+            video_buffer_unref(buf);
+            slock_unlock(fifo_lock);
+         }
+         else
 #endif
-            {
-               fifo_read(video_decode_fifo, data, media.width * media.height * sizeof(uint32_t));
-               dupe = false;
-            }
+         {
+            /* Handed to video_cb as is, hold on to it until the
+             * next frame replaces it. */
+            slock_lock(fifo_lock);
+            video_buffer_unref(video_current);
+            slock_unlock(fifo_lock);
+            video_current = buf;
+            dupe          = false;
          }
 
-         scond_signal(fifo_decode_cond);
-         slock_unlock(fifo_lock);
-
-         frames[1].pts = av_q2d(fctx->streams[video_stream]->time_base) * pts;
+         frames[1].pts = pts;
       }
 
 #if defined(HAVE_OPENGL) || defined(HAVE_OPENGLES)
@@ -719,7 +849,7 @@ void CORE_PREFIX(retro_run)(void)
       else
 #endif
       {
-         CORE_PREFIX(video_cb)(dupe ? NULL : video_frame_temp_buffer,
+         CORE_PREFIX(video_cb)(dupe ? NULL : video_current->data,
                media.width, media.height, media.width * sizeof(uint32_t));
       }
    }
@@ -765,6 +895,15 @@ static bool open_codec(AVCodecContext **ctx, unsigned index)
    }
 
    *ctx = fctx->streams[index]->codec;
+
+   /* Let libavcodec pick the thread count and decode several
+    * frames, or slices of one frame, at once. */
+   if ((*ctx)->codec_type == AVMEDIA_TYPE_VIDEO)
+   {
+      (*ctx)->thread_count = 0;
+      (*ctx)->thread_type  = FF_THREAD_FRAME | FF_THREAD_SLICE;
+   }
+
    if (avcodec_open2(*ctx, codec, NULL) < 0)
       return false;
 
@@ -995,28 +1134,217 @@ static void set_colorspace(struct SwsContext *sws,
    }
 }
 
-static bool decode_video(AVPacket *pkt, AVFrame *frame,
-      AVFrame *conv, struct SwsContext *sws)
+static void conv_scale_band(const struct conv_band *band,
+      const AVFrame *src, AVFrame *dst)
 {
-   int got_ptr = 0;
-   int ret     = avcodec_decode_video2(vctx, frame, &got_ptr, pkt);
+   unsigned i;
+   const uint8_t *src_data[4];
+   uint8_t *dst_data[4];
+   const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(vctx->pix_fmt);
+   int planes                     = av_pix_fmt_count_planes(vctx->pix_fmt);
 
-   if (ret < 0)
-      return false;
+   for (i = 0; i < 4; i++)
+   {
+      unsigned y;
+
+      /* Unknown formats are converted as a single band, see conv_init(). */
+      if (!desc)
+      {
+         src_data[i] = src->data[i];
+         dst_data[i] = dst->data[i];
+         continue;
+      }
+
+      /* Planes 1 and 2 hold the (possibly subsampled) chroma. */
+      y           = (i == 1 || i == 2) ? band->y >> desc->log2_chroma_h : band->y;
+
+      /* Anything past the image planes, like a palette, is passed as is. */
+      src_data[i] = src->data[i] && (int)i < planes
+         ? src->data[i] + y * src->linesize[i] : src->data[i];
+      dst_data[i] = dst->data[i] ? dst->data[i] + band->y * dst->linesize[i] : NULL;
+   }
 
-   if (got_ptr)
+   set_colorspace(band->sws, media.width, media.height,
+         av_frame_get_colorspace(src), av_frame_get_color_range(src));
+   sws_scale(band->sws, src_data, src->linesize, 0, band->height,
+         dst_data, dst->linesize);
+}
+
+static void conv_run_bands(void)
+{
+   slock_lock(conv_lock);
+
+   while (conv_next < conv_bands_num)
    {
-      set_colorspace(sws, media.width, media.height,
-            av_frame_get_colorspace(frame), av_frame_get_color_range(frame));
-      sws_scale(sws, (const uint8_t * const*)frame->data,
-            frame->linesize, 0, media.height,
-            conv->data, conv->linesize);
-      return true;
+      const struct conv_band *band = &conv_bands[conv_next++];
+      const AVFrame *src           = conv_src;
+      AVFrame *dst                 = conv_dst;
+
+      slock_unlock(conv_lock);
+      conv_scale_band(band, src, dst);
+      slock_lock(conv_lock);
+
+      if (++conv_done == conv_bands_num)
+         scond_signal(conv_done_cond);
    }
 
+   slock_unlock(conv_lock);
+}
+
+static void conv_thread(void *data)
+{
+   unsigned job = 0;
+
+   (void)data;
+
+   slock_lock(conv_lock);
+
+   for (;;)
+   {
+      while (!conv_quit && job == conv_job)
+         scond_wait(conv_cond, conv_lock);
+
+      if (conv_quit)
+         break;
+
+      job = conv_job;
+      slock_unlock(conv_lock);
+      conv_run_bands();
+      slock_lock(conv_lock);
+   }
+
+   slock_unlock(conv_lock);
+}
+
+static void conv_deinit(void)
+{
+   unsigned i;
+
+   if (conv_lock)
+   {
+      slock_lock(conv_lock);
+      conv_quit = true;
+      scond_broadcast(conv_cond);
+      slock_unlock(conv_lock);
+   }
+
+   for (i = 0; i < CONV_MAX_BANDS; i++)
+   {
+      if (conv_bands[i].thread)
+         sthread_join(conv_bands[i].thread);
+      if (conv_bands[i].sws)
+         sws_freeContext(conv_bands[i].sws);
+   }
+
+   if (conv_cond)
+      scond_free(conv_cond);
+   if (conv_done_cond)
+      scond_free(conv_done_cond);
+   if (conv_lock)
+      slock_free(conv_lock);
+
+   memset(conv_bands, 0, sizeof(conv_bands));
+   conv_bands_num = 0;
+   conv_cond      = NULL;
+   conv_done_cond = NULL;
+   conv_lock      = NULL;
+   conv_quit      = false;
+}
+
+static bool conv_init(unsigned bands)
+{
+   unsigned i;
+   unsigned align;
+   unsigned lines;
+   const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(vctx->pix_fmt);
+
+   /* Hardware frames have no lines to split. */
+   if (!desc || (desc->flags & AV_PIX_FMT_FLAG_HWACCEL))
+      bands = 1;
+
+   /* Band edges must fall on chroma lines. */
+   align = 16;
+   lines = ((media.height + bands - 1) / bands + align - 1) & ~(align - 1);
+
+   for (i = 0; i < bands && i * lines < media.height; i++)
+   {
+      struct conv_band *band = &conv_bands[i];
+
+      band->y      = i * lines;
+      band->height = media.height - band->y;
+      if (band->height > lines)
+         band->height = lines;
+      band->sws    = sws_getContext(media.width, band->height, vctx->pix_fmt,
+            media.width, band->height, PIX_FMT_RGB32,
+            SWS_POINT, NULL, NULL, NULL);
+
+      if (!band->sws)
+         goto error;
+   }
+
+   /* Rounding may leave fewer bands than asked for. */
+   conv_bands_num = i;
+
+   if (conv_bands_num < 2)
+      return true;
+
+   conv_lock      = slock_new();
+   conv_cond      = scond_new();
+   conv_done_cond = scond_new();
+
+   if (!conv_lock || !conv_cond || !conv_done_cond)
+      goto error;
+
+   /* The decode thread converts a band itself. */
+   for (i = 1; i < conv_bands_num; i++)
+      conv_bands[i].thread = sthread_create(conv_thread, NULL);
+
+   return true;
+
+error:
+   conv_deinit();
    return false;
 }
 
+static void conv_scale(const AVFrame *src, AVFrame *dst)
+{
+   int64_t start = av_gettime();
+
+   if (conv_bands_num < 2)
+      conv_scale_band(&conv_bands[0], src, dst);
+   else
+   {
+      slock_lock(conv_lock);
+      conv_src  = src;
+      conv_dst  = dst;
+      conv_next = 0;
+      conv_done = 0;
+      conv_job++;
+      scond_broadcast(conv_cond);
+      slock_unlock(conv_lock);
+
+      conv_run_bands();
+
+      slock_lock(conv_lock);
+      while (conv_done < conv_bands_num)
+         scond_wait(conv_done_cond, conv_lock);
+      slock_unlock(conv_lock);
+   }
+
+   conv_time += av_gettime() - start;
+}
+
+static bool decode_video(AVPacket *pkt, AVFrame *frame)
+{
+   int got_ptr = 0;
+   int ret     = avcodec_decode_video2(vctx, frame, &got_ptr, pkt);
+
+   if (ret < 0)
+      return false;
+
+   return got_ptr != 0;
+}
+
 static int16_t *decode_audio(AVCodecContext *ctx, AVPacket *pkt,
       AVFrame *frame, int16_t *buffer, size_t *buffer_cap,
       SwrContext *swr)
@@ -1164,20 +1492,31 @@ static void decode_thread(void *data)
    SwrContext *swr[audio_streams_num];
    AVFrame *aud_frame      = NULL;
    AVFrame *vid_frame      = NULL;
-   void *conv_frame_buf    = NULL;
    size_t frame_size       = 0;
    int16_t *audio_buffer   = NULL;
    size_t audio_buffer_cap = 0;
    AVFrame *conv_frame     = NULL;
-   struct SwsContext *sws  = NULL;
+   bool eof                = false;
 
    (void)data;
 
    if (video_stream >= 0)
-      sws = sws_getCachedContext(NULL,
-            media.width, media.height, vctx->pix_fmt,
-            media.width, media.height, PIX_FMT_RGB32,
-            SWS_POINT, NULL, NULL, NULL);
+   {
+      int bands = av_cpu_count();
+
+      if (bands > CONV_MAX_BANDS)
+         bands = CONV_MAX_BANDS;
+      if (bands > (int)(media.height / CONV_MIN_BAND_LINES))
+         bands = media.height / CONV_MIN_BAND_LINES;
+      if (bands < 1)
+         bands = 1;
+
+      if (!conv_init(bands) && !conv_init(1))
+         log_cb(RETRO_LOG_ERROR, "Failed to create colour conversion context.\n");
+      else
+         log_cb(RETRO_LOG_INFO, "Converting video in %u band(s).\n",
+               conv_bands_num);
+   }
 
    for (i = 0; (int)i < audio_streams_num; i++)
    {
@@ -1199,9 +1538,6 @@ static void decode_thread(void *data)
    {
       frame_size = avpicture_get_size(PIX_FMT_RGB32, media.width, media.height);
       conv_frame = av_frame_alloc();
-      conv_frame_buf = av_malloc(frame_size);
-      avpicture_fill((AVPicture*)conv_frame, (const uint8_t*)conv_frame_buf,
-            PIX_FMT_RGB32, media.width, media.height);
    }
 
    while (!decode_thread_dead)
@@ -1230,8 +1566,7 @@ static void decode_thread(void *data)
          do_seek = false;
          seek_time = 0.0;
 
-         if (video_decode_fifo)
-            fifo_clear(video_decode_fifo);
+         video_queue_clear();
          if (audio_decode_fifo)
             fifo_clear(audio_decode_fifo);
 
@@ -1241,7 +1576,15 @@ static void decode_thread(void *data)
 
       memset(&pkt, 0, sizeof(pkt));
       if (av_read_frame(fctx, &pkt) < 0)
-         break;
+      {
+         /* Frame threading holds back a few frames,
+          * flush them out with empty packets. */
+         if (video_stream < 0 || eof)
+            break;
+
+         memset(&pkt, 0, sizeof(pkt));
+         pkt.stream_index = video_stream;
+      }
 
       slock_lock(decode_thread_lock);
       audio_stream                = audio_streams[audio_streams_ptr];
@@ -1256,57 +1599,71 @@ static void decode_thread(void *data)
 
       if (pkt.stream_index == video_stream)
       {
-         if (decode_video(&pkt, vid_frame, conv_frame, sws))
+         if (!conv_bands_num)
+            eof = !pkt.data;
+         else if (decode_video(&pkt, vid_frame))
          {
-            size_t decoded_size;
+            struct video_buffer *buf = NULL;
             int64_t pts       = av_frame_get_best_effort_timestamp(vid_frame);
             double video_time = pts * av_q2d(fctx->streams[video_stream]->time_base);
 
-#ifdef HAVE_SSA
-            if (ass_render && ass_track_active)
-            {
-               int change     = 0;
-               ASS_Image *img = ass_render_frame(ass_render, ass_track_active,
-                     1000 * video_time, &change);
-
-               /* Do it on CPU for now.
-                * We're in a thread anyways, so shouldn't really matter. */
-               render_ass_img(conv_frame, img);
-            }
-#endif
-
-            decoded_size = frame_size + sizeof(pts);
             slock_lock(fifo_lock);
 
-            while (!decode_thread_dead  && (video_decode_fifo != NULL)
-                  && fifo_write_avail(video_decode_fifo) < decoded_size)
+            while (!decode_thread_dead && !(buf = video_buffer_get()))
             {
                if (!main_sleeping)
                   scond_wait(fifo_decode_cond, fifo_lock);
                else
                {
-                  fifo_clear(video_decode_fifo);
-                  break;
+                  video_frames_dropped += video_queue_size;
+                  video_queue_clear();
                }
             }
 
             decode_last_video_time = video_time;
-            if (!decode_thread_dead)
+            slock_unlock(fifo_lock);
+
+            if (buf && !buf->data)
+               buf->data = (uint32_t*)av_malloc(frame_size);
+
+            if (buf && buf->data)
             {
-               int stride;
-               unsigned y;
-               const uint8_t *src = NULL;
+               /* Convert straight into the buffer retro_run() gets. */
+               avpicture_fill((AVPicture*)conv_frame, (const uint8_t*)buf->data,
+                     PIX_FMT_RGB32, media.width, media.height);
+               conv_scale(vid_frame, conv_frame);
+
+#ifdef HAVE_SSA
+               if (ass_render && ass_track_active)
+               {
+                  int change     = 0;
+                  ASS_Image *img = ass_render_frame(ass_render, ass_track_active,
+                        1000 * video_time, &change);
 
-               fifo_write(video_decode_fifo, &pts, sizeof(pts));
-               src    = conv_frame->data[0];
-               stride = conv_frame->linesize[0];
+                  /* Do it on CPU for now.
+                   * We're in a thread anyways, so shouldn't really matter. */
+                  render_ass_img(conv_frame, img);
+               }
+#endif
+            }
 
-               for (y = 0; y < media.height; y++, src += stride)
-                  fifo_write(video_decode_fifo, src, media.width * sizeof(uint32_t));
+            slock_lock(fifo_lock);
+            if (buf)
+            {
+               if (!decode_thread_dead && buf->data)
+               {
+                  buf->pts = pts;
+                  video_queue_push(buf);
+                  video_frames_decoded++;
+               }
+               else
+                  video_buffer_unref(buf);
             }
             scond_signal(fifo_cond);
             slock_unlock(fifo_lock);
          }
+         else
+            eof = !pkt.data;
       }
       else if (pkt.stream_index == audio_stream && actx_active)
       {
@@ -1345,9 +1702,7 @@ static void decode_thread(void *data)
       av_free_packet(&pkt);
    }
 
-   if (sws)
-      sws_freeContext(sws);
-   sws = NULL;
+   conv_deinit();
 
    for (i = 0; (int)i < audio_streams_num; i++)
       swr_free(&swr[i]);
@@ -1355,7 +1710,6 @@ static void decode_thread(void *data)
    av_frame_free(&aud_frame);
    av_frame_free(&vid_frame);
    av_frame_free(&conv_frame);
-   av_freep(&conv_frame_buf);
    av_freep(&audio_buffer);
 
    slock_lock(fifo_lock);
@@ -1485,8 +1839,6 @@ void CORE_PREFIX(retro_unload_game)(void)
    if (decode_thread_lock)
       slock_free(decode_thread_lock);
 
-   if (video_decode_fifo)
-      fifo_free(video_decode_fifo);
    if (audio_decode_fifo)
       fifo_free(audio_decode_fifo);
 
@@ -1494,9 +1846,33 @@ void CORE_PREFIX(retro_unload_game)(void)
    fifo_decode_cond = NULL;
    fifo_lock = NULL;
    decode_thread_lock = NULL;
-   video_decode_fifo = NULL;
    audio_decode_fifo = NULL;
 
+   if (video_frames_decoded)
+   {
+      double wall = (av_gettime() - play_start_time) / 1000000.0;
+      double cpu  = (double)(clock() - play_start_clock) / CLOCKS_PER_SEC;
+
+      log_cb(RETRO_LOG_INFO,
+            "Video: %u frames decoded, %u dropped, %.3f ms colour conversion per frame.\n",
+            video_frames_decoded, video_frames_dropped,
+            conv_time / (1000.0 * video_frames_decoded));
+      if (wall > 0.0)
+         log_cb(RETRO_LOG_INFO,
+               "Video: %.1f s played, process CPU %.1f%% of one core.\n",
+               wall, 100.0 * cpu / wall);
+   }
+
+   for (i = 0; i < VIDEO_BUFFER_FRAMES; i++)
+      av_freep(&video_buffers[i].data);
+   memset(video_buffers, 0, sizeof(video_buffers));
+   video_queue_head     = 0;
+   video_queue_size     = 0;
+   video_current        = NULL;
+   video_frames_decoded = 0;
+   video_frames_dropped = 0;
+   conv_time            = 0;
+
    decode_last_video_time = 0.0;
    decode_last_audio_time = 0.0;
 
@@ -1550,8 +1926,6 @@ void CORE_PREFIX(retro_unload_game)(void)
    ass_render = NULL;
    ass = NULL;
 #endif
-
-   av_freep(&video_frame_temp_buffer);
 }
 
 bool CORE_PREFIX(retro_load_game)(const struct retro_game_info *info)
@@ -1612,9 +1986,6 @@ bool CORE_PREFIX(retro_load_game)(const struct retro_game_info *info)
 
    if (video_stream >= 0 || is_fft)
    {
-      video_decode_fifo = fifo_new(media.width
-            * media.height * sizeof(uint32_t) * 32);
-
 #if defined(HAVE_OPENGL) || defined(HAVE_OPENGLES)
       use_gl = true;
       hw_render.context_reset      = context_reset;
@@ -1650,11 +2021,10 @@ bool CORE_PREFIX(retro_load_game)(const struct retro_game_info *info)
 
    check_variables();
 
+   play_start_time      = av_gettime();
+   play_start_clock     = clock();
    decode_thread_handle = sthread_create(decode_thread, NULL);
 
-   video_frame_temp_buffer = (uint32_t*)
-      av_malloc(media.width * media.height * sizeof(uint32_t));
-
    pts_bias = 0.0;
 
    return true;
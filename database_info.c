@@ -17,6 +17,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 
 #include <compat/strl.h>
 #include <retro_endianness.h>
@@ -26,6 +27,8 @@
 #include <string/stdstring.h>
 
 #include "libretro-db/libretrodb.h"
+#include "libretro-db/query.h"
+#include "libretro-db/rmsgpack.h"
 
 #include "core_info.h"
 #include "database_info.h"
@@ -149,195 +152,202 @@ char *bin_to_hex_alloc(const uint8_t *data, size_t len)
 }
 
 
-static int database_cursor_iterate(libretrodb_cursor_t *cur,
-      database_info_t *db_info)
+static bool database_info_key_is(const char *key, uint32_t len,
+      const char *name)
 {
-   unsigned i;
-   struct rmsgpack_dom_value item;
-   const char* str                = NULL;
+   return strlen(name) == len && !memcmp(key, name, len);
+}
+
+/* Copies a string value, NULL unless it is a non-empty string. */
+static char *database_info_view_strdup(const struct rmsgpack_view *val)
+{
+   char *str = NULL;
+
+   if (val->type != RDT_STRING || !val->val.string.len)
+      return NULL;
+
+   if (!(str = (char*)malloc(val->val.string.len + 1)))
+      return NULL;
+
+   memcpy(str, val->val.string.buff, val->val.string.len);
+   str[val->val.string.len] = '\0';
+
+   return str;
+}
 
-   if (libretrodb_cursor_read_item(cur, &item) != 0)
-      return -1;
+static void database_info_parse_field(database_info_t *db_info,
+      const char *key, uint32_t len, const struct rmsgpack_view *val)
+{
+   if (database_info_key_is(key, len, "publisher"))
+      db_info->publisher            = database_info_view_strdup(val);
+   else if (database_info_key_is(key, len, "developer"))
+   {
+      char *developer               = database_info_view_strdup(val);
+      if (developer)
+         db_info->developer         = string_split(developer, "|");
+      free(developer);
+   }
+   else if (database_info_key_is(key, len, "serial"))
+      db_info->serial               = database_info_view_strdup(val);
+   else if (database_info_key_is(key, len, "rom_name"))
+      db_info->rom_name             = database_info_view_strdup(val);
+   else if (database_info_key_is(key, len, "name"))
+      db_info->name                 = database_info_view_strdup(val);
+   else if (database_info_key_is(key, len, "description"))
+      db_info->description          = database_info_view_strdup(val);
+   else if (database_info_key_is(key, len, "genre"))
+      db_info->genre                = database_info_view_strdup(val);
+   else if (database_info_key_is(key, len, "origin"))
+      db_info->origin               = database_info_view_strdup(val);
+   else if (database_info_key_is(key, len, "franchise"))
+      db_info->franchise            = database_info_view_strdup(val);
+   else if (database_info_key_is(key, len, "bbfc_rating"))
+      db_info->bbfc_rating          = database_info_view_strdup(val);
+   else if (database_info_key_is(key, len, "esrb_rating"))
+      db_info->esrb_rating          = database_info_view_strdup(val);
+   else if (database_info_key_is(key, len, "elspa_rating"))
+      db_info->elspa_rating         = database_info_view_strdup(val);
+   else if (database_info_key_is(key, len, "cero_rating"))
+      db_info->cero_rating          = database_info_view_strdup(val);
+   else if (database_info_key_is(key, len, "pegi_rating"))
+      db_info->pegi_rating          = database_info_view_strdup(val);
+   else if (database_info_key_is(key, len, "enhancement_hw"))
+      db_info->enhancement_hw       = database_info_view_strdup(val);
+   else if (database_info_key_is(key, len, "edge_review"))
+      db_info->edge_magazine_review = database_info_view_strdup(val);
+   else if (database_info_key_is(key, len, "edge_rating"))
+      db_info->edge_magazine_rating    = (unsigned)val->val.uint_;
+   else if (database_info_key_is(key, len, "edge_issue"))
+      db_info->edge_magazine_issue     = (unsigned)val->val.uint_;
+   else if (database_info_key_is(key, len, "famitsu_rating"))
+      db_info->famitsu_magazine_rating = (unsigned)val->val.uint_;
+   else if (database_info_key_is(key, len, "tgdb_rating"))
+      db_info->tgdb_rating             = (unsigned)val->val.uint_;
+   else if (database_info_key_is(key, len, "users"))
+      db_info->max_users               = (unsigned)val->val.uint_;
+   else if (database_info_key_is(key, len, "releasemonth"))
+      db_info->releasemonth            = (unsigned)val->val.uint_;
+   else if (database_info_key_is(key, len, "releaseyear"))
+      db_info->releaseyear             = (unsigned)val->val.uint_;
+   else if (database_info_key_is(key, len, "rumble"))
+      db_info->rumble_supported        = (int)val->val.uint_;
+   else if (database_info_key_is(key, len, "coop"))
+      db_info->coop_supported          = (int)val->val.uint_;
+   else if (database_info_key_is(key, len, "analog"))
+      db_info->analog_supported        = (int)val->val.uint_;
+   else if (database_info_key_is(key, len, "size"))
+      db_info->size                    = (unsigned)val->val.uint_;
+   else if (database_info_key_is(key, len, "crc"))
+   {
+      uint32_t crc = 0;
 
-   if (item.type != RDT_MAP)
+      /* Mapped records are not aligned */
+      if (val->type == RDT_BINARY && val->val.binary.len >= sizeof(crc))
+         memcpy(&crc, val->val.binary.buff, sizeof(crc));
+      db_info->crc32 = swap_if_little32(crc);
+   }
+   else if (database_info_key_is(key, len, "sha1"))
+      db_info->sha1 = bin_to_hex_alloc(
+            (const uint8_t*)val->val.binary.buff, val->val.binary.len);
+   else if (database_info_key_is(key, len, "md5"))
+      db_info->md5 = bin_to_hex_alloc(
+            (const uint8_t*)val->val.binary.buff, val->val.binary.len);
+   else
    {
-      rmsgpack_dom_value_free(&item);
-      return 1;
+      RARCH_LOG("Unknown key: %.*s\n", (int)len, key);
    }
+}
 
+static void database_info_init_item(database_info_t *db_info)
+{
    db_info->analog_supported       = -1;
    db_info->rumble_supported       = -1;
    db_info->coop_supported         = -1;
+}
+
+static int database_info_parse_item(struct rmsgpack_dom_value *item,
+      database_info_t *db_info)
+{
+   unsigned i;
 
-   for (i = 0; i < item.val.map.len; i++)
+   if (item->type != RDT_MAP)
    {
-      struct rmsgpack_dom_value *key = &item.val.map.items[i].key;
-      struct rmsgpack_dom_value *val = &item.val.map.items[i].value;
-      const char *val_string         = NULL;
+      rmsgpack_dom_value_free(item);
+      return 1;
+   }
 
-      if (!key || !val)
-         continue;
+   database_info_init_item(db_info);
 
-      val_string                     = val->val.string.buff;
-      str                            = key->val.string.buff;
+   for (i = 0; i < item->val.map.len; i++)
+   {
+      struct rmsgpack_view view;
+      struct rmsgpack_dom_value *key = &item->val.map.items[i].key;
+      struct rmsgpack_dom_value *val = &item->val.map.items[i].value;
 
-      if (string_is_equal(str, "publisher"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->publisher = strdup(val_string);
-      }
-      else if (string_is_equal(str, "developer"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->developer = string_split(val_string, "|");
-      }
-      else if (string_is_equal(str, "serial"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->serial = strdup(val_string);
-      }
-      else if (string_is_equal(str, "rom_name"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->rom_name = strdup(val_string);
-      }
-      else if (string_is_equal(str, "name"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->name = strdup(val_string);
-      }
-      else if (string_is_equal(str, "description"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->description = strdup(val_string);
-      }
-      else if (string_is_equal(str, "genre"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->genre = strdup(val_string);
-      }
-      else if (string_is_equal(str, "origin"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->origin = strdup(val_string);
-      }
-      else if (string_is_equal(str, "franchise"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->franchise = strdup(val_string);
-      }
-      else if (string_is_equal(str, "bbfc_rating"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->bbfc_rating = strdup(val_string);
-      }
-      else if (string_is_equal(str, "esrb_rating"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->esrb_rating = strdup(val_string);
-      }
-      else if (string_is_equal(str, "elspa_rating"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->elspa_rating = strdup(val_string);
-      }
-      else if (string_is_equal(str, "cero_rating"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->cero_rating          = strdup(val_string);
-      }
-      else if (string_is_equal(str, "pegi_rating"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->pegi_rating          = strdup(val_string);
-      }
-      else if (string_is_equal(str, "enhancement_hw"))
-      {
-         if (!string_is_empty(val_string))
-            db_info->enhancement_hw       = strdup(val_string);
-      }
-      else if (string_is_equal(str, "edge_review"))
+      if (key->type != RDT_STRING)
+         continue;
+
+      /* Scalars share the layout, strings and binaries
+       * only need their buffer. */
+      view.type = val->type;
+      if (val->type == RDT_STRING || val->type == RDT_BINARY)
       {
-         if (!string_is_empty(val_string))
-            db_info->edge_magazine_review = strdup(val_string);
+         view.val.string.len  = val->val.string.len;
+         view.val.string.buff = val->val.string.buff;
       }
-      else if (string_is_equal(str, "edge_rating"))
-         db_info->edge_magazine_rating    = (unsigned)val->val.uint_;
-      else if (string_is_equal(str, "edge_issue"))
-         db_info->edge_magazine_issue     = (unsigned)val->val.uint_;
-      else if (string_is_equal(str, "famitsu_rating"))
-         db_info->famitsu_magazine_rating = (unsigned)val->val.uint_;
-      else if (string_is_equal(str, "tgdb_rating"))
-         db_info->tgdb_rating             = (unsigned)val->val.uint_;
-      else if (string_is_equal(str, "users"))
-         db_info->max_users               = (unsigned)val->val.uint_;
-      else if (string_is_equal(str, "releasemonth"))
-         db_info->releasemonth            = (unsigned)val->val.uint_;
-      else if (string_is_equal(str, "releaseyear"))
-         db_info->releaseyear             = (unsigned)val->val.uint_;
-      else if (string_is_equal(str, "rumble"))
-         db_info->rumble_supported        = (int)val->val.uint_;
-      else if (string_is_equal(str, "coop"))
-         db_info->coop_supported          = (int)val->val.uint_;
-      else if (string_is_equal(str, "analog"))
-         db_info->analog_supported        = (int)val->val.uint_;
-      else if (string_is_equal(str, "size"))
-         db_info->size                    = (unsigned)val->val.uint_;
-      else if (string_is_equal(str, "crc"))
-         db_info->crc32 = swap_if_little32(
-               *(uint32_t*)val->val.binary.buff);
-      else if (string_is_equal(str, "sha1"))
-         db_info->sha1 = bin_to_hex_alloc(
-               (uint8_t*)val->val.binary.buff, val->val.binary.len);
-      else if (string_is_equal(str, "md5"))
-         db_info->md5 = bin_to_hex_alloc(
-               (uint8_t*)val->val.binary.buff, val->val.binary.len);
       else
-      {
-         RARCH_LOG("Unknown key: %s\n", str);
-      }
+         view.val.uint_       = val->val.uint_;
+
+      database_info_parse_field(db_info,
+            key->val.string.buff, key->val.string.len, &view);
    }
 
-   rmsgpack_dom_value_free(&item);
+   rmsgpack_dom_value_free(item);
 
    return 0;
 }
 
-static int database_cursor_open(libretrodb_t *db,
-      libretrodb_cursor_t *cur, const char *path, const char *query)
+static int database_info_parse_record(const libretrodb_record_t *record,
+      database_info_t *db_info)
 {
-   const char *error     = NULL;
-   libretrodb_query_t *q = NULL;
-
-   if ((libretrodb_open(path, db)) != 0)
-      return -1;
+   uint32_t i;
+   const uint8_t *pos = record->items;
 
-   if (query)
-      q = (libretrodb_query_t*)libretrodb_query_compile(db, query,
-      strlen(query), &error);
+   database_info_init_item(db_info);
 
-   if (error)
-      goto error;
-   if ((libretrodb_cursor_open(db, cur, q)) != 0)
-      goto error;
+   for (i = 0; i < record->count; i++)
+   {
+      struct rmsgpack_view key;
+      struct rmsgpack_view val;
+      const uint8_t *start = pos;
 
-   if (q)
-      libretrodb_query_free(q);
+      if (rmsgpack_view_read(&pos, record->end, &key) < 0)
+         return -1;
 
-   return 0;
+      if (key.type == RDT_MAP || key.type == RDT_ARRAY)
+      {
+         pos = start;
+         if (rmsgpack_view_skip(&pos, record->end) < 0)
+            return -1;
+      }
 
-error:
-   if (q)
-      libretrodb_query_free(q);
-   libretrodb_close(db);
+      start = pos;
+      if (rmsgpack_view_read(&pos, record->end, &val) < 0)
+         return -1;
 
-   return -1;
-}
+      /* No field holds a map or an array, step over them whole. */
+      if (val.type == RDT_MAP || val.type == RDT_ARRAY)
+      {
+         pos = start;
+         if (rmsgpack_view_skip(&pos, record->end) < 0)
+            return -1;
+         continue;
+      }
 
-static int database_cursor_close(libretrodb_t *db, libretrodb_cursor_t *cur)
-{
-   libretrodb_cursor_close(cur);
-   libretrodb_close(db);
+      if (key.type == RDT_STRING)
+         database_info_parse_field(db_info,
+               key.val.string.buff, key.val.string.len, &val);
+   }
 
    return 0;
 }
@@ -443,8 +453,12 @@ void database_info_free(database_info_handle_t *db)
 database_info_list_t *database_info_list_new(
       const char *rdb_path, const char *query)
 {
-   int ret                                  = 0;
+   libretrodb_record_t record;
    unsigned k                               = 0;
+   unsigned capacity                        = 0;
+   bool opened                              = false;
+   const char *error                        = NULL;
+   libretrodb_query_t *q                    = NULL;
    database_info_t *database_info           = NULL;
    database_info_list_t *database_info_list = NULL;
    libretrodb_t *db                         = libretrodb_new();
@@ -453,7 +467,22 @@ database_info_list_t *database_info_list_new(
    if (!db || !cur)
       goto end;
 
-   if ((database_cursor_open(db, cur, rdb_path, query) != 0))
+   if (libretrodb_open(rdb_path, db) != 0)
+      goto end;
+
+   opened = true;
+
+   if (query)
+   {
+      q = (libretrodb_query_t*)libretrodb_query_compile(db, query,
+            strlen(query), &error);
+      if (error || !q)
+         goto end;
+   }
+
+   /* Walk the records in place, only the fields the query
+    * names are decoded before a record is known to match. */
+   if (libretrodb_cursor_open_mapped(db, cur) != 0)
       goto end;
 
    database_info_list = (database_info_list_t*)
@@ -465,50 +494,255 @@ database_info_list_t *database_info_list_new(
    database_info_list->count  = 0;
    database_info_list->list   = NULL;
 
-   while (ret != -1)
+   while (libretrodb_cursor_read_record(cur, &record) == 0)
    {
-      database_info_t db_info = {0};
-      ret = database_cursor_iterate(cur, &db_info);
+      if (q && !libretrodb_query_filter_record(q, &record))
+         continue;
 
-      if (ret == 0)
+      if (k == capacity)
       {
-         database_info_t *db_ptr  = NULL;
+         unsigned new_capacity    = capacity ? capacity * 2 : 16;
          database_info_t *new_ptr = (database_info_t*)
-            realloc(database_info, (k+1) * sizeof(database_info_t));
+            realloc(database_info, new_capacity * sizeof(database_info_t));
 
          if (!new_ptr)
          {
+            database_info_list->list  = database_info;
+            database_info_list->count = k;
             database_info_list_free(database_info_list);
-            free(database_info);
             free(database_info_list);
             database_info_list = NULL;
             goto end;
          }
 
          database_info = new_ptr;
-         db_ptr        = &database_info[k];
+         capacity      = new_capacity;
+      }
 
-         memcpy(db_ptr, &db_info, sizeof(*db_ptr));
+      memset(&database_info[k], 0, sizeof(database_info[k]));
 
+      if (database_info_parse_record(&record, &database_info[k]) == 0)
          k++;
-      }
    }
 
    database_info_list->list  = database_info;
    database_info_list->count = k;
 
 end:
+   if (q)
+      libretrodb_query_free(q);
+   if (cur)
+   {
+      libretrodb_cursor_close(cur);
+      libretrodb_cursor_free(cur);
+   }
    if (db)
    {
-      database_cursor_close(db, cur);
+      if (opened)
+         libretrodb_close(db);
       libretrodb_free(db);
    }
-   if (cur)
-      libretrodb_cursor_free(cur);
 
    return database_info_list;
 }
 
+#define DATABASE_INFO_MAX_MATCHES 64
+
+typedef struct database_info_rdb
+{
+   char *path;
+   libretrodb_t *db;
+   libretrodb_hash_index_t *crc_index;
+   libretrodb_hash_index_t *serial_index;
+} database_info_rdb_t;
+
+struct database_info_index_cache
+{
+   database_info_rdb_t *list;
+   size_t count;
+};
+
+database_info_index_cache_t *database_info_index_cache_new(void)
+{
+   return (database_info_index_cache_t*)calloc(1,
+         sizeof(database_info_index_cache_t));
+}
+
+void database_info_index_cache_free(database_info_index_cache_t *cache)
+{
+   size_t i;
+
+   if (!cache)
+      return;
+
+   for (i = 0; i < cache->count; i++)
+   {
+      database_info_rdb_t *rdb = &cache->list[i];
+
+      libretrodb_hash_index_free(rdb->crc_index);
+      libretrodb_hash_index_free(rdb->serial_index);
+      if (rdb->db)
+      {
+         libretrodb_close(rdb->db);
+         libretrodb_free(rdb->db);
+      }
+      free(rdb->path);
+   }
+
+   free(cache->list);
+   free(cache);
+}
+
+static database_info_rdb_t *database_info_index_cache_get(
+      database_info_index_cache_t *cache, const char *rdb_path)
+{
+   size_t i;
+   database_info_rdb_t *rdb = NULL;
+   database_info_rdb_t *list;
+
+   for (i = 0; i < cache->count; i++)
+      if (string_is_equal(cache->list[i].path, rdb_path))
+         return cache->list[i].db ? &cache->list[i] : NULL;
+
+   list = (database_info_rdb_t*)realloc(cache->list,
+         (cache->count + 1) * sizeof(*list));
+
+   if (!list)
+      return NULL;
+
+   cache->list = list;
+   rdb         = &cache->list[cache->count++];
+   rdb->path   = strdup(rdb_path);
+   rdb->db     = libretrodb_new();
+   rdb->crc_index    = NULL;
+   rdb->serial_index = NULL;
+
+   /* Remember databases that fail to open so
+    * they are not retried for every file. */
+   if (rdb->db && libretrodb_open(rdb_path, rdb->db) != 0)
+   {
+      libretrodb_free(rdb->db);
+      rdb->db = NULL;
+   }
+
+   return rdb->db ? rdb : NULL;
+}
+
+static database_info_list_t *database_info_list_new_offsets(
+      libretrodb_t *db, const uint64_t *offsets, size_t count)
+{
+   size_t i;
+   database_info_list_t *database_info_list = (database_info_list_t*)
+      calloc(1, sizeof(*database_info_list));
+
+   if (!database_info_list)
+      return NULL;
+
+   if (count == 0)
+      return database_info_list;
+
+   database_info_list->list = (database_info_t*)
+      calloc(count, sizeof(database_info_t));
+
+   if (!database_info_list->list)
+   {
+      free(database_info_list);
+      return NULL;
+   }
+
+   for (i = 0; i < count; i++)
+   {
+      struct rmsgpack_dom_value item;
+      database_info_t *db_info = &database_info_list->list[
+         database_info_list->count];
+
+      if (libretrodb_read_entry_at(db, offsets[i], &item) < 0)
+         continue;
+
+      if (database_info_parse_item(&item, db_info) == 0)
+         database_info_list->count++;
+   }
+
+   return database_info_list;
+}
+
+database_info_list_t *database_info_list_new_crc(
+      database_info_index_cache_t *cache, const char *rdb_path,
+      uint32_t crc, uint32_t archive_crc)
+{
+   uint8_t key[4];
+   uint64_t offsets[DATABASE_INFO_MAX_MATCHES * 2];
+   uint64_t merged[DATABASE_INFO_MAX_MATCHES * 2];
+   size_t num_crc, num_archive, i = 0, j = 0, count = 0;
+   database_info_rdb_t *rdb = database_info_index_cache_get(cache, rdb_path);
+
+   /* Unreadable databases give an empty list,
+    * so the scan moves on to the next one. */
+   if (!rdb)
+      return database_info_list_new_offsets(NULL, NULL, 0);
+
+   if (!rdb->crc_index)
+      rdb->crc_index = libretrodb_hash_index_new(rdb->db, "crc");
+
+   if (!rdb->crc_index)
+      return database_info_list_new_offsets(NULL, NULL, 0);
+
+   /* Stored as 4 big-endian bytes. */
+   key[0]      = (uint8_t)(crc >> 24);
+   key[1]      = (uint8_t)(crc >> 16);
+   key[2]      = (uint8_t)(crc >> 8);
+   key[3]      = (uint8_t)(crc >> 0);
+   num_crc     = libretrodb_hash_index_find(rdb->crc_index, key, sizeof(key),
+         offsets, DATABASE_INFO_MAX_MATCHES);
+
+   num_archive = 0;
+   if (archive_crc != crc)
+   {
+      key[0]      = (uint8_t)(archive_crc >> 24);
+      key[1]      = (uint8_t)(archive_crc >> 16);
+      key[2]      = (uint8_t)(archive_crc >> 8);
+      key[3]      = (uint8_t)(archive_crc >> 0);
+      num_archive = libretrodb_hash_index_find(rdb->crc_index,
+            key, sizeof(key), offsets + num_crc, DATABASE_INFO_MAX_MATCHES);
+   }
+
+   /* Both runs are in file order, merge them so the
+    * result matches what a cursor walk would return. */
+   while (i < num_crc || j < num_archive)
+   {
+      if (j >= num_archive
+            || (i < num_crc && offsets[i] < offsets[num_crc + j]))
+         merged[count++] = offsets[i++];
+      else
+         merged[count++] = offsets[num_crc + j++];
+   }
+
+   return database_info_list_new_offsets(rdb->db, merged, count);
+}
+
+database_info_list_t *database_info_list_new_serial(
+      database_info_index_cache_t *cache, const char *rdb_path,
+      const char *serial)
+{
+   size_t count;
+   uint64_t offsets[DATABASE_INFO_MAX_MATCHES];
+   database_info_rdb_t *rdb = database_info_index_cache_get(cache, rdb_path);
+
+   if (!rdb || string_is_empty(serial))
+      return database_info_list_new_offsets(NULL, NULL, 0);
+
+   if (!rdb->serial_index)
+      rdb->serial_index = libretrodb_hash_index_new(rdb->db, "serial");
+
+   if (!rdb->serial_index)
+      return database_info_list_new_offsets(NULL, NULL, 0);
+
+   count = libretrodb_hash_index_find(rdb->serial_index,
+         serial, strlen(serial), offsets, DATABASE_INFO_MAX_MATCHES);
+
+   return database_info_list_new_offsets(rdb->db, offsets, count);
+}
+
 void database_info_list_free(database_info_list_t *database_info_list)
 {
    size_t i;
@@ -120,9 +120,28 @@ typedef struct
    database_info_t *list;
 } database_info_list_t;
 
+/* Keeps databases open with lazily built CRC and serial
+ * hash indexes, so a scan can look up many files without
+ * walking every record of every database each time. */
+typedef struct database_info_index_cache database_info_index_cache_t;
+
 database_info_list_t *database_info_list_new(const char *rdb_path,
       const char *query);
 
+database_info_index_cache_t *database_info_index_cache_new(void);
+
+void database_info_index_cache_free(database_info_index_cache_t *cache);
+
+/* Entries of @rdb_path whose crc is @crc or @archive_crc, in file order. */
+database_info_list_t *database_info_list_new_crc(
+      database_info_index_cache_t *cache, const char *rdb_path,
+      uint32_t crc, uint32_t archive_crc);
+
+/* Entries of @rdb_path whose serial is @serial, in file order. */
+database_info_list_t *database_info_list_new_serial(
+      database_info_index_cache_t *cache, const char *rdb_path,
+      const char *serial);
+
 void database_info_list_free(database_info_list_t *list);
 
 database_info_handle_t *database_info_dir_init(const char *dir,
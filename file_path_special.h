@@ -93,7 +93,8 @@ enum file_path_enum
    FILE_PATH_S3M_EXTENSION,
    FILE_PATH_XM_EXTENSION,
    FILE_PATH_CONFIG_EXTENSION,
-   FILE_PATH_CORE_INFO_EXTENSION
+   FILE_PATH_CORE_INFO_EXTENSION,
+   FILE_PATH_CORE_INFO_CACHE
 };
 
 enum application_special_type
@@ -74,6 +74,9 @@ const char *file_path_str(enum file_path_enum enum_idx)
       case FILE_PATH_CORE_INFO_EXTENSION:
          str = ".info";
          break;
+      case FILE_PATH_CORE_INFO_CACHE:
+         str = "core_info.cache";
+         break;
       case FILE_PATH_CONFIG_EXTENSION:
          str = ".cfg";
          break;
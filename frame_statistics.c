@@ -0,0 +1,280 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "frame_statistics.h"
+
+#define FRAME_HISTOGRAM_SUB_COUNT  (1 << FRAME_HISTOGRAM_SUB_BITS)
+#define FRAME_HISTOGRAM_LINEAR     (2 << FRAME_HISTOGRAM_SUB_BITS)
+
+/* Audio occupancy is reported in bands of 10%. */
+#define FRAME_STATISTICS_AUDIO_BANDS 10
+
+static struct
+{
+   frame_histogram_t frame_time;
+   frame_histogram_t jitter;
+   retro_time_t prev_frame_time;
+   uint64_t late_frames;
+   uint64_t missed_vsyncs;
+} frame_stats_video;
+
+static struct
+{
+   frame_histogram_t occupancy;
+   uint64_t underruns;
+} frame_stats_audio;
+
+static unsigned frame_histogram_index(uint32_t value)
+{
+   unsigned msb = FRAME_HISTOGRAM_SUB_BITS + 1;
+
+   if (value < FRAME_HISTOGRAM_LINEAR)
+      return value;
+
+   while (msb < 31 && (value >> (msb + 1)))
+      msb++;
+
+   return FRAME_HISTOGRAM_LINEAR
+      + (msb - FRAME_HISTOGRAM_SUB_BITS - 1) * FRAME_HISTOGRAM_SUB_COUNT
+      + ((value >> (msb - FRAME_HISTOGRAM_SUB_BITS))
+            & (FRAME_HISTOGRAM_SUB_COUNT - 1));
+}
+
+/* Lowest value mapping to bucket @idx. */
+static uint32_t frame_histogram_bucket_low(unsigned idx)
+{
+   unsigned k, shift;
+
+   if (idx < FRAME_HISTOGRAM_LINEAR)
+      return idx;
+
+   k     = idx - FRAME_HISTOGRAM_LINEAR;
+   shift = k / FRAME_HISTOGRAM_SUB_COUNT + 1;
+
+   return (uint32_t)(FRAME_HISTOGRAM_SUB_COUNT
+         + (k & (FRAME_HISTOGRAM_SUB_COUNT - 1))) << shift;
+}
+
+/* Highest value mapping to bucket @idx. */
+static uint32_t frame_histogram_bucket_high(unsigned idx)
+{
+   unsigned shift;
+
+   if (idx < FRAME_HISTOGRAM_LINEAR)
+      return idx;
+
+   shift = (idx - FRAME_HISTOGRAM_LINEAR) / FRAME_HISTOGRAM_SUB_COUNT + 1;
+
+   return frame_histogram_bucket_low(idx) + ((1u << shift) - 1);
+}
+
+void frame_histogram_reset(frame_histogram_t *hist)
+{
+   memset(hist, 0, sizeof(*hist));
+}
+
+void frame_histogram_record(frame_histogram_t *hist, uint32_t value)
+{
+   if (!hist->total || value < hist->min)
+      hist->min = value;
+   if (value > hist->max)
+      hist->max = value;
+
+   hist->counts[frame_histogram_index(value)]++;
+   hist->total++;
+   hist->sum  += value;
+}
+
+uint32_t frame_histogram_percentile(const frame_histogram_t *hist,
+      double percentile)
+{
+   unsigned i;
+   uint64_t rank;
+   uint64_t seen = 0;
+
+   if (!hist->total)
+      return 0;
+
+   rank = (uint64_t)(percentile / 100.0 * hist->total + 0.5);
+   if (rank < 1)
+      rank = 1;
+   if (rank > hist->total)
+      rank = hist->total;
+
+   for (i = 0; i < FRAME_HISTOGRAM_BUCKETS; i++)
+   {
+      seen += hist->counts[i];
+      if (seen >= rank)
+      {
+         uint32_t value = frame_histogram_bucket_high(i);
+         return value < hist->max ? value : hist->max;
+      }
+   }
+
+   return hist->max;
+}
+
+uint64_t frame_histogram_count_range(const frame_histogram_t *hist,
+      uint32_t lo, uint32_t hi)
+{
+   unsigned i;
+   uint64_t count = 0;
+
+   for (i = frame_histogram_index(lo); i < FRAME_HISTOGRAM_BUCKETS; i++)
+   {
+      uint32_t low = frame_histogram_bucket_low(i);
+      if (low > hi)
+         break;
+      if (low >= lo)
+         count += hist->counts[i];
+   }
+
+   return count;
+}
+
+void frame_statistics_push_frame(retro_time_t frame_time,
+      float refresh_rate, float core_fps)
+{
+   uint32_t value;
+
+   if (frame_time <= 0)
+      return;
+
+   value = frame_time > UINT32_MAX ? UINT32_MAX : (uint32_t)frame_time;
+   frame_histogram_record(&frame_stats_video.frame_time, value);
+
+   if (frame_stats_video.prev_frame_time)
+   {
+      retro_time_t diff = frame_time - frame_stats_video.prev_frame_time;
+      if (diff < 0)
+         diff = -diff;
+      frame_histogram_record(&frame_stats_video.jitter,
+            diff > UINT32_MAX ? UINT32_MAX : (uint32_t)diff);
+   }
+   frame_stats_video.prev_frame_time = frame_time;
+
+   if (core_fps > 0.0f)
+   {
+      retro_time_t period = (retro_time_t)(1000000.0f / core_fps);
+
+      if (frame_time > period + period / 4)
+         frame_stats_video.late_frames++;
+
+      if (refresh_rate > 0.0f)
+      {
+         retro_time_t interval  = (retro_time_t)(1000000.0f / refresh_rate);
+         retro_time_t expected  = (period   + interval / 2) / interval;
+         retro_time_t presented = (frame_time + interval / 2) / interval;
+
+         if (expected < 1)
+            expected = 1;
+         if (presented > expected)
+            frame_stats_video.missed_vsyncs += presented - expected;
+      }
+   }
+}
+
+void frame_statistics_push_audio(size_t write_avail, size_t buffer_size)
+{
+   uint32_t occupancy;
+
+   if (!buffer_size)
+      return;
+   if (write_avail > buffer_size)
+      write_avail = buffer_size;
+
+   occupancy = (uint32_t)(100 - (write_avail * 100) / buffer_size);
+   frame_histogram_record(&frame_stats_audio.occupancy, occupancy);
+
+   if (!occupancy)
+      frame_stats_audio.underruns++;
+}
+
+void frame_statistics_reset_video(void)
+{
+   memset(&frame_stats_video, 0, sizeof(frame_stats_video));
+}
+
+void frame_statistics_reset_audio(void)
+{
+   memset(&frame_stats_audio, 0, sizeof(frame_stats_audio));
+}
+
+size_t frame_statistics_get_report(char *s, size_t len)
+{
+   unsigned i;
+   size_t pos                         = 0;
+   const frame_histogram_t *frames    = &frame_stats_video.frame_time;
+   const frame_histogram_t *jitter    = &frame_stats_video.jitter;
+   const frame_histogram_t *occupancy = &frame_stats_audio.occupancy;
+   double mean                        = frames->total
+      ? (double)frames->sum / frames->total : 0.0;
+
+   if (!len)
+      return 0;
+
+   pos += snprintf(s + pos, len - pos,
+         "frames=%llu fps_mean=%.3f frame_time_mean=%.3f"
+         " frame_time_p50=%.3f frame_time_p90=%.3f frame_time_p99=%.3f"
+         " frame_time_p999=%.3f frame_time_max=%.3f"
+         " late_frames=%llu missed_vsyncs=%llu"
+         " jitter_p50=%.3f jitter_p99=%.3f jitter_max=%.3f",
+         (unsigned long long)frames->total,
+         mean > 0.0 ? 1000000.0 / mean : 0.0,
+         mean / 1000.0,
+         frame_histogram_percentile(frames, 50.0)  / 1000.0,
+         frame_histogram_percentile(frames, 90.0)  / 1000.0,
+         frame_histogram_percentile(frames, 99.0)  / 1000.0,
+         frame_histogram_percentile(frames, 99.9)  / 1000.0,
+         frames->max / 1000.0,
+         (unsigned long long)frame_stats_video.late_frames,
+         (unsigned long long)frame_stats_video.missed_vsyncs,
+         frame_histogram_percentile(jitter, 50.0)  / 1000.0,
+         frame_histogram_percentile(jitter, 99.0)  / 1000.0,
+         jitter->max / 1000.0);
+
+   if (pos < len)
+      pos += snprintf(s + pos, len - pos,
+            " audio_samples=%llu audio_underruns=%llu"
+            " audio_occupancy_p1=%u audio_occupancy_p50=%u"
+            " audio_occupancy_p99=%u audio_occupancy_hist=",
+            (unsigned long long)occupancy->total,
+            (unsigned long long)frame_stats_audio.underruns,
+            (unsigned)frame_histogram_percentile(occupancy, 1.0),
+            (unsigned)frame_histogram_percentile(occupancy, 50.0),
+            (unsigned)frame_histogram_percentile(occupancy, 99.0));
+
+   for (i = 0; i < FRAME_STATISTICS_AUDIO_BANDS && pos < len; i++)
+   {
+      uint32_t lo = i * 10;
+      /* The last band also holds a completely full buffer. */
+      uint32_t hi = (i == FRAME_STATISTICS_AUDIO_BANDS - 1) ? 100 : lo + 9;
+
+      pos += snprintf(s + pos, len - pos, "%s%llu",
+            i ? "," : "",
+            (unsigned long long)frame_histogram_count_range(
+               occupancy, lo, hi));
+   }
+
+   if (pos < len)
+      pos += snprintf(s + pos, len - pos, "\n");
+
+   if (pos >= len)
+      pos = len - 1;
+
+   return pos;
+}
@@ -0,0 +1,109 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _FRAME_STATISTICS_H
+#define _FRAME_STATISTICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <boolean.h>
+
+#include <retro_common_api.h>
+#include <libretro.h>
+
+RETRO_BEGIN_DECLS
+
+/* Values below 2 << FRAME_HISTOGRAM_SUB_BITS are stored exactly,
+ * above that every power of two is split into
+ * 1 << FRAME_HISTOGRAM_SUB_BITS buckets (~3% relative error). */
+#define FRAME_HISTOGRAM_SUB_BITS 5
+#define FRAME_HISTOGRAM_BUCKETS  ((2 << FRAME_HISTOGRAM_SUB_BITS) + \
+      (31 - FRAME_HISTOGRAM_SUB_BITS) * (1 << FRAME_HISTOGRAM_SUB_BITS))
+
+typedef struct frame_histogram
+{
+   uint64_t total;
+   uint64_t sum;
+   uint32_t min;
+   uint32_t max;
+   uint32_t counts[FRAME_HISTOGRAM_BUCKETS];
+} frame_histogram_t;
+
+void frame_histogram_reset(frame_histogram_t *hist);
+
+void frame_histogram_record(frame_histogram_t *hist, uint32_t value);
+
+/**
+ * frame_histogram_percentile:
+ * @hist               : histogram
+ * @percentile         : 0.0 - 100.0
+ *
+ * Returns: highest value equivalent to the bucket holding
+ * @percentile of the recorded samples, 0 if empty.
+ **/
+uint32_t frame_histogram_percentile(const frame_histogram_t *hist,
+      double percentile);
+
+/**
+ * frame_histogram_count_range:
+ * @hist               : histogram
+ * @lo                 : first value (inclusive)
+ * @hi                 : last value (inclusive)
+ *
+ * Returns: number of samples whose bucket starts inside [@lo, @hi].
+ **/
+uint64_t frame_histogram_count_range(const frame_histogram_t *hist,
+      uint32_t lo, uint32_t hi);
+
+/**
+ * frame_statistics_push_frame:
+ * @frame_time         : time since the previous frame (usec)
+ * @refresh_rate       : display refresh rate (Hz)
+ * @core_fps           : frame rate reported by the core (Hz)
+ *
+ * Records a presented frame. Frames arriving more than a
+ * quarter of the core frame period late count as late frames,
+ * display refresh intervals skipped count as missed vsyncs.
+ **/
+void frame_statistics_push_frame(retro_time_t frame_time,
+      float refresh_rate, float core_fps);
+
+/**
+ * frame_statistics_push_audio:
+ * @write_avail        : free space in the audio buffer (bytes)
+ * @buffer_size        : audio buffer size (bytes)
+ *
+ * Records the audio buffer occupancy seen before a write.
+ **/
+void frame_statistics_push_audio(size_t write_avail, size_t buffer_size);
+
+void frame_statistics_reset_video(void);
+
+void frame_statistics_reset_audio(void);
+
+/**
+ * frame_statistics_get_report:
+ * @s                  : output buffer
+ * @len                : size of @s
+ *
+ * Writes the current statistics as a single line of
+ * space separated key=value pairs, terminated by a newline.
+ *
+ * Returns: number of characters written.
+ **/
+size_t frame_statistics_get_report(char *s, size_t len);
+
+RETRO_END_DECLS
+
+#endif
@@ -43,6 +43,7 @@
 #include "../../retroarch.h"
 #include "../../verbosity.h"
 #include "../../command.h"
+#include "../../performance_counters.h"
 #include "../../tasks/tasks_internal.h"
 #include "../../file_path_special.h"
 
@@ -103,7 +104,9 @@ static void emscripten_mainloop(void)
    if (ret == 1 && sleep_ms > 0)
       retro_sleep(sleep_ms);
 
+   rarch_profile_begin(RARCH_PROFILE_TASK_GATHER);
    task_queue_check();
+   rarch_profile_end(RARCH_PROFILE_TASK_GATHER);
 
    if (ret != -1)
       return;
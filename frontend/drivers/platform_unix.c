@@ -75,6 +75,7 @@
 #include "../../retroarch.h"
 #include "../../verbosity.h"
 #include "../../paths.h"
+#include "../../performance_counters.h"
 #include "platform_unix.h"
 
 #ifdef HAVE_MENU
@@ -416,7 +417,9 @@ static void android_app_entry(void *data)
       if (ret == 1 && sleep_ms > 0)
          retro_sleep(sleep_ms);
 
+      rarch_profile_begin(RARCH_PROFILE_TASK_GATHER);
       task_queue_check();
+      rarch_profile_end(RARCH_PROFILE_TASK_GATHER);
 
       if (ret == -1)
          break;
@@ -35,6 +35,7 @@
 
 #include "../driver.h"
 #include "../paths.h"
+#include "../performance_counters.h"
 #include "../retroarch.h"
 
 /* griffin hack */
@@ -143,7 +144,9 @@ int rarch_main(int argc, char *argv[], void *data)
       if (ret == 1 && sleep_ms > 0)
          retro_sleep(sleep_ms);
 
+      rarch_profile_begin(RARCH_PROFILE_TASK_GATHER);
       task_queue_check();
+      rarch_profile_end(RARCH_PROFILE_TASK_GATHER);
 
       if (ret == -1)
          break;
@@ -65,6 +65,8 @@
 #include "../core.h"
 #include "../command.h"
 #include "../msg_hash.h"
+#include "../performance_counters.h"
+#include "../frame_statistics.h"
 #include "../verbosity.h"
 
 #define MEASURE_FRAME_TIME_SAMPLES_COUNT (2 * 1024)
@@ -1797,6 +1799,7 @@ void video_driver_free(void)
 void video_driver_monitor_reset(void)
 {
    video_driver_frame_time_count = 0;
+   frame_statistics_reset_video();
 }
 
 void video_driver_set_aspect_ratio(void)
@@ -2399,6 +2402,8 @@ void video_driver_frame(const void *data, unsigned width,
    if (!video_driver_active)
       return;
 
+   rarch_profile_begin(RARCH_PROFILE_VIDEO_FRAME);
+
    if (video_driver_scaler_ptr && data &&
          (video_driver_pix_fmt == RETRO_PIXEL_FORMAT_0RGB1555) &&
          (data != RETRO_HW_FRAME_BUFFER_VALID))
@@ -2432,6 +2437,10 @@ void video_driver_frame(const void *data, unsigned width,
       video_driver_frame_time_samples[write_index] = frame_time;
       fps_time                                     = new_time;
 
+      frame_statistics_push_frame((retro_time_t)frame_time,
+            video_info.refresh_rate,
+            (float)video_driver_av_info.timing.fps);
+
       if (video_driver_frame_count == 1)
          strlcpy(title, video_driver_window_title, sizeof(title));
 
@@ -2596,6 +2605,13 @@ void video_driver_frame(const void *data, unsigned width,
             av_info->timing.fps,
             av_info->timing.sample_rate);
 
+      if (video_info.is_perfcnt_enable)
+      {
+         size_t len = strlen(video_info.stat_text);
+         rarch_profile_get_stats(video_info.stat_text + len,
+               sizeof(video_info.stat_text) - len);
+      }
+
       /* TODO/FIXME - add OSD chat text here */
 #if 0
       snprintf(video_info.chat_text, sizeof(video_info.chat_text),
@@ -2631,6 +2647,8 @@ void video_driver_frame(const void *data, unsigned width,
 		video_driver_crt_switching_active = false;
 	
 	/* trigger set resolution*/
+
+   rarch_profile_end(RARCH_PROFILE_VIDEO_FRAME);
 }
 
 void video_driver_display_type_set(enum rarch_display_type type)
@@ -60,6 +60,7 @@
 #include "../movie.h"
 #include "../list_special.h"
 #include "../verbosity.h"
+#include "../performance_counters.h"
 #include "../tasks/tasks_internal.h"
 #include "../command.h"
 #include "include/gamepad.h"
@@ -364,6 +365,16 @@ struct turbo_buttons
    unsigned count;
 };
 
+/* Per-frame input of one user, resolved once after input_poll()
+ * with remapping, overlay and turbo already applied, so that
+ * repeated input_state() calls from the core are table lookups. */
+typedef struct input_snapshot
+{
+   bool valid;
+   uint16_t buttons;         /* RETRO_DEVICE_JOYPAD, bit per id */
+   int16_t analog[2][2];     /* RETRO_DEVICE_ANALOG, [idx][id] */
+} input_snapshot_t;
+
 struct input_keyboard_line
 {
    char *buffer;
@@ -390,6 +401,7 @@ static unsigned osk_last_codepoint_len            = 0;
 static input_keyboard_press_t g_keyboard_press_cb;
 
 static turbo_buttons_t input_driver_turbo_btns;
+static input_snapshot_t input_driver_snapshots[MAX_USERS];
 #ifdef HAVE_COMMAND
 static command_t *input_driver_command            = NULL;
 #endif
@@ -586,15 +598,23 @@ void input_poll(void)
    settings_t *settings           = config_get_ptr();
    uint8_t max_users              = (uint8_t)input_driver_max_users;
 
+   rarch_profile_begin(RARCH_PROFILE_INPUT_POLL);
+
    current_input->poll(current_input_data);
 
    input_driver_turbo_btns.count++;
 
+   for (i = 0; i < MAX_USERS; i++)
+      input_driver_snapshots[i].valid = false;
+
    for (i = 0; i < max_users; i++)
       input_driver_turbo_btns.frame_enable[i] = 0;
 
    if (input_driver_block_libretro_input)
+   {
+      rarch_profile_end(RARCH_PROFILE_INPUT_POLL);
       return;
+   }
 
 
 
@@ -634,6 +654,149 @@ void input_poll(void)
    if (input_driver_remote)
       input_remote_poll(input_driver_remote, max_users);
 #endif
+
+   /* The overlay may have queried input_state() above,
+    * before the overlay and mapper state were updated. */
+   for (i = 0; i < MAX_USERS; i++)
+      input_driver_snapshots[i].valid = false;
+
+   rarch_profile_end(RARCH_PROFILE_INPUT_POLL);
+}
+
+/* Resolves a single input through the input driver, overlay,
+ * network gamepad and remapper. Turbo is applied separately. */
+static int16_t input_state_resolve(settings_t *settings,
+      unsigned port, unsigned device, unsigned idx, unsigned id)
+{
+   int16_t res = 0, res_overlay = 0;
+
+   /* used to reset input state of a button when the gamepad mapper
+      is in action for that button*/
+   bool reset_state  = false;
+
+   if (settings->bools.input_remap_binds_enable)
+   {
+      switch (device)
+      {
+         case RETRO_DEVICE_JOYPAD:
+            if (id != settings->uints.input_remap_ids[port][id])
+               reset_state = true;
+            break;
+         case RETRO_DEVICE_ANALOG:
+            if (idx < 2 && id < 2)
+            {
+               unsigned offset = RARCH_FIRST_CUSTOM_BIND + (idx * 4) + (id * 2);
+               if (settings->uints.input_remap_ids[port][offset]   != offset)
+                  reset_state = true;
+               if (settings->uints.input_remap_ids[port][offset+1] != (offset+1))
+                  reset_state = true;
+            }
+            break;
+      }
+   }
+
+#ifdef HAVE_OVERLAY
+   if (overlay_ptr)
+      input_state_overlay(overlay_ptr, &res_overlay, port, device, idx, id);
+#endif
+
+#ifdef HAVE_NETWORKGAMEPAD
+   if (input_driver_remote)
+      input_remote_state(&res, port, device, idx, id);
+#endif
+
+   if (((id < RARCH_FIRST_META_KEY) || (device == RETRO_DEVICE_KEYBOARD)))
+   {
+      bool bind_valid = libretro_input_binds[port] && libretro_input_binds[port][id].valid;
+
+      if (bind_valid || device == RETRO_DEVICE_KEYBOARD)
+      {
+         rarch_joypad_info_t joypad_info;
+         joypad_info.axis_threshold = input_driver_axis_threshold;
+         joypad_info.joy_idx        = settings->uints.input_joypad_map[port];
+         joypad_info.auto_binds     = input_autoconf_binds[joypad_info.joy_idx];
+
+         if (!reset_state)
+         {
+            res = current_input->input_state(
+                  current_input_data, joypad_info, libretro_input_binds, port, device, idx, id);
+
+#ifdef HAVE_OVERLAY
+            if (input_overlay_is_alive(overlay_ptr) && port == 0)
+               res |= res_overlay;
+#endif
+         }
+         else
+            res = 0;
+      }
+   }
+
+   if (settings->bools.input_remap_binds_enable && input_driver_mapper)
+      input_mapper_state(input_driver_mapper,
+            &res, port, device, idx, id);
+
+   return res;
+}
+
+static int16_t input_state_turbo(settings_t *settings,
+      unsigned port, unsigned id, int16_t res)
+{
+   /* Don't allow turbo for D-pad. */
+   if (id >= RETRO_DEVICE_ID_JOYPAD_UP && id <= RETRO_DEVICE_ID_JOYPAD_RIGHT)
+      return res;
+
+   /*
+    * Apply turbo button if activated.
+    *
+    * If turbo button is held, all buttons pressed except
+    * for D-pad will go into a turbo mode. Until the button is
+    * released again, the input state will be modulated by a
+    * periodic pulse defined by the configured duty cycle.
+    */
+   if (res && input_driver_turbo_btns.frame_enable[port])
+      input_driver_turbo_btns.enable[port] |= (1 << id);
+   else if (!res)
+      input_driver_turbo_btns.enable[port] &= ~(1 << id);
+
+   if (input_driver_turbo_btns.enable[port] & (1 << id))
+   {
+      /* if turbo button is enabled for this key ID */
+      res = res && ((input_driver_turbo_btns.count
+               % settings->uints.input_turbo_period)
+            < settings->uints.input_turbo_duty_cycle);
+   }
+
+   return res;
+}
+
+static const input_snapshot_t *input_driver_get_snapshot(unsigned port)
+{
+   unsigned i;
+   settings_t *settings    = NULL;
+   input_snapshot_t *snap  = &input_driver_snapshots[port];
+
+   if (snap->valid)
+      return snap;
+
+   settings      = config_get_ptr();
+   snap->buttons = 0;
+
+   for (i = 0; i <= RETRO_DEVICE_ID_JOYPAD_R3; i++)
+   {
+      int16_t res = input_state_resolve(settings,
+            port, RETRO_DEVICE_JOYPAD, 0, i);
+
+      if (input_state_turbo(settings, port, i, res))
+         snap->buttons |= (1 << i);
+   }
+
+   for (i = 0; i < 4; i++)
+      snap->analog[i >> 1][i & 1] = input_state_resolve(settings,
+            port, RETRO_DEVICE_ANALOG, i >> 1, i & 1);
+
+   snap->valid = true;
+
+   return snap;
 }
 
 /**
@@ -651,11 +814,7 @@ void input_poll(void)
 int16_t input_state(unsigned port, unsigned device,
       unsigned idx, unsigned id)
 {
-   int16_t res = 0, res_overlay = 0;
-
-   /* used to reset input state of a button when the gamepad mapper
-      is in action for that button*/
-   bool reset_state  = false;
+   int16_t res = 0;
 
    device &= RETRO_DEVICE_MASK;
 
@@ -671,95 +830,23 @@ int16_t input_state(unsigned port, unsigned device,
    if (     !input_driver_flushing_input
          && !input_driver_block_libretro_input)
    {
-      settings_t *settings = config_get_ptr();
-
-      if (settings->bools.input_remap_binds_enable)
-      {
-         switch (device)
-         {
-            case RETRO_DEVICE_JOYPAD:
-               if (id != settings->uints.input_remap_ids[port][id])
-                  reset_state = true;
-               break;
-            case RETRO_DEVICE_ANALOG:
-               if (idx < 2 && id < 2)
-               {
-                  unsigned offset = RARCH_FIRST_CUSTOM_BIND + (idx * 4) + (id * 2);
-                  if (settings->uints.input_remap_ids[port][offset]   != offset)
-                     reset_state = true;
-                  if (settings->uints.input_remap_ids[port][offset+1] != (offset+1))
-                     reset_state = true;
-               }
-               break;
-         }
-      }
-
-#ifdef HAVE_OVERLAY
-      if (overlay_ptr)
-         input_state_overlay(overlay_ptr, &res_overlay, port, device, idx, id);
-#endif
-
-#ifdef HAVE_NETWORKGAMEPAD
-      if (input_driver_remote)
-         input_remote_state(&res, port, device, idx, id);
-#endif
-
-      if (((id < RARCH_FIRST_META_KEY) || (device == RETRO_DEVICE_KEYBOARD)))
+      if (     port   <  MAX_USERS
+            && device == RETRO_DEVICE_JOYPAD
+            && id     <= RETRO_DEVICE_ID_JOYPAD_R3)
+         res = (input_driver_get_snapshot(port)->buttons >> id) & 1;
+      else if (port   <  MAX_USERS
+            && device == RETRO_DEVICE_ANALOG
+            && idx    <  2
+            && id     <  2)
+         res = input_driver_get_snapshot(port)->analog[idx][id];
+      else
       {
-         bool bind_valid = libretro_input_binds[port] && libretro_input_binds[port][id].valid;
-
-         if (bind_valid || device == RETRO_DEVICE_KEYBOARD)
-         {
-            rarch_joypad_info_t joypad_info;
-            joypad_info.axis_threshold = input_driver_axis_threshold;
-            joypad_info.joy_idx        = settings->uints.input_joypad_map[port];
-            joypad_info.auto_binds     = input_autoconf_binds[joypad_info.joy_idx];
+         settings_t *settings = config_get_ptr();
 
-            if (!reset_state)
-            {
-               res = current_input->input_state(
-                     current_input_data, joypad_info, libretro_input_binds, port, device, idx, id);
+         res = input_state_resolve(settings, port, device, idx, id);
 
-#ifdef HAVE_OVERLAY
-               if (input_overlay_is_alive(overlay_ptr) && port == 0)
-                  res |= res_overlay;
-#endif
-            }
-            else
-               res = 0;
-         }
-      }
-
-      if (settings->bools.input_remap_binds_enable && input_driver_mapper)
-         input_mapper_state(input_driver_mapper,
-               &res, port, device, idx, id);
-
-
-
-      /* Don't allow turbo for D-pad. */
-      if (device == RETRO_DEVICE_JOYPAD && (id < RETRO_DEVICE_ID_JOYPAD_UP ||
-               id > RETRO_DEVICE_ID_JOYPAD_RIGHT))
-      {
-         /*
-          * Apply turbo button if activated.
-          *
-          * If turbo button is held, all buttons pressed except
-          * for D-pad will go into a turbo mode. Until the button is
-          * released again, the input state will be modulated by a
-          * periodic pulse defined by the configured duty cycle.
-          */
-         if (res && input_driver_turbo_btns.frame_enable[port])
-            input_driver_turbo_btns.enable[port] |= (1 << id);
-         else if (!res)
-            input_driver_turbo_btns.enable[port] &= ~(1 << id);
-
-         if (input_driver_turbo_btns.enable[port] & (1 << id))
-         {
-            /* if turbo button is enabled for this key ID */
-            res = res && ((input_driver_turbo_btns.count
-                     % settings->uints.input_turbo_period)
-                  < settings->uints.input_turbo_duty_cycle);
-         }
+         if (device == RETRO_DEVICE_JOYPAD)
+            res = input_state_turbo(settings, port, id, res);
       }
    }
 
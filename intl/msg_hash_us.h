@@ -1397,6 +1397,8 @@ MSG_HASH(MENU_ENUM_LABEL_VALUE_SAVESTATE_DIRECTORY,
       "Savestate")
 MSG_HASH(MENU_ENUM_LABEL_VALUE_SAVESTATE_THUMBNAIL_ENABLE,
       "Savestate Thumbnails")
+MSG_HASH(MENU_ENUM_LABEL_VALUE_SAVESTATE_FILE_COMPRESSION,
+      "Savestate Compression")
 MSG_HASH(MENU_ENUM_LABEL_VALUE_SAVE_CURRENT_CONFIG,
       "Save Current Configuration")
 MSG_HASH(MENU_ENUM_LABEL_VALUE_SAVE_CURRENT_CONFIG_OVERRIDE_CORE,
@@ -2788,6 +2790,10 @@ MSG_HASH(
       MENU_ENUM_SUBLABEL_SAVESTATE_THUMBNAIL_ENABLE,
       "Show thumbnails of save states inside the menu."
       )
+MSG_HASH(
+      MENU_ENUM_SUBLABEL_SAVESTATE_FILE_COMPRESSION,
+      "Write save state files in a compressed format. Reduces file size at the cost of some extra work in the background when saving and loading."
+      )
 MSG_HASH(
       MENU_ENUM_SUBLABEL_AUTOSAVE_INTERVAL,
       "Autosaves the non-volatile Save RAM at a regular interval. This is disabled by default unless set otherwise. The interval is measured in seconds. A value of 0 disables autosave."
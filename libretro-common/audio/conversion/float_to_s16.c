@@ -22,7 +22,9 @@
 #include <stdint.h>
 #include <stddef.h>
 
-#if defined(__SSE2__)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
 #include <emmintrin.h>
 #elif defined(__ALTIVEC__)
 #include <altivec.h>
@@ -51,7 +53,25 @@ void convert_float_to_s16(int16_t *out,
       const float *in, size_t samples)
 {
    size_t i      = 0;
-#if defined(__SSE2__)
+#if defined(__AVX2__)
+   __m256 factor = _mm256_set1_ps((float)0x8000);
+
+   for (i = 0; i + 16 <= samples; i += 16, in += 16, out += 16)
+   {
+      __m256 input_l = _mm256_loadu_ps(in + 0);
+      __m256 input_r = _mm256_loadu_ps(in + 8);
+      __m256i ints_l = _mm256_cvtps_epi32(_mm256_mul_ps(input_l, factor));
+      __m256i ints_r = _mm256_cvtps_epi32(_mm256_mul_ps(input_r, factor));
+      /* packs works per 128-bit lane, put the quadwords back in order. */
+      __m256i packed = _mm256_permute4x64_epi64(
+            _mm256_packs_epi32(ints_l, ints_r), _MM_SHUFFLE(3, 1, 2, 0));
+
+      _mm256_storeu_si256((__m256i *)out, packed);
+   }
+
+   samples = samples - i;
+   i       = 0;
+#elif defined(__SSE2__)
    __m128 factor = _mm_set1_ps((float)0x8000);
 
    for (i = 0; i + 8 <= samples; i += 8, in += 8, out += 8)
@@ -19,7 +19,9 @@
  * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
-#if defined(__SSE2__)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
 #include <emmintrin.h>
 #elif defined(__ALTIVEC__)
 #include <altivec.h>
@@ -52,7 +54,25 @@ void convert_s16_to_float(float *out,
 {
    size_t i      = 0;
 
-#if defined(__SSE2__)
+#if defined(__AVX2__)
+   __m256 factor = _mm256_set1_ps(gain / 0x8000);
+
+   for (i = 0; i + 16 <= samples; i += 16, in += 16, out += 16)
+   {
+      __m128i input_l  = _mm_loadu_si128((const __m128i *)(in + 0));
+      __m128i input_r  = _mm_loadu_si128((const __m128i *)(in + 8));
+      __m256 output_l  = _mm256_mul_ps(_mm256_cvtepi32_ps(
+               _mm256_cvtepi16_epi32(input_l)), factor);
+      __m256 output_r  = _mm256_mul_ps(_mm256_cvtepi32_ps(
+               _mm256_cvtepi16_epi32(input_r)), factor);
+
+      _mm256_storeu_ps(out + 0, output_l);
+      _mm256_storeu_ps(out + 8, output_r);
+   }
+
+   samples = samples - i;
+   i       = 0;
+#elif defined(__SSE2__)
    float fgain   = gain / UINT32_C(0x80000000);
    __m128 factor = _mm_set1_ps(fgain);
 
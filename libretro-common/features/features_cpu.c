@@ -461,6 +461,35 @@ static void cpulist_read_from(CpuList* list, const char* filename)
 
 #endif
 
+/**
+ * cpu_features_get_extra:
+ *
+ * Gets CPU features not covered by the RETRO_SIMD_* bits.
+ *
+ * Returns: bitmask of CPU_FEATURE_* flags.
+ **/
+uint64_t cpu_features_get_extra(void)
+{
+   uint64_t cpu = 0;
+#if defined(CPU_X86) && !defined(__MACH__) && !defined(_XBOX1)
+   int flags[4];
+
+   x86_cpuid(0, flags);
+   if (flags[0] < 1)
+      return 0;
+
+   x86_cpuid(1, flags);
+
+   if (flags[2] & (1 << 1))
+      cpu |= CPU_FEATURE_PCLMUL;
+#elif defined(__linux__) && !defined(CPU_X86)
+   if (check_arm_cpu_feature("crc32"))
+      cpu |= CPU_FEATURE_CRC32;
+#endif
+
+   return cpu;
+}
+
 /**
  * cpu_features_get_core_amount:
  *
@@ -48,15 +48,28 @@
 
 #define MAX_INCLUDE_DEPTH 16
 
+/* Initial number of hash buckets, always a power of two. */
+#define CONFIG_MAP_MIN_SIZE 64
+
 struct config_entry_list
 {
    /* If we got this from an #include,
     * do not allow overwrite. */
    bool readonly;
 
+   /* Set when key/value point into a file buffer
+    * rather than being allocated on their own. */
+   bool key_in_buffer;
+   bool value_in_buffer;
+
+   uint32_t key_hash;
    char *key;
    char *value;
    struct config_entry_list *next;
+
+   /* Next entry in the same hash bucket. Only the
+    * first entry for any key is in the hash map. */
+   struct config_entry_list *hash_next;
 };
 
 struct config_include_list
@@ -65,6 +78,13 @@ struct config_include_list
    struct config_include_list *next;
 };
 
+/* A whole file read in one go. Parsed entries point into it. */
+struct config_buffer_list
+{
+   char *data;
+   struct config_buffer_list *next;
+};
+
 static config_file_t *config_file_new_internal(
       const char *path, unsigned depth);
 
@@ -140,53 +160,137 @@ static char *extract_value(char *line, bool is_value)
       tok = strtok_r(line, " \n\t\f\r\v", &save);
 
    if (tok && *tok)
-      return strdup(tok);
+      return tok;
    return NULL;
 }
 
-/* Move semantics? */
-static void add_child_list(config_file_t *parent, config_file_t *child)
+static uint32_t config_hash_key(const char *key)
 {
-   struct config_entry_list *list = child->entries;
-   if (parent->entries)
+   /* FNV-1a */
+   uint32_t hash = 0x811c9dc5;
+
+   while (*key)
    {
-      struct config_entry_list *head = parent->entries;
-      while (head->next)
-         head = head->next;
+      hash ^= (uint8_t)*key++;
+      hash *= 0x01000193;
+   }
 
-      /* set list readonly */
-      while (list)
-      {
-         list->readonly = true;
-         list           = list->next;
-      }
-      head->next        = child->entries;
+   return hash;
+}
+
+static void config_map_free(config_file_t *conf)
+{
+   free(conf->entries_map);
+   conf->entries_map       = NULL;
+   conf->entries_map_size  = 0;
+   conf->entries_map_count = 0;
+}
+
+static void config_map_put(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   struct config_entry_list **bucket = NULL;
+
+   /* Keep the first entry for a key, as the list walk did. */
+   for (bucket = &conf->entries_map[entry->key_hash
+         & (conf->entries_map_size - 1)];
+         *bucket; bucket = &(*bucket)->hash_next)
+   {
+      if ((*bucket)->key_hash == entry->key_hash
+            && string_is_equal((*bucket)->key, entry->key))
+         return;
    }
+
+   entry->hash_next = NULL;
+   *bucket          = entry;
+   conf->entries_map_count++;
+}
+
+/* Rebuilds the hash map from the ordered list.
+ * On allocation failure the map is dropped and lookups
+ * fall back to walking the list. */
+static void config_map_rebuild(config_file_t *conf, size_t size)
+{
+   struct config_entry_list *entry = NULL;
+
+   config_map_free(conf);
+
+   conf->entries_map = (struct config_entry_list**)
+      calloc(size, sizeof(*conf->entries_map));
+
+   if (!conf->entries_map)
+      return;
+
+   conf->entries_map_size = size;
+
+   for (entry = conf->entries; entry; entry = entry->next)
+      if (entry->key)
+         config_map_put(conf, entry);
+}
+
+static void config_map_add(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   entry->key_hash  = config_hash_key(entry->key);
+   entry->hash_next = NULL;
+
+   if (conf->entries_map_size == 0)
+   {
+      if (!conf->entries_map)
+         config_map_rebuild(conf, CONFIG_MAP_MIN_SIZE);
+      return;
+   }
+
+   /* Grow at 3/4 load. */
+   if ((conf->entries_map_count + 1) * 4 > conf->entries_map_size * 3)
+      config_map_rebuild(conf, conf->entries_map_size * 2);
    else
+      config_map_put(conf, entry);
+}
+
+static void config_append_entry(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   entry->next = NULL;
+
+   if (conf->tail)
+      conf->tail->next = entry;
+   else
+      conf->entries    = entry;
+
+   conf->tail = entry;
+
+   config_map_add(conf, entry);
+}
+
+/* Move semantics? */
+static void add_child_list(config_file_t *parent, config_file_t *child)
+{
+   struct config_entry_list  *list = child->entries;
+   struct config_buffer_list *bufs = child->buffers;
+
+   while (list)
    {
+      struct config_entry_list *next = list->next;
+
       /* set list readonly */
-      while (list)
-      {
-         list->readonly = true;
-         list           = list->next;
-      }
-      parent->entries   = child->entries;
+      list->readonly = true;
+      config_append_entry(parent, list);
+      list           = next;
    }
 
    child->entries = NULL;
+   child->tail    = NULL;
 
-   /* Rebase tail. */
-   if (parent->entries)
+   /* The entries point into the child's buffers. */
+   if (bufs)
    {
-      struct config_entry_list *head =
-         (struct config_entry_list*)parent->entries;
-
-      while (head->next)
-         head = head->next;
-      parent->tail = head;
+      while (bufs->next)
+         bufs = bufs->next;
+      bufs->next      = parent->buffers;
+      parent->buffers = child->buffers;
+      child->buffers  = NULL;
    }
-   else
-      parent->tail = NULL;
 }
 
 static void add_sub_conf(config_file_t *conf, char *path)
@@ -248,16 +352,8 @@ static void add_sub_conf(config_file_t *conf, char *path)
 static bool parse_line(config_file_t *conf,
       struct config_entry_list *list, char *line)
 {
-   char *comment   = NULL;
-   char *key_tmp   = NULL;
-   size_t cur_size = 8;
-   size_t idx      = 0;
-   char *key       = (char*)malloc(9);
-
-   if (!key)
-      return false;
-
-   comment = strip_comment(line);
+   char *key     = NULL;
+   char *comment = strip_comment(line);
 
    /* Starting line with #include includes config files. */
    if (comment == line)
@@ -265,8 +361,7 @@ static bool parse_line(config_file_t *conf,
       comment++;
       if (strstr(comment, "include ") == comment)
       {
-         char *line = comment + strlen("include ");
-         char *path = extract_value(line, false);
+         char *path = extract_value(comment + strlen("include "), false);
 
          if (path)
          {
@@ -274,9 +369,8 @@ static bool parse_line(config_file_t *conf,
                fprintf(stderr, "!!! #include depth exceeded for config. Might be a cycle.\n");
             else
                add_sub_conf(conf, path);
-            free(path);
          }
-         goto error;
+         return false;
       }
    }
 
@@ -284,52 +378,110 @@ static bool parse_line(config_file_t *conf,
    while (isspace((int)*line))
       line++;
 
+   key = line;
+
    while (isgraph((int)*line))
+      line++;
+
+   /* The key has to be followed by whitespace before the '='.
+    * Terminate it in place. */
+   if (!isspace((int)*line))
+      return false;
+
+   *line++     = '\0';
+
+   list->key   = key;
+   list->value = extract_value(line, true);
+
+   if (!list->value)
    {
-      if (idx == cur_size)
-      {
-         cur_size *= 2;
-         key_tmp = (char*)realloc(key, cur_size + 1);
+      list->key = NULL;
+      return false;
+   }
 
-         if (!key_tmp)
-            goto error;
+   return true;
+}
 
-         key = key_tmp;
-      }
+/* Parses every line of @buf, which must be NUL-terminated
+ * at @len. @conf takes ownership of @buf. */
+static bool config_file_parse_buffer(config_file_t *conf,
+      char *buf, size_t len)
+{
+   char *line = buf;
+   char *end  = buf + len;
+   struct config_buffer_list *node = (struct config_buffer_list*)
+      malloc(sizeof(*node));
 
-      key[idx++] = *line++;
+   if (!node)
+   {
+      free(buf);
+      return false;
    }
-   key[idx]      = '\0';
-   list->key     = key;
 
-   list->value   = extract_value(line, true);
+   node->data    = buf;
+   node->next    = conf->buffers;
+   conf->buffers = node;
 
-   if (!list->value)
+   while (line < end)
    {
-      list->key = NULL;
-      goto error;
+      struct config_entry_list entry;
+      char *next = (char*)memchr(line, '\n', end - line);
+
+      if (next)
+         *next = '\0';
+      else
+         next  = end;
+
+      entry.key   = NULL;
+      entry.value = NULL;
+
+      if (*line && parse_line(conf, &entry, line))
+      {
+         struct config_entry_list *list = (struct config_entry_list*)
+            malloc(sizeof(*list));
+
+         if (!list)
+            return false;
+
+         list->readonly        = false;
+         list->key_in_buffer   = true;
+         list->value_in_buffer = true;
+         list->key             = entry.key;
+         list->value           = entry.value;
+
+         config_append_entry(conf, list);
+      }
+
+      line = next + 1;
    }
 
    return true;
+}
 
-error:
-   free(key);
-   return false;
+static void config_file_init(config_file_t *conf)
+{
+   conf->path              = NULL;
+   conf->entries           = NULL;
+   conf->tail              = NULL;
+   conf->includes          = NULL;
+   conf->include_depth     = 0;
+   conf->buffers           = NULL;
+   conf->entries_map       = NULL;
+   conf->entries_map_size  = 0;
+   conf->entries_map_count = 0;
 }
 
 static config_file_t *config_file_new_internal(
       const char *path, unsigned depth)
 {
+   int64_t size             = 0;
+   char *buf                = NULL;
    RFILE              *file = NULL;
    struct config_file *conf = (struct config_file*)malloc(sizeof(*conf));
    if (!conf)
       return NULL;
 
-   conf->path          = NULL;
-   conf->entries       = NULL;
-   conf->tail          = NULL;
-   conf->includes      = NULL;
-   conf->include_depth = 0;
+   config_file_init(conf);
 
    if (!path || !*path)
       return conf;
@@ -352,48 +504,33 @@ static config_file_t *config_file_new_internal(
       goto error;
    }
 
-   while (!filestream_eof(file))
-   {
-      char *line                     = NULL;
-      struct config_entry_list *list = (struct config_entry_list*)malloc(sizeof(*list));
-
-      if (!list)
-      {
-         config_file_free(conf);
-         filestream_close(file);
-         return NULL;
-      }
+   /* Read the whole file at once, lines are parsed in place. */
+   size = filestream_get_size(file);
 
-      list->readonly  = false;
-      list->key       = NULL;
-      list->value     = NULL;
-      list->next      = NULL;
+   if (size >= 0)
+      buf = (char*)malloc((size_t)size + 1);
 
-      line            = filestream_getline(file);
+   if (buf)
+   {
+      int64_t len = filestream_read(file, buf, size);
+      if (len < 0)
+         len = 0;
+      buf[len] = '\0';
 
-      if (!line)
-      {
-         free(list);
-         continue;
-      }
+      filestream_close(file);
 
-      if (*line && parse_line(conf, list, line))
+      if (!config_file_parse_buffer(conf, buf, (size_t)len))
       {
-         if (conf->entries)
-            conf->tail->next = list;
-         else
-            conf->entries = list;
-
-         conf->tail = list;
+         config_file_free(conf);
+         return NULL;
       }
-
-      free(line);
-
-      if (list != conf->tail)
-         free(list);
    }
-
-   filestream_close(file);
+   else
+   {
+      filestream_close(file);
+      config_file_free(conf);
+      return NULL;
+   }
 
    return conf;
 
@@ -414,9 +551,9 @@ void config_file_free(config_file_t *conf)
    while (tmp)
    {
       struct config_entry_list *hold = NULL;
-      if (tmp->key)
+      if (tmp->key && !tmp->key_in_buffer)
          free(tmp->key);
-      if (tmp->value)
+      if (tmp->value && !tmp->value_in_buffer)
          free(tmp->value);
 
       tmp->value = NULL;
@@ -439,6 +576,16 @@ void config_file_free(config_file_t *conf)
       free(hold);
    }
 
+   while (conf->buffers)
+   {
+      struct config_buffer_list *hold = conf->buffers;
+      conf->buffers = hold->next;
+      free(hold->data);
+      free(hold);
+   }
+
+   config_map_free(conf);
+
    if (conf->path)
       free(conf->path);
    free(conf);
@@ -452,9 +599,27 @@ bool config_append_file(config_file_t *conf, const char *path)
 
    if (new_conf->tail)
    {
+      struct config_buffer_list *bufs = new_conf->buffers;
+
       new_conf->tail->next = conf->entries;
       conf->entries        = new_conf->entries; /* Pilfer. */
+      if (!conf->tail)
+         conf->tail        = new_conf->tail;
       new_conf->entries    = NULL;
+      new_conf->tail       = NULL;
+
+      if (bufs)
+      {
+         while (bufs->next)
+            bufs = bufs->next;
+         bufs->next         = conf->buffers;
+         conf->buffers      = new_conf->buffers;
+         new_conf->buffers  = NULL;
+      }
+
+      /* The new entries take priority. */
+      config_map_rebuild(conf, conf->entries_map_size
+            ? conf->entries_map_size : CONFIG_MAP_MIN_SIZE);
    }
 
    config_file_free(new_conf);
@@ -464,61 +629,27 @@ bool config_append_file(config_file_t *conf, const char *path)
 
 config_file_t *config_file_new_from_string(const char *from_string)
 {
-   size_t i;
-   struct string_list *lines = NULL;
+   char *buf                = NULL;
    struct config_file *conf = (struct config_file*)malloc(sizeof(*conf));
    if (!conf)
       return NULL;
 
+   config_file_init(conf);
+
    if (!from_string)
       return conf;
 
-   conf->path          = NULL;
-   conf->entries       = NULL;
-   conf->tail          = NULL;
-   conf->includes      = NULL;
-   conf->include_depth = 0;
+   buf = strdup(from_string);
 
-   lines = string_split(from_string, "\n");
-   if (!lines)
-      return conf;
-
-   for (i = 0; i < lines->size; i++)
+   if (!buf || !config_file_parse_buffer(conf, buf, strlen(buf)))
    {
-      struct config_entry_list *list = (struct config_entry_list*)malloc(sizeof(*list));
-      char                    *line  = lines->elems[i].data;
-
-      if (!list)
-      {
-         string_list_free(lines);
+      if (!buf)
+         free(conf);
+      else
          config_file_free(conf);
-         return NULL;
-      }
-
-      list->readonly  = false;
-      list->key       = NULL;
-      list->value     = NULL;
-      list->next      = NULL;
-
-      if (line && conf)
-      {
-         if (*line && parse_line(conf, list, line))
-         {
-            if (conf->entries)
-               conf->tail->next = list;
-            else
-               conf->entries = list;
-
-            conf->tail = list;
-         }
-      }
-
-      if (list != conf->tail)
-         free(list);
+      return NULL;
    }
 
-   string_list_free(lines);
-
    return conf;
 }
 
@@ -527,29 +658,35 @@ config_file_t *config_file_new(const char *path)
    return config_file_new_internal(path, 0);
 }
 
-static struct config_entry_list *config_get_entry(const config_file_t *conf,
-      const char *key, struct config_entry_list **prev)
+static struct config_entry_list *config_get_entry(
+      const config_file_t *conf, const char *key)
 {
-   struct config_entry_list *entry    = NULL;
-   struct config_entry_list *previous = prev ? *prev : NULL;
+   struct config_entry_list *entry = NULL;
+   uint32_t hash;
 
-   for (entry = conf->entries; entry; entry = entry->next)
+   if (!conf->entries_map)
    {
-      if (string_is_equal(key, entry->key))
-         return entry;
-
-      previous = entry;
+      for (entry = conf->entries; entry; entry = entry->next)
+         if (entry->key && string_is_equal(key, entry->key))
+            return entry;
+      return NULL;
    }
 
-   if (prev)
-      *prev = previous;
+   hash = config_hash_key(key);
+
+   for (entry = conf->entries_map[hash & (conf->entries_map_size - 1)];
+         entry; entry = entry->hash_next)
+   {
+      if (entry->key_hash == hash && string_is_equal(key, entry->key))
+         return entry;
+   }
 
    return NULL;
 }
 
 bool config_get_double(config_file_t *conf, const char *key, double *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -562,7 +699,7 @@ bool config_get_double(config_file_t *conf, const char *key, double *in)
 
 bool config_get_float(config_file_t *conf, const char *key, float *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -575,7 +712,7 @@ bool config_get_float(config_file_t *conf, const char *key, float *in)
 
 bool config_get_int(config_file_t *conf, const char *key, int *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -595,7 +732,7 @@ bool config_get_int(config_file_t *conf, const char *key, int *in)
 #if defined(__STDC_VERSION__) && __STDC_VERSION__>=199901L
 bool config_get_uint64(config_file_t *conf, const char *key, uint64_t *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -614,7 +751,7 @@ bool config_get_uint64(config_file_t *conf, const char *key, uint64_t *in)
 
 bool config_get_uint(config_file_t *conf, const char *key, unsigned *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -633,7 +770,7 @@ bool config_get_uint(config_file_t *conf, const char *key, unsigned *in)
 
 bool config_get_hex(config_file_t *conf, const char *key, unsigned *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
    errno = 0;
 
    if (entry)
@@ -652,7 +789,7 @@ bool config_get_hex(config_file_t *conf, const char *key, unsigned *in)
 
 bool config_get_char(config_file_t *conf, const char *key, char *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -668,7 +805,7 @@ bool config_get_char(config_file_t *conf, const char *key, char *in)
 
 bool config_get_string(config_file_t *conf, const char *key, char **str)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -689,7 +826,7 @@ bool config_get_config_path(config_file_t *conf, char *s, size_t len)
 bool config_get_array(config_file_t *conf, const char *key,
       char *buf, size_t size)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
       return strlcpy(buf, entry->value, size) < size;
@@ -703,7 +840,7 @@ bool config_get_path(config_file_t *conf, const char *key,
    if (config_get_array(conf, key, buf, size))
       return true;
 #else
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -716,7 +853,7 @@ bool config_get_path(config_file_t *conf, const char *key,
 
 bool config_get_bool(config_file_t *conf, const char *key, bool *in)
 {
-   const struct config_entry_list *entry = config_get_entry(conf, key, NULL);
+   const struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry)
    {
@@ -737,13 +874,14 @@ bool config_get_bool(config_file_t *conf, const char *key, bool *in)
 
 void config_set_string(config_file_t *conf, const char *key, const char *val)
 {
-   struct config_entry_list *last  = conf->entries;
-   struct config_entry_list *entry = config_get_entry(conf, key, &last);
+   struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (entry && !entry->readonly)
    {
-      free(entry->value);
-      entry->value = strdup(val);
+      if (!entry->value_in_buffer)
+         free(entry->value);
+      entry->value           = strdup(val);
+      entry->value_in_buffer = false;
       return;
    }
 
@@ -754,29 +892,33 @@ void config_set_string(config_file_t *conf, const char *key, const char *val)
    if (!entry)
       return;
 
-   entry->readonly  = false;
-   entry->key       = strdup(key);
-   entry->value     = strdup(val);
-   entry->next      = NULL;
+   entry->readonly        = false;
+   entry->key_in_buffer   = false;
+   entry->value_in_buffer = false;
+   entry->key             = strdup(key);
+   entry->value           = strdup(val);
 
-   if (last)
-      last->next    = entry;
-   else
-      conf->entries = entry;
+   config_append_entry(conf, entry);
 }
 
 void config_unset(config_file_t *conf, const char *key)
 {
-   struct config_entry_list *last  = conf->entries;
-   struct config_entry_list *entry = config_get_entry(conf, key, &last);
+   struct config_entry_list *entry = config_get_entry(conf, key);
 
    if (!entry)
       return;
 
+   if (!entry->key_in_buffer)
+      free(entry->key);
+   if (!entry->value_in_buffer)
+      free(entry->value);
+
    entry->key   = NULL;
    entry->value = NULL;
-   free(entry->key);
-   free(entry->value);
+
+   /* A later entry with the same key may now be the first one. */
+   config_map_rebuild(conf, conf->entries_map_size
+         ? conf->entries_map_size : CONFIG_MAP_MIN_SIZE);
 }
 
 void config_set_path(config_file_t *conf, const char *entry, const char *val)
@@ -905,16 +1047,7 @@ void config_file_dump(config_file_t *conf, FILE *file)
 
 bool config_entry_exists(config_file_t *conf, const char *entry)
 {
-   struct config_entry_list *list = conf->entries;
-
-   while (list)
-   {
-      if (string_is_equal(entry, list->key))
-         return true;
-      list = list->next;
-   }
-
-   return false;
+   return config_get_entry(conf, entry) != NULL;
 }
 
 bool config_get_entry_list_head(config_file_t *conf,
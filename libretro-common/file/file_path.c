@@ -107,7 +107,8 @@ enum stat_mode
    IS_VALID
 };
 
-static bool path_stat(const char *path, enum stat_mode mode, int32_t *size)
+static bool path_stat(const char *path, enum stat_mode mode,
+      int32_t *size, int64_t *mtime)
 {
 #if defined(VITA) || defined(PSP)
    SceIoStat buf;
@@ -132,6 +133,9 @@ static bool path_stat(const char *path, enum stat_mode mode, int32_t *size)
    char *path_local;
    wchar_t *path_wide;
    DWORD file_info;
+#if !defined(LEGACY_WIN32)
+   WIN32_FILE_ATTRIBUTE_DATA attr;
+#endif
 
    if (!path || !*path)
       return false;
@@ -154,6 +158,11 @@ static bool path_stat(const char *path, enum stat_mode mode, int32_t *size)
 
    _wstat(path_wide, &buf);
 
+   /* _stat only has seconds, the file time 100ns intervals */
+   if (mtime && !GetFileAttributesExW(path_wide,
+            GetFileExInfoStandard, &attr))
+      memset(&attr, 0, sizeof(attr));
+
    if (path_wide)
       free(path_wide);
 #endif
@@ -169,6 +178,27 @@ static bool path_stat(const char *path, enum stat_mode mode, int32_t *size)
    if (size)
       *size = (int32_t)buf.st_size;
 
+   if (mtime)
+   {
+#if defined(VITA) || defined(PSP)
+      /* st_mtime is a broken-down SceDateTime here,
+       * callers only get the size to compare against. */
+      *mtime = 0;
+#elif defined(_WIN32) && !defined(LEGACY_WIN32)
+      *mtime = (int64_t)(((uint64_t)attr.ftLastWriteTime.dwHighDateTime << 32)
+            | attr.ftLastWriteTime.dwLowDateTime) * 100;
+#elif defined(__APPLE__)
+      *mtime = (int64_t)buf.st_mtimespec.tv_sec * 1000000000
+         + buf.st_mtimespec.tv_nsec;
+#elif (defined(__linux__) && (!defined(__GLIBC__) || defined(__USE_XOPEN2K8) || defined(__USE_MISC))) \
+   || defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__)
+      *mtime = (int64_t)buf.st_mtim.tv_sec * 1000000000
+         + buf.st_mtim.tv_nsec;
+#else
+      *mtime = (int64_t)buf.st_mtime * 1000000000;
+#endif
+   }
+
    switch (mode)
    {
       case IS_DIRECTORY:
@@ -204,28 +234,33 @@ static bool path_stat(const char *path, enum stat_mode mode, int32_t *size)
  */
 bool path_is_directory(const char *path)
 {
-   return path_stat(path, IS_DIRECTORY, NULL);
+   return path_stat(path, IS_DIRECTORY, NULL, NULL);
 }
 
 bool path_is_character_special(const char *path)
 {
-   return path_stat(path, IS_CHARACTER_SPECIAL, NULL);
+   return path_stat(path, IS_CHARACTER_SPECIAL, NULL, NULL);
 }
 
 bool path_is_valid(const char *path)
 {
-   return path_stat(path, IS_VALID, NULL);
+   return path_stat(path, IS_VALID, NULL, NULL);
 }
 
 int32_t path_get_size(const char *path)
 {
    int32_t filesize = 0;
-   if (path_stat(path, IS_VALID, &filesize))
+   if (path_stat(path, IS_VALID, &filesize, NULL))
       return filesize;
 
    return -1;
 }
 
+bool path_get_size_mtime(const char *path, int32_t *size, int64_t *mtime)
+{
+   return path_stat(path, IS_VALID, size, mtime);
+}
+
 static bool path_mkdir_error(int ret)
 {
 #if defined(VITA)
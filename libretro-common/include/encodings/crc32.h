@@ -32,6 +32,17 @@ RETRO_BEGIN_DECLS
 
 uint32_t encoding_crc32(uint32_t crc, const uint8_t *buf, size_t len);
 
+/**
+ * encoding_crc32_combine:
+ * @crc1               : CRC32 of the first block.
+ * @crc2               : CRC32 of the second block.
+ * @len2               : Length of the second block in bytes.
+ *
+ * Returns: CRC32 of the two blocks concatenated, so separate
+ * regions of a file can be hashed independently and merged.
+ **/
+uint32_t encoding_crc32_combine(uint32_t crc1, uint32_t crc2, uint64_t len2);
+
 RETRO_END_DECLS
 
 #endif
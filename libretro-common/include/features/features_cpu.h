@@ -59,6 +59,20 @@ retro_time_t cpu_features_get_time_usec(void);
  **/
 uint64_t cpu_features_get(void);
 
+/* CPU features the libretro API has no RETRO_SIMD_* bit for.
+ * Frontend only, not reported to cores. */
+#define CPU_FEATURE_PCLMUL (1 << 0)
+#define CPU_FEATURE_CRC32  (1 << 1)
+
+/**
+ * cpu_features_get_extra:
+ *
+ * Gets CPU features not covered by the RETRO_SIMD_* bits.
+ *
+ * Returns: bitmask of CPU_FEATURE_* flags.
+ **/
+uint64_t cpu_features_get_extra(void);
+
 /**
  * cpu_features_get_core_amount:
  *
@@ -60,6 +60,14 @@ struct config_file
    unsigned include_depth;
 
    struct config_include_list *includes;
+
+   /* Files read by the parser, entries point into them. */
+   struct config_buffer_list *buffers;
+
+   /* Hash of key -> first entry with that key. */
+   struct config_entry_list **entries_map;
+   size_t entries_map_size;
+   size_t entries_map_count;
 };
 
 
@@ -486,6 +486,20 @@ bool path_is_valid(const char *path);
 
 int32_t path_get_size(const char *path);
 
+/**
+ * path_get_size_mtime:
+ * @path               : path
+ * @size               : size of the file in bytes (may be NULL)
+ * @mtime              : last modification time in nanoseconds (may be NULL)
+ *
+ * Stats @path once and returns both its size and modification
+ * time. @mtime only has the resolution the platform keeps, and
+ * is 0 on platforms that do not expose it.
+ *
+ * Returns: true (1) if path exists, otherwise false (0).
+ */
+bool path_get_size_mtime(const char *path, int32_t *size, int64_t *mtime);
+
 RETRO_END_DECLS
 
 #endif
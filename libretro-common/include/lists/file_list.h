@@ -44,12 +44,23 @@ struct item_file
    void *actiondata;
 };
 
+struct file_list_string_chunk;
+
+/* Entries are kept contiguous in list[0..size-1], with spare
+ * slots both behind (capacity) and in front of list[0] (front)
+ * so that append and prepend are both amortized O(1).
+ *
+ * path, label and alt strings live in a per-list arena and
+ * must only be changed through file_list_set_*_at_offset();
+ * they are released all at once on clear/free. */
 typedef struct file_list
 {
    struct item_file *list;
 
    size_t capacity;
    size_t size;
+   size_t front;
+   struct file_list_string_chunk *strings;
 } file_list_t;
 
 
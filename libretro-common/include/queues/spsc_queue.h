@@ -0,0 +1,117 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_queue.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef __LIBRETRO_SDK_SPSC_QUEUE_H
+#define __LIBRETRO_SDK_SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Lock-free single-producer/single-consumer byte ring.
+ *
+ * Exactly one thread may call the producer functions (write/stage/
+ * commit/wait_write/write_avail) and exactly one other thread the
+ * consumer ones (read/wait_read). spsc_queue_read_avail() may be
+ * called from anywhere, its result is only a snapshot.
+ *
+ * Writes can be staged and published together with one commit, so the
+ * consumer sees a batch at once and the shared index is touched once. */
+typedef struct spsc_queue spsc_queue_t;
+
+/**
+ * spsc_queue_new:
+ * @size                    : capacity in bytes. Storage is rounded
+ *                            up to a power of two internally.
+ *
+ * Returns: new queue, or NULL on allocation failure.
+ **/
+spsc_queue_t *spsc_queue_new(size_t size);
+
+void spsc_queue_free(spsc_queue_t *queue);
+
+/* Resets the queue. Neither side may be using it. */
+void spsc_queue_clear(spsc_queue_t *queue);
+
+size_t spsc_queue_capacity(spsc_queue_t *queue);
+
+size_t spsc_queue_read_avail(spsc_queue_t *queue);
+
+size_t spsc_queue_write_avail(spsc_queue_t *queue);
+
+/**
+ * spsc_queue_stage:
+ *
+ * Copies up to @size bytes into the queue without making them
+ * visible to the consumer yet.
+ *
+ * Returns: number of bytes staged.
+ **/
+size_t spsc_queue_stage(spsc_queue_t *queue, const void *in_buf, size_t size);
+
+/* Publishes everything staged so far and wakes a waiting consumer. */
+void spsc_queue_commit(spsc_queue_t *queue);
+
+/* spsc_queue_stage() followed by spsc_queue_commit(). */
+size_t spsc_queue_write(spsc_queue_t *queue, const void *in_buf, size_t size);
+
+/**
+ * spsc_queue_read:
+ *
+ * Copies up to @size bytes out of the queue and wakes a waiting
+ * producer.
+ *
+ * Returns: number of bytes read.
+ **/
+size_t spsc_queue_read(spsc_queue_t *queue, void *out_buf, size_t size);
+
+/**
+ * spsc_queue_wait_write:
+ * @size                    : bytes of free space to wait for.
+ * @timeout_us              : maximum time to sleep, negative waits
+ *                            until woken.
+ *
+ * Blocks the producer until @size bytes can be written, the timeout
+ * expires or the queue is aborted. May return early, callers are
+ * expected to loop. Never sleeps without thread support.
+ *
+ * Returns: true if @size bytes can be written.
+ **/
+bool spsc_queue_wait_write(spsc_queue_t *queue, size_t size,
+      int64_t timeout_us);
+
+/* Consumer counterpart of spsc_queue_wait_write(). */
+bool spsc_queue_wait_read(spsc_queue_t *queue, size_t size,
+      int64_t timeout_us);
+
+/* Wakes up both sides and keeps any further wait from sleeping,
+ * until spsc_queue_clear(). Used when one side shuts down. */
+void spsc_queue_abort(spsc_queue_t *queue);
+
+RETRO_END_DECLS
+
+#endif
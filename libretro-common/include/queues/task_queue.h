@@ -42,6 +42,22 @@ enum task_type
    TASK_TYPE_BLOCKING
 };
 
+/* Scheduling class, used by the threaded task queue.
+ * Classes are served in this order. */
+enum task_priority
+{
+   /* Default. Interactive tasks never run concurrently with
+    * each other, so handlers that share global state stay
+    * safe, but they are not held up by the classes below. */
+   TASK_PRIORITY_INTERACTIVE = 0,
+   /* Network and file transfers, image decoding. */
+   TASK_PRIORITY_IO,
+   /* Long running work such as database scans. */
+   TASK_PRIORITY_BULK,
+
+   TASK_PRIORITY_COUNT
+};
+
 
 typedef struct retro_task retro_task_t;
 typedef void (*retro_task_callback_t)(void *task_data,
@@ -110,8 +126,17 @@ struct retro_task
 
    enum task_type type;
 
+   enum task_priority priority;
+
+   /* kept by the task system, in microseconds: total time
+    * spent waiting to run and total time spent in the handler. */
+   int64_t wait_time;
+   int64_t run_time;
+
    /* don't touch this. */
    retro_task_t *next;
+   retro_task_t *ready_next;
+   int64_t ready_time;
 };
 
 typedef struct task_finder_data
@@ -173,6 +198,10 @@ char* task_get_title(retro_task_t *task);
 
 void* task_get_data(retro_task_t *task);
 
+int64_t task_get_wait_time(retro_task_t *task);
+
+int64_t task_get_run_time(retro_task_t *task);
+
 void task_queue_set_threaded(void);
 
 void task_queue_unset_threaded(void);
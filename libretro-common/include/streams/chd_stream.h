@@ -39,6 +39,27 @@ typedef struct chdstream chdstream_t;
 /* Primary (largest) data track, used for CRC identification purposes */
 #define CHDSTREAM_TRACK_PRIMARY (-3)
 
+/* Decompressed hunks kept by each stream */
+#define CHDSTREAM_CACHE_HUNKS_DEFAULT 16
+/* Hunks decompressed on worker threads ahead of sequential reads */
+#define CHDSTREAM_READ_AHEAD_DEFAULT 4
+
+typedef struct chdstream_stats
+{
+   /* Hunks found in the cache */
+   uint64_t hits;
+   /* Hunks decompressed while the reader waited */
+   uint64_t misses;
+   /* Hunks decompressed ahead of the reader */
+   uint64_t read_ahead;
+   /* Read-ahead hunks the reader went on to use */
+   uint64_t read_ahead_hits;
+   /* Time spent decompressing, summed over all threads (usec) */
+   uint64_t decode_time;
+   /* Time the reader spent waiting on read-ahead (usec) */
+   uint64_t wait_time;
+} chdstream_stats_t;
+
 chdstream_t *chdstream_open(const char *path, int32_t track);
 
 void chdstream_close(chdstream_t *stream);
@@ -57,6 +78,19 @@ int64_t chdstream_seek(chdstream_t *stream, int64_t offset, int whence);
 
 ssize_t chdstream_get_size(chdstream_t *stream);
 
+/**
+ * chdstream_set_cache:
+ * @hunks              : decompressed hunks kept per stream (at least 2)
+ * @read_ahead         : hunks decompressed ahead of sequential reads,
+ *                       0 disables read-ahead
+ *
+ * Applies to streams opened afterwards. @read_ahead is capped to
+ * @hunks - 2, read-ahead needs HAVE_THREADS.
+ **/
+void chdstream_set_cache(unsigned hunks, unsigned read_ahead);
+
+void chdstream_get_stats(chdstream_t *stream, chdstream_stats_t *stats);
+
 RETRO_END_DECLS
 
 #endif
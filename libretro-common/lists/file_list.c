@@ -29,18 +29,128 @@
 #include <string/stdstring.h>
 #include <compat/strcasestr.h>
 
+#define FILE_LIST_CHUNK_MIN_SIZE 4096
+
+struct file_list_string_chunk
+{
+   struct file_list_string_chunk *next;
+   size_t size;
+   size_t used;
+};
+
+#define FILE_LIST_CHUNK_DATA(chunk) ((char*)((chunk) + 1))
+
+/* Copies @str into the list's string arena. Chunks are never
+ * moved, so returned pointers stay valid until the list is
+ * cleared or freed. */
+static char *file_list_strdup(file_list_t *list, const char *str)
+{
+   char *ret                            = NULL;
+   size_t len                           = strlen(str) + 1;
+   struct file_list_string_chunk *chunk = list->strings;
+
+   if (!chunk || chunk->size - chunk->used < len)
+   {
+      size_t size = chunk ? chunk->size * 2 : FILE_LIST_CHUNK_MIN_SIZE;
+
+      if (size < len)
+         size     = len;
+
+      chunk       = (struct file_list_string_chunk*)
+         malloc(sizeof(*chunk) + size);
+
+      if (!chunk)
+         return NULL;
+
+      chunk->next   = list->strings;
+      chunk->size   = size;
+      chunk->used   = 0;
+      list->strings = chunk;
+   }
+
+   ret          = FILE_LIST_CHUNK_DATA(chunk) + chunk->used;
+   memcpy(ret, str, len);
+   chunk->used += len;
+
+   return ret;
+}
+
+/* Gives the space of @str back to the arena when it was the
+ * last string allocated, which covers push/pop on menu stacks.
+ * Anything else is reclaimed on clear/free. */
+static void file_list_string_release(file_list_t *list, const char *str)
+{
+   struct file_list_string_chunk *chunk = list->strings;
+   size_t len                           = 0;
+
+   if (!str || !chunk)
+      return;
+
+   len = strlen(str) + 1;
+
+   if (str + len == FILE_LIST_CHUNK_DATA(chunk) + chunk->used)
+      chunk->used -= len;
+}
+
+static void file_list_string_set(file_list_t *list, char **dst,
+      const char *str)
+{
+   if (*dst == str)
+      return;
+
+   /* Reuse the old storage whenever the new string fits */
+   if (*dst && str && strlen(str) <= strlen(*dst))
+   {
+      memmove(*dst, str, strlen(str) + 1);
+      return;
+   }
+
+   file_list_string_release(list, *dst);
+   *dst = str ? file_list_strdup(list, str) : NULL;
+}
+
+/* Drops every string; keeps the largest chunk around
+ * so that refilling the list does not allocate again. */
+static void file_list_strings_reset(file_list_t *list, bool keep)
+{
+   struct file_list_string_chunk *chunk = list->strings;
+
+   if (!chunk)
+      return;
+
+   if (keep)
+   {
+      chunk->used   = 0;
+      chunk         = chunk->next;
+      list->strings->next = NULL;
+   }
+   else
+      list->strings = NULL;
+
+   while (chunk)
+   {
+      struct file_list_string_chunk *next = chunk->next;
+      free(chunk);
+      chunk = next;
+   }
+}
+
 bool file_list_reserve(file_list_t *list, size_t nitems)
 {
    const size_t item_size = sizeof(struct item_file);
+   struct item_file *base = list->list ? list->list - list->front : NULL;
    struct item_file *new_data;
 
-   if (nitems < list->capacity || nitems > (size_t)-1/item_size)
+   if (nitems < list->capacity
+         || nitems > (size_t)-1/item_size - list->front)
       return false;
 
-   new_data = (struct item_file*)realloc(list->list, nitems * item_size);
+   new_data = (struct item_file*)realloc(base,
+         (list->front + nitems) * item_size);
 
    if (new_data)
    {
+      new_data      += list->front;
       memset(&new_data[list->capacity], 0, item_size * (nitems - list->capacity));
 
       list->list     = new_data;
@@ -50,6 +160,43 @@ bool file_list_reserve(file_list_t *list, size_t nitems)
    return new_data != NULL;
 }
 
+/* Makes room for at least one slot in front of list[0].
+ * The front gap grows with the list, keeping prepends
+ * amortized O(1) just like appends. */
+static bool file_list_reserve_front(file_list_t *list)
+{
+   const size_t item_size = sizeof(struct item_file);
+   size_t front           = list->size + 1;
+   struct item_file *base = NULL;
+   struct item_file *new_data;
+
+   if (list->front)
+      return true;
+
+   if (front < 4)
+      front = 4;
+
+   if (list->capacity > (size_t)-1/item_size - front)
+      return false;
+
+   new_data = (struct item_file*)malloc((front + list->capacity) * item_size);
+
+   if (!new_data)
+      return false;
+
+   if (list->list)
+   {
+      base = list->list - list->front;
+      memcpy(&new_data[front], list->list, list->capacity * item_size);
+      free(base);
+   }
+
+   list->list  = new_data + front;
+   list->front = front;
+
+   return true;
+}
+
 static void file_list_add(file_list_t *list, unsigned idx,
       const char *path, const char *label,
       unsigned type, size_t directory_ptr,
@@ -65,9 +212,9 @@ static void file_list_add(file_list_t *list, unsigned idx,
    list->list[idx].actiondata    = NULL;
 
    if (label)
-      list->list[idx].label      = strdup(label);
+      list->list[idx].label      = file_list_strdup(list, label);
    if (path)
-      list->list[idx].path       = strdup(path);
+      list->list[idx].path       = file_list_strdup(list, path);
 
    list->size++;
 }
@@ -85,23 +232,12 @@ bool file_list_prepend(file_list_t *list,
       unsigned type, size_t directory_ptr,
       size_t entry_idx)
 {
-   unsigned i;
-
-   if (!file_list_expand_if_needed(list))
+   if (!file_list_reserve_front(list))
       return false;
 
-   for (i = (unsigned)list->size; i > 0; i--)
-   {
-      struct item_file *copy = (struct item_file*)
-         calloc(1, sizeof(struct item_file));
-
-      memcpy(copy, &list->list[i-1], sizeof(struct item_file));
-
-      memcpy(&list->list[i-1], &list->list[i], sizeof(struct item_file));
-      memcpy(&list->list[i],             copy, sizeof(struct item_file));
-
-      free(copy);
-   }
+   list->list--;
+   list->front--;
+   list->capacity++;
 
    file_list_add(list, 0, path, label, type,
          directory_ptr, entry_idx);
@@ -144,14 +280,19 @@ void file_list_pop(file_list_t *list, size_t *directory_ptr)
 
    if (list->size != 0)
    {
-      --list->size;
-      if (list->list[list->size].path)
-         free(list->list[list->size].path);
-      list->list[list->size].path = NULL;
-
-      if (list->list[list->size].label)
-         free(list->list[list->size].label);
-      list->list[list->size].label = NULL;
+      struct item_file *item = &list->list[--list->size];
+
+      /* Reverse order of allocation */
+      file_list_string_release(list, item->alt);
+      file_list_string_release(list, item->path);
+      file_list_string_release(list, item->label);
+
+      item->alt   = NULL;
+      item->path  = NULL;
+      item->label = NULL;
+
+      if (list->size == 0)
+         file_list_strings_reset(list, true);
    }
 
    if (directory_ptr)
@@ -169,21 +310,12 @@ void file_list_free(file_list_t *list)
    {
       file_list_free_userdata(list, i);
       file_list_free_actiondata(list, i);
+   }
 
-      if (list->list[i].path)
-         free(list->list[i].path);
-      list->list[i].path = NULL;
-
-      if (list->list[i].label)
-         free(list->list[i].label);
-      list->list[i].label = NULL;
+   file_list_strings_reset(list, false);
 
-      if (list->list[i].alt)
-         free(list->list[i].alt);
-      list->list[i].alt = NULL;
-   }
    if (list->list)
-      free(list->list);
+      free(list->list - list->front);
    list->list = NULL;
    free(list);
 }
@@ -197,19 +329,13 @@ void file_list_clear(file_list_t *list)
 
    for (i = 0; i < list->size; i++)
    {
-      if (list->list[i].path)
-         free(list->list[i].path);
-      list->list[i].path = NULL;
-
-      if (list->list[i].label)
-         free(list->list[i].label);
+      list->list[i].path  = NULL;
       list->list[i].label = NULL;
-
-      if (list->list[i].alt)
-         free(list->list[i].alt);
-      list->list[i].alt = NULL;
+      list->list[i].alt   = NULL;
    }
 
+   file_list_strings_reset(list, true);
+
    list->size = 0;
 }
 
@@ -220,32 +346,17 @@ void file_list_copy(const file_list_t *src, file_list_t *dst)
    if (!src || !dst)
       return;
 
+   file_list_strings_reset(dst, false);
+
    if (dst->list)
    {
-      for (item = dst->list; item < &dst->list[dst->size]; ++item)
-      {
-         if (!item)
-            continue;
-
-         if (item->path)
-            free(item->path);
-         item->path = NULL;
-
-         if (item->label)
-            free(item->label);
-         item->label = NULL;
-
-         if (item->alt)
-            free(item->alt);
-         item->alt = NULL;
-      }
-
-      free(dst->list);
+      free(dst->list - dst->front);
       dst->list = NULL;
    }
 
    dst->size     = 0;
    dst->capacity = 0;
+   dst->front    = 0;
    dst->list     = (struct item_file*)malloc(src->size * sizeof(struct item_file));
 
    if (!dst->list)
@@ -258,13 +369,13 @@ void file_list_copy(const file_list_t *src, file_list_t *dst)
    for (item = dst->list; item < &dst->list[dst->size]; ++item)
    {
       if (item->path)
-         item->path  = strdup(item->path);
+         item->path  = file_list_strdup(dst, item->path);
 
       if (item->label)
-         item->label = strdup(item->label);
+         item->label = file_list_strdup(dst, item->label);
 
       if (item->alt)
-         item->alt   = strdup(item->alt);
+         item->alt   = file_list_strdup(dst, item->alt);
    }
 }
 
@@ -274,12 +385,7 @@ void file_list_set_label_at_offset(file_list_t *list, size_t idx,
    if (!list)
       return;
 
-   if (list->list[idx].label)
-      free(list->list[idx].label);
-   list->list[idx].alt      = NULL;
-
-   if (label)
-      list->list[idx].label = strdup(label);
+   file_list_string_set(list, &list->list[idx].label, label);
 }
 
 void file_list_get_label_at_offset(const file_list_t *list, size_t idx,
@@ -299,12 +405,7 @@ void file_list_set_alt_at_offset(file_list_t *list, size_t idx,
    if (!list || !alt)
       return;
 
-   if (list->list[idx].alt)
-      free(list->list[idx].alt);
-   list->list[idx].alt      = NULL;
-
-   if (alt)
-      list->list[idx].alt   = strdup(alt);
+   file_list_string_set(list, &list->list[idx].alt, alt);
 }
 
 void file_list_get_alt_at_offset(const file_list_t *list, size_t idx,
@@ -0,0 +1,375 @@
+/* Copyright  (C) 2010-2018 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_queue.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_inline.h>
+#include <retro_miscellaneous.h>
+#include <queues/spsc_queue.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+#if defined(__clang__) || (defined(__GNUC__) && \
+      (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+#define SPSC_GNUC_ATOMICS
+#elif defined(_MSC_VER)
+#define SPSC_MSVC_ATOMICS
+#include <windows.h>
+#elif defined(HAVE_THREADS)
+#define SPSC_LOCKED_ATOMICS
+#endif
+
+/* Keeps the indices each side writes on their own cache line,
+ * so the producer and consumer don't keep stealing it from
+ * each other. */
+#define SPSC_CACHE_LINE 64
+
+struct spsc_queue
+{
+   /* Written by the producer (commit), read by the consumer */
+   size_t head;
+   uint8_t pad0[SPSC_CACHE_LINE - sizeof(size_t)];
+
+   /* Written by the consumer, read by the producer */
+   size_t tail;
+   uint8_t pad1[SPSC_CACHE_LINE - sizeof(size_t)];
+
+   /* Producer only */
+   size_t staged;
+   size_t tail_cache;
+   uint8_t pad2[SPSC_CACHE_LINE - 2 * sizeof(size_t)];
+
+   /* Consumer only */
+   size_t head_cache;
+   uint8_t pad3[SPSC_CACHE_LINE - sizeof(size_t)];
+
+   /* Set by a side while it sleeps in spsc_queue_wait_*() */
+   size_t producer_waiting;
+   size_t consumer_waiting;
+   uint8_t pad4[SPSC_CACHE_LINE - 2 * sizeof(size_t)];
+
+   uint8_t *buffer;
+   size_t mask;
+   size_t size;    /* Usable capacity, buffer itself is mask + 1 */
+   bool aborted;
+#ifdef HAVE_THREADS
+   slock_t *wait_lock;
+   scond_t *wait_cond;
+#endif
+#ifdef SPSC_LOCKED_ATOMICS
+   slock_t *index_lock;
+#endif
+};
+
+/* Acquire load */
+static INLINE size_t spsc_load(spsc_queue_t *queue, size_t *ptr)
+{
+#if defined(SPSC_GNUC_ATOMICS)
+   return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#elif defined(SPSC_MSVC_ATOMICS)
+   size_t val = *(volatile size_t*)ptr;
+   MemoryBarrier();
+   return val;
+#elif defined(SPSC_LOCKED_ATOMICS)
+   size_t val;
+   slock_lock(queue->index_lock);
+   val = *ptr;
+   slock_unlock(queue->index_lock);
+   return val;
+#else
+   return *ptr;
+#endif
+}
+
+/* Release store */
+static INLINE void spsc_store(spsc_queue_t *queue, size_t *ptr, size_t val)
+{
+#if defined(SPSC_GNUC_ATOMICS)
+   __atomic_store_n(ptr, val, __ATOMIC_RELEASE);
+#elif defined(SPSC_MSVC_ATOMICS)
+   MemoryBarrier();
+   *(volatile size_t*)ptr = val;
+#elif defined(SPSC_LOCKED_ATOMICS)
+   slock_lock(queue->index_lock);
+   *ptr = val;
+   slock_unlock(queue->index_lock);
+#else
+   *ptr = val;
+#endif
+}
+
+/* Orders a preceding store before a following load. */
+static INLINE void spsc_fence(spsc_queue_t *queue)
+{
+#if defined(SPSC_GNUC_ATOMICS)
+   __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#elif defined(SPSC_MSVC_ATOMICS)
+   MemoryBarrier();
+#elif defined(SPSC_LOCKED_ATOMICS)
+   slock_lock(queue->index_lock);
+   slock_unlock(queue->index_lock);
+#endif
+}
+
+static void spsc_queue_signal(spsc_queue_t *queue, size_t *waiting)
+{
+   spsc_fence(queue);
+
+   if (!spsc_load(queue, waiting))
+      return;
+
+#ifdef HAVE_THREADS
+   slock_lock(queue->wait_lock);
+   scond_broadcast(queue->wait_cond);
+   slock_unlock(queue->wait_lock);
+#endif
+}
+
+spsc_queue_t *spsc_queue_new(size_t size)
+{
+   size_t capacity      = 1;
+   spsc_queue_t *queue  = (spsc_queue_t*)calloc(1, sizeof(*queue));
+
+   if (!queue)
+      return NULL;
+
+   while (capacity < size)
+      capacity <<= 1;
+
+   queue->buffer = (uint8_t*)calloc(1, capacity);
+   queue->mask   = capacity - 1;
+   queue->size   = size;
+
+   if (!queue->buffer)
+      goto error;
+
+#ifdef HAVE_THREADS
+   queue->wait_lock  = slock_new();
+   queue->wait_cond  = scond_new();
+   if (!queue->wait_lock || !queue->wait_cond)
+      goto error;
+#endif
+#ifdef SPSC_LOCKED_ATOMICS
+   if (!(queue->index_lock = slock_new()))
+      goto error;
+#endif
+
+   return queue;
+
+error:
+   spsc_queue_free(queue);
+   return NULL;
+}
+
+void spsc_queue_free(spsc_queue_t *queue)
+{
+   if (!queue)
+      return;
+
+#ifdef HAVE_THREADS
+   if (queue->wait_lock)
+      slock_free(queue->wait_lock);
+   if (queue->wait_cond)
+      scond_free(queue->wait_cond);
+#endif
+#ifdef SPSC_LOCKED_ATOMICS
+   if (queue->index_lock)
+      slock_free(queue->index_lock);
+#endif
+
+   free(queue->buffer);
+   free(queue);
+}
+
+void spsc_queue_clear(spsc_queue_t *queue)
+{
+   queue->head       = 0;
+   queue->tail       = 0;
+   queue->staged     = 0;
+   queue->tail_cache = 0;
+   queue->head_cache = 0;
+   queue->aborted    = false;
+}
+
+size_t spsc_queue_capacity(spsc_queue_t *queue)
+{
+   return queue->size;
+}
+
+size_t spsc_queue_read_avail(spsc_queue_t *queue)
+{
+   size_t tail = spsc_load(queue, &queue->tail);
+   return spsc_load(queue, &queue->head) - tail;
+}
+
+size_t spsc_queue_write_avail(spsc_queue_t *queue)
+{
+   queue->tail_cache = spsc_load(queue, &queue->tail);
+   return queue->size - (queue->staged - queue->tail_cache);
+}
+
+size_t spsc_queue_stage(spsc_queue_t *queue, const void *in_buf, size_t size)
+{
+   size_t offset, first;
+   size_t avail = queue->size - (queue->staged - queue->tail_cache);
+
+   /* Only look at the consumer's index when the cached one
+    * says we're out of room. */
+   if (avail < size)
+      avail = spsc_queue_write_avail(queue);
+
+   if (size > avail)
+      size   = avail;
+
+   offset    = queue->staged & queue->mask;
+   first     = MIN(size, queue->mask + 1 - offset);
+
+   memcpy(queue->buffer + offset, in_buf, first);
+   memcpy(queue->buffer, (const uint8_t*)in_buf + first, size - first);
+
+   queue->staged += size;
+   return size;
+}
+
+void spsc_queue_commit(spsc_queue_t *queue)
+{
+   spsc_store(queue, &queue->head, queue->staged);
+   spsc_queue_signal(queue, &queue->consumer_waiting);
+}
+
+size_t spsc_queue_write(spsc_queue_t *queue, const void *in_buf, size_t size)
+{
+   size_t written = spsc_queue_stage(queue, in_buf, size);
+
+   if (written)
+      spsc_queue_commit(queue);
+
+   return written;
+}
+
+size_t spsc_queue_read(spsc_queue_t *queue, void *out_buf, size_t size)
+{
+   size_t offset, first;
+   size_t tail  = queue->tail;
+   size_t avail = queue->head_cache - tail;
+
+   if (avail < size)
+   {
+      queue->head_cache = spsc_load(queue, &queue->head);
+      avail             = queue->head_cache - tail;
+   }
+
+   if (size > avail)
+      size   = avail;
+
+   if (!size)
+      return 0;
+
+   offset    = tail & queue->mask;
+   first     = MIN(size, queue->mask + 1 - offset);
+
+   memcpy(out_buf, queue->buffer + offset, first);
+   memcpy((uint8_t*)out_buf + first, queue->buffer, size - first);
+
+   spsc_store(queue, &queue->tail, tail + size);
+   spsc_queue_signal(queue, &queue->producer_waiting);
+
+   return size;
+}
+
+/* Sleeps once, until the other side commits/reads,
+ * the timeout expires or the queue is aborted.
+ * Setting the flag, then checking for data under the lock pairs
+ * with the store-fence-load in spsc_queue_signal(), so a wakeup
+ * can't be missed. */
+static void spsc_queue_sleep(spsc_queue_t *queue, size_t *waiting,
+      bool (*ready)(spsc_queue_t*, size_t), size_t size, int64_t timeout_us)
+{
+#ifdef HAVE_THREADS
+   slock_lock(queue->wait_lock);
+
+   spsc_store(queue, waiting, 1);
+   spsc_fence(queue);
+
+   if (!queue->aborted && !ready(queue, size))
+   {
+      if (timeout_us < 0)
+         scond_wait(queue->wait_cond, queue->wait_lock);
+      else
+         scond_wait_timeout(queue->wait_cond, queue->wait_lock, timeout_us);
+   }
+
+   spsc_store(queue, waiting, 0);
+   slock_unlock(queue->wait_lock);
+#endif
+}
+
+static bool spsc_queue_can_write(spsc_queue_t *queue, size_t size)
+{
+   return spsc_queue_write_avail(queue) >= size;
+}
+
+static bool spsc_queue_can_read(spsc_queue_t *queue, size_t size)
+{
+   queue->head_cache = spsc_load(queue, &queue->head);
+   return queue->head_cache - queue->tail >= size;
+}
+
+bool spsc_queue_wait_write(spsc_queue_t *queue, size_t size,
+      int64_t timeout_us)
+{
+   if (spsc_queue_can_write(queue, size))
+      return true;
+
+   spsc_queue_sleep(queue, &queue->producer_waiting,
+         spsc_queue_can_write, size, timeout_us);
+
+   return spsc_queue_can_write(queue, size);
+}
+
+bool spsc_queue_wait_read(spsc_queue_t *queue, size_t size,
+      int64_t timeout_us)
+{
+   if (spsc_queue_can_read(queue, size))
+      return true;
+
+   spsc_queue_sleep(queue, &queue->consumer_waiting,
+         spsc_queue_can_read, size, timeout_us);
+
+   return spsc_queue_can_read(queue, size);
+}
+
+void spsc_queue_abort(spsc_queue_t *queue)
+{
+#ifdef HAVE_THREADS
+   slock_lock(queue->wait_lock);
+   queue->aborted = true;
+   scond_broadcast(queue->wait_cond);
+   slock_unlock(queue->wait_lock);
+#else
+   queue->aborted = true;
+#endif
+}
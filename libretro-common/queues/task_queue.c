@@ -23,8 +23,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <string.h>
 
 #include <queues/task_queue.h>
+#include <features/features_cpu.h>
 
 #ifdef HAVE_THREADS
 #include <rthreads/rthreads.h>
@@ -155,6 +157,8 @@ static void retro_task_internal_gather(void)
 
 static void retro_task_regular_push_running(retro_task_t *task)
 {
+   if (!task->ready_time)
+      task->ready_time = cpu_features_get_time_usec();
    task_queue_put(&tasks_running, task);
 }
 
@@ -178,9 +182,18 @@ static void retro_task_regular_gather(void)
 
    for (task = queue; task; task = next)
    {
+      retro_time_t start = cpu_features_get_time_usec();
+
       next = task->next;
+
+      if (task->ready_time)
+         task->wait_time += start - task->ready_time;
+
       task->handler(task);
 
+      task->ready_time    = cpu_features_get_time_usec();
+      task->run_time     += task->ready_time - start;
+
       task_queue_push_progress(task);
 
       if (task->finished)
@@ -285,50 +298,186 @@ static struct retro_task_impl impl_regular = {
 };
 
 #ifdef HAVE_THREADS
+/* Upper bound on pool size; the pool always has at least two
+ * workers so bulk work can never starve interactive tasks. */
+#define TASK_QUEUE_MAX_WORKERS 4
+
+/* How long a worker keeps calling a handler before putting
+ * the task back and looking for more urgent work. */
+#define TASK_QUEUE_SLICE_USEC  2000
+
+typedef struct
+{
+   retro_task_t *front;
+   retro_task_t *back;
+} task_ready_queue_t;
+
+typedef struct
+{
+   sthread_t *thread;
+   slock_t *lock;
+   /* Only the IO and BULK classes are queued per worker. */
+   task_ready_queue_t ready[TASK_PRIORITY_COUNT];
+} task_worker_t;
+
 static slock_t *running_lock    = NULL;
 static slock_t *finished_lock   = NULL;
 static slock_t *property_lock   = NULL;
 static slock_t *queue_lock      = NULL;
+
+/* pool_lock guards everything below it. */
+static slock_t *pool_lock       = NULL;
 static scond_t *worker_cond     = NULL;
-static sthread_t *worker_thread = NULL;
-static bool worker_continue     = true; /* use running_lock when touching it */
+static bool worker_continue     = true;
+static task_ready_queue_t interactive_queue = {NULL, NULL};
+static bool interactive_busy    = false;
+static unsigned ready_count     = 0;
+static unsigned next_worker     = 0;
+
+static task_worker_t workers[TASK_QUEUE_MAX_WORKERS];
+static unsigned worker_count    = 0;
+
+static void task_ready_put(task_ready_queue_t *queue, retro_task_t *task)
+{
+   task->ready_next = NULL;
+
+   if (queue->front)
+      queue->back->ready_next = task;
+   else
+      queue->front = task;
+
+   queue->back = task;
+}
+
+static retro_task_t *task_ready_get(task_ready_queue_t *queue)
+{
+   retro_task_t *task = queue->front;
+
+   if (task)
+   {
+      queue->front     = task->ready_next;
+      task->ready_next = NULL;
+   }
+
+   return task;
+}
 
 static void task_queue_remove(task_queue_t *queue, retro_task_t *task)
 {
-   retro_task_t     *t = NULL;
-   retro_task_t *front = NULL;
+   retro_task_t *prev = NULL;
+   retro_task_t *t    = NULL;
 
    slock_lock(queue_lock);
-   front = queue->front;
-   slock_unlock(queue_lock);
 
-   /* Remove first element if needed */
-   if (task == front)
+   for (t = queue->front; t; prev = t, t = t->next)
    {
-      slock_lock(queue_lock);
-      queue->front = task->next;
-      slock_unlock(queue_lock);
-      task->next   = NULL;
+      if (t != task)
+         continue;
+
+      if (prev)
+         prev->next   = task->next;
+      else
+         queue->front = task->next;
+
+      if (queue->back == task)
+         queue->back  = prev;
+
+      task->next      = NULL;
+      break;
+   }
+
+   slock_unlock(queue_lock);
+}
 
+/* Makes @task runnable again. @worker is the worker that just
+ * ran it, or NULL for a newly pushed task. */
+static void task_pool_submit(retro_task_t *task, task_worker_t *worker)
+{
+   task->ready_time = cpu_features_get_time_usec();
+
+   if (task->priority == TASK_PRIORITY_INTERACTIVE
+         || task->priority >= TASK_PRIORITY_COUNT)
+   {
+      slock_lock(pool_lock);
+      task_ready_put(&interactive_queue, task);
+      scond_signal(worker_cond);
+      slock_unlock(pool_lock);
       return;
    }
 
-   /* Parse queue */
-   t = front;
+   if (!worker)
+   {
+      slock_lock(pool_lock);
+      worker = &workers[next_worker++ % worker_count];
+      slock_unlock(pool_lock);
+   }
 
-   while (t && t->next)
+   slock_lock(worker->lock);
+   task_ready_put(&worker->ready[task->priority], task);
+   slock_unlock(worker->lock);
+
+   slock_lock(pool_lock);
+   ready_count++;
+   scond_signal(worker_cond);
+   slock_unlock(pool_lock);
+}
+
+/* Takes the most urgent IO/BULK task, preferring the worker's
+ * own queue and stealing from the others otherwise. */
+static retro_task_t *task_pool_take(task_worker_t *worker)
+{
+   unsigned prio, i;
+   unsigned self = (unsigned)(worker - workers);
+
+   for (prio = TASK_PRIORITY_IO; prio < TASK_PRIORITY_COUNT; prio++)
    {
-      /* Remove task and update queue */
-      if (t->next == task)
+      for (i = 0; i < worker_count; i++)
       {
-         t->next    = task->next;
-         task->next = NULL;
-         break;
-      }
+         retro_task_t *task   = NULL;
+         task_worker_t *victim = &workers[(self + i) % worker_count];
+
+         slock_lock(victim->lock);
+         task = task_ready_get(&victim->ready[prio]);
+         slock_unlock(victim->lock);
 
-      /* Update iterator */
-      t = t->next;
+         if (task)
+         {
+            slock_lock(pool_lock);
+            ready_count--;
+            slock_unlock(pool_lock);
+            return task;
+         }
+      }
    }
+
+   return NULL;
+}
+
+/* Runs @task for up to one time slice.
+ * Returns true once the task has finished. */
+static bool task_pool_run(retro_task_t *task)
+{
+   bool finished      = false;
+   retro_time_t start = cpu_features_get_time_usec();
+   retro_time_t now   = start;
+
+   do
+   {
+      task->handler(task);
+
+      slock_lock(property_lock);
+      finished = task->finished;
+      slock_unlock(property_lock);
+
+      now = cpu_features_get_time_usec();
+   } while (!finished && now - start < TASK_QUEUE_SLICE_USEC);
+
+   slock_lock(property_lock);
+   task->wait_time += start - task->ready_time;
+   task->run_time  += now - start;
+   slock_unlock(property_lock);
+
+   return finished;
 }
 
 static void retro_task_threaded_push_running(retro_task_t *task)
@@ -336,9 +485,10 @@ static void retro_task_threaded_push_running(retro_task_t *task)
    slock_lock(running_lock);
    slock_lock(queue_lock);
    task_queue_put(&tasks_running, task);
-   scond_signal(worker_cond);
    slock_unlock(queue_lock);
    slock_unlock(running_lock);
+
+   task_pool_submit(task, NULL);
 }
 
 static void retro_task_threaded_cancel(void *task)
@@ -436,91 +586,146 @@ static void retro_task_threaded_retrieve(task_retriever_data_t *data)
 
 static void threaded_worker(void *userdata)
 {
-   (void)userdata;
+   task_worker_t *worker = (task_worker_t*)userdata;
 
    for (;;)
    {
-      retro_task_t *task  = NULL;
-      bool finished = false;
+      retro_task_t *task = NULL;
+      bool interactive   = false;
 
-      if (!worker_continue)
-         break; /* should we keep running until all tasks finished? */
+      slock_lock(pool_lock);
 
-      slock_lock(running_lock);
-
-      /* Get first task to run */
-      task = tasks_running.front;
-      if (task == NULL)
+      for (;;)
       {
-         scond_wait(worker_cond, running_lock);
-         slock_unlock(running_lock);
-         continue;
-      }
+         if (!worker_continue)
+         {
+            slock_unlock(pool_lock);
+            return;
+         }
 
-      slock_unlock(running_lock);
+         if (!interactive_busy && interactive_queue.front)
+         {
+            task             = task_ready_get(&interactive_queue);
+            interactive      = true;
+            interactive_busy = true;
+            break;
+         }
 
-      task->handler(task);
+         if (ready_count)
+            break;
 
-      slock_lock(property_lock);
-      finished = task->finished;
-      slock_unlock(property_lock);
+         scond_wait(worker_cond, pool_lock);
+      }
 
-      slock_lock(running_lock);
-      task_queue_remove(&tasks_running, task);
-      slock_unlock(running_lock);
+      slock_unlock(pool_lock);
 
-      /* Update queue */
-      if (!finished)
-      {
-         /* Re-add task to running queue */
-         retro_task_threaded_push_running(task);
-      }
-      else
+      if (!task)
+         task = task_pool_take(worker);
+
+      /* Another worker got there first. */
+      if (!task)
+         continue;
+
+      if (task_pool_run(task))
       {
-         /* Add task to finished queue */
+         slock_lock(running_lock);
+         task_queue_remove(&tasks_running, task);
+         slock_unlock(running_lock);
+
          slock_lock(finished_lock);
          task_queue_put(&tasks_finished, task);
          slock_unlock(finished_lock);
+
+         task = NULL;
+      }
+
+      if (interactive)
+      {
+         if (task)
+            task->ready_time = cpu_features_get_time_usec();
+
+         /* Hand the interactive lane to whoever is next. */
+         slock_lock(pool_lock);
+         interactive_busy = false;
+         if (task)
+            task_ready_put(&interactive_queue, task);
+         if (interactive_queue.front)
+            scond_signal(worker_cond);
+         slock_unlock(pool_lock);
       }
+      else if (task)
+         task_pool_submit(task, worker);
    }
 }
 
 static void retro_task_threaded_init(void)
 {
+   unsigned i;
+   retro_task_t *task = NULL;
+
    running_lock  = slock_new();
    finished_lock = slock_new();
    property_lock = slock_new();
    queue_lock    = slock_new();
+   pool_lock     = slock_new();
    worker_cond   = scond_new();
 
+   worker_count  = cpu_features_get_core_amount();
+   if (worker_count < 2)
+      worker_count = 2;
+   if (worker_count > TASK_QUEUE_MAX_WORKERS)
+      worker_count = TASK_QUEUE_MAX_WORKERS;
+
+   worker_continue   = true;
+   interactive_busy  = false;
+   ready_count       = 0;
+   next_worker       = 0;
+
+   for (i = 0; i < worker_count; i++)
+      workers[i].lock = slock_new();
+
+   /* Tasks left on hold by a previous deinit. */
    slock_lock(running_lock);
-   worker_continue = true;
+   for (task = tasks_running.front; task; task = task->next)
+      task_pool_submit(task, NULL);
    slock_unlock(running_lock);
 
-   worker_thread = sthread_create(threaded_worker, NULL);
+   for (i = 0; i < worker_count; i++)
+      workers[i].thread = sthread_create(threaded_worker, &workers[i]);
 }
 
 static void retro_task_threaded_deinit(void)
 {
-   slock_lock(running_lock);
+   unsigned i;
+
+   slock_lock(pool_lock);
    worker_continue = false;
-   scond_signal(worker_cond);
-   slock_unlock(running_lock);
+   scond_broadcast(worker_cond);
+   slock_unlock(pool_lock);
 
-   sthread_join(worker_thread);
+   for (i = 0; i < worker_count; i++)
+   {
+      sthread_join(workers[i].thread);
+      slock_free(workers[i].lock);
+      memset(&workers[i], 0, sizeof(workers[i]));
+   }
 
    scond_free(worker_cond);
    slock_free(running_lock);
    slock_free(finished_lock);
    slock_free(property_lock);
    slock_free(queue_lock);
+   slock_free(pool_lock);
 
-   worker_thread = NULL;
+   interactive_queue.front = NULL;
+   interactive_queue.back  = NULL;
+   worker_count  = 0;
    worker_cond   = NULL;
    running_lock  = NULL;
    finished_lock = NULL;
    property_lock = NULL;
-   queue_lock = NULL;
+   queue_lock    = NULL;
+   pool_lock     = NULL;
 }
 
 static struct retro_task_impl impl_threaded = {
@@ -756,6 +961,28 @@ void* task_get_data(retro_task_t *task)
    return data;
 }
 
+int64_t task_get_wait_time(retro_task_t *task)
+{
+   int64_t wait_time = 0;
+
+   SLOCK_LOCK(property_lock);
+   wait_time = task->wait_time;
+   SLOCK_UNLOCK(property_lock);
+
+   return wait_time;
+}
+
+int64_t task_get_run_time(retro_task_t *task)
+{
+   int64_t run_time = 0;
+
+   SLOCK_LOCK(property_lock);
+   run_time = task->run_time;
+   SLOCK_UNLOCK(property_lock);
+
+   return run_time;
+}
+
 bool task_get_cancelled(retro_task_t *task)
 {
    bool cancelled = false;
@@ -0,0 +1,154 @@
+/* Measures the per-frame cost of the audio output pipeline.
+ *
+ * Each stage (s16 -> float, sinc resampler, float -> s16) is first
+ * timed on its own over a whole buffer, the way audio_driver_flush
+ * runs them by default, and then all three are run back to back on
+ * AUDIO_FUSED_TILE_FRAMES sized tiles, the way the fused pipeline
+ * does. DSP filters and the mixer are left out since they are
+ * optional and depend on user configuration. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#include <boolean.h>
+#include <memalign.h>
+#include <audio/audio_resampler.h>
+#include <audio/conversion/float_to_s16.h>
+#include <audio/conversion/s16_to_float.h>
+
+#define OUTPUT_RATE     48000
+#define TILE_FRAMES     256
+#define CHUNK_FRAMES    2048
+#define ITERATIONS      500
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void run_rate(unsigned input_rate)
+{
+   unsigned iter;
+   size_t max_out;
+   struct resampler_data src_data;
+   uint64_t start;
+   uint64_t t_conv_in  = 0;
+   uint64_t t_resample = 0;
+   uint64_t t_conv_out = 0;
+   uint64_t t_fused    = 0;
+   double ratio        = (double)OUTPUT_RATE / input_rate;
+   int16_t *in_s16     = NULL;
+   float *in_float     = NULL;
+   float *out_float    = NULL;
+   int16_t *out_s16    = NULL;
+   void *re            = sinc_resampler.init(NULL, ratio,
+         RESAMPLER_QUALITY_NORMAL, 0);
+
+   if (!re)
+      return;
+
+   max_out   = (size_t)(CHUNK_FRAMES * ratio) + 16;
+   in_s16    = (int16_t*)malloc(CHUNK_FRAMES * 2 * sizeof(int16_t));
+   in_float  = (float*)memalign_alloc(64, CHUNK_FRAMES * 2 * sizeof(float));
+   out_float = (float*)memalign_alloc(64, max_out * 2 * sizeof(float));
+   out_s16   = (int16_t*)malloc(max_out * 2 * sizeof(int16_t));
+
+   if (!in_s16 || !in_float || !out_float || !out_s16)
+      goto end;
+
+   for (iter = 0; iter < CHUNK_FRAMES * 2; iter++)
+      in_s16[iter] = (int16_t)(16000.0 * sin(iter * 0.01));
+
+   /* Separate passes over the whole chunk. */
+   for (iter = 0; iter < ITERATIONS; iter++)
+   {
+      start      = now_ns();
+      convert_s16_to_float(in_float, in_s16, CHUNK_FRAMES * 2, 1.0f);
+      t_conv_in += now_ns() - start;
+
+      src_data.data_in       = in_float;
+      src_data.input_frames  = CHUNK_FRAMES;
+      src_data.data_out      = out_float;
+      src_data.output_frames = 0;
+      src_data.ratio         = ratio;
+
+      start       = now_ns();
+      sinc_resampler.process(re, &src_data);
+      t_resample += now_ns() - start;
+
+      start       = now_ns();
+      convert_float_to_s16(out_s16, out_float,
+            src_data.output_frames * 2);
+      t_conv_out += now_ns() - start;
+   }
+
+   /* Fused passes, one tile at a time. */
+   for (iter = 0; iter < ITERATIONS; iter++)
+   {
+      size_t frames_in     = CHUNK_FRAMES;
+      size_t out_frames    = 0;
+      const int16_t *data  = in_s16;
+
+      start = now_ns();
+
+      while (frames_in)
+      {
+         size_t tile_frames = frames_in < TILE_FRAMES
+            ? frames_in : TILE_FRAMES;
+         float *tile_out    = out_float + out_frames * 2;
+
+         convert_s16_to_float(in_float, data, tile_frames * 2, 1.0f);
+
+         src_data.data_in       = in_float;
+         src_data.input_frames  = tile_frames;
+         src_data.data_out      = tile_out;
+         src_data.output_frames = 0;
+         src_data.ratio         = ratio;
+
+         sinc_resampler.process(re, &src_data);
+
+         convert_float_to_s16(out_s16 + out_frames * 2,
+               tile_out, src_data.output_frames * 2);
+
+         out_frames += src_data.output_frames;
+         data       += tile_frames * 2;
+         frames_in  -= tile_frames;
+      }
+
+      t_fused += now_ns() - start;
+   }
+
+   printf("%6u Hz -> %u Hz:  s16->float %6.2f  resample %7.2f  "
+         "float->s16 %6.2f  separate %7.2f  fused %7.2f  ns/frame\n",
+         input_rate, OUTPUT_RATE,
+         (double)t_conv_in  / ITERATIONS / CHUNK_FRAMES,
+         (double)t_resample / ITERATIONS / CHUNK_FRAMES,
+         (double)t_conv_out / ITERATIONS / CHUNK_FRAMES,
+         (double)(t_conv_in + t_resample + t_conv_out)
+            / ITERATIONS / CHUNK_FRAMES,
+         (double)t_fused    / ITERATIONS / CHUNK_FRAMES);
+
+end:
+   free(in_s16);
+   free(out_s16);
+   memalign_free(in_float);
+   memalign_free(out_float);
+   sinc_resampler.free(re);
+}
+
+int main(int argc, char *argv[])
+{
+   convert_s16_to_float_init_simd();
+   convert_float_to_s16_init_simd();
+
+   run_rate(44100);
+   run_rate(48000);
+   run_rate(96000);
+
+   return 0;
+}
@@ -0,0 +1,177 @@
+/* Reports encoding_crc32 throughput against the original
+ * byte-at-a-time table loop, and checks that the runtime-selected
+ * implementation and encoding_crc32_combine agree with it.
+ *
+ * The threaded run splits the buffer into one region per core,
+ * hashes each on its own thread and merges the results, the way
+ * the database scanner handles large disc images. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <boolean.h>
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+#include <rthreads/rthreads.h>
+
+#define BUFFER_SIZE  (64 * 1024 * 1024)
+#define PASSES       4
+#define MAX_THREADS  16
+
+typedef struct region
+{
+   const uint8_t *data;
+   size_t size;
+   uint32_t crc;
+} region_t;
+
+static uint32_t table[256];
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void reference_init(void)
+{
+   unsigned i, j;
+
+   for (i = 0; i < 256; i++)
+   {
+      uint32_t c = i;
+      for (j = 0; j < 8; j++)
+         c = (c & 1) ? (c >> 1) ^ 0xedb88320 : c >> 1;
+      table[i] = c;
+   }
+}
+
+static uint32_t reference_crc32(uint32_t crc, const uint8_t *buf, size_t len)
+{
+   crc = crc ^ 0xffffffff;
+
+   while (len--)
+      crc = table[(crc ^ (*buf++)) & 0xff] ^ (crc >> 8);
+
+   return crc ^ 0xffffffff;
+}
+
+static void hash_region(void *data)
+{
+   region_t *region = (region_t*)data;
+   region->crc      = encoding_crc32(0, region->data, region->size);
+}
+
+static bool verify(const uint8_t *data)
+{
+   unsigned i;
+
+   for (i = 0; i < 2000; i++)
+   {
+      size_t offset = (size_t)rand() % 64;
+      size_t len    = (size_t)rand() % 4096;
+      size_t split  = len ? (size_t)rand() % len : 0;
+      uint32_t ref  = reference_crc32(0, data + offset, len);
+      uint32_t crc  = encoding_crc32(0, data + offset, len);
+      uint32_t a    = encoding_crc32(0, data + offset, split);
+      uint32_t b    = encoding_crc32(0, data + offset + split, len - split);
+
+      if (crc != ref)
+      {
+         printf("mismatch: offset %u len %u: %08x != %08x\n",
+               (unsigned)offset, (unsigned)len, crc, ref);
+         return false;
+      }
+
+      if (encoding_crc32_combine(a, b, len - split) != ref)
+      {
+         printf("combine mismatch: len %u split %u\n",
+               (unsigned)len, (unsigned)split);
+         return false;
+      }
+   }
+
+   return true;
+}
+
+static double gbps(uint64_t ns)
+{
+   return (double)BUFFER_SIZE * PASSES / (double)ns;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i, pass;
+   uint64_t start, t_ref, t_new, t_threads;
+   region_t regions[MAX_THREADS];
+   sthread_t *threads[MAX_THREADS];
+   uint32_t crc_ref      = 0;
+   uint32_t crc_new      = 0;
+   uint32_t crc_threads  = 0;
+   unsigned num_threads  = cpu_features_get_core_amount();
+   uint8_t *data         = (uint8_t*)malloc(BUFFER_SIZE);
+
+   if (!data)
+      return 1;
+
+   if (num_threads < 1)
+      num_threads = 1;
+   if (num_threads > MAX_THREADS)
+      num_threads = MAX_THREADS;
+
+   reference_init();
+   srand(1);
+
+   for (i = 0; i < BUFFER_SIZE; i++)
+      data[i] = (uint8_t)rand();
+
+   if (!verify(data))
+      return 1;
+
+   start = now_ns();
+   for (pass = 0; pass < PASSES; pass++)
+      crc_ref = reference_crc32(0, data, BUFFER_SIZE);
+   t_ref = now_ns() - start;
+
+   start = now_ns();
+   for (pass = 0; pass < PASSES; pass++)
+      crc_new = encoding_crc32(0, data, BUFFER_SIZE);
+   t_new = now_ns() - start;
+
+   start = now_ns();
+   for (pass = 0; pass < PASSES; pass++)
+   {
+      size_t part = BUFFER_SIZE / num_threads;
+
+      for (i = 0; i < num_threads; i++)
+      {
+         regions[i].data = data + part * i;
+         regions[i].size = (i == num_threads - 1)
+            ? BUFFER_SIZE - part * i : part;
+         threads[i]      = sthread_create(hash_region, &regions[i]);
+      }
+
+      for (i = 0; i < num_threads; i++)
+         sthread_join(threads[i]);
+
+      crc_threads = regions[0].crc;
+      for (i = 1; i < num_threads; i++)
+         crc_threads = encoding_crc32_combine(crc_threads,
+               regions[i].crc, regions[i].size);
+   }
+   t_threads = now_ns() - start;
+
+   printf("table:        %08x  %6.2f GB/s\n", crc_ref, gbps(t_ref));
+   printf("encoding_crc32: %08x  %6.2f GB/s (%.1fx)\n",
+         crc_new, gbps(t_new), (double)t_ref / t_new);
+   printf("%2u threads:   %08x  %6.2f GB/s (%.1fx)\n",
+         num_threads, crc_threads, gbps(t_threads),
+         (double)t_ref / t_threads);
+
+   free(data);
+
+   return (crc_new == crc_ref && crc_threads == crc_ref) ? 0 : 1;
+}
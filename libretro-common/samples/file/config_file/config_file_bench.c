@@ -0,0 +1,245 @@
+/* Startup benchmark for config_file: loads a retroarch.cfg and every
+ * .info file in a directory, then reads back each key the way
+ * config_load_file and core_info_list_new do.
+ *
+ * The reference loader is the previous implementation in miniature:
+ * one filestream_getline and two strdups per line, and a linear
+ * list walk for every lookup. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+#include <boolean.h>
+#include <retro_dirent.h>
+#include <compat/strl.h>
+#include <file/config_file.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#define MAX_INFO_FILES 1024
+#define PASSES         20
+
+typedef struct ref_entry
+{
+   char *key;
+   char *value;
+   struct ref_entry *next;
+} ref_entry_t;
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static ref_entry_t *ref_load(const char *path)
+{
+   ref_entry_t *head = NULL;
+   ref_entry_t *tail = NULL;
+   RFILE       *file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return NULL;
+
+   while (!filestream_eof(file))
+   {
+      char *key, *value, *end;
+      ref_entry_t *entry = NULL;
+      char *line         = filestream_getline(file);
+
+      if (!line)
+         continue;
+
+      key = line;
+      while (isspace((int)*key))
+         key++;
+      end = key;
+      while (isgraph((int)*end))
+         end++;
+      value = end;
+      while (isspace((int)*value))
+         value++;
+
+      if (*key == '#' || end == key || *value != '=')
+      {
+         free(line);
+         continue;
+      }
+
+      *end = '\0';
+      value++;
+      while (isspace((int)*value))
+         value++;
+      if (*value == '"')
+         value++;
+      end = value;
+      while (*end && *end != '"' && *end != '\r' && *end != '\n')
+         end++;
+      *end = '\0';
+
+      /* Empty values are dropped, as config_file does. */
+      if (!*value)
+      {
+         free(line);
+         continue;
+      }
+
+      entry        = (ref_entry_t*)malloc(sizeof(*entry));
+      entry->key   = strdup(key);
+      entry->value = strdup(value);
+      entry->next  = NULL;
+
+      if (tail)
+         tail->next = entry;
+      else
+         head       = entry;
+      tail          = entry;
+
+      free(line);
+   }
+
+   filestream_close(file);
+   return head;
+}
+
+static const char *ref_get(const ref_entry_t *list, const char *key)
+{
+   for (; list; list = list->next)
+      if (string_is_equal(list->key, key))
+         return list->value;
+   return NULL;
+}
+
+static void ref_free(ref_entry_t *list)
+{
+   while (list)
+   {
+      ref_entry_t *next = list->next;
+      free(list->key);
+      free(list->value);
+      free(list);
+      list = next;
+   }
+}
+
+/* Loads @path and looks up each of its keys.
+ * Returns the number of successful lookups. */
+static unsigned bench_ref(const char *path)
+{
+   unsigned found    = 0;
+   ref_entry_t *list = ref_load(path);
+   ref_entry_t *e    = NULL;
+
+   for (e = list; e; e = e->next)
+      if (ref_get(list, e->key))
+         found++;
+
+   ref_free(list);
+   return found;
+}
+
+static unsigned bench_conf(const char *path)
+{
+   struct config_file_entry entry;
+   unsigned found      = 0;
+   config_file_t *conf = config_file_new(path);
+
+   if (!conf)
+      return 0;
+
+   if (config_get_entry_list_head(conf, &entry))
+   {
+      do
+      {
+         char buf[1024];
+         if (entry.key && config_get_array(conf, entry.key, buf, sizeof(buf)))
+            found++;
+      } while (config_get_entry_list_next(&entry));
+   }
+
+   config_file_free(conf);
+   return found;
+}
+
+static void run(const char *label, char **paths, unsigned count)
+{
+   unsigned i, pass;
+   uint64_t ref_ns   = 0;
+   uint64_t conf_ns  = 0;
+   unsigned ref_hits = 0;
+   unsigned hits     = 0;
+
+   for (pass = 0; pass < PASSES; pass++)
+   {
+      uint64_t t0 = now_ns();
+      for (i = 0; i < count; i++)
+         ref_hits += bench_ref(paths[i]);
+      ref_ns += now_ns() - t0;
+
+      t0 = now_ns();
+      for (i = 0; i < count; i++)
+         hits += bench_conf(paths[i]);
+      conf_ns += now_ns() - t0;
+   }
+
+   printf("%-12s %4u files, %6u lookups: reference %8.3f ms, config_file %8.3f ms (%.2fx)\n",
+         label, count, hits / PASSES,
+         ref_ns / 1e6 / PASSES, conf_ns / 1e6 / PASSES,
+         conf_ns ? (double)ref_ns / conf_ns : 0.0);
+
+   if (ref_hits != hits)
+      printf("  note: reference parser found %u keys, config_file %u\n",
+            ref_hits / PASSES, hits / PASSES);
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i;
+   char *info_paths[MAX_INFO_FILES];
+   unsigned info_count = 0;
+   struct RDIR *dir    = NULL;
+
+   if (argc < 3)
+   {
+      fprintf(stderr, "Usage: %s <retroarch.cfg> <info directory>\n", argv[0]);
+      return 1;
+   }
+
+   run("retroarch.cfg", &argv[1], 1);
+
+   if (!(dir = retro_opendir(argv[2])))
+   {
+      fprintf(stderr, "Could not open %s\n", argv[2]);
+      return 1;
+   }
+
+   while (retro_readdir(dir) && info_count < MAX_INFO_FILES)
+   {
+      char path[4096];
+      const char *name = retro_dirent_get_name(dir);
+      size_t len       = strlen(name);
+
+      if (len < 5 || !string_is_equal(name + len - 5, ".info"))
+         continue;
+
+      strlcpy(path, argv[2], sizeof(path));
+      strlcat(path, "/", sizeof(path));
+      strlcat(path, name, sizeof(path));
+      info_paths[info_count++] = strdup(path);
+   }
+
+   retro_closedir(dir);
+
+   run("core info", info_paths, info_count);
+
+   for (i = 0; i < info_count; i++)
+      free(info_paths[i]);
+
+   return 0;
+}
@@ -0,0 +1,129 @@
+/* Builds, sorts and tears down a 100k-entry file_list the way
+ * the menu does for large playlists and directories, once with
+ * appends and once with prepends, and checks that both produce
+ * the same sorted order. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <boolean.h>
+#include <lists/file_list.h>
+
+#define ENTRIES 100000
+#define PASSES  4
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void make_entry(char *path, char *alt, size_t size, unsigned i)
+{
+   unsigned key = (i * 2654435761u) % ENTRIES;
+
+   snprintf(path, size, "/roms/collection/Game %06u (Region) [!].zip", key);
+   snprintf(alt,  size, "Game %06u (Region) [!]", key);
+}
+
+static file_list_t *build(bool prepend)
+{
+   unsigned i;
+   char path[128];
+   char alt[128];
+   file_list_t *list = (file_list_t*)calloc(1, sizeof(*list));
+
+   for (i = 0; i < ENTRIES; i++)
+   {
+      make_entry(path, alt, sizeof(path), i);
+
+      if (prepend)
+      {
+         file_list_prepend(list, path, "", 0, 0, i);
+         file_list_set_alt_at_offset(list, 0, alt);
+      }
+      else
+      {
+         file_list_append(list, path, "", 0, 0, i);
+         file_list_set_alt_at_offset(list, list->size - 1, alt);
+      }
+   }
+
+   return list;
+}
+
+static bool same_order(const file_list_t *a, const file_list_t *b)
+{
+   size_t i;
+
+   if (a->size != b->size)
+      return false;
+
+   for (i = 0; i < a->size; i++)
+      if (strcmp(a->list[i].path, b->list[i].path))
+         return false;
+
+   return true;
+}
+
+static void run(const char *name, bool prepend, file_list_t **keep)
+{
+   unsigned pass;
+   uint64_t build_ns = 0;
+   uint64_t sort_ns  = 0;
+   uint64_t free_ns  = 0;
+
+   for (pass = 0; pass < PASSES; pass++)
+   {
+      file_list_t *list = NULL;
+      uint64_t t0       = now_ns();
+      uint64_t t1, t2;
+
+      list     = build(prepend);
+      t1       = now_ns();
+      file_list_sort_on_alt(list);
+      t2       = now_ns();
+
+      build_ns += t1 - t0;
+      sort_ns  += t2 - t1;
+
+      if (pass == PASSES - 1)
+      {
+         *keep = list;
+         break;
+      }
+
+      file_list_clear(list);
+      file_list_free(list);
+      free_ns  += now_ns() - t2;
+   }
+
+   printf("%-8s build %7.2f ms  sort %7.2f ms  clear+free %6.2f ms\n",
+         name,
+         build_ns / (PASSES * 1e6),
+         sort_ns  / (PASSES * 1e6),
+         free_ns  / ((PASSES - 1) * 1e6));
+}
+
+int main(void)
+{
+   file_list_t *appended  = NULL;
+   file_list_t *prepended = NULL;
+   bool ok                = false;
+
+   printf("%u entries, %u passes\n", ENTRIES, PASSES);
+
+   run("append",  false, &appended);
+   run("prepend", true,  &prepended);
+
+   ok = same_order(appended, prepended);
+   printf("sorted order %s\n", ok ? "matches" : "DIFFERS");
+
+   file_list_free(appended);
+   file_list_free(prepended);
+
+   return ok ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+/* Compares throughput and latency jitter of spsc_queue against a
+ * fifo_buffer guarded by a mutex + condition variable, the way the
+ * threaded audio drivers used to do it.
+ *
+ * The producer pushes audio-sized chunks stamped with the time they
+ * were written; the consumer reads them back and records how long
+ * each chunk sat in the queue. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <boolean.h>
+#include <queues/fifo_queue.h>
+#include <queues/spsc_queue.h>
+#include <rthreads/rthreads.h>
+
+#define CHUNK_SIZE  2048 /* 512 stereo s16 frames */
+#define QUEUE_SIZE  (CHUNK_SIZE * 8)
+#define NUM_CHUNKS  200000
+
+typedef struct bench
+{
+   spsc_queue_t *spsc;
+
+   fifo_buffer_t *fifo;
+   slock_t *lock;
+   scond_t *cond;
+
+   uint64_t *latency;
+} bench_t;
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void spsc_producer(void *data)
+{
+   unsigned i;
+   uint8_t chunk[CHUNK_SIZE] = {0};
+   bench_t *bench            = (bench_t*)data;
+
+   for (i = 0; i < NUM_CHUNKS; i++)
+   {
+      uint64_t stamp;
+
+      while (!spsc_queue_wait_write(bench->spsc, CHUNK_SIZE, -1));
+
+      stamp = now_ns();
+      memcpy(chunk, &stamp, sizeof(stamp));
+      spsc_queue_write(bench->spsc, chunk, CHUNK_SIZE);
+   }
+}
+
+static void spsc_consumer(void *data)
+{
+   unsigned i;
+   uint8_t chunk[CHUNK_SIZE];
+   bench_t *bench = (bench_t*)data;
+
+   for (i = 0; i < NUM_CHUNKS; i++)
+   {
+      uint64_t stamp;
+
+      while (!spsc_queue_wait_read(bench->spsc, CHUNK_SIZE, -1));
+
+      spsc_queue_read(bench->spsc, chunk, CHUNK_SIZE);
+      memcpy(&stamp, chunk, sizeof(stamp));
+      bench->latency[i] = now_ns() - stamp;
+   }
+}
+
+static void fifo_producer(void *data)
+{
+   unsigned i;
+   uint8_t chunk[CHUNK_SIZE] = {0};
+   bench_t *bench            = (bench_t*)data;
+
+   for (i = 0; i < NUM_CHUNKS; i++)
+   {
+      uint64_t stamp;
+
+      slock_lock(bench->lock);
+      while (fifo_write_avail(bench->fifo) < CHUNK_SIZE)
+         scond_wait(bench->cond, bench->lock);
+
+      stamp = now_ns();
+      memcpy(chunk, &stamp, sizeof(stamp));
+      fifo_write(bench->fifo, chunk, CHUNK_SIZE);
+      scond_signal(bench->cond);
+      slock_unlock(bench->lock);
+   }
+}
+
+static void fifo_consumer(void *data)
+{
+   unsigned i;
+   uint8_t chunk[CHUNK_SIZE];
+   bench_t *bench = (bench_t*)data;
+
+   for (i = 0; i < NUM_CHUNKS; i++)
+   {
+      uint64_t stamp;
+
+      slock_lock(bench->lock);
+      while (fifo_read_avail(bench->fifo) < CHUNK_SIZE)
+         scond_wait(bench->cond, bench->lock);
+
+      fifo_read(bench->fifo, chunk, CHUNK_SIZE);
+      scond_signal(bench->cond);
+      slock_unlock(bench->lock);
+
+      memcpy(&stamp, chunk, sizeof(stamp));
+      bench->latency[i] = now_ns() - stamp;
+   }
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+   uint64_t x = *(const uint64_t*)a;
+   uint64_t y = *(const uint64_t*)b;
+   return x < y ? -1 : x > y;
+}
+
+static void run(const char *name, bench_t *bench,
+      void (*producer)(void*), void (*consumer)(void*))
+{
+   uint64_t start, elapsed;
+   sthread_t *threads[2];
+
+   start      = now_ns();
+   threads[0] = sthread_create(consumer, bench);
+   threads[1] = sthread_create(producer, bench);
+   sthread_join(threads[1]);
+   sthread_join(threads[0]);
+   elapsed    = now_ns() - start;
+
+   qsort(bench->latency, NUM_CHUNKS, sizeof(uint64_t), compare_u64);
+
+   printf("%-12s %8.1f MB/s   latency p50 %7.2f us  p99 %8.2f us  max %9.2f us\n",
+         name,
+         (double)NUM_CHUNKS * CHUNK_SIZE / (elapsed / 1e9) / (1024 * 1024),
+         bench->latency[NUM_CHUNKS / 2] / 1e3,
+         bench->latency[NUM_CHUNKS - NUM_CHUNKS / 100] / 1e3,
+         bench->latency[NUM_CHUNKS - 1] / 1e3);
+}
+
+int main(void)
+{
+   bench_t bench;
+
+   memset(&bench, 0, sizeof(bench));
+   bench.latency = (uint64_t*)malloc(NUM_CHUNKS * sizeof(uint64_t));
+   bench.spsc    = spsc_queue_new(QUEUE_SIZE);
+   bench.fifo    = fifo_new(QUEUE_SIZE);
+   bench.lock    = slock_new();
+   bench.cond    = scond_new();
+
+   if (!bench.latency || !bench.spsc || !bench.fifo
+         || !bench.lock || !bench.cond)
+   {
+      puts("[ERROR]: allocation failed");
+      return 1;
+   }
+
+   printf("%u chunks of %u bytes, %u byte queue\n",
+         NUM_CHUNKS, CHUNK_SIZE, QUEUE_SIZE);
+
+   run("fifo+slock", &bench, fifo_producer, fifo_consumer);
+   run("spsc_queue", &bench, spsc_producer, spsc_consumer);
+
+   spsc_queue_free(bench.spsc);
+   fifo_free(bench.fifo);
+   slock_free(bench.lock);
+   scond_free(bench.cond);
+   free(bench.latency);
+   return 0;
+}
@@ -0,0 +1,131 @@
+/* Read benchmark for chd_stream: reads the primary track of a CHD
+ * sequentially, then bounces between two hunks, then reads sectors
+ * scattered over a few neighbouring hunks, printing throughput and
+ * the hunk cache statistics of each pass.
+ *
+ * Usage: chd_stream_bench <file.chd> [cache hunks] [read-ahead hunks] */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <streams/chd_stream.h>
+
+#define SECTOR_SIZE      2352
+#define SEQUENTIAL_CHUNK (SECTOR_SIZE * 16)
+#define ALTERNATE_READS  4000
+#define SCATTER_READS    20000
+#define SCATTER_HUNKS    8
+#define FRAMES_PER_HUNK  8
+
+static double now(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void print_pass(const char *name, chdstream_t *stream,
+      double secs, uint64_t bytes)
+{
+   chdstream_stats_t stats;
+   uint64_t lookups;
+
+   chdstream_get_stats(stream, &stats);
+   lookups = stats.hits + stats.misses;
+
+   printf("%-10s %8.1f MB/s  %7.1f ms  hits %llu/%llu (%.1f%%)"
+         "  read-ahead %llu used %llu"
+         "  decode %.1f ms  waited %.1f ms\n",
+         name, bytes / secs / 1e6, secs * 1000.0,
+         (unsigned long long)stats.hits, (unsigned long long)lookups,
+         lookups ? 100.0 * stats.hits / lookups : 0.0,
+         (unsigned long long)stats.read_ahead,
+         (unsigned long long)stats.read_ahead_hits,
+         stats.decode_time / 1000.0, stats.wait_time / 1000.0);
+}
+
+static chdstream_t *open_track(const char *path)
+{
+   chdstream_t *stream = chdstream_open(path, CHDSTREAM_TRACK_PRIMARY);
+
+   if (!stream)
+   {
+      fprintf(stderr, "Couldn't open %s.\n", path);
+      exit(1);
+   }
+
+   return stream;
+}
+
+int main(int argc, char **argv)
+{
+   int i;
+   double start;
+   ssize_t size;
+   ssize_t sectors;
+   uint64_t bytes;
+   chdstream_t *stream = NULL;
+   static char buf[SEQUENTIAL_CHUNK];
+
+   if (argc < 2)
+   {
+      fprintf(stderr,
+            "Usage: %s <file.chd> [cache hunks] [read-ahead hunks]\n",
+            argv[0]);
+      return 1;
+   }
+
+   if (argc > 2)
+      chdstream_set_cache(atoi(argv[2]),
+            argc > 3 ? atoi(argv[3]) : CHDSTREAM_READ_AHEAD_DEFAULT);
+
+   /* Sequential, the way the database scanner CRCs a track */
+   stream = open_track(argv[1]);
+   size   = chdstream_get_size(stream);
+   bytes  = 0;
+   start  = now();
+   for (;;)
+   {
+      ssize_t ret = chdstream_read(stream, buf, sizeof(buf));
+      if (ret <= 0)
+         break;
+      bytes += ret;
+   }
+   print_pass("sequential", stream, now() - start, bytes);
+   chdstream_close(stream);
+
+   sectors = size / SECTOR_SIZE;
+   if (sectors < FRAMES_PER_HUNK * SCATTER_HUNKS * 2)
+      return 0;
+
+   /* Two hunks, one at each end of the track */
+   stream = open_track(argv[1]);
+   bytes  = 0;
+   start  = now();
+   for (i = 0; i < ALTERNATE_READS; i++)
+   {
+      ssize_t sector = (i & 1) ? sectors - 1 : 0;
+      chdstream_seek(stream, sector * SECTOR_SIZE, SEEK_SET);
+      bytes += chdstream_read(stream, buf, SECTOR_SIZE);
+   }
+   print_pass("alternate", stream, now() - start, bytes);
+   chdstream_close(stream);
+
+   /* Sectors scattered over a few hunks in the middle */
+   stream = open_track(argv[1]);
+   bytes  = 0;
+   srand(1);
+   start  = now();
+   for (i = 0; i < SCATTER_READS; i++)
+   {
+      ssize_t sector = sectors / 2
+         + rand() % (FRAMES_PER_HUNK * SCATTER_HUNKS);
+      chdstream_seek(stream, sector * SECTOR_SIZE, SEEK_SET);
+      bytes += chdstream_read(stream, buf, SECTOR_SIZE);
+   }
+   print_pass("scattered", stream, now() - start, bytes);
+   chdstream_close(stream);
+
+   return 0;
+}
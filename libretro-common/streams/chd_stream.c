@@ -28,12 +28,54 @@
 
 #include <streams/chd_stream.h>
 #include <retro_endianness.h>
+#include <retro_inline.h>
+#include <features/features_cpu.h>
 #include <libchdr/chd.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #define SECTOR_SIZE 2352
 #define SUBCODE_SIZE 96
 #define TRACK_PAD 4
 
+/* Hunks read in order before read-ahead kicks in */
+#define CHDSTREAM_SEQUENTIAL_HUNKS 2
+#define CHDSTREAM_MAX_WORKERS 4
+
+enum chdstream_hunk_state
+{
+   CHDSTREAM_HUNK_EMPTY = 0,
+   /* Waiting for a worker */
+   CHDSTREAM_HUNK_QUEUED,
+   /* Being decompressed */
+   CHDSTREAM_HUNK_LOADING,
+   CHDSTREAM_HUNK_READY
+};
+
+typedef struct chdstream_hunk
+{
+   uint8_t *data;
+   uint32_t hunknum;
+   /* Access clock value of the last use */
+   uint32_t last_used;
+   enum chdstream_hunk_state state;
+   /* Decompressed ahead and not used yet */
+   bool read_ahead;
+} chdstream_hunk_t;
+
+#ifdef HAVE_THREADS
+typedef struct chdstream_worker
+{
+   chdstream_t *stream;
+   sthread_t *thread;
+} chdstream_worker_t;
+#endif
+
+static unsigned chdstream_cache_hunks = CHDSTREAM_CACHE_HUNKS_DEFAULT;
+static unsigned chdstream_read_ahead_hunks = CHDSTREAM_READ_AHEAD_DEFAULT;
+
 struct chdstream
 {
    chd_file *chd;
@@ -53,10 +95,37 @@ struct chdstream
    size_t track_end;
    /* Byte offset of read cursor */
    size_t offset;
-   /* Loaded hunk number */
-   int32_t hunknum;
-   /* Loaded hunk */
-   uint8_t *hunkmem;
+   /* Bytes per hunk */
+   uint32_t hunkbytes;
+   /* Last hunk holding track data */
+   uint32_t last_hunk;
+   /* Hunk the reader is copying from */
+   chdstream_hunk_t *hunk;
+   /* Decompressed hunks, the least recently used one is replaced */
+   chdstream_hunk_t *cache;
+   uint8_t *cache_data;
+   unsigned cache_size;
+   /* Access clock for the LRU */
+   uint32_t clock;
+   /* Hunks read in order so far */
+   unsigned sequential;
+   /* Hunks to decompress ahead of a sequential reader */
+   unsigned read_ahead;
+   /* Workers open their own chd_file, libchdr handles aren't thread safe */
+   char *path;
+   chdstream_stats_t stats;
+#ifdef HAVE_THREADS
+   /* Protects the cache and stats once workers may exist */
+   slock_t *lock;
+   /* Wakes workers */
+   scond_t *cond;
+   /* Signalled when a worker finishes a hunk */
+   scond_t *done_cond;
+   chdstream_worker_t workers[CHDSTREAM_MAX_WORKERS];
+   unsigned workers_num;
+   bool workers_started;
+   bool quit;
+#endif
 };
 
 typedef struct metadata {
@@ -202,6 +271,7 @@ chdstream_find_track(chd_file *fd, int32_t track, metadata_t *meta)
 chdstream_t *chdstream_open(const char *path, int32_t track)
 {
    metadata_t meta;
+   unsigned i;
    uint32_t pregap      = 0;
    const chd_header *hd = NULL;
    chdstream_t *stream  = NULL;
@@ -218,11 +288,34 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
    if (!stream)
       goto error;
 
-   hd              = chd_get_header(chd);
-   stream->hunkmem = (uint8_t*)malloc(hd->hunkbytes);
-   if (!stream->hunkmem)
+   hd                 = chd_get_header(chd);
+   stream->hunkbytes  = hd->hunkbytes;
+   stream->cache_size = chdstream_cache_hunks;
+   stream->read_ahead = chdstream_read_ahead_hunks;
+   stream->cache      = (chdstream_hunk_t*)
+      calloc(stream->cache_size, sizeof(*stream->cache));
+   stream->cache_data = (uint8_t*)
+      malloc((size_t)stream->cache_size * hd->hunkbytes);
+   if (!stream->cache || !stream->cache_data)
       goto error;
 
+   for (i = 0; i < stream->cache_size; i++)
+      stream->cache[i].data = stream->cache_data + (size_t)i * hd->hunkbytes;
+
+#ifdef HAVE_THREADS
+   if (stream->read_ahead)
+   {
+      stream->path      = strdup(path);
+      stream->lock      = slock_new();
+      stream->cond      = scond_new();
+      stream->done_cond = scond_new();
+      if (!stream->path || !stream->lock || !stream->cond || !stream->done_cond)
+         goto error;
+   }
+#else
+   stream->read_ahead = 0;
+#endif
+
    if (!strcmp(meta.type, "MODE1_RAW"))
    {
       stream->frame_size = SECTOR_SIZE;
@@ -259,7 +352,10 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
    stream->track_end       = stream->track_start +
       (size_t) meta.frames * stream->frame_size;
    stream->offset          = 0;
-   stream->hunknum         = -1;
+   stream->last_hunk       = (stream->track_frame + meta.frames - 1)
+      / stream->frames_per_hunk;
+   if (stream->last_hunk >= hd->totalhunks)
+      stream->last_hunk = hd->totalhunks - 1;
 
    return stream;
 
@@ -277,41 +373,387 @@ void chdstream_close(chdstream_t *stream)
 {
    if (stream)
    {
-      if (stream->hunkmem)
-         free(stream->hunkmem);
+#ifdef HAVE_THREADS
+      unsigned i;
+
+      if (stream->lock)
+      {
+         slock_lock(stream->lock);
+         stream->quit = true;
+         scond_broadcast(stream->cond);
+         slock_unlock(stream->lock);
+      }
+
+      for (i = 0; i < stream->workers_num; i++)
+         sthread_join(stream->workers[i].thread);
+
+      if (stream->done_cond)
+         scond_free(stream->done_cond);
+      if (stream->cond)
+         scond_free(stream->cond);
+      if (stream->lock)
+         slock_free(stream->lock);
+#endif
+      if (stream->cache_data)
+         free(stream->cache_data);
+      if (stream->cache)
+         free(stream->cache);
+      if (stream->path)
+         free(stream->path);
       if (stream->chd)
          chd_close(stream->chd);
       free(stream);
    }
 }
 
+void chdstream_set_cache(unsigned hunks, unsigned read_ahead)
+{
+   if (hunks < 2)
+      hunks = 2;
+
+   /* Leave room for the hunk being read and one to replace */
+   if (read_ahead > hunks - 2)
+      read_ahead = hunks - 2;
+
+   chdstream_cache_hunks      = hunks;
+   chdstream_read_ahead_hunks = read_ahead;
+}
+
+void chdstream_get_stats(chdstream_t *stream, chdstream_stats_t *stats)
+{
+#ifdef HAVE_THREADS
+   if (stream->lock)
+      slock_lock(stream->lock);
+#endif
+
+   *stats = stream->stats;
+
+#ifdef HAVE_THREADS
+   if (stream->lock)
+      slock_unlock(stream->lock);
+#endif
+}
+
+static INLINE void chdstream_lock(chdstream_t *stream)
+{
+#ifdef HAVE_THREADS
+   if (stream->lock)
+      slock_lock(stream->lock);
+#endif
+}
+
+static INLINE void chdstream_unlock(chdstream_t *stream)
+{
+#ifdef HAVE_THREADS
+   if (stream->lock)
+      slock_unlock(stream->lock);
+#endif
+}
+
 static bool
-chdstream_load_hunk(chdstream_t *stream, uint32_t hunknum)
+chdstream_decode_hunk(chdstream_t *stream, chd_file *chd,
+      uint8_t *data, uint32_t hunknum, retro_time_t *time)
 {
-   chd_error err;
-   uint16_t *array;
    uint32_t i;
-   uint32_t count;
-
-   if (hunknum == stream->hunknum)
-      return true;
+   retro_time_t start = cpu_features_get_time_usec();
 
-   err = chd_read(stream->chd, hunknum, stream->hunkmem);
-   if (err != CHDERR_NONE)
+   if (chd_read(chd, hunknum, data) != CHDERR_NONE)
       return false;
 
    if (stream->swab)
    {
-      count = chd_get_header(stream->chd)->hunkbytes / 2;
-      array = (uint16_t*) stream->hunkmem;
+      uint32_t count  = stream->hunkbytes / 2;
+      uint16_t *array = (uint16_t*)data;
       for (i = 0; i < count; ++i)
          array[i] = SWAP16(array[i]);
    }
 
-   stream->hunknum = hunknum;
+   *time = cpu_features_get_time_usec() - start;
    return true;
 }
 
+static chdstream_hunk_t *
+chdstream_find_hunk(chdstream_t *stream, uint32_t hunknum)
+{
+   unsigned i;
+
+   for (i = 0; i < stream->cache_size; i++)
+   {
+      chdstream_hunk_t *hunk = &stream->cache[i];
+      if (hunk->state != CHDSTREAM_HUNK_EMPTY && hunk->hunknum == hunknum)
+         return hunk;
+   }
+
+   return NULL;
+}
+
+/* Picks the hunk to replace: an empty one, else the least
+ * recently used one. Hunks being decompressed and the one the
+ * reader copies from are never picked, read-ahead the reader
+ * hasn't got to yet only if @cancel is set. */
+static chdstream_hunk_t *
+chdstream_evict_hunk(chdstream_t *stream, bool cancel)
+{
+   unsigned i;
+   chdstream_hunk_t *best = NULL;
+
+   for (i = 0; i < stream->cache_size; i++)
+   {
+      chdstream_hunk_t *hunk = &stream->cache[i];
+
+      if (hunk == stream->hunk || hunk->state == CHDSTREAM_HUNK_LOADING)
+         continue;
+      if (hunk->read_ahead && !cancel)
+         continue;
+      if (hunk->state == CHDSTREAM_HUNK_EMPTY)
+         return hunk;
+
+      if (!best)
+         best = hunk;
+      else if (best->read_ahead != hunk->read_ahead)
+      {
+         /* Rather drop a hunk already read than pending read-ahead */
+         if (best->read_ahead)
+            best = hunk;
+      }
+      else if ((int32_t)(hunk->last_used - best->last_used) < 0)
+         best = hunk;
+   }
+
+   if (best)
+   {
+      best->state      = CHDSTREAM_HUNK_EMPTY;
+      best->read_ahead = false;
+   }
+
+   return best;
+}
+
+#ifdef HAVE_THREADS
+static void chdstream_worker_thread(void *data)
+{
+   chdstream_worker_t *worker = (chdstream_worker_t*)data;
+   chdstream_t *stream        = worker->stream;
+   chd_file *chd              = NULL;
+
+   if (chd_open(stream->path, CHD_OPEN_READ, NULL, &chd) != CHDERR_NONE)
+      return;
+
+   slock_lock(stream->lock);
+
+   while (!stream->quit)
+   {
+      unsigned i;
+      bool ok;
+      uint32_t hunknum;
+      retro_time_t time      = 0;
+      chdstream_hunk_t *hunk = NULL;
+
+      /* Nearest queued hunk first */
+      for (i = 0; i < stream->cache_size; i++)
+      {
+         chdstream_hunk_t *queued = &stream->cache[i];
+         if (queued->state == CHDSTREAM_HUNK_QUEUED &&
+               (!hunk || queued->hunknum < hunk->hunknum))
+            hunk = queued;
+      }
+
+      if (!hunk)
+      {
+         scond_wait(stream->cond, stream->lock);
+         continue;
+      }
+
+      hunk->state = CHDSTREAM_HUNK_LOADING;
+      hunknum     = hunk->hunknum;
+      slock_unlock(stream->lock);
+
+      ok = chdstream_decode_hunk(stream, chd, hunk->data, hunknum, &time);
+
+      slock_lock(stream->lock);
+      if (ok)
+      {
+         hunk->state = CHDSTREAM_HUNK_READY;
+         stream->stats.read_ahead++;
+         stream->stats.decode_time += time;
+      }
+      else
+      {
+         /* Let the reader run into the error itself */
+         hunk->state      = CHDSTREAM_HUNK_EMPTY;
+         hunk->read_ahead = false;
+      }
+      scond_broadcast(stream->done_cond);
+   }
+
+   slock_unlock(stream->lock);
+
+   chd_close(chd);
+}
+
+static void chdstream_start_workers(chdstream_t *stream)
+{
+   unsigned i;
+   unsigned num = cpu_features_get_core_amount();
+
+   stream->workers_started = true;
+
+   /* Leave a core to the reader, on a single core
+    * decompressing ahead only competes with it */
+   num = num > 1 ? num - 1 : 0;
+   if (num > CHDSTREAM_MAX_WORKERS)
+      num = CHDSTREAM_MAX_WORKERS;
+   if (num > stream->read_ahead)
+      num = stream->read_ahead;
+
+   for (i = 0; i < num; i++)
+   {
+      chdstream_worker_t *worker = &stream->workers[stream->workers_num];
+
+      worker->stream = stream;
+      worker->thread = sthread_create(chdstream_worker_thread, worker);
+      if (worker->thread)
+         stream->workers_num++;
+   }
+}
+
+/* Queues the hunks following @hunknum for the workers.
+ * Called with the lock held. */
+static void chdstream_queue_read_ahead(chdstream_t *stream, uint32_t hunknum)
+{
+   unsigned i;
+   bool queued = false;
+
+   if (!stream->read_ahead || stream->sequential < CHDSTREAM_SEQUENTIAL_HUNKS)
+      return;
+
+   if (!stream->workers_started)
+      chdstream_start_workers(stream);
+
+   if (!stream->workers_num)
+      return;
+
+   for (i = 1; i <= stream->read_ahead; i++)
+   {
+      chdstream_hunk_t *hunk = NULL;
+      uint32_t next          = hunknum + i;
+
+      if (next > stream->last_hunk)
+         break;
+
+      if (chdstream_find_hunk(stream, next))
+         continue;
+
+      hunk = chdstream_evict_hunk(stream, false);
+      if (!hunk)
+         break;
+
+      hunk->hunknum    = next;
+      hunk->state      = CHDSTREAM_HUNK_QUEUED;
+      hunk->read_ahead = true;
+      hunk->last_used  = stream->clock;
+      queued           = true;
+   }
+
+   if (queued)
+      scond_broadcast(stream->cond);
+}
+#endif
+
+static chdstream_hunk_t *
+chdstream_load_hunk(chdstream_t *stream, uint32_t hunknum)
+{
+   chdstream_hunk_t *hunk = stream->hunk;
+
+   /* Only the reader replaces hunks, so the current one is safe
+    * to look at without the lock */
+   if (hunk && hunk->hunknum == hunknum)
+      return hunk;
+
+   chdstream_lock(stream);
+
+   if (hunk && hunknum == hunk->hunknum + 1)
+      stream->sequential++;
+   else
+      stream->sequential = 0;
+
+   hunk = chdstream_find_hunk(stream, hunknum);
+
+#ifdef HAVE_THREADS
+   if (hunk && hunk->state == CHDSTREAM_HUNK_LOADING)
+   {
+      retro_time_t start = cpu_features_get_time_usec();
+
+      while (hunk->state == CHDSTREAM_HUNK_LOADING)
+         scond_wait(stream->done_cond, stream->lock);
+
+      stream->stats.wait_time += cpu_features_get_time_usec() - start;
+
+      /* Failed, try again below */
+      if (hunk->state == CHDSTREAM_HUNK_EMPTY)
+         hunk = NULL;
+   }
+#endif
+
+   if (hunk && hunk->state == CHDSTREAM_HUNK_READY)
+   {
+      stream->stats.hits++;
+      if (hunk->read_ahead)
+      {
+         stream->stats.read_ahead_hits++;
+         hunk->read_ahead = false;
+      }
+   }
+   else
+   {
+      bool ok;
+      retro_time_t time = 0;
+
+      /* Not cached, or still queued: decompress it right here */
+      if (!hunk)
+      {
+#ifdef HAVE_THREADS
+         while (!(hunk = chdstream_evict_hunk(stream, true)))
+            scond_wait(stream->done_cond, stream->lock);
+#else
+         hunk = chdstream_evict_hunk(stream, true);
+#endif
+         hunk->hunknum = hunknum;
+      }
+
+      hunk->state      = CHDSTREAM_HUNK_LOADING;
+      hunk->read_ahead = false;
+      chdstream_unlock(stream);
+
+      ok = chdstream_decode_hunk(stream, stream->chd,
+            hunk->data, hunknum, &time);
+
+      chdstream_lock(stream);
+      stream->stats.misses++;
+      stream->stats.decode_time += time;
+
+      if (!ok)
+      {
+         hunk->state = CHDSTREAM_HUNK_EMPTY;
+         chdstream_unlock(stream);
+         return NULL;
+      }
+
+      hunk->state = CHDSTREAM_HUNK_READY;
+   }
+
+   hunk->last_used = ++stream->clock;
+   stream->hunk    = hunk;
+
+#ifdef HAVE_THREADS
+   chdstream_queue_read_ahead(stream, hunknum);
+#endif
+
+   chdstream_unlock(stream);
+
+   return hunk;
+}
+
 ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
 {
    size_t end;
@@ -320,6 +762,7 @@ ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
    uint32_t chd_frame;
    uint32_t hunk;
    uint32_t amount;
+   chdstream_hunk_t *loaded;
    size_t data_offset   = 0;
    const chd_header *hd = chd_get_header(stream->chd);
    uint8_t         *out = (uint8_t*)data;
@@ -345,12 +788,12 @@ ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
          hunk = chd_frame / stream->frames_per_hunk;
          hunk_offset = (chd_frame % stream->frames_per_hunk) * hd->unitbytes;
 
-         if (!chdstream_load_hunk(stream, hunk))
-         {
+         loaded = chdstream_load_hunk(stream, hunk);
+         if (!loaded)
             return -1;
-         }
+
          memcpy(out + data_offset,
-                stream->hunkmem + frame_offset
+                loaded->data + frame_offset
                 + hunk_offset + stream->frame_offset, amount);
       }
 
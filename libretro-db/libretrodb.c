@@ -32,6 +32,15 @@
 #include <sys/stat.h>
 #include <stdlib.h>
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#if defined(HAVE_MMAP) && !defined(_WIN32)
+#include <fcntl.h>
+#include <memmap.h>
+#endif
+
 #include <streams/file_stream.h>
 #include <retro_endianness.h>
 #include <string/stdstring.h>
@@ -59,6 +68,10 @@ struct libretrodb
 	uint64_t count;
 	uint64_t first_index_offset;
    char *path;
+   /* Last on-disk index read by libretrodb_find_entry. */
+   char index_name[50];
+   uint64_t index_key_size;
+   void *index_buff;
 };
 
 struct libretrodb_index
@@ -79,6 +92,27 @@ typedef struct libretrodb_header
 	uint64_t metadata_offset;
 } libretrodb_header_t;
 
+typedef struct libretrodb_hash_entry
+{
+	uint64_t offset;
+	uint32_t hash;
+	uint32_t key_len;
+	uint32_t key_pos;  /* into the key pool */
+	uint32_t next;     /* chain, entry index + 1, 0 ends it */
+} libretrodb_hash_entry_t;
+
+struct libretrodb_hash_index
+{
+	libretrodb_hash_entry_t *entries;
+	uint32_t *buckets; /* entry index + 1, 0 is empty */
+	char *keys;
+	size_t count;
+	size_t capacity;
+	size_t keys_len;
+	size_t keys_capacity;
+	uint32_t mask;
+};
+
 struct libretrodb_cursor
 {
 	int is_valid;
@@ -86,6 +120,11 @@ struct libretrodb_cursor
 	int eof;
 	libretrodb_query_t *query;
 	libretrodb_t *db;
+   /* Whole file, set by libretrodb_cursor_open_mapped. */
+   const uint8_t *map;
+   size_t map_size;
+   size_t map_pos;
+   int map_is_mmap;
 };
 
 static struct rmsgpack_dom_value sentinal;
@@ -173,8 +212,7 @@ int libretrodb_create(RFILE *fd, libretrodb_value_provider value_provider,
    if ((rv = rmsgpack_dom_write(fd, &sentinal)) < 0)
       goto clean;
 
-   header.metadata_offset = swap_if_little64(filestream_seek(
-            fd, 0, RETRO_VFS_SEEK_POSITION_CURRENT));
+   header.metadata_offset = swap_if_little64(filestream_tell(fd));
    md.count = item_count;
    libretrodb_write_metadata(fd, &md);
    filestream_seek(fd, root, RETRO_VFS_SEEK_POSITION_START);
@@ -210,8 +248,12 @@ void libretrodb_close(libretrodb_t *db)
       filestream_close(db->fd);
    if (!string_is_empty(db->path))
       free(db->path);
-   db->path = NULL;
-   db->fd   = NULL;
+   if (db->index_buff)
+      free(db->index_buff);
+   db->path          = NULL;
+   db->fd            = NULL;
+   db->index_buff    = NULL;
+   db->index_name[0] = '\0';
 }
 
 int libretrodb_open(const char *path, libretrodb_t *db)
@@ -238,7 +280,8 @@ int libretrodb_open(const char *path, libretrodb_t *db)
       goto error;
    }
 
-   if (strncmp(header.magic_number, MAGIC_NUMBER, sizeof(MAGIC_NUMBER)) != 0)
+   if (memcmp(header.magic_number, MAGIC_NUMBER,
+            sizeof(header.magic_number)) != 0)
    {
       rv = -EINVAL;
       goto error;
@@ -318,34 +361,45 @@ int libretrodb_find_entry(libretrodb_t *db, const char *index_name,
 {
    libretrodb_index_t idx;
    int rv;
-   void *buff;
    uint64_t offset;
-   ssize_t bufflen, nread = 0;
 
-   if (libretrodb_find_index(db, index_name, &idx) < 0)
-      return -1;
+   /* Keep the index block around, repeated lookups
+    * against the same index no longer re-read it. */
+   if (!db->index_buff || strcmp(db->index_name, index_name))
+   {
+      void *buff;
+      ssize_t bufflen, nread = 0;
 
-   bufflen = idx.next;
-   buff = malloc(bufflen);
+      if (libretrodb_find_index(db, index_name, &idx) < 0)
+         return -1;
 
-   if (!buff)
-      return -ENOMEM;
+      bufflen = idx.next;
+      buff    = malloc(bufflen);
 
-   while (nread < bufflen)
-   {
-      void *buff_ = (uint64_t *)buff + nread;
-      rv = (int)filestream_read(db->fd, buff_, bufflen - nread);
+      if (!buff)
+         return -ENOMEM;
 
-      if (rv <= 0)
+      while (nread < bufflen)
       {
-         free(buff);
-         return -errno;
+         void *buff_ = (uint8_t *)buff + nread;
+         rv = (int)filestream_read(db->fd, buff_, bufflen - nread);
+
+         if (rv <= 0)
+         {
+            free(buff);
+            return -errno;
+         }
+         nread += rv;
       }
-      nread += rv;
+
+      free(db->index_buff);
+      db->index_buff     = buff;
+      db->index_key_size = idx.key_size;
+      strlcpy(db->index_name, index_name, sizeof(db->index_name));
    }
 
-   rv = binsearch(buff, key, db->count, (ssize_t)idx.key_size, &offset);
-   free(buff);
+   rv = binsearch(db->index_buff, key, db->count,
+         (ssize_t)db->index_key_size, &offset);
 
    if (rv == 0)
       filestream_seek(db->fd, (ssize_t)offset,
@@ -418,6 +472,21 @@ void libretrodb_cursor_close(libretrodb_cursor_t *cursor)
    if (cursor->query)
       libretrodb_query_free(cursor->query);
 
+   if (cursor->map)
+   {
+#if defined(HAVE_MMAP) && !defined(_WIN32)
+      if (cursor->map_is_mmap)
+         munmap((void*)cursor->map, cursor->map_size);
+      else
+#endif
+         free((void*)cursor->map);
+   }
+
+   cursor->map         = NULL;
+   cursor->map_size    = 0;
+   cursor->map_pos     = 0;
+   cursor->map_is_mmap = 0;
+
    cursor->is_valid = 0;
    cursor->eof      = 1;
    cursor->fd       = NULL;
@@ -461,6 +530,172 @@ int libretrodb_cursor_open(libretrodb_t *db, libretrodb_cursor_t *cursor,
    return 0;
 }
 
+static int libretrodb_map_file(const char *path,
+      libretrodb_cursor_t *cursor)
+{
+   void *buf   = NULL;
+   int64_t len = 0;
+#if defined(HAVE_MMAP) && !defined(_WIN32)
+   struct stat st;
+   int fd      = open(path, O_RDONLY);
+
+   if (fd != -1)
+   {
+      if (fstat(fd, &st) == 0 && st.st_size > 0)
+      {
+         buf = mmap(NULL, (size_t)st.st_size, PROT_READ,
+               MAP_SHARED, fd, 0);
+
+         if (buf != MAP_FAILED)
+         {
+            cursor->map         = (const uint8_t*)buf;
+            cursor->map_size    = (size_t)st.st_size;
+            cursor->map_is_mmap = 1;
+         }
+      }
+      close(fd);
+
+      if (cursor->map)
+         return 0;
+   }
+#endif
+
+   /* No mmap, read the whole file once instead. */
+   if (!filestream_read_file(path, &buf, &len) || !buf)
+      return -EIO;
+
+   cursor->map         = (const uint8_t*)buf;
+   cursor->map_size    = (size_t)len;
+   cursor->map_is_mmap = 0;
+   return 0;
+}
+
+/**
+ * libretrodb_cursor_open_mapped:
+ * @db                  : Handle to database.
+ * @cursor              : Handle to database cursor.
+ *
+ * Opens a read-only cursor over the whole database file,
+ * mapped into memory where the platform allows it.
+ * Records are read with libretrodb_cursor_read_record.
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+int libretrodb_cursor_open_mapped(libretrodb_t *db,
+      libretrodb_cursor_t *cursor)
+{
+   int rv;
+   uint64_t start;
+
+   if (!db || string_is_empty(db->path))
+      return -EINVAL;
+
+   if ((rv = libretrodb_map_file(db->path, cursor)) < 0)
+      return rv;
+
+   start = db->root + sizeof(libretrodb_header_t);
+
+   if (start > cursor->map_size)
+   {
+      libretrodb_cursor_close(cursor);
+      return -EINVAL;
+   }
+
+   cursor->db       = db;
+   cursor->query    = NULL;
+   cursor->eof      = 0;
+   cursor->map_pos  = (size_t)start;
+   cursor->is_valid = 1;
+
+   return 0;
+}
+
+int libretrodb_cursor_read_record(libretrodb_cursor_t *cursor,
+      libretrodb_record_t *out)
+{
+   struct rmsgpack_view val;
+   const uint8_t *end = NULL;
+   const uint8_t *pos = NULL;
+   uint32_t i;
+
+   if (cursor->eof || !cursor->map)
+      return EOF;
+
+   end = cursor->map + cursor->map_size;
+
+   for (;;)
+   {
+      const uint8_t *start = cursor->map + cursor->map_pos;
+
+      pos = start;
+
+      if (rmsgpack_view_read(&pos, end, &val) < 0)
+         return -EINVAL;
+
+      if (val.type == RDT_NULL)
+      {
+         cursor->eof = 1;
+         return EOF;
+      }
+
+      if (val.type != RDT_MAP)
+      {
+         pos = start;
+         if (rmsgpack_view_skip(&pos, end) < 0)
+            return -EINVAL;
+         cursor->map_pos = pos - cursor->map;
+         continue;
+      }
+
+      out->items  = pos;
+      out->count  = val.val.map.len;
+      out->offset = start - cursor->map;
+
+      for (i = 0; i < out->count * 2; i++)
+         if (rmsgpack_view_skip(&pos, end) < 0)
+            return -EINVAL;
+
+      out->end        = pos;
+      cursor->map_pos = pos - cursor->map;
+      return 0;
+   }
+}
+
+int libretrodb_record_get(const libretrodb_record_t *record,
+      const char *name, struct rmsgpack_view *out)
+{
+   uint32_t i;
+   struct rmsgpack_view key;
+   const uint8_t *pos = record->items;
+   size_t name_len    = strlen(name);
+
+   for (i = 0; i < record->count; i++)
+   {
+      const uint8_t *key_start = pos;
+
+      if (rmsgpack_view_read(&pos, record->end, &key) < 0)
+         return -EINVAL;
+
+      if (     key.type == RDT_STRING
+            && key.val.string.len == name_len
+            && !memcmp(key.val.string.buff, name, name_len))
+         return rmsgpack_view_read(&pos, record->end, out);
+
+      /* Non-string keys never match, step over them whole. */
+      if (key.type == RDT_MAP || key.type == RDT_ARRAY)
+      {
+         pos = key_start;
+         if (rmsgpack_view_skip(&pos, record->end) < 0)
+            return -EINVAL;
+      }
+
+      if (rmsgpack_view_skip(&pos, record->end) < 0)
+         return -EINVAL;
+   }
+
+   return -1;
+}
+
 static int node_iter(void *value, void *ctx)
 {
    struct node_iter_ctx *nictx = (struct node_iter_ctx*)ctx;
@@ -625,3 +860,191 @@ void libretrodb_free(libretrodb_t *db)
 
    free(db);
 }
+
+static uint32_t libretrodb_hash_key(const void *key, size_t len)
+{
+   /* FNV-1a */
+   size_t i;
+   const uint8_t *p = (const uint8_t*)key;
+   uint32_t hash    = 2166136261u;
+
+   for (i = 0; i < len; i++)
+   {
+      hash ^= p[i];
+      hash *= 16777619u;
+   }
+
+   return hash;
+}
+
+static int libretrodb_hash_index_append(libretrodb_hash_index_t *idx,
+      const char *key, uint32_t key_len, uint64_t offset)
+{
+   libretrodb_hash_entry_t *entry = NULL;
+
+   if (idx->count == idx->capacity)
+   {
+      size_t capacity                   = idx->capacity ? idx->capacity * 2 : 1024;
+      libretrodb_hash_entry_t *entries  = (libretrodb_hash_entry_t*)
+         realloc(idx->entries, capacity * sizeof(*entries));
+
+      if (!entries)
+         return -ENOMEM;
+
+      idx->entries  = entries;
+      idx->capacity = capacity;
+   }
+
+   if (idx->keys_len + key_len > idx->keys_capacity)
+   {
+      size_t capacity = idx->keys_capacity ? idx->keys_capacity * 2 : 16384;
+      char *keys      = NULL;
+
+      while (capacity < idx->keys_len + key_len)
+         capacity *= 2;
+
+      keys = (char*)realloc(idx->keys, capacity);
+
+      if (!keys)
+         return -ENOMEM;
+
+      idx->keys          = keys;
+      idx->keys_capacity = capacity;
+   }
+
+   memcpy(idx->keys + idx->keys_len, key, key_len);
+
+   entry          = &idx->entries[idx->count++];
+   entry->offset  = offset;
+   entry->hash    = libretrodb_hash_key(key, key_len);
+   entry->key_len = key_len;
+   entry->key_pos = (uint32_t)idx->keys_len;
+   entry->next    = 0;
+
+   idx->keys_len += key_len;
+
+   return 0;
+}
+
+libretrodb_hash_index_t *libretrodb_hash_index_new(libretrodb_t *db,
+      const char *field_name)
+{
+   size_t i;
+   uint32_t num_buckets = 16;
+   libretrodb_record_t record;
+   libretrodb_cursor_t cur      = {0};
+   libretrodb_hash_index_t *idx = NULL;
+   int rv                       = 0;
+
+   if (!db)
+      return NULL;
+
+   idx = (libretrodb_hash_index_t*)calloc(1, sizeof(*idx));
+
+   if (!idx)
+      return NULL;
+
+   /* Only one field per record is needed, so walk the
+    * file in place instead of decoding every record. */
+   if (libretrodb_cursor_open_mapped(db, &cur) != 0)
+      goto error;
+
+   while ((rv = libretrodb_cursor_read_record(&cur, &record)) == 0)
+   {
+      struct rmsgpack_view field;
+
+      if (libretrodb_record_get(&record, field_name, &field) != 0)
+         continue;
+
+      if ((field.type == RDT_BINARY || field.type == RDT_STRING)
+            && field.val.binary.len)
+      {
+         if (libretrodb_hash_index_append(idx, field.val.binary.buff,
+                  field.val.binary.len, record.offset) != 0)
+            goto error;
+      }
+   }
+
+   libretrodb_cursor_close(&cur);
+
+   if (rv != EOF)
+      goto error;
+
+   while (num_buckets < idx->count * 2)
+      num_buckets <<= 1;
+
+   idx->buckets = (uint32_t*)calloc(num_buckets, sizeof(*idx->buckets));
+
+   if (!idx->buckets)
+      goto error;
+
+   idx->mask = num_buckets - 1;
+
+   /* Insert back to front so every chain is in file order. */
+   for (i = idx->count; i-- > 0; )
+   {
+      uint32_t *bucket      = &idx->buckets[idx->entries[i].hash & idx->mask];
+      idx->entries[i].next  = *bucket;
+      *bucket               = (uint32_t)(i + 1);
+   }
+
+   return idx;
+
+error:
+   if (cur.is_valid)
+      libretrodb_cursor_close(&cur);
+   libretrodb_hash_index_free(idx);
+   return NULL;
+}
+
+void libretrodb_hash_index_free(libretrodb_hash_index_t *idx)
+{
+   if (!idx)
+      return;
+
+   free(idx->entries);
+   free(idx->buckets);
+   free(idx->keys);
+   free(idx);
+}
+
+size_t libretrodb_hash_index_find(const libretrodb_hash_index_t *idx,
+      const void *key, size_t key_len,
+      uint64_t *offsets, size_t max_offsets)
+{
+   uint32_t hash;
+   uint32_t pos;
+   size_t found = 0;
+
+   if (!idx || !idx->buckets)
+      return 0;
+
+   hash = libretrodb_hash_key(key, key_len);
+   pos  = idx->buckets[hash & idx->mask];
+
+   while (pos && found < max_offsets)
+   {
+      const libretrodb_hash_entry_t *entry = &idx->entries[pos - 1];
+
+      if (entry->hash == hash && entry->key_len == key_len
+            && !memcmp(idx->keys + entry->key_pos, key, key_len))
+         offsets[found++] = entry->offset;
+
+      pos = entry->next;
+   }
+
+   return found;
+}
+
+int libretrodb_read_entry_at(libretrodb_t *db, uint64_t offset,
+      struct rmsgpack_dom_value *out)
+{
+   if (!db || !db->fd)
+      return -EINVAL;
+
+   if (filestream_seek(db->fd, (ssize_t)offset,
+            RETRO_VFS_SEEK_POSITION_START) == -1)
+      return -EIO;
+
+   return rmsgpack_dom_read(db->fd, out);
+}
@@ -33,6 +33,7 @@
 #include <retro_common_api.h>
 
 #include "query.h"
+#include "rmsgpack.h"
 #include "rmsgpack_dom.h"
 
 RETRO_BEGIN_DECLS
@@ -43,6 +44,8 @@ typedef struct libretrodb_cursor libretrodb_cursor_t;
 
 typedef struct libretrodb_index libretrodb_index_t;
 
+typedef struct libretrodb_hash_index libretrodb_hash_index_t;
+
 typedef int (*libretrodb_value_provider)(void *ctx, struct rmsgpack_dom_value *out);
 
 int libretrodb_create(RFILE *fd, libretrodb_value_provider value_provider, void *ctx);
@@ -105,6 +108,101 @@ void libretrodb_query_free(void *q);
 int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
       struct rmsgpack_dom_value *out);
 
+/* One record of a mapped cursor. Only valid until the
+ * cursor is closed. */
+typedef struct libretrodb_record
+{
+   const uint8_t *items;   /* first key of the record map */
+   const uint8_t *end;     /* one past the last byte */
+   uint64_t offset;        /* from the start of the file */
+   uint32_t count;         /* number of key/value pairs */
+} libretrodb_record_t;
+
+/**
+ * libretrodb_cursor_open_mapped:
+ * @db                  : Handle to database.
+ * @cursor              : Handle to database cursor.
+ *
+ * Opens a read-only cursor that walks the database in place,
+ * memory mapped when HAVE_MMAP is available and read into a
+ * single buffer otherwise. Queries are not supported; callers
+ * pick the fields they need with libretrodb_record_get.
+ * Close it with libretrodb_cursor_close.
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+int libretrodb_cursor_open_mapped(libretrodb_t *db,
+      libretrodb_cursor_t *cursor);
+
+/**
+ * libretrodb_cursor_read_record:
+ * @cursor              : Cursor opened with libretrodb_cursor_open_mapped.
+ * @out                 : Receives the next record.
+ *
+ * Does not allocate or decode any field.
+ *
+ * Returns: 0 if successful, EOF at the end, otherwise negative.
+ **/
+int libretrodb_cursor_read_record(libretrodb_cursor_t *cursor,
+      libretrodb_record_t *out);
+
+/**
+ * libretrodb_record_get:
+ * @record              : Record from libretrodb_cursor_read_record.
+ * @name                : Field name.
+ * @out                 : Receives a view of the field value.
+ *
+ * Strings and binaries in @out point into the mapping.
+ *
+ * Returns: 0 if found, otherwise negative.
+ **/
+int libretrodb_record_get(const libretrodb_record_t *record,
+      const char *name, struct rmsgpack_view *out);
+
+/**
+ * libretrodb_hash_index_new:
+ * @db                  : Handle to an open database.
+ * @field_name          : Name of a string or binary field.
+ *
+ * Walks the database once and builds an in-memory hash table
+ * from the value of @field_name to the offset of every record
+ * that has it. Keys do not need to be unique.
+ *
+ * Returns: the index, or NULL on failure.
+ **/
+libretrodb_hash_index_t *libretrodb_hash_index_new(libretrodb_t *db,
+      const char *field_name);
+
+void libretrodb_hash_index_free(libretrodb_hash_index_t *idx);
+
+/**
+ * libretrodb_hash_index_find:
+ * @idx                 : Hash index.
+ * @key                 : Raw bytes of the field value.
+ * @key_len             : Length of @key.
+ * @offsets             : Receives the offsets of matching records.
+ * @max_offsets         : Size of @offsets.
+ *
+ * Looks up records without touching the database file.
+ * Offsets are returned in file order.
+ *
+ * Returns: number of matches stored in @offsets.
+ **/
+size_t libretrodb_hash_index_find(const libretrodb_hash_index_t *idx,
+      const void *key, size_t key_len,
+      uint64_t *offsets, size_t max_offsets);
+
+/**
+ * libretrodb_read_entry_at:
+ * @db                  : Handle to an open database.
+ * @offset              : Record offset from libretrodb_hash_index_find.
+ * @out                 : Receives the record.
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+int libretrodb_read_entry_at(libretrodb_t *db, uint64_t offset,
+      struct rmsgpack_dom_value *out);
+
 RETRO_END_DECLS
 
 #endif
@@ -35,6 +35,7 @@
 
 #include "libretrodb.h"
 #include "query.h"
+#include "rmsgpack.h"
 #include "rmsgpack_dom.h"
 
 #define MAX_ERROR_LEN   256
@@ -977,3 +978,61 @@ int libretrodb_query_filter(libretrodb_query_t *q,
    struct rmsgpack_dom_value res = inv.func(*v, inv.argc, inv.argv);
    return (res.type == RDT_BOOL && res.val.bool_);
 }
+
+int libretrodb_query_filter_record(libretrodb_query_t *q,
+      const struct libretrodb_record *record)
+{
+   unsigned i;
+   struct rmsgpack_view view;
+   struct rmsgpack_dom_value input;
+   struct rmsgpack_dom_value res;
+   struct rmsgpack_dom_pair items[QUERY_MAX_ARGS / 2];
+   struct invocation inv = ((struct query *)q)->root;
+
+   if (inv.func != query_func_all_map)
+   {
+      /* Anything but a plain table may look at the whole record. */
+      view.type              = RDT_MAP;
+      view.val.map.len       = record->count;
+      view.val.map.items     = record->items;
+
+      if (rmsgpack_dom_value_from_view(&view, record->end, &input) < 0)
+         return 0;
+
+      res = inv.func(input, inv.argc, inv.argv);
+      rmsgpack_dom_value_free(&input);
+      return (res.type == RDT_BOOL && res.val.bool_);
+   }
+
+   /* A table only reads the fields it names, decode just those.
+    * The keys are borrowed from the query. */
+   input.type          = RDT_MAP;
+   input.val.map.len   = 0;
+   input.val.map.items = items;
+
+   for (i = 0; i + 1 < inv.argc; i += 2)
+   {
+      const struct argument *key = &inv.argv[i];
+      struct rmsgpack_dom_pair *pair = &items[input.val.map.len];
+
+      if (     key->type != AT_VALUE
+            || key->a.value.type != RDT_STRING
+            || libretrodb_record_get(record,
+               key->a.value.val.string.buff, &view) < 0)
+         continue;
+
+      if (rmsgpack_dom_value_from_view(&view, record->end,
+               &pair->value) < 0)
+         continue;
+
+      pair->key = key->a.value;
+      input.val.map.len++;
+   }
+
+   res = inv.func(input, inv.argc, inv.argv);
+
+   for (i = 0; i < input.val.map.len; i++)
+      rmsgpack_dom_value_free(&items[i].value);
+
+   return (res.type == RDT_BOOL && res.val.bool_);
+}
@@ -32,12 +32,19 @@ RETRO_BEGIN_DECLS
 
 typedef struct libretrodb_query libretrodb_query_t;
 
+struct libretrodb_record;
+
 void libretrodb_query_inc_ref(libretrodb_query_t *q);
 
 void libretrodb_query_dec_ref(libretrodb_query_t *q);
 
 int libretrodb_query_filter(libretrodb_query_t *q, struct rmsgpack_dom_value *v);
 
+/* Same as libretrodb_query_filter for a record of a mapped cursor.
+ * Tables only decode the fields they name. */
+int libretrodb_query_filter_record(libretrodb_query_t *q,
+      const struct libretrodb_record *record);
+
 RETRO_END_DECLS
 
 #endif
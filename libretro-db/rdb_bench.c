@@ -0,0 +1,222 @@
+/* Copyright  (C) 2010-2017 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rdb_bench.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Compares decoding every record with libretrodb_cursor_read_item
+ * against walking a mapped cursor and viewing only a few fields. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "libretrodb.h"
+#include "rmsgpack.h"
+#include "rmsgpack_dom.h"
+
+/* Heap blocks rmsgpack_dom_read made for @v. */
+static unsigned long count_allocs(const struct rmsgpack_dom_value *v)
+{
+   uint32_t i;
+   unsigned long count = 0;
+
+   switch (v->type)
+   {
+      case RDT_STRING:
+      case RDT_BINARY:
+         return 1;
+      case RDT_MAP:
+         count = 1;
+         for (i = 0; i < v->val.map.len; i++)
+         {
+            count += count_allocs(&v->val.map.items[i].key);
+            count += count_allocs(&v->val.map.items[i].value);
+         }
+         break;
+      case RDT_ARRAY:
+         count = 1;
+         for (i = 0; i < v->val.array.len; i++)
+            count += count_allocs(&v->val.array.items[i]);
+         break;
+      default:
+         break;
+   }
+
+   return count;
+}
+
+static size_t field_size(enum rmsgpack_dom_type type, uint32_t len)
+{
+   return (type == RDT_STRING || type == RDT_BINARY) ? len : 0;
+}
+
+static int bench_dom(libretrodb_t *db, const char **fields,
+      int num_fields, unsigned long *records, unsigned long *allocs,
+      size_t *bytes)
+{
+   int i;
+   struct rmsgpack_dom_value item;
+   libretrodb_cursor_t *cur = libretrodb_cursor_new();
+
+   if (!cur || libretrodb_cursor_open(db, cur, NULL) != 0)
+   {
+      libretrodb_cursor_free(cur);
+      return -1;
+   }
+
+   while (libretrodb_cursor_read_item(cur, &item) == 0)
+   {
+      for (i = 0; i < num_fields; i++)
+      {
+         struct rmsgpack_dom_value key;
+         struct rmsgpack_dom_value *val = NULL;
+
+         key.type            = RDT_STRING;
+         key.val.string.len  = (uint32_t)strlen(fields[i]);
+         key.val.string.buff = (char*)fields[i];
+
+         if ((val = rmsgpack_dom_value_map_value(&item, &key)))
+            *bytes += field_size(val->type, val->val.string.len);
+      }
+
+      *allocs += count_allocs(&item);
+      (*records)++;
+      rmsgpack_dom_value_free(&item);
+   }
+
+   libretrodb_cursor_close(cur);
+   libretrodb_cursor_free(cur);
+   return 0;
+}
+
+static int bench_mapped(libretrodb_t *db, const char **fields,
+      int num_fields, unsigned long *records, size_t *bytes)
+{
+   int i;
+   libretrodb_record_t record;
+   libretrodb_cursor_t *cur = libretrodb_cursor_new();
+
+   if (!cur || libretrodb_cursor_open_mapped(db, cur) != 0)
+   {
+      libretrodb_cursor_free(cur);
+      return -1;
+   }
+
+   while (libretrodb_cursor_read_record(cur, &record) == 0)
+   {
+      for (i = 0; i < num_fields; i++)
+      {
+         struct rmsgpack_view val;
+
+         if (libretrodb_record_get(&record, fields[i], &val) == 0)
+            *bytes += field_size(val.type, val.val.string.len);
+      }
+
+      (*records)++;
+   }
+
+   libretrodb_cursor_close(cur);
+   libretrodb_cursor_free(cur);
+   return 0;
+}
+
+int main(int argc, char **argv)
+{
+   int i;
+   clock_t start;
+   double dom_time, mapped_time;
+   const char *default_fields[] = { "name", "crc" };
+   const char **fields          = default_fields;
+   int num_fields               = 2;
+   int passes                   = 20;
+   unsigned long dom_records    = 0;
+   unsigned long dom_allocs     = 0;
+   unsigned long mapped_records = 0;
+   size_t dom_bytes             = 0;
+   size_t mapped_bytes          = 0;
+   libretrodb_t *db             = NULL;
+
+   if (argc < 2)
+   {
+      printf("Usage: %s <db file> [passes] [field...]\n", argv[0]);
+      return 1;
+   }
+
+   if (argc > 2)
+      passes = atoi(argv[2]);
+
+   if (passes < 1)
+      passes = 1;
+
+   if (argc > 3)
+   {
+      fields     = (const char**)&argv[3];
+      num_fields = argc - 3;
+   }
+
+   db = libretrodb_new();
+
+   if (!db || libretrodb_open(argv[1], db) != 0)
+   {
+      printf("Could not open db file '%s'\n", argv[1]);
+      libretrodb_free(db);
+      return 1;
+   }
+
+   start = clock();
+   for (i = 0; i < passes; i++)
+      if (bench_dom(db, fields, num_fields,
+               &dom_records, &dom_allocs, &dom_bytes) != 0)
+         goto error;
+   dom_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+   start = clock();
+   for (i = 0; i < passes; i++)
+      if (bench_mapped(db, fields, num_fields,
+               &mapped_records, &mapped_bytes) != 0)
+         goto error;
+   mapped_time = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+   if (dom_records != mapped_records || dom_bytes != mapped_bytes)
+   {
+      printf("Mismatch: %lu/%lu records, %lu/%lu field bytes\n",
+            dom_records, mapped_records,
+            (unsigned long)dom_bytes, (unsigned long)mapped_bytes);
+      goto error;
+   }
+
+   printf("%lu records x %d passes\n", dom_records / passes, passes);
+   printf("read_item: %8.3f ms/pass, %lu allocations/pass\n",
+         dom_time * 1000.0 / passes, dom_allocs / passes);
+   printf("mapped:    %8.3f ms/pass, 0 allocations/pass\n",
+         mapped_time * 1000.0 / passes);
+   printf("speedup:   %8.2fx\n",
+         mapped_time > 0.0 ? dom_time / mapped_time : 0.0);
+
+   libretrodb_close(db);
+   libretrodb_free(db);
+   return 0;
+
+error:
+   libretrodb_close(db);
+   libretrodb_free(db);
+   return 1;
+}
@@ -658,3 +658,182 @@ int rmsgpack_read(RFILE *fd,
 error:
    return -errno;
 }
+
+static uint64_t rmsgpack_view_uint(const uint8_t *p, size_t size)
+{
+   size_t i;
+   uint64_t val = 0;
+
+   for (i = 0; i < size; i++)
+      val = (val << 8) | p[i];
+
+   return val;
+}
+
+int rmsgpack_view_read(const uint8_t **pos, const uint8_t *end,
+      struct rmsgpack_view *out)
+{
+   uint64_t tmp_len  = 0;
+   size_t size       = 0;
+   const uint8_t *p  = *pos;
+   uint8_t type;
+
+   if (p >= end)
+      return -EINVAL;
+
+   type = *p++;
+
+   if (type < MPF_FIXMAP)
+   {
+      out->type     = RDT_INT;
+      out->val.int_ = type;
+      goto done;
+   }
+   else if (type < MPF_FIXARRAY)
+   {
+      out->type          = RDT_MAP;
+      out->val.map.len   = type - MPF_FIXMAP;
+      out->val.map.items = p;
+      goto done;
+   }
+   else if (type < MPF_FIXSTR)
+   {
+      out->type            = RDT_ARRAY;
+      out->val.array.len   = type - MPF_FIXARRAY;
+      out->val.array.items = p;
+      goto done;
+   }
+   else if (type < MPF_NIL)
+   {
+      tmp_len = type - MPF_FIXSTR;
+      goto string;
+   }
+   else if (type > MPF_MAP32)
+   {
+      out->type     = RDT_INT;
+      out->val.int_ = (int8_t)type;
+      goto done;
+   }
+
+   switch (type)
+   {
+      case _MPF_NIL:
+         out->type = RDT_NULL;
+         break;
+      case _MPF_FALSE:
+      case _MPF_TRUE:
+         out->type      = RDT_BOOL;
+         out->val.bool_ = (type == _MPF_TRUE);
+         break;
+      case _MPF_BIN8:
+      case _MPF_BIN16:
+      case _MPF_BIN32:
+         size = (size_t)1 << (type - _MPF_BIN8);
+         if ((size_t)(end - p) < size)
+            return -EINVAL;
+         tmp_len = rmsgpack_view_uint(p, size);
+         p      += size;
+         if ((uint64_t)(end - p) < tmp_len)
+            return -EINVAL;
+         out->type              = RDT_BINARY;
+         out->val.binary.len    = (uint32_t)tmp_len;
+         out->val.binary.buff   = (const char*)p;
+         p                     += tmp_len;
+         break;
+      case _MPF_UINT8:
+      case _MPF_UINT16:
+      case _MPF_UINT32:
+      case _MPF_UINT64:
+         size = (size_t)1 << (type - _MPF_UINT8);
+         if ((size_t)(end - p) < size)
+            return -EINVAL;
+         out->type      = RDT_UINT;
+         out->val.uint_ = rmsgpack_view_uint(p, size);
+         p             += size;
+         break;
+      case _MPF_INT8:
+      case _MPF_INT16:
+      case _MPF_INT32:
+      case _MPF_INT64:
+         size = (size_t)1 << (type - _MPF_INT8);
+         if ((size_t)(end - p) < size)
+            return -EINVAL;
+         tmp_len = rmsgpack_view_uint(p, size);
+         /* Sign-extend narrower integers. */
+         if (size < 8 && (tmp_len >> (size * 8 - 1)) & 1)
+            tmp_len |= ~UINT64_C(0) << (size * 8);
+         out->type     = RDT_INT;
+         out->val.int_ = (int64_t)tmp_len;
+         p            += size;
+         break;
+      case _MPF_STR8:
+      case _MPF_STR16:
+      case _MPF_STR32:
+         size = (size_t)1 << (type - _MPF_STR8);
+         if ((size_t)(end - p) < size)
+            return -EINVAL;
+         tmp_len = rmsgpack_view_uint(p, size);
+         p      += size;
+         goto string;
+      case _MPF_ARRAY16:
+      case _MPF_ARRAY32:
+         size = (size_t)2 << (type - _MPF_ARRAY16);
+         if ((size_t)(end - p) < size)
+            return -EINVAL;
+         out->type            = RDT_ARRAY;
+         out->val.array.len   = (uint32_t)rmsgpack_view_uint(p, size);
+         out->val.array.items = p + size;
+         p                   += size;
+         break;
+      case _MPF_MAP16:
+      case _MPF_MAP32:
+         size = (size_t)2 << (type - _MPF_MAP16);
+         if ((size_t)(end - p) < size)
+            return -EINVAL;
+         out->type          = RDT_MAP;
+         out->val.map.len   = (uint32_t)rmsgpack_view_uint(p, size);
+         out->val.map.items = p + size;
+         p                 += size;
+         break;
+      default:
+         return -EINVAL;
+   }
+
+done:
+   *pos = p;
+   return 0;
+
+string:
+   if ((uint64_t)(end - p) < tmp_len)
+      return -EINVAL;
+   out->type            = RDT_STRING;
+   out->val.string.len  = (uint32_t)tmp_len;
+   out->val.string.buff = (const char*)p;
+   *pos                 = p + tmp_len;
+   return 0;
+}
+
+int rmsgpack_view_skip(const uint8_t **pos, const uint8_t *end)
+{
+   struct rmsgpack_view val;
+   uint64_t pending = 1;
+   const uint8_t *p = *pos;
+
+   /* Every value is at least one byte long, so a corrupt
+    * length runs into @end instead of looping forever. */
+   while (pending)
+   {
+      if (rmsgpack_view_read(&p, end, &val) < 0)
+         return -EINVAL;
+
+      pending--;
+
+      if (val.type == RDT_MAP)
+         pending += (uint64_t)val.val.map.len * 2;
+      else if (val.type == RDT_ARRAY)
+         pending += val.val.array.len;
+   }
+
+   *pos = p;
+   return 0;
+}
@@ -27,6 +27,8 @@
 
 #include <streams/file_stream.h>
 
+#include "rmsgpack_dom.h"
+
 struct rmsgpack_read_callbacks
 {
    int (*read_nil        )(void *);
@@ -57,5 +59,68 @@ int rmsgpack_write_uint(RFILE *fd, uint64_t value );
 
 int rmsgpack_read(RFILE *fd, struct rmsgpack_read_callbacks *callbacks, void *data);
 
+/* Read-only view of a value inside a caller-owned buffer.
+ * Strings and binaries point into the buffer and are not
+ * NUL-terminated. Maps and arrays only carry their length
+ * and a pointer to the first encoded item. */
+struct rmsgpack_view
+{
+   enum rmsgpack_dom_type type;
+   union
+   {
+      uint64_t uint_;
+      int64_t int_;
+      int bool_;
+      struct
+      {
+         uint32_t len;
+         const char *buff;
+      } string;
+      struct
+      {
+         uint32_t len;
+         const char *buff;
+      } binary;
+      struct
+      {
+         uint32_t len;
+         const uint8_t *items;
+      } map;
+      struct
+      {
+         uint32_t len;
+         const uint8_t *items;
+      } array;
+   } val;
+};
+
+/**
+ * rmsgpack_view_read:
+ * @pos                 : Position in the buffer, advanced on success.
+ * @end                 : One past the last byte of the buffer.
+ * @out                 : Receives the value.
+ *
+ * Decodes the value at @pos without allocating. Scalars,
+ * strings and binaries are consumed whole; for maps and
+ * arrays only the header is consumed, so @pos is left on
+ * the first item.
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+int rmsgpack_view_read(const uint8_t **pos, const uint8_t *end,
+      struct rmsgpack_view *out);
+
+/**
+ * rmsgpack_view_skip:
+ * @pos                 : Position in the buffer, advanced on success.
+ * @end                 : One past the last byte of the buffer.
+ *
+ * Steps over one complete value, including everything
+ * nested inside it.
+ *
+ * Returns: 0 if successful, otherwise negative.
+ **/
+int rmsgpack_view_skip(const uint8_t **pos, const uint8_t *end);
+
 #endif
 
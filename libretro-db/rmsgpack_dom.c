@@ -418,6 +418,121 @@ int rmsgpack_dom_read(RFILE *fd, struct rmsgpack_dom_value *out)
    return rv;
 }
 
+static int dom_read_view_items(const uint8_t **pos, const uint8_t *end,
+      struct rmsgpack_dom_value *out);
+
+static int dom_from_view(const struct rmsgpack_view *view,
+      const uint8_t *end, struct rmsgpack_dom_value *out)
+{
+   uint32_t i;
+   const uint8_t *pos = NULL;
+
+   memset(out, 0, sizeof(*out));
+
+   switch (view->type)
+   {
+      case RDT_NULL:
+         break;
+      case RDT_BOOL:
+         out->val.bool_ = view->val.bool_;
+         break;
+      case RDT_UINT:
+         out->val.uint_ = view->val.uint_;
+         break;
+      case RDT_INT:
+         out->val.int_  = view->val.int_;
+         break;
+      case RDT_STRING:
+         out->val.string.buff = (char*)malloc(view->val.string.len + 1);
+         if (!out->val.string.buff)
+            return -ENOMEM;
+         memcpy(out->val.string.buff, view->val.string.buff,
+               view->val.string.len);
+         out->val.string.buff[view->val.string.len] = '\0';
+         out->val.string.len  = view->val.string.len;
+         break;
+      case RDT_BINARY:
+         out->val.binary.buff = (char*)malloc(view->val.binary.len + 1);
+         if (!out->val.binary.buff)
+            return -ENOMEM;
+         memcpy(out->val.binary.buff, view->val.binary.buff,
+               view->val.binary.len);
+         out->val.binary.len  = view->val.binary.len;
+         break;
+      case RDT_MAP:
+         out->type = RDT_MAP;
+         if (!view->val.map.len)
+            return 0;
+         out->val.map.items = (struct rmsgpack_dom_pair*)calloc(
+               view->val.map.len, sizeof(struct rmsgpack_dom_pair));
+         if (!out->val.map.items)
+            return -ENOMEM;
+         out->val.map.len = view->val.map.len;
+         pos              = view->val.map.items;
+         for (i = 0; i < view->val.map.len; i++)
+         {
+            if (dom_read_view_items(&pos, end,
+                     &out->val.map.items[i].key) < 0
+                  || dom_read_view_items(&pos, end,
+                     &out->val.map.items[i].value) < 0)
+               return -EINVAL;
+         }
+         return 0;
+      case RDT_ARRAY:
+         out->type = RDT_ARRAY;
+         if (!view->val.array.len)
+            return 0;
+         out->val.array.items = (struct rmsgpack_dom_value*)calloc(
+               view->val.array.len, sizeof(struct rmsgpack_dom_value));
+         if (!out->val.array.items)
+            return -ENOMEM;
+         out->val.array.len = view->val.array.len;
+         pos                = view->val.array.items;
+         for (i = 0; i < view->val.array.len; i++)
+         {
+            if (dom_read_view_items(&pos, end,
+                     &out->val.array.items[i]) < 0)
+               return -EINVAL;
+         }
+         return 0;
+   }
+
+   out->type = view->type;
+   return 0;
+}
+
+/* Decodes the value at *pos and moves *pos past it, including
+ * the items of maps and arrays. */
+static int dom_read_view_items(const uint8_t **pos, const uint8_t *end,
+      struct rmsgpack_dom_value *out)
+{
+   struct rmsgpack_view view;
+   const uint8_t *start = *pos;
+
+   if (rmsgpack_view_read(pos, end, &view) < 0)
+      return -EINVAL;
+
+   if (view.type == RDT_MAP || view.type == RDT_ARRAY)
+   {
+      *pos = start;
+      if (rmsgpack_view_skip(pos, end) < 0)
+         return -EINVAL;
+   }
+
+   return dom_from_view(&view, end, out);
+}
+
+int rmsgpack_dom_value_from_view(const struct rmsgpack_view *view,
+      const uint8_t *end, struct rmsgpack_dom_value *out)
+{
+   int rv = dom_from_view(view, end, out);
+
+   if (rv < 0)
+      rmsgpack_dom_value_free(out);
+
+   return rv;
+}
+
 int rmsgpack_dom_read_into(RFILE *fd, ...)
 {
    va_list ap;
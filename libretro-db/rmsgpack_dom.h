@@ -91,6 +91,14 @@ struct rmsgpack_dom_value *rmsgpack_dom_value_map_value(
 
 int rmsgpack_dom_read(RFILE *fd, struct rmsgpack_dom_value *out);
 
+struct rmsgpack_view;
+
+/* Copies a view and everything it contains into a DOM value.
+ * @end is the end of the buffer the view points into.
+ * Free the result with rmsgpack_dom_value_free. */
+int rmsgpack_dom_value_from_view(const struct rmsgpack_view *view,
+      const uint8_t *end, struct rmsgpack_dom_value *out);
+
 int rmsgpack_dom_write(RFILE *fd, const struct rmsgpack_dom_value *obj);
 
 int rmsgpack_dom_read_into(RFILE *fd, ...);
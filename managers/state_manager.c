@@ -24,6 +24,10 @@
 #include <compat/strl.h>
 #include <compat/intrinsics.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "state_manager.h"
 #include "../msg_hash.h"
 #include "../movie.h"
@@ -157,8 +161,55 @@ static size_t find_same(const uint16_t *a, const uint16_t *b)
    return a - a_org;
 }
 
+/* Block-deduplicated backend.
+ *
+ * The savestate is split into REWIND_BLOCK_SIZE chunks. A history entry
+ * is an array of indices into a pool of refcounted blocks shared by all
+ * entries. A block is only copied into the pool if it differs from the
+ * same block of the previous entry and no identical block (looked up by
+ * hash) is pooled already. When the pool runs dry, the oldest entry
+ * is discarded.
+ *
+ * Diffing is done on a worker thread so it overlaps with the next
+ * core_run; pushing waits for the previous frame's job to finish. */
+
+#define REWIND_BLOCK_SIZE 4096
+#define REWIND_BLOCK_NONE 0xffffffffu
+
+typedef struct state_manager_blocks
+{
+   uint8_t *pool;          /* num_slots * REWIND_BLOCK_SIZE */
+   uint8_t *capture[2];    /* Savestates are serialized in here */
+   uint8_t *output;        /* Last popped savestate */
+   uint32_t *slot_hash;
+   uint32_t *slot_refs;
+   uint32_t *free_slots;
+   uint32_t *table;        /* Open addressing, slot + 1; 0 is empty */
+   uint32_t *entries;      /* Ring of max_entries * num_blocks slots */
+
+   size_t num_blocks;
+   size_t num_slots;
+   size_t num_free;
+   size_t table_mask;
+   size_t max_entries;
+   size_t first_entry;
+   size_t num_entries;
+   unsigned capture_index;
+
+#ifdef HAVE_THREADS
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   uint8_t *job;
+   bool quit;
+#endif
+} state_manager_blocks_t;
+
 struct state_manager
 {
+   /* If set, all other members are unused. */
+   state_manager_blocks_t *blocks;
+
    uint8_t *data;
    size_t capacity;
    /* Reading and writing is done here here. */
@@ -407,11 +458,408 @@ static INLINE size_t read_size_t(const void *ptr)
    return ret;
 }
 
+/* Hashes one block, four interleaved FNV-1a lanes over 32-bit words
+ * so the multiplies don't serialize. */
+static uint32_t state_manager_block_hash(const uint8_t *data)
+{
+   size_t i;
+   const uint32_t *words = (const uint32_t*)data;
+   uint32_t h0           = 2166136261u;
+   uint32_t h1           = 2166136261u ^ 1;
+   uint32_t h2           = 2166136261u ^ 2;
+   uint32_t h3           = 2166136261u ^ 3;
+
+   for (i = 0; i < REWIND_BLOCK_SIZE / sizeof(uint32_t); i += 4)
+   {
+      h0 = (h0 ^ words[i + 0]) * 16777619u;
+      h1 = (h1 ^ words[i + 1]) * 16777619u;
+      h2 = (h2 ^ words[i + 2]) * 16777619u;
+      h3 = (h3 ^ words[i + 3]) * 16777619u;
+   }
+
+   h0 = (h0 ^ h1) * 16777619u;
+   h0 = (h0 ^ h2) * 16777619u;
+   return (h0 ^ h3) * 16777619u;
+}
+
+static INLINE uint8_t *state_manager_block_data(
+      state_manager_blocks_t *blocks, uint32_t slot)
+{
+   return blocks->pool + (size_t)slot * REWIND_BLOCK_SIZE;
+}
+
+static INLINE uint32_t *state_manager_blocks_entry(
+      state_manager_blocks_t *blocks, size_t idx)
+{
+   return blocks->entries + ((blocks->first_entry + idx)
+         % blocks->max_entries) * blocks->num_blocks;
+}
+
+static uint32_t state_manager_blocks_lookup(state_manager_blocks_t *blocks,
+      const uint8_t *data, uint32_t hash)
+{
+   size_t pos = hash & blocks->table_mask;
+
+   while (blocks->table[pos])
+   {
+      uint32_t slot = blocks->table[pos] - 1;
+
+      if (     blocks->slot_hash[slot] == hash
+            && !memcmp(state_manager_block_data(blocks, slot),
+               data, REWIND_BLOCK_SIZE))
+         return slot;
+
+      pos = (pos + 1) & blocks->table_mask;
+   }
+
+   return REWIND_BLOCK_NONE;
+}
+
+static void state_manager_blocks_insert(state_manager_blocks_t *blocks,
+      uint32_t slot)
+{
+   size_t pos = blocks->slot_hash[slot] & blocks->table_mask;
+
+   while (blocks->table[pos])
+      pos = (pos + 1) & blocks->table_mask;
+
+   blocks->table[pos] = slot + 1;
+}
+
+/* Linear probing with backward shift deletion, so no tombstones
+ * accumulate over a long play session. */
+static void state_manager_blocks_remove(state_manager_blocks_t *blocks,
+      uint32_t slot)
+{
+   size_t mask = blocks->table_mask;
+   size_t i    = blocks->slot_hash[slot] & mask;
+
+   while (blocks->table[i] != slot + 1)
+      i = (i + 1) & mask;
+
+   for (;;)
+   {
+      size_t j = i;
+
+      blocks->table[i] = 0;
+
+      for (;;)
+      {
+         size_t k;
+
+         j = (j + 1) & mask;
+
+         if (!blocks->table[j])
+            return;
+
+         k = blocks->slot_hash[blocks->table[j] - 1] & mask;
+
+         /* Leave it if its home lies cyclically in (i, j]. */
+         if (i <= j ? (i < k && k <= j) : (i < k || k <= j))
+            continue;
+         break;
+      }
+
+      blocks->table[i] = blocks->table[j];
+      i                = j;
+   }
+}
+
+static void state_manager_blocks_release(state_manager_blocks_t *blocks,
+      uint32_t slot)
+{
+   if (--blocks->slot_refs[slot])
+      return;
+
+   state_manager_blocks_remove(blocks, slot);
+   blocks->free_slots[blocks->num_free++] = slot;
+}
+
+static void state_manager_blocks_drop_oldest(state_manager_blocks_t *blocks)
+{
+   size_t i;
+   uint32_t *entry = state_manager_blocks_entry(blocks, 0);
+
+   for (i = 0; i < blocks->num_blocks; i++)
+      state_manager_blocks_release(blocks, entry[i]);
+
+   blocks->first_entry = (blocks->first_entry + 1) % blocks->max_entries;
+   blocks->num_entries--;
+}
+
+static void state_manager_blocks_store(state_manager_blocks_t *blocks,
+      const uint8_t *data)
+{
+   size_t i;
+   uint32_t *prev  = NULL;
+   uint32_t *entry = NULL;
+
+   if (blocks->num_entries == blocks->max_entries)
+      state_manager_blocks_drop_oldest(blocks);
+
+   if (blocks->num_entries)
+      prev  = state_manager_blocks_entry(blocks, blocks->num_entries - 1);
+   entry    = state_manager_blocks_entry(blocks, blocks->num_entries);
+
+   for (i = 0; i < blocks->num_blocks; i++, data += REWIND_BLOCK_SIZE)
+   {
+      uint32_t hash;
+      uint32_t slot;
+
+      if (prev && !memcmp(state_manager_block_data(blocks, prev[i]),
+               data, REWIND_BLOCK_SIZE))
+         slot = prev[i];
+      else
+      {
+         hash = state_manager_block_hash(data);
+         slot = state_manager_blocks_lookup(blocks, data, hash);
+
+         if (slot == REWIND_BLOCK_NONE)
+         {
+            /* The pool holds at least two full states, so the
+             * previous entry never has to go. */
+            while (!blocks->num_free)
+               state_manager_blocks_drop_oldest(blocks);
+
+            slot                    = blocks->free_slots[--blocks->num_free];
+            blocks->slot_hash[slot] = hash;
+            blocks->slot_refs[slot] = 0;
+            memcpy(state_manager_block_data(blocks, slot),
+                  data, REWIND_BLOCK_SIZE);
+            state_manager_blocks_insert(blocks, slot);
+         }
+      }
+
+      blocks->slot_refs[slot]++;
+      entry[i] = slot;
+   }
+
+   blocks->num_entries++;
+}
+
+#ifdef HAVE_THREADS
+static void state_manager_blocks_thread(void *data)
+{
+   state_manager_blocks_t *blocks = (state_manager_blocks_t*)data;
+
+   slock_lock(blocks->lock);
+
+   for (;;)
+   {
+      uint8_t *job = NULL;
+
+      while (!blocks->job && !blocks->quit)
+         scond_wait(blocks->cond, blocks->lock);
+
+      if (blocks->quit)
+         break;
+
+      job = blocks->job;
+      slock_unlock(blocks->lock);
+
+      state_manager_blocks_store(blocks, job);
+
+      slock_lock(blocks->lock);
+      blocks->job = NULL;
+      scond_broadcast(blocks->cond);
+   }
+
+   slock_unlock(blocks->lock);
+}
+#endif
+
+static void state_manager_blocks_wait(state_manager_blocks_t *blocks)
+{
+#ifdef HAVE_THREADS
+   if (!blocks->thread)
+      return;
+
+   slock_lock(blocks->lock);
+   while (blocks->job)
+      scond_wait(blocks->cond, blocks->lock);
+   slock_unlock(blocks->lock);
+#endif
+}
+
+static void state_manager_blocks_free(state_manager_blocks_t *blocks)
+{
+   if (!blocks)
+      return;
+
+#ifdef HAVE_THREADS
+   if (blocks->thread)
+   {
+      slock_lock(blocks->lock);
+      blocks->quit = true;
+      scond_broadcast(blocks->cond);
+      slock_unlock(blocks->lock);
+      sthread_join(blocks->thread);
+   }
+   if (blocks->lock)
+      slock_free(blocks->lock);
+   if (blocks->cond)
+      scond_free(blocks->cond);
+#endif
+
+   free(blocks->pool);
+   free(blocks->capture[0]);
+   free(blocks->capture[1]);
+   free(blocks->output);
+   free(blocks->slot_hash);
+   free(blocks->slot_refs);
+   free(blocks->free_slots);
+   free(blocks->table);
+   free(blocks->entries);
+   free(blocks);
+}
+
+static state_manager_blocks_t *state_manager_blocks_new(
+      size_t state_size, size_t buffer_size)
+{
+   size_t i, entry_size, slot_size, table_size;
+   state_manager_blocks_t *blocks = NULL;
+   size_t num_blocks              = (state_size + REWIND_BLOCK_SIZE - 1)
+      / REWIND_BLOCK_SIZE;
+   size_t padded_size             = num_blocks * REWIND_BLOCK_SIZE;
+
+   if (!num_blocks)
+      return NULL;
+
+   /* An eighth of the budget goes to the entry indices,
+    * the rest to the pool itself. */
+   entry_size  = num_blocks * sizeof(uint32_t);
+   slot_size   = REWIND_BLOCK_SIZE + 5 * sizeof(uint32_t);
+
+   blocks      = (state_manager_blocks_t*)calloc(1, sizeof(*blocks));
+   if (!blocks)
+      return NULL;
+
+   blocks->num_blocks  = num_blocks;
+   blocks->max_entries = buffer_size / 8 / entry_size;
+   if (blocks->max_entries < 2)
+      blocks->max_entries = 2;
+
+   if (buffer_size < blocks->max_entries * entry_size)
+      goto error;
+
+   blocks->num_slots   = (buffer_size - blocks->max_entries * entry_size)
+      / slot_size;
+   if (blocks->num_slots < num_blocks * 2
+         || blocks->num_slots >= REWIND_BLOCK_NONE)
+      goto error;
+
+   for (table_size = 1; table_size < blocks->num_slots * 2; )
+      table_size <<= 1;
+   blocks->table_mask  = table_size - 1;
+
+   blocks->pool        = (uint8_t*)malloc(
+         blocks->num_slots * REWIND_BLOCK_SIZE);
+   /* Zeroed so the padding of the last block never differs. */
+   blocks->capture[0]  = (uint8_t*)calloc(padded_size, 1);
+   blocks->capture[1]  = (uint8_t*)calloc(padded_size, 1);
+   blocks->output      = (uint8_t*)calloc(padded_size, 1);
+   blocks->slot_hash   = (uint32_t*)malloc(
+         blocks->num_slots * sizeof(uint32_t));
+   blocks->slot_refs   = (uint32_t*)calloc(
+         blocks->num_slots, sizeof(uint32_t));
+   blocks->free_slots  = (uint32_t*)malloc(
+         blocks->num_slots * sizeof(uint32_t));
+   blocks->table       = (uint32_t*)calloc(table_size, sizeof(uint32_t));
+   blocks->entries     = (uint32_t*)malloc(
+         blocks->max_entries * entry_size);
+
+   if (     !blocks->pool
+         || !blocks->capture[0]
+         || !blocks->capture[1]
+         || !blocks->output
+         || !blocks->slot_hash
+         || !blocks->slot_refs
+         || !blocks->free_slots
+         || !blocks->table
+         || !blocks->entries)
+      goto error;
+
+   /* Hand out low slots first. */
+   for (i = 0; i < blocks->num_slots; i++)
+      blocks->free_slots[i] = (uint32_t)(blocks->num_slots - 1 - i);
+   blocks->num_free = blocks->num_slots;
+
+#ifdef HAVE_THREADS
+   blocks->lock   = slock_new();
+   blocks->cond   = scond_new();
+
+   if (blocks->lock && blocks->cond)
+      blocks->thread = sthread_create(state_manager_blocks_thread, blocks);
+
+   /* Without a worker, diffing simply runs in state_manager_push_do. */
+   if (!blocks->thread)
+      RARCH_WARN("Rewind: could not start worker thread, diffing on main thread.\n");
+#endif
+
+   return blocks;
+
+error:
+   state_manager_blocks_free(blocks);
+   return NULL;
+}
+
+static bool state_manager_blocks_pop(state_manager_blocks_t *blocks,
+      const void **data)
+{
+   size_t i;
+   uint32_t *entry = NULL;
+
+   state_manager_blocks_wait(blocks);
+
+   *data = blocks->output;
+
+   if (!blocks->num_entries)
+      return false;
+
+   entry = state_manager_blocks_entry(blocks, blocks->num_entries - 1);
+
+   for (i = 0; i < blocks->num_blocks; i++)
+   {
+      memcpy(blocks->output + i * REWIND_BLOCK_SIZE,
+            state_manager_block_data(blocks, entry[i]), REWIND_BLOCK_SIZE);
+      state_manager_blocks_release(blocks, entry[i]);
+   }
+
+   blocks->num_entries--;
+   return true;
+}
+
+static void state_manager_blocks_push_do(state_manager_blocks_t *blocks)
+{
+   uint8_t *job = blocks->capture[blocks->capture_index];
+
+   blocks->capture_index ^= 1;
+
+#ifdef HAVE_THREADS
+   if (blocks->thread)
+   {
+      slock_lock(blocks->lock);
+      while (blocks->job)
+         scond_wait(blocks->cond, blocks->lock);
+      blocks->job = job;
+      scond_broadcast(blocks->cond);
+      slock_unlock(blocks->lock);
+      return;
+   }
+#endif
+
+   state_manager_blocks_store(blocks, job);
+}
+
 static void state_manager_free(state_manager_t *state)
 {
    if (!state)
       return;
 
+   if (state->blocks)
+      state_manager_blocks_free(state->blocks);
+   state->blocks     = NULL;
+
    if (state->data)
       free(state->data);
    if (state->thisblock)
@@ -428,7 +876,8 @@ static void state_manager_free(state_manager_t *state)
    state->nextblock  = NULL;
 }
 
-static state_manager_t *state_manager_new(size_t state_size, size_t buffer_size)
+static state_manager_t *state_manager_new(size_t state_size,
+      size_t buffer_size, bool block_dedup)
 {
    size_t max_comp_size, block_size;
    uint8_t *next_block    = NULL;
@@ -439,6 +888,16 @@ static state_manager_t *state_manager_new(size_t state_size, size_t buffer_size)
    if (!state)
       return NULL;
 
+   if (block_dedup)
+   {
+      state->blocks = state_manager_blocks_new(state_size, buffer_size);
+      if (state->blocks)
+         return state;
+
+      RARCH_WARN("Rewind: buffer too small for block deduplication, "
+            "falling back to delta compression.\n");
+   }
+
    block_size         = (state_size + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
 
    /* the compressed data is surrounded by pointers to the other side */
@@ -488,6 +947,9 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
 
    *data = NULL;
 
+   if (state->blocks)
+      return state_manager_blocks_pop(state->blocks, data);
+
    if (state->thisblock_valid)
    {
       state->thisblock_valid = false;
@@ -519,6 +981,14 @@ static void state_manager_push_where(state_manager_t *state, void **data)
     * pushed state, or we could end up applying a 'patch' to wrong
     * savestate, and that'd blow up rather quickly. */
 
+   if (state->blocks)
+   {
+      /* Diffing is against the pool, the other capture
+       * buffer may still be in use by the worker. */
+      *data = state->blocks->capture[state->blocks->capture_index];
+      return;
+   }
+
    if (!state->thisblock_valid)
    {
       const void *ignored;
@@ -539,6 +1009,12 @@ static void state_manager_push_do(state_manager_t *state)
 {
    uint8_t *swap = NULL;
 
+   if (state->blocks)
+   {
+      state_manager_blocks_push_do(state->blocks);
+      return;
+   }
+
 #if STRICT_BUF_SIZE
    memcpy(state->nextblock, state->debugblock, state->debugsize);
 #endif
@@ -611,7 +1087,8 @@ static void state_manager_capacity(state_manager_t *state,
 }
 #endif
 
-void state_manager_event_init(unsigned rewind_buffer_size)
+void state_manager_event_init(unsigned rewind_buffer_size,
+      bool block_dedup)
 {
    retro_ctx_serialize_info_t serial_info;
    retro_ctx_size_info_t info;
@@ -642,7 +1119,7 @@ void state_manager_event_init(unsigned rewind_buffer_size)
          (unsigned)(rewind_buffer_size / 1000000));
 
    rewind_state.state = state_manager_new(rewind_state.size,
-         rewind_buffer_size);
+         rewind_buffer_size, block_dedup);
 
    if (!rewind_state.state)
       RARCH_WARN("%s.\n", msg_hash_to_str(MSG_REWIND_INIT_FAILED));
@@ -32,7 +32,15 @@ bool state_manager_frame_is_reversed(void);
 
 void state_manager_event_deinit(void);
 
-void state_manager_event_init(unsigned rewind_buffer_size);
+/**
+ * state_manager_event_init:
+ * @rewind_buffer_size   : memory budget for the rewind history, in bytes.
+ * @block_dedup          : store history as deduplicated blocks,
+ *                         diffed on a worker thread. Meant for cores with
+ *                         large savestates.
+ **/
+void state_manager_event_init(unsigned rewind_buffer_size,
+      bool block_dedup);
 
 /**
  * check_rewind:
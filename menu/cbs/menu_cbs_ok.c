@@ -1033,6 +1033,7 @@ static void content_add_to_playlist(const char *path)
          settings->paths.path_content_database,
          path, false,
          settings->bools.show_hidden_files,
+         settings->uints.database_scan_threads,
          handle_dbscan_finished);
 #endif
 }
@@ -66,6 +66,7 @@ int action_scan_file(const char *path,
          settings->paths.path_content_database,
          fullpath, false,
          settings->bools.show_hidden_files,
+         settings->uints.database_scan_threads,
          handle_dbscan_finished);
 
    return 0;
@@ -94,6 +95,7 @@ int action_scan_directory(const char *path,
          settings->paths.path_content_database,
          fullpath, true,
          settings->bools.show_hidden_files,
+         settings->uints.database_scan_threads,
          handle_dbscan_finished);
 
    return 0;
@@ -1925,30 +1925,29 @@ static void materialui_preswitch_tabs(materialui_handle_t *mui, unsigned action)
    menu_stack = menu_entries_get_menu_stack_ptr(0);
    stack_size = menu_stack->size;
 
-   if (menu_stack->list[stack_size - 1].label)
-      free(menu_stack->list[stack_size - 1].label);
-   menu_stack->list[stack_size - 1].label = NULL;
-
    switch (mui->categories_selection_ptr)
    {
       case MUI_SYSTEM_TAB_MAIN:
-         menu_stack->list[stack_size - 1].label =
-            strdup(msg_hash_to_str(MENU_ENUM_LABEL_MAIN_MENU));
+         file_list_set_label_at_offset(menu_stack, stack_size - 1,
+            msg_hash_to_str(MENU_ENUM_LABEL_MAIN_MENU));
          menu_stack->list[stack_size - 1].type =
             MENU_SETTINGS;
          break;
       case MUI_SYSTEM_TAB_PLAYLISTS:
-         menu_stack->list[stack_size - 1].label =
-            strdup(msg_hash_to_str(MENU_ENUM_LABEL_PLAYLISTS_TAB));
+         file_list_set_label_at_offset(menu_stack, stack_size - 1,
+            msg_hash_to_str(MENU_ENUM_LABEL_PLAYLISTS_TAB));
          menu_stack->list[stack_size - 1].type =
             MENU_PLAYLISTS_TAB;
          break;
       case MUI_SYSTEM_TAB_SETTINGS:
-         menu_stack->list[stack_size - 1].label =
-            strdup(msg_hash_to_str(MENU_ENUM_LABEL_SETTINGS_TAB));
+         file_list_set_label_at_offset(menu_stack, stack_size - 1,
+            msg_hash_to_str(MENU_ENUM_LABEL_SETTINGS_TAB));
          menu_stack->list[stack_size - 1].type =
             MENU_SETTINGS;
          break;
+      default:
+         file_list_set_label_at_offset(menu_stack, stack_size - 1, NULL);
+         break;
    }
 }
 
@@ -4685,75 +4685,71 @@ static void xmb_list_cache(void *data, enum menu_list_type type, unsigned action
 
          stack_size = menu_stack->size;
 
-         if (menu_stack->list[stack_size - 1].label)
-            free(menu_stack->list[stack_size - 1].label);
-         menu_stack->list[stack_size - 1].label = NULL;
-
          switch (xmb_get_system_tab(xmb, (unsigned)xmb->categories_selection_ptr))
          {
             case XMB_SYSTEM_TAB_MAIN:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_MAIN_MENU));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                  msg_hash_to_str(MENU_ENUM_LABEL_MAIN_MENU));
                menu_stack->list[stack_size - 1].type =
                   MENU_SETTINGS;
                break;
             case XMB_SYSTEM_TAB_SETTINGS:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_SETTINGS_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                  msg_hash_to_str(MENU_ENUM_LABEL_SETTINGS_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_SETTINGS_TAB;
                break;
 #ifdef HAVE_IMAGEVIEWER
             case XMB_SYSTEM_TAB_IMAGES:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_IMAGES_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                  msg_hash_to_str(MENU_ENUM_LABEL_IMAGES_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_IMAGES_TAB;
                break;
 #endif
             case XMB_SYSTEM_TAB_MUSIC:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_MUSIC_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                  msg_hash_to_str(MENU_ENUM_LABEL_MUSIC_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_MUSIC_TAB;
                break;
 #ifdef HAVE_FFMPEG
             case XMB_SYSTEM_TAB_VIDEO:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_VIDEO_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                  msg_hash_to_str(MENU_ENUM_LABEL_VIDEO_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_VIDEO_TAB;
                break;
 #endif
             case XMB_SYSTEM_TAB_HISTORY:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_HISTORY_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                  msg_hash_to_str(MENU_ENUM_LABEL_HISTORY_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_HISTORY_TAB;
                break;
             case XMB_SYSTEM_TAB_FAVORITES:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_FAVORITES_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                  msg_hash_to_str(MENU_ENUM_LABEL_FAVORITES_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_FAVORITES_TAB;
                break;
 #ifdef HAVE_NETWORKING
             case XMB_SYSTEM_TAB_NETPLAY:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_NETPLAY_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                  msg_hash_to_str(MENU_ENUM_LABEL_NETPLAY_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_NETPLAY_TAB;
                break;
 #endif
             case XMB_SYSTEM_TAB_ADD:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_ADD_TAB));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                  msg_hash_to_str(MENU_ENUM_LABEL_ADD_TAB));
                menu_stack->list[stack_size - 1].type =
                   MENU_ADD_TAB;
                break;
             default:
-               menu_stack->list[stack_size - 1].label =
-                  strdup(msg_hash_to_str(MENU_ENUM_LABEL_HORIZONTAL_MENU));
+               file_list_set_label_at_offset(menu_stack, stack_size - 1,
+                  msg_hash_to_str(MENU_ENUM_LABEL_HORIZONTAL_MENU));
                menu_stack->list[stack_size - 1].type =
                   MENU_SETTING_HORIZONTAL_MENU;
                break;
@@ -2807,7 +2807,7 @@ static bool setting_append_list(
       case SETTINGS_LIST_SAVING:
          {
             uint8_t i;
-            struct bool_entry bool_entries[11];
+            struct bool_entry bool_entries[12];
 
             START_GROUP(list, list_info, &group_info, msg_hash_to_str(MENU_ENUM_LABEL_VALUE_SAVING_SETTINGS), parent_group);
             parent_group = msg_hash_to_str(MENU_ENUM_LABEL_SAVING_SETTINGS);
@@ -2881,6 +2881,12 @@ static bool setting_append_list(
             bool_entries[10].default_value  = default_screenshots_in_content_dir;
             bool_entries[10].flags          = SD_FLAG_ADVANCED;
 
+            bool_entries[11].target         = &settings->bools.savestate_file_compression;
+            bool_entries[11].name_enum_idx  = MENU_ENUM_LABEL_SAVESTATE_FILE_COMPRESSION;
+            bool_entries[11].SHORT_enum_idx = MENU_ENUM_LABEL_VALUE_SAVESTATE_FILE_COMPRESSION;
+            bool_entries[11].default_value  = savestate_file_compression;
+            bool_entries[11].flags          = SD_FLAG_NONE;
+
             for (i = 0; i < ARRAY_SIZE(bool_entries); i++)
             {
                CONFIG_BOOL(
@@ -34,6 +34,23 @@
 #include "command.h"
 #include "file_path_special.h"
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+/* Input samples are streamed through fixed-size blocks instead of
+ * hitting the stream layer for every 2-byte sample. While one block
+ * is consumed (playback) or filled (recording), the other one is
+ * prefetched or written behind on a worker thread. */
+#define BSV_MOVIE_BLOCK_SIZE (64 * 1024)
+
+typedef struct bsv_movie_block
+{
+   uint8_t *data;
+   int64_t offset;   /* file offset of data[0] */
+   size_t len;       /* valid bytes in data */
+} bsv_movie_block_t;
+
 struct bsv_movie
 {
    intfstream_t *file;
@@ -49,6 +66,21 @@ struct bsv_movie
    size_t state_size;
    uint8_t *state;
 
+   /* Block being consumed or filled on the main thread,
+    * and the one owned by the worker. */
+   bsv_movie_block_t block;
+   bsv_movie_block_t pending;
+   size_t block_pos;
+   bool pending_write;
+
+#ifdef HAVE_THREADS
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   bool busy;
+   bool quit;
+#endif
+
    bool playback;
    bool first_rewind;
    bool did_rewind;
@@ -71,6 +103,267 @@ struct bsv_state
 static bsv_movie_t     *bsv_movie_state_handle = NULL;
 static struct bsv_state bsv_movie_state;
 
+static void bsv_movie_block_io(bsv_movie_t *handle,
+      bsv_movie_block_t *block, bool write)
+{
+   intfstream_seek(handle->file, block->offset, SEEK_SET);
+
+   if (write)
+   {
+      if (block->len)
+         intfstream_write(handle->file, block->data, block->len);
+   }
+   else
+   {
+      int64_t ret = intfstream_read(handle->file,
+            block->data, BSV_MOVIE_BLOCK_SIZE);
+      block->len  = ret > 0 ? (size_t)ret : 0;
+   }
+}
+
+#ifdef HAVE_THREADS
+static void bsv_movie_io_thread(void *data)
+{
+   bsv_movie_t *handle = (bsv_movie_t*)data;
+
+   slock_lock(handle->lock);
+
+   for (;;)
+   {
+      while (!handle->busy && !handle->quit)
+         scond_wait(handle->cond, handle->lock);
+
+      if (handle->quit)
+         break;
+
+      slock_unlock(handle->lock);
+      bsv_movie_block_io(handle, &handle->pending, handle->pending_write);
+      slock_lock(handle->lock);
+
+      handle->busy = false;
+      scond_signal(handle->cond);
+   }
+
+   slock_unlock(handle->lock);
+}
+#endif
+
+/* Waits until the worker is done with the pending block. */
+static void bsv_movie_io_wait(bsv_movie_t *handle)
+{
+#ifdef HAVE_THREADS
+   if (!handle->thread)
+      return;
+
+   slock_lock(handle->lock);
+   while (handle->busy)
+      scond_wait(handle->cond, handle->lock);
+   slock_unlock(handle->lock);
+#endif
+}
+
+/* Hands the pending block to the worker, or performs the
+ * transfer right away when there is no worker. */
+static void bsv_movie_io_start(bsv_movie_t *handle, bool write)
+{
+   handle->pending_write = write;
+
+#ifdef HAVE_THREADS
+   if (handle->thread)
+   {
+      slock_lock(handle->lock);
+      handle->busy = true;
+      scond_signal(handle->cond);
+      slock_unlock(handle->lock);
+      return;
+   }
+#endif
+
+   bsv_movie_block_io(handle, &handle->pending, write);
+}
+
+static void bsv_movie_swap_blocks(bsv_movie_t *handle)
+{
+   bsv_movie_block_t tmp = handle->block;
+   handle->block         = handle->pending;
+   handle->pending       = tmp;
+}
+
+/* Prefetches the block following the current one,
+ * unless the current one already hit the end of the file. */
+static void bsv_movie_prefetch(bsv_movie_t *handle)
+{
+   handle->pending.offset = handle->block.offset + handle->block.len;
+   handle->pending.len    = 0;
+
+   if (handle->block.len == BSV_MOVIE_BLOCK_SIZE)
+      bsv_movie_io_start(handle, false);
+}
+
+static void bsv_movie_load_block(bsv_movie_t *handle, int64_t offset)
+{
+   bsv_movie_io_wait(handle);
+
+   handle->block.offset = offset;
+   handle->block_pos    = 0;
+   bsv_movie_block_io(handle, &handle->block, false);
+
+   bsv_movie_prefetch(handle);
+}
+
+static size_t bsv_movie_read(bsv_movie_t *handle, void *data, size_t len)
+{
+   uint8_t *out = (uint8_t*)data;
+   size_t done  = 0;
+
+   while (done < len)
+   {
+      size_t chunk;
+
+      if (handle->block_pos == handle->block.len)
+      {
+         /* A short block means end of file */
+         if (handle->block.len < BSV_MOVIE_BLOCK_SIZE)
+            break;
+
+         bsv_movie_io_wait(handle);
+         bsv_movie_swap_blocks(handle);
+         handle->block_pos = 0;
+
+         if (!handle->block.len)
+            break;
+
+         bsv_movie_prefetch(handle);
+      }
+
+      chunk = handle->block.len - handle->block_pos;
+      if (chunk > len - done)
+         chunk = len - done;
+
+      memcpy(out + done, handle->block.data + handle->block_pos, chunk);
+      handle->block_pos += chunk;
+      done              += chunk;
+   }
+
+   return done;
+}
+
+static void bsv_movie_write(bsv_movie_t *handle,
+      const void *data, size_t len)
+{
+   const uint8_t *in = (const uint8_t*)data;
+
+   while (len)
+   {
+      size_t chunk = BSV_MOVIE_BLOCK_SIZE - handle->block.len;
+
+      if (chunk > len)
+         chunk = len;
+
+      memcpy(handle->block.data + handle->block.len, in, chunk);
+      handle->block.len += chunk;
+      in                += chunk;
+      len               -= chunk;
+
+      if (handle->block.len == BSV_MOVIE_BLOCK_SIZE)
+      {
+         bsv_movie_io_wait(handle);
+         bsv_movie_swap_blocks(handle);
+         handle->block.offset = handle->pending.offset + handle->pending.len;
+         handle->block.len    = 0;
+         bsv_movie_io_start(handle, true);
+      }
+   }
+}
+
+static int64_t bsv_movie_tell(bsv_movie_t *handle)
+{
+   if (handle->playback)
+      return handle->block.offset + handle->block_pos;
+   return handle->block.offset + handle->block.len;
+}
+
+static void bsv_movie_seek(bsv_movie_t *handle, int64_t offset)
+{
+   int64_t end = handle->block.offset + handle->block.len;
+
+   if (offset >= handle->block.offset && offset <= end)
+   {
+      if (handle->playback)
+         handle->block_pos = (size_t)(offset - handle->block.offset);
+      else
+         handle->block.len = (size_t)(offset - handle->block.offset);
+      return;
+   }
+
+   if (handle->playback)
+      bsv_movie_load_block(handle, offset);
+   else
+   {
+      /* Recording continues from an earlier position,
+       * whatever follows it gets overwritten. */
+      bsv_movie_io_wait(handle);
+      handle->block.offset = offset;
+      handle->block.len    = 0;
+   }
+}
+
+static bool bsv_movie_init_blocks(bsv_movie_t *handle)
+{
+   handle->block.data   = (uint8_t*)malloc(BSV_MOVIE_BLOCK_SIZE);
+   handle->pending.data = (uint8_t*)malloc(BSV_MOVIE_BLOCK_SIZE);
+
+   if (!handle->block.data || !handle->pending.data)
+      return false;
+
+   handle->block.offset = handle->min_file_pos;
+
+#ifdef HAVE_THREADS
+   handle->lock         = slock_new();
+   handle->cond         = scond_new();
+
+   if (handle->lock && handle->cond)
+      handle->thread    = sthread_create(bsv_movie_io_thread, handle);
+#endif
+
+   if (handle->playback)
+      bsv_movie_load_block(handle, handle->min_file_pos);
+
+   return true;
+}
+
+static void bsv_movie_deinit_blocks(bsv_movie_t *handle)
+{
+   bsv_movie_io_wait(handle);
+
+   /* Write out what is left of the recording */
+   if (!handle->playback && handle->block.data && handle->file)
+      bsv_movie_block_io(handle, &handle->block, true);
+
+#ifdef HAVE_THREADS
+   if (handle->thread)
+   {
+      slock_lock(handle->lock);
+      handle->quit = true;
+      scond_signal(handle->cond);
+      slock_unlock(handle->lock);
+      sthread_join(handle->thread);
+   }
+   if (handle->lock)
+      slock_free(handle->lock);
+   if (handle->cond)
+      scond_free(handle->cond);
+   handle->thread = NULL;
+   handle->lock   = NULL;
+   handle->cond   = NULL;
+#endif
+
+   free(handle->block.data);
+   free(handle->pending.data);
+   handle->block.data   = NULL;
+   handle->pending.data = NULL;
+}
+
 static bool bsv_movie_init_playback(bsv_movie_t *handle, const char *path)
 {
    uint32_t state_size       = 0;
@@ -217,6 +510,8 @@ static void bsv_movie_free(bsv_movie_t *handle)
    if (!handle)
       return;
 
+   bsv_movie_deinit_blocks(handle);
+
    intfstream_close(handle->file);
    free(handle->file);
 
@@ -242,6 +537,9 @@ static bsv_movie_t *bsv_movie_init_internal(const char *path,
    else if (!bsv_movie_init_record(handle, path))
       goto error;
 
+   if (!bsv_movie_init_blocks(handle))
+      goto error;
+
    /* Just pick something really large
     * ~1 million frames rewind should do the trick. */
    if (!(frame_pos = (size_t*)calloc((1 << 20), sizeof(size_t))))
@@ -264,7 +562,7 @@ void bsv_movie_set_frame_start(void)
 {
    if (bsv_movie_state_handle)
       bsv_movie_state_handle->frame_pos[bsv_movie_state_handle->frame_ptr]
-         = intfstream_tell(bsv_movie_state_handle->file);
+         = (size_t)bsv_movie_tell(bsv_movie_state_handle);
 }
 
 void bsv_movie_set_frame_end(void)
@@ -290,7 +588,7 @@ static void bsv_movie_frame_rewind(bsv_movie_t *handle)
    {
       /* If we're at the beginning... */
       handle->frame_ptr = 0;
-      intfstream_seek(handle->file, (int)handle->min_file_pos, SEEK_SET);
+      bsv_movie_seek(handle, handle->min_file_pos);
    }
    else
    {
@@ -302,11 +600,10 @@ static void bsv_movie_frame_rewind(bsv_movie_t *handle)
        * plus another. */
       handle->frame_ptr = (handle->frame_ptr -
             (handle->first_rewind ? 1 : 2)) & handle->frame_mask;
-      intfstream_seek(handle->file,
-            (int)handle->frame_pos[handle->frame_ptr], SEEK_SET);
+      bsv_movie_seek(handle, handle->frame_pos[handle->frame_ptr]);
    }
 
-   if (intfstream_tell(handle->file) <= (long)handle->min_file_pos)
+   if (bsv_movie_tell(handle) <= (int64_t)handle->min_file_pos)
    {
       /* We rewound past the beginning. */
 
@@ -317,6 +614,9 @@ static void bsv_movie_frame_rewind(bsv_movie_t *handle)
          /* If recording, we simply reset
           * the starting point. Nice and easy. */
 
+         bsv_movie_seek(handle, handle->min_file_pos);
+         bsv_movie_io_wait(handle);
+
          intfstream_seek(handle->file, 4 * sizeof(uint32_t), SEEK_SET);
 
          serial_info.data = handle->state;
@@ -327,7 +627,7 @@ static void bsv_movie_frame_rewind(bsv_movie_t *handle)
          intfstream_write(handle->file, handle->state, handle->state_size);
       }
       else
-         intfstream_seek(handle->file, (int)handle->min_file_pos, SEEK_SET);
+         bsv_movie_seek(handle, handle->min_file_pos);
    }
 }
 
@@ -395,7 +695,8 @@ bool bsv_movie_init(void)
 
 bool bsv_movie_get_input(int16_t *bsv_data)
 {
-   if (intfstream_read(bsv_movie_state_handle->file, bsv_data, 1) != 1)
+   if (bsv_movie_read(bsv_movie_state_handle,
+            bsv_data, sizeof(*bsv_data)) != sizeof(*bsv_data))
       return false;
 
    *bsv_data = swap_if_big16(*bsv_data);
@@ -456,7 +757,8 @@ bool bsv_movie_ctl(enum bsv_ctl_state state, void *data)
             int16_t *bsv_data = (int16_t*)data;
 
             *bsv_data = swap_if_big16(*bsv_data);
-            intfstream_write(bsv_movie_state_handle->file, bsv_data, 1);
+            bsv_movie_write(bsv_movie_state_handle,
+                  bsv_data, sizeof(*bsv_data));
          }
          break;
       case BSV_MOVIE_CTL_NONE:
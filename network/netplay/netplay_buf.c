@@ -13,11 +13,22 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#if !defined(_WIN32) && !defined(HAVE_SOCKET_LEGACY) && \
+   (defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__) || \
+    defined(__NetBSD__) || defined(__OpenBSD__))
+#define HAVE_NETPLAY_SENDMSG
+#endif
+
 #include <stdlib.h>
+#include <string.h>
 
 #include <net/net_compat.h>
 #include <net/net_socket.h>
 
+#ifdef HAVE_NETPLAY_SENDMSG
+#include <sys/uio.h>
+#endif
+
 #include "netplay_private.h"
 
 static size_t buf_used(struct socket_buffer *sbuf)
@@ -235,6 +246,112 @@ bool netplay_send_flush(struct socket_buffer *sbuf, int sockfd, bool block)
    return true;
 }
 
+/* Most chunks netplay_sendv sends at once, any more are simply queued */
+#define NETPLAY_SENDV_CHUNKS 8
+
+/**
+ * netplay_sendv
+ *
+ * Queue the given chunks for sending and flush without blocking. Data
+ * already queued and the new chunks go out in a single vectored send where
+ * supported, so only what the socket doesn't take is copied into the buffer.
+ *
+ * Returns false only on socket failures, true otherwise.
+ */
+bool netplay_sendv(struct socket_buffer *sbuf, int sockfd,
+   const struct netplay_send_chunk *chunks, size_t count)
+{
+   size_t i;
+
+#ifdef HAVE_NETPLAY_SENDMSG
+   if (count <= NETPLAY_SENDV_CHUNKS)
+   {
+      struct iovec iov[NETPLAY_SENDV_CHUNKS + 2];
+      struct msghdr msg;
+      ssize_t sent;
+      size_t used   = buf_used(sbuf);
+      size_t iovcnt = 0;
+
+      /* Anything still queued goes first, possibly in two pieces */
+      if (used)
+      {
+         if (sbuf->end > sbuf->start)
+         {
+            iov[iovcnt].iov_base = sbuf->data + sbuf->start;
+            iov[iovcnt++].iov_len = used;
+         }
+         else
+         {
+            iov[iovcnt].iov_base = sbuf->data + sbuf->start;
+            iov[iovcnt++].iov_len = sbuf->bufsz - sbuf->start;
+            if (sbuf->end)
+            {
+               iov[iovcnt].iov_base = sbuf->data;
+               iov[iovcnt++].iov_len = sbuf->end;
+            }
+         }
+      }
+
+      for (i = 0; i < count; i++)
+      {
+         if (!chunks[i].len)
+            continue;
+         iov[iovcnt].iov_base = (void*)chunks[i].data;
+         iov[iovcnt++].iov_len = chunks[i].len;
+      }
+
+      if (!iovcnt)
+         return true;
+
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_iov    = iov;
+      msg.msg_iovlen = iovcnt;
+
+      sent = sendmsg(sockfd, &msg, MSG_NOSIGNAL);
+      if (sent < 0)
+      {
+         if (!isagain((int)sent))
+            return false;
+         sent = 0;
+      }
+
+      /* Retire what was sent from the queue... */
+      if (used)
+      {
+         size_t done = ((size_t)sent < used) ? (size_t)sent : used;
+         sbuf->start = (sbuf->start + done) % sbuf->bufsz;
+         if (sbuf->start == sbuf->end)
+            sbuf->start = sbuf->end = 0;
+         sent -= done;
+      }
+
+      /* ...and queue whatever is left of the new chunks */
+      for (i = 0; i < count; i++)
+      {
+         if ((size_t)sent >= chunks[i].len)
+         {
+            sent -= chunks[i].len;
+            continue;
+         }
+
+         if (!netplay_send(sbuf, sockfd,
+               (const unsigned char*)chunks[i].data + sent,
+               chunks[i].len - sent))
+            return false;
+         sent = 0;
+      }
+
+      return true;
+   }
+#endif
+
+   for (i = 0; i < count; i++)
+      if (!netplay_send(sbuf, sockfd, chunks[i].data, chunks[i].len))
+         return false;
+
+   return netplay_send_flush(sbuf, sockfd, false);
+}
+
 /**
  * netplay_recv
  *
@@ -354,3 +471,13 @@ void netplay_recv_flush(struct socket_buffer *sbuf)
 {
    sbuf->start = sbuf->read;
 }
+
+/**
+ * netplay_recv_pending
+ *
+ * Is there received data in the buffer that hasn't been read yet?
+ */
+bool netplay_recv_pending(struct socket_buffer *sbuf)
+{
+   return buf_unread(sbuf) > 0;
+}
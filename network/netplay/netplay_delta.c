@@ -16,6 +16,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 
 #include <boolean.h>
@@ -57,6 +58,7 @@ bool netplay_delta_frame_ready(netplay_t *netplay, struct delta_frame *delta,
    delta->used = true;
    delta->frame = frame;
    delta->crc = 0;
+   delta->state_skipped = false;
    for (i = 0; i < MAX_INPUT_DEVICES; i++)
    {
       clear_input(delta->resolved_input[i]);
@@ -187,3 +189,158 @@ uint32_t netplay_expected_input_size(netplay_t *netplay, uint32_t devices)
    }
    return ret;
 }
+
+static size_t netplay_delta_bitmap_size(size_t state_size)
+{
+   size_t blocks = (state_size + NETPLAY_DELTA_BLOCK_SIZE - 1) /
+      NETPLAY_DELTA_BLOCK_SIZE;
+   return (blocks + 7) / 8;
+}
+
+/**
+ * netplay_delta_state_init
+ *
+ * Allocate the buffers used for savestate deltas. Failure only disables
+ * deltas.
+ */
+void netplay_delta_state_init(netplay_t *netplay)
+{
+   netplay->delta_base_valid  = false;
+   netplay->delta_buffer_size = netplay_delta_bitmap_size(netplay->state_size)
+      + netplay->state_size;
+   netplay->delta_base        = (uint8_t*)malloc(netplay->state_size);
+   netplay->delta_buffer      = (uint8_t*)malloc(netplay->delta_buffer_size);
+
+   if (!netplay->delta_base || !netplay->delta_buffer)
+   {
+      free(netplay->delta_base);
+      free(netplay->delta_buffer);
+      netplay->delta_base        = NULL;
+      netplay->delta_buffer      = NULL;
+      netplay->delta_buffer_size = 0;
+   }
+}
+
+/**
+ * netplay_delta_state_set_base
+ *
+ * Remember a savestate that was just sent to or received from our peers as
+ * the base for future deltas.
+ */
+void netplay_delta_state_set_base(netplay_t *netplay, const void *state,
+      uint32_t frame)
+{
+   if (!netplay->delta_base)
+      return;
+
+   memcpy(netplay->delta_base, state, netplay->state_size);
+   netplay->delta_base_frame = frame;
+   netplay->delta_base_crc   = encoding_crc32(0L,
+         (const unsigned char*)netplay->delta_base, netplay->state_size);
+   netplay->delta_base_valid = true;
+}
+
+/**
+ * netplay_delta_state_encode
+ *
+ * Encode a savestate as a block delta against the base into
+ * netplay->delta_buffer: a bitmap of changed blocks, followed by each changed
+ * block XORed with the base so that the compressor sees mostly zeroes.
+ *
+ * Returns: The size of the delta, or 0 if there is no base or the delta
+ * would not be smaller than the state itself.
+ */
+size_t netplay_delta_state_encode(netplay_t *netplay, const uint8_t *state)
+{
+   size_t i, j, offset;
+   size_t state_size    = netplay->state_size;
+   size_t out           = netplay_delta_bitmap_size(state_size);
+   uint8_t *bitmap      = netplay->delta_buffer;
+   const uint8_t *base  = netplay->delta_base;
+
+   if (!netplay->delta_base_valid || !netplay->delta_buffer)
+      return 0;
+
+   memset(bitmap, 0, out);
+
+   for (i = 0, offset = 0; offset < state_size;
+         i++, offset += NETPLAY_DELTA_BLOCK_SIZE)
+   {
+      size_t len = state_size - offset;
+      if (len > NETPLAY_DELTA_BLOCK_SIZE)
+         len = NETPLAY_DELTA_BLOCK_SIZE;
+
+      if (!memcmp(state + offset, base + offset, len))
+         continue;
+
+      /* Not worth it, send the full state */
+      if (out + len >= state_size)
+         return 0;
+
+      bitmap[i >> 3] |= 1 << (i & 7);
+      for (j = 0; j < len; j++)
+         netplay->delta_buffer[out + j] = state[offset + j] ^ base[offset + j];
+      out += len;
+   }
+
+   return out;
+}
+
+/**
+ * netplay_delta_state_apply
+ *
+ * Rebuild a savestate from the base and a delta held in
+ * netplay->delta_buffer. The delta is validated before anything is written.
+ *
+ * Returns: True on success, false if the delta is malformed.
+ */
+bool netplay_delta_state_apply(netplay_t *netplay, uint8_t *state,
+      size_t delta_size)
+{
+   size_t i, j, offset;
+   size_t state_size     = netplay->state_size;
+   size_t bitmap_size    = netplay_delta_bitmap_size(state_size);
+   size_t expected       = bitmap_size;
+   const uint8_t *bitmap = netplay->delta_buffer;
+   const uint8_t *in     = netplay->delta_buffer + bitmap_size;
+
+   if (!netplay->delta_base_valid || !netplay->delta_buffer ||
+         delta_size < bitmap_size || delta_size > netplay->delta_buffer_size)
+      return false;
+
+   /* Check that the bitmap accounts for exactly the data we got */
+   for (i = 0, offset = 0; offset < state_size;
+         i++, offset += NETPLAY_DELTA_BLOCK_SIZE)
+   {
+      if (bitmap[i >> 3] & (1 << (i & 7)))
+      {
+         size_t len = state_size - offset;
+         expected  += len > NETPLAY_DELTA_BLOCK_SIZE
+            ? NETPLAY_DELTA_BLOCK_SIZE : len;
+      }
+   }
+   if (expected != delta_size)
+      return false;
+
+   if (state != netplay->delta_base)
+      memcpy(state, netplay->delta_base, state_size);
+
+   for (i = 0, offset = 0; offset < state_size;
+         i++, offset += NETPLAY_DELTA_BLOCK_SIZE)
+   {
+      size_t len;
+
+      if (!(bitmap[i >> 3] & (1 << (i & 7))))
+         continue;
+
+      len = state_size - offset;
+      if (len > NETPLAY_DELTA_BLOCK_SIZE)
+         len = NETPLAY_DELTA_BLOCK_SIZE;
+
+      for (j = 0; j < len; j++)
+         state[offset + j] ^= in[j];
+      in += len;
+   }
+
+   return true;
+}
@@ -0,0 +1,240 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if defined(__linux__) && !defined(HAVE_SOCKET_LEGACY)
+#define HAVE_NETPLAY_EPOLL
+#endif
+
+#include <stdlib.h>
+#include <errno.h>
+
+#include <net/net_compat.h>
+#include <net/net_socket.h>
+
+#ifdef HAVE_NETPLAY_EPOLL
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+#include "netplay_private.h"
+
+/* Number of ready connections fetched per epoll_wait. Any beyond that are
+ * reported again on the next call, as the descriptors are level-triggered. */
+#define NETPLAY_EVENT_BATCH 64
+
+#ifdef HAVE_NETPLAY_EPOLL
+/* Give up on epoll, e.g. because a descriptor could not be added to it */
+static void netplay_event_fallback(netplay_t *netplay)
+{
+   RARCH_WARN("[netplay] epoll failed, falling back to select().\n");
+   close(netplay->event_fd);
+   netplay->event_fd = -1;
+}
+#endif
+
+/**
+ * netplay_event_init
+ *
+ * Start tracking the readiness of our connections.
+ */
+void netplay_event_init(netplay_t *netplay)
+{
+   netplay->event_fd = -1;
+
+#ifdef HAVE_NETPLAY_EPOLL
+   {
+      size_t i;
+
+      netplay->event_fd = epoll_create1(EPOLL_CLOEXEC);
+      if (netplay->event_fd < 0)
+      {
+         RARCH_WARN("[netplay] epoll unavailable, falling back to select().\n");
+         return;
+      }
+
+      for (i = 0; i < netplay->connections_size; i++)
+         if (netplay->connections[i].active)
+            netplay_event_add(netplay, &netplay->connections[i]);
+   }
+#endif
+}
+
+/**
+ * netplay_event_deinit
+ *
+ * Stop tracking readiness.
+ */
+void netplay_event_deinit(netplay_t *netplay)
+{
+#ifdef HAVE_NETPLAY_EPOLL
+   if (netplay->event_fd >= 0)
+      close(netplay->event_fd);
+#endif
+   netplay->event_fd = -1;
+}
+
+/**
+ * netplay_event_add
+ *
+ * Start watching a newly activated connection.
+ */
+void netplay_event_add(netplay_t *netplay,
+      struct netplay_connection *connection)
+{
+   connection->readable = false;
+
+#ifdef HAVE_NETPLAY_EPOLL
+   if (netplay->event_fd >= 0)
+   {
+      struct epoll_event event = {0};
+
+      /* The connection array may be reallocated, so refer to it by index */
+      event.events   = EPOLLIN;
+      event.data.u32 = (uint32_t)(connection - netplay->connections);
+
+      if (epoll_ctl(netplay->event_fd, EPOLL_CTL_ADD, connection->fd,
+               &event) < 0)
+         netplay_event_fallback(netplay);
+   }
+#endif
+}
+
+/**
+ * netplay_event_remove
+ *
+ * Stop watching a connection. Must be called before its socket is closed.
+ */
+void netplay_event_remove(netplay_t *netplay,
+      struct netplay_connection *connection)
+{
+   connection->readable = false;
+
+#ifdef HAVE_NETPLAY_EPOLL
+   if (netplay->event_fd >= 0)
+   {
+      struct epoll_event event = {0};
+      epoll_ctl(netplay->event_fd, EPOLL_CTL_DEL, connection->fd, &event);
+   }
+#endif
+}
+
+/* Add @fd to @fds, unless the set is already full or can't represent it */
+static bool netplay_event_fd_set(int fd, fd_set *fds, int *max_fd,
+      unsigned *count)
+{
+#ifndef _WIN32
+   if (fd >= FD_SETSIZE)
+      return false;
+#endif
+   if (*count >= FD_SETSIZE)
+      return false;
+
+   FD_SET(fd, fds);
+   (*count)++;
+   if (fd > *max_fd)
+      *max_fd = fd;
+
+   return true;
+}
+
+static int netplay_event_wait_select(netplay_t *netplay, unsigned timeout_ms)
+{
+   fd_set fds;
+   struct timeval tv;
+   size_t i;
+   int ret;
+   int max_fd        = -1;
+   int unwatched     = 0;
+   unsigned count    = 0;
+
+   FD_ZERO(&fds);
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      struct netplay_connection *connection = &netplay->connections[i];
+      if (!connection->active)
+         continue;
+
+      /* Whatever doesn't fit in an fd_set has to be read blindly */
+      if (!netplay_event_fd_set(connection->fd, &fds, &max_fd, &count))
+      {
+         connection->readable = true;
+         unwatched++;
+      }
+   }
+
+   if (unwatched)
+      timeout_ms = 0;
+   if (max_fd < 0)
+      return unwatched;
+
+   tv.tv_sec  = timeout_ms / 1000;
+   tv.tv_usec = (timeout_ms % 1000) * 1000;
+
+   ret = socket_select(max_fd + 1, &fds, NULL, NULL, &tv);
+   if (ret < 0)
+      return -1;
+   if (ret == 0)
+      return unwatched;
+
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      struct netplay_connection *connection = &netplay->connections[i];
+      if (connection->active && !connection->readable &&
+            FD_ISSET(connection->fd, &fds))
+         connection->readable = true;
+   }
+
+   return ret + unwatched;
+}
+
+/**
+ * netplay_event_wait
+ *
+ * Wait up to timeout_ms for any connection to become readable, and set the
+ * readable flag of every connection accordingly.
+ *
+ * Returns the number of readable connections, or -1 on error.
+ */
+int netplay_event_wait(netplay_t *netplay, unsigned timeout_ms)
+{
+   size_t i;
+
+   for (i = 0; i < netplay->connections_size; i++)
+      netplay->connections[i].readable = false;
+
+#ifdef HAVE_NETPLAY_EPOLL
+   if (netplay->event_fd >= 0)
+   {
+      struct epoll_event events[NETPLAY_EVENT_BATCH];
+      int ready = epoll_wait(netplay->event_fd, events,
+            NETPLAY_EVENT_BATCH, (int)timeout_ms);
+
+      if (ready < 0)
+         return (errno == EINTR) ? 0 : -1;
+
+      /* Errors and hangups are reported as readable too, so that the
+       * following recv notices them */
+      for (i = 0; i < (size_t)ready; i++)
+      {
+         uint32_t connection_num = events[i].data.u32;
+         if (connection_num < netplay->connections_size)
+            netplay->connections[connection_num].readable = true;
+      }
+
+      return ready;
+   }
+#endif
+
+   return netplay_event_wait_select(netplay, timeout_ms);
+}
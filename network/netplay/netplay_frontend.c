@@ -236,12 +236,7 @@ static bool get_self_input_state(netplay_t *netplay)
    }
 
    /* And send this input to our peers */
-   for (i = 0; i < netplay->connections_size; i++)
-   {
-      struct netplay_connection *connection = &netplay->connections[i];
-      if (connection->active && connection->mode >= NETPLAY_CONNECTION_CONNECTED)
-         netplay_send_cur_input(netplay, &netplay->connections[i]);
-   }
+   netplay_send_cur_input_all(netplay);
 
    /* Handle any delayed state changes */
    if (netplay->is_server)
@@ -1047,38 +1042,115 @@ static void netplay_force_future(netplay_t *netplay)
    }
 }
 
+/**
+ * netplay_compress_savestate
+ *
+ * Compress data into netplay->zbuffer, hanging up on every peer on failure.
+ */
+static bool netplay_compress_savestate(netplay_t *netplay,
+   struct compression_transcoder *z, const uint8_t *data, size_t size,
+   uint32_t *wn)
+{
+   uint32_t rd;
+   size_t i;
+
+   z->compression_backend->set_in(z->compression_stream,
+      data, (uint32_t)size);
+   z->compression_backend->set_out(z->compression_stream,
+      netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
+   if (!z->compression_backend->trans(z->compression_stream, true, &rd,
+         wn, NULL))
+   {
+      /* Catastrophe! */
+      for (i = 0; i < netplay->connections_size; i++)
+         netplay_hangup(netplay, &netplay->connections[i]);
+      return false;
+   }
+
+   return true;
+}
+
 /**
  * netplay_send_savestate
  * @netplay              : pointer to netplay object
  * @serial_info          : the savestate being loaded
  * @cx                   : compression type
  * @z                    : compression backend to use
+ * @delta_size           : size of the delta in netplay->delta_buffer, 0 if
+ *                         there is none
  *
  * Send a loaded savestate to those connected peers using the given compression
- * scheme.
+ * scheme. Peers holding the delta base get the delta, the others the full
+ * state.
  */
 void netplay_send_savestate(netplay_t *netplay,
    retro_ctx_serialize_info_t *serial_info, uint32_t cx,
-   struct compression_transcoder *z)
+   struct compression_transcoder *z, size_t delta_size)
 {
    uint32_t header[4];
-   uint32_t rd, wn;
+   uint32_t delta_header[7];
+   uint32_t wn;
    size_t i;
+   bool need_full  = false;
+   bool need_delta = false;
 
-   /* Compress it */
-   z->compression_backend->set_in(z->compression_stream,
-      (const uint8_t*)serial_info->data_const, (uint32_t)serial_info->size);
-   z->compression_backend->set_out(z->compression_stream,
-      netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
-   if (!z->compression_backend->trans(z->compression_stream, true, &rd,
-         &wn, NULL))
+   for (i = 0; i < netplay->connections_size; i++)
    {
-      /* Catastrophe! */
+      struct netplay_connection *connection = &netplay->connections[i];
+      if (!connection->active ||
+          connection->mode < NETPLAY_CONNECTION_CONNECTED ||
+          connection->compression_supported != cx) continue;
+
+      if (delta_size && connection->delta_supported &&
+            connection->delta_base_ok)
+         need_delta = true;
+      else
+         need_full  = true;
+   }
+
+   if (need_delta)
+   {
+      if (!netplay_compress_savestate(netplay, z, netplay->delta_buffer,
+               delta_size, &wn))
+         return;
+
+      delta_header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE_DELTA);
+      delta_header[1] = htonl(wn + 5*sizeof(uint32_t));
+      delta_header[2] = htonl(netplay->run_frame_count);
+      delta_header[3] = htonl(serial_info->size);
+      delta_header[4] = htonl(netplay->delta_base_frame);
+      delta_header[5] = htonl(netplay->delta_base_crc);
+      delta_header[6] = htonl((uint32_t)delta_size);
+
       for (i = 0; i < netplay->connections_size; i++)
-         netplay_hangup(netplay, &netplay->connections[i]);
-      return;
+      {
+         struct netplay_connection *connection = &netplay->connections[i];
+         if (!connection->active ||
+             connection->mode < NETPLAY_CONNECTION_CONNECTED ||
+             connection->compression_supported != cx ||
+             !connection->delta_supported ||
+             !connection->delta_base_ok) continue;
+
+         if (!netplay_send(&connection->send_packet_buffer, connection->fd,
+               delta_header, sizeof(delta_header)) ||
+             !netplay_send(&connection->send_packet_buffer, connection->fd,
+               netplay->zbuffer, wn))
+            netplay_hangup(netplay, connection);
+         else
+         {
+            netplay->savestate_bytes_sent += sizeof(delta_header) + wn;
+            netplay->savestate_delta_sends++;
+         }
+      }
    }
 
+   if (!need_full)
+      return;
+
+   if (!netplay_compress_savestate(netplay, z,
+            (const uint8_t*)serial_info->data_const, serial_info->size, &wn))
+      return;
+
    /* Send it to relevant peers */
    header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
    header[1] = htonl(wn + 2*sizeof(uint32_t));
@@ -1091,12 +1163,16 @@ void netplay_send_savestate(netplay_t *netplay,
       if (!connection->active ||
           connection->mode < NETPLAY_CONNECTION_CONNECTED ||
           connection->compression_supported != cx) continue;
+      if (delta_size && connection->delta_supported &&
+            connection->delta_base_ok) continue;
 
       if (!netplay_send(&connection->send_packet_buffer, connection->fd, header,
             sizeof(header)) ||
           !netplay_send(&connection->send_packet_buffer, connection->fd,
             netplay->zbuffer, wn))
          netplay_hangup(netplay, connection);
+      else
+         netplay->savestate_bytes_sent += sizeof(header) + wn;
    }
 }
 
@@ -1114,6 +1190,9 @@ void netplay_load_savestate(netplay_t *netplay,
       retro_ctx_serialize_info_t *serial_info, bool save)
 {
    retro_ctx_serialize_info_t tmp_serial_info;
+   size_t delta_size = 0;
+   uint64_t bytes_sent;
+   uint32_t deltas;
 
    netplay_force_future(netplay);
 
@@ -1158,12 +1237,48 @@ void netplay_load_savestate(netplay_t *netplay,
             | NETPLAY_QUIRK_NO_TRANSMISSION))
       return;
 
+   /* Diff it against the last state our peers got */
+   if (serial_info->size == netplay->state_size)
+      delta_size = netplay_delta_state_encode(netplay,
+            (const uint8_t*)serial_info->data_const);
+
+   bytes_sent = netplay->savestate_bytes_sent;
+   deltas     = netplay->savestate_delta_sends;
+
    /* Send this to every peer */
    if (netplay->compress_nil.compression_backend)
-      netplay_send_savestate(netplay, serial_info, 0, &netplay->compress_nil);
+      netplay_send_savestate(netplay, serial_info, 0, &netplay->compress_nil,
+         delta_size);
    if (netplay->compress_zlib.compression_backend)
       netplay_send_savestate(netplay, serial_info, NETPLAY_COMPRESSION_ZLIB,
-         &netplay->compress_zlib);
+         &netplay->compress_zlib, delta_size);
+
+   netplay->savestate_sends++;
+   RARCH_LOG("[netplay] Sent savestate for frame %u: %u bytes (%u delta), "
+         "state is %u bytes. Total %llu bytes in %u resyncs.\n",
+         netplay->run_frame_count,
+         (unsigned)(netplay->savestate_bytes_sent - bytes_sent),
+         (unsigned)(netplay->savestate_delta_sends - deltas),
+         (unsigned)serial_info->size,
+         (unsigned long long)netplay->savestate_bytes_sent,
+         netplay->savestate_sends);
+
+   /* Everyone we're connected to now holds this state */
+   if (serial_info->size == netplay->state_size)
+   {
+      size_t i;
+      netplay_delta_state_set_base(netplay, serial_info->data_const,
+            netplay->run_frame_count);
+      for (i = 0; i < netplay->connections_size; i++)
+      {
+         struct netplay_connection *connection = &netplay->connections[i];
+         connection->delta_base_ok = connection->active &&
+            connection->mode >= NETPLAY_CONNECTION_CONNECTED &&
+            connection->delta_supported;
+      }
+   }
+   else
+      netplay->delta_base_valid = false;
 }
 
 /**
@@ -372,6 +372,9 @@ bool netplay_handshake_init(netplay_t *netplay,
    compression  = ntohl(header[2]);
    compression &= NETPLAY_COMPRESSION_SUPPORTED;
 
+   connection->delta_supported = !!(compression & NETPLAY_COMPRESSION_DELTA);
+   connection->delta_base_ok   = false;
+
    if (compression & NETPLAY_COMPRESSION_ZLIB)
    {
       ctrans = &netplay->compress_zlib;
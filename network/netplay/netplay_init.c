@@ -305,6 +305,8 @@ bool netplay_init_serialization(netplay_t *netplay)
       return false;
    }
 
+   netplay_delta_state_init(netplay);
+
    return true;
 }
 
@@ -425,6 +427,7 @@ netplay_t *netplay_new(void *direct_host, const char *server, uint16_t port,
       return NULL;
 
    netplay->listen_fd            = -1;
+   netplay->event_fd             = -1;
    netplay->tcp_port             = port;
    netplay->cbs                  = *cb;
    netplay->is_server            = (direct_host == NULL && server == NULL);
@@ -506,6 +509,8 @@ netplay_t *netplay_new(void *direct_host, const char *server, uint16_t port,
          goto error;
    }
 
+   netplay_event_init(netplay);
+
    return netplay;
 
 error:
@@ -529,6 +534,19 @@ void netplay_free(netplay_t *netplay)
 {
    size_t i;
 
+   if (netplay->rollbacks)
+      RARCH_LOG("[netplay] %u rollbacks, %llu frames replayed (%llu "
+            "serialized). Per rollback: emulation %u us, serialization %u us, "
+            "CRC %u us.\n",
+            netplay->rollbacks,
+            (unsigned long long)netplay->rollback_frames,
+            (unsigned long long)netplay->rollback_serialized,
+            (unsigned)(netplay->rollback_run_time / netplay->rollbacks),
+            (unsigned)(netplay->rollback_serialize_time / netplay->rollbacks),
+            (unsigned)(netplay->rollback_crc_time / netplay->rollbacks));
+
+   netplay_event_deinit(netplay);
+
    if (netplay->listen_fd >= 0)
       socket_close(netplay->listen_fd);
 
@@ -560,6 +578,11 @@ void netplay_free(netplay_t *netplay)
    if (netplay->zbuffer)
       free(netplay->zbuffer);
 
+   if (netplay->delta_base)
+      free(netplay->delta_base);
+   if (netplay->delta_buffer)
+      free(netplay->delta_buffer);
+
    if (netplay->compress_nil.compression_stream)
    {
       netplay->compress_nil.compression_backend->stream_free(netplay->compress_nil.compression_stream);
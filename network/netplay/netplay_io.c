@@ -120,6 +120,7 @@ void netplay_hangup(netplay_t *netplay, struct netplay_connection *connection)
    RARCH_LOG("%s\n", dmsg);
    runloop_msg_queue_push(dmsg, 1, 180, false);
 
+   netplay_event_remove(netplay, connection);
    socket_close(connection->fd);
    connection->active = false;
    netplay_deinit_socket_buffer(&connection->send_packet_buffer);
@@ -210,13 +211,13 @@ void netplay_delayed_state_change(netplay_t *netplay)
    }
 }
 
-/* Send the specified input data */
-static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
-      struct netplay_connection *only, struct netplay_connection *except,
-      uint32_t client_num, bool slave)
+/* Encode the specified input data as an input packet, returning its size in
+ * words */
+static size_t encode_input_frame(netplay_t *netplay,
+      struct delta_frame *dframe, uint32_t client_num, bool slave,
+      uint32_t *buffer)
 {
-#define BUFSZ 16 /* FIXME: Arbitrary restriction */
-   uint32_t buffer[BUFSZ], devices, device;
+   uint32_t devices, device;
    size_t bufused, i;
 
    /* Set up the basic buffer */
@@ -237,7 +238,7 @@ static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
          istate = istate->next;
       if (!istate)
          continue;
-      if (bufused + istate->size >= BUFSZ)
+      if (bufused + istate->size >= NETPLAY_INPUT_PACKET_WORDS)
          continue; /* FIXME: More severe? */
       for (i = 0; i < istate->size; i++)
          buffer[bufused+i] = htonl(istate->data[i]);
@@ -245,6 +246,19 @@ static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
    }
    buffer[1] = htonl((bufused-2) * sizeof(uint32_t));
 
+   return bufused;
+}
+
+/* Send the specified input data */
+static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
+      struct netplay_connection *only, struct netplay_connection *except,
+      uint32_t client_num, bool slave)
+{
+   uint32_t buffer[NETPLAY_INPUT_PACKET_WORDS];
+   size_t bufused, i;
+
+   bufused = encode_input_frame(netplay, dframe, client_num, slave, buffer);
+
 #ifdef DEBUG_NETPLAY_STEPS
    RARCH_LOG("Sending input for client %u\n", (unsigned) client_num);
    print_state(netplay);
@@ -277,69 +291,152 @@ static bool send_input_frame(netplay_t *netplay, struct delta_frame *dframe,
    }
 
    return true;
-#undef BUFSZ
+}
+
+/* Append a packet to this frame's input broadcast */
+static uint32_t *add_input_packet(netplay_t *netplay, uint32_t client_num)
+{
+   struct netplay_input_packet *packet =
+      &netplay->input_packets[netplay->input_packets_count];
+
+   packet->offset     = netplay->input_packets_count ?
+      packet[-1].offset + packet[-1].words : 0;
+   packet->words      = 0;
+   packet->client_num = client_num;
+
+   return netplay->input_broadcast + packet->offset;
 }
 
 /**
- * netplay_send_cur_input
- *
- * Send the current input frame to a given connection.
+ * build_input_broadcast
  *
- * Returns true if successful, false otherwise.
+ * Encode every input packet of the current frame once. What each peer needs
+ * is a subset of these, so they can all be sent from the same buffer.
  */
-bool netplay_send_cur_input(netplay_t *netplay,
-   struct netplay_connection *connection)
+static void build_input_broadcast(netplay_t *netplay)
 {
-   uint32_t from_client, to_client;
+   uint32_t from_client, *buffer;
    struct delta_frame *dframe = &netplay->buffer[netplay->self_ptr];
 
+   netplay->input_packets_count = 0;
+
    if (netplay->is_server)
    {
-      to_client = (uint32_t)(connection - netplay->connections + 1);
-
-      /* Send the other players' input data (FIXME: This involves an
-       * unacceptable amount of recalculating) */
+      /* The other players' input data */
       for (from_client = 1; from_client < MAX_CLIENTS; from_client++)
       {
-         if (from_client == to_client)
+         if (!(netplay->connected_players & (1<<from_client)) ||
+             !dframe->have_real[from_client])
             continue;
-          
-         if ((netplay->connected_players & (1<<from_client)))
-         {
-            if (dframe->have_real[from_client])
-            {
-               if (!send_input_frame(netplay, dframe, connection, NULL, from_client, false))
-                  return false;
-            }
-         }
+
+         buffer = add_input_packet(netplay, from_client);
+         netplay->input_packets[netplay->input_packets_count++].words =
+            encode_input_frame(netplay, dframe, from_client, false, buffer);
       }
 
-      /* If we're not playing, send a NOINPUT */
+      /* If we're not playing, a NOINPUT */
       if (netplay->self_mode != NETPLAY_CONNECTION_PLAYING)
       {
-         uint32_t payload = htonl(netplay->self_frame_count);
-         if (!netplay_send_raw_cmd(netplay, connection, NETPLAY_CMD_NOINPUT,
-               &payload, sizeof(payload)))
-            return false;
+         buffer    = add_input_packet(netplay, netplay->self_client_num);
+         buffer[0] = htonl(NETPLAY_CMD_NOINPUT);
+         buffer[1] = htonl(sizeof(uint32_t));
+         buffer[2] = htonl(netplay->self_frame_count);
+         netplay->input_packets[netplay->input_packets_count++].words = 3;
       }
-
    }
 
-   /* Send our own data */
+   /* Our own data */
    if (netplay->self_mode == NETPLAY_CONNECTION_PLAYING
          || netplay->self_mode == NETPLAY_CONNECTION_SLAVE)
    {
-      if (!send_input_frame(netplay, dframe, connection, NULL,
-            netplay->self_client_num,
-            netplay->self_mode == NETPLAY_CONNECTION_SLAVE))
-         return false;
+      buffer = add_input_packet(netplay, netplay->self_client_num);
+      netplay->input_packets[netplay->input_packets_count++].words =
+         encode_input_frame(netplay, dframe, netplay->self_client_num,
+               netplay->self_mode == NETPLAY_CONNECTION_SLAVE, buffer);
    }
+}
 
-   if (!netplay_send_flush(&connection->send_packet_buffer, connection->fd,
-         false))
-      return false;
+/**
+ * send_input_broadcast
+ *
+ * Send the prepared input broadcast to a connection, leaving out the
+ * connection's own input. As the packets are contiguous, this is at most two
+ * chunks of the shared buffer.
+ */
+static bool send_input_broadcast(netplay_t *netplay,
+   struct netplay_connection *connection)
+{
+   struct netplay_send_chunk chunks[2];
+   size_t i, start = 0, end = 0, count = 0;
+   uint32_t to_client = (uint32_t)(connection - netplay->connections + 1);
 
-   return true;
+   if (netplay->input_packets_count)
+      end = netplay->input_packets[netplay->input_packets_count - 1].offset +
+         netplay->input_packets[netplay->input_packets_count - 1].words;
+
+   if (netplay->is_server)
+   {
+      for (i = 0; i < netplay->input_packets_count; i++)
+      {
+         const struct netplay_input_packet *packet = &netplay->input_packets[i];
+
+         if (packet->client_num != to_client)
+            continue;
+
+         /* Everything before and everything after the peer's own input */
+         chunks[count].data   = netplay->input_broadcast;
+         chunks[count++].len  = packet->offset * sizeof(uint32_t);
+         start                = packet->offset + packet->words;
+         break;
+      }
+   }
+
+   chunks[count].data  = netplay->input_broadcast + start;
+   chunks[count++].len = (end - start) * sizeof(uint32_t);
+
+#ifdef DEBUG_NETPLAY_STEPS
+   RARCH_LOG("Sending input to client %u\n", (unsigned) to_client);
+   print_state(netplay);
+#endif
+
+   return netplay_sendv(&connection->send_packet_buffer, connection->fd,
+         chunks, count);
+}
+
+/**
+ * netplay_send_cur_input
+ *
+ * Send the current input frame to a given connection.
+ *
+ * Returns true if successful, false otherwise.
+ */
+bool netplay_send_cur_input(netplay_t *netplay,
+   struct netplay_connection *connection)
+{
+   build_input_broadcast(netplay);
+   return send_input_broadcast(netplay, connection);
+}
+
+/**
+ * netplay_send_cur_input_all
+ *
+ * Send the current input frame to every connected peer, hanging up on those
+ * that fail.
+ */
+void netplay_send_cur_input_all(netplay_t *netplay)
+{
+   size_t i;
+
+   build_input_broadcast(netplay);
+
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      struct netplay_connection *connection = &netplay->connections[i];
+      if (connection->active &&
+          connection->mode >= NETPLAY_CONNECTION_CONNECTED &&
+          !send_input_broadcast(netplay, connection))
+         netplay_hangup(netplay, connection);
+   }
 }
 
 /**
@@ -463,6 +560,22 @@ bool netplay_cmd_request_savestate(netplay_t *netplay)
       NETPLAY_CMD_REQUEST_SAVESTATE, NULL, 0);
 }
 
+/**
+ * netplay_cmd_request_full_savestate
+ *
+ * Ask a peer for a complete savestate, because a delta could not be applied.
+ */
+bool netplay_cmd_request_full_savestate(netplay_t *netplay,
+      struct netplay_connection *connection)
+{
+   uint32_t flags = htonl(NETPLAY_CMD_REQUEST_SAVESTATE_BIT_FULL);
+
+   netplay->delta_base_valid              = false;
+   netplay->savestate_request_outstanding = true;
+   return netplay_send_raw_cmd(netplay, connection,
+      NETPLAY_CMD_REQUEST_SAVESTATE, &flags, sizeof(flags));
+}
+
 /**
  * netplay_cmd_mode
  *
@@ -1522,9 +1635,14 @@ static bool netplay_get_cmd(netplay_t *netplay,
 
             if (buffer[0] <= netplay->other_frame_count)
             {
+               uint32_t local_crc;
+
                /* We've already replayed up to this frame, so we can check it
-                * directly */
-               uint32_t local_crc = netplay_delta_frame_crc(
+                * directly, unless the replay didn't keep its state */
+               if (netplay->buffer[tmp_ptr].state_skipped)
+                  break;
+
+               local_crc = netplay_delta_frame_crc(
                      netplay, &netplay->buffer[tmp_ptr]);
 
                if (buffer[1] != local_crc)
@@ -1543,17 +1661,40 @@ static bool netplay_get_cmd(netplay_t *netplay,
          }
 
       case NETPLAY_CMD_REQUEST_SAVESTATE:
+         if (cmd_size == sizeof(uint32_t))
+         {
+            uint32_t flags;
+            RECV(&flags, sizeof(flags))
+            {
+               RARCH_ERR("NETPLAY_CMD_REQUEST_SAVESTATE failed to receive flags.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            /* The peer couldn't use our last delta */
+            if (ntohl(flags) & NETPLAY_CMD_REQUEST_SAVESTATE_BIT_FULL)
+               connection->delta_base_ok = false;
+         }
+         else if (cmd_size != 0)
+         {
+            RARCH_ERR("NETPLAY_CMD_REQUEST_SAVESTATE received an unexpected payload size.\n");
+            return netplay_cmd_nak(netplay, connection);
+         }
+
          /* Delay until next frame so we don't send the savestate after the
           * input */
          netplay->force_send_savestate = true;
          break;
 
       case NETPLAY_CMD_LOAD_SAVESTATE:
+      case NETPLAY_CMD_LOAD_SAVESTATE_DELTA:
       case NETPLAY_CMD_RESET:
          {
             uint32_t frame;
             uint32_t isize;
             uint32_t rd, wn;
+            uint32_t delta_header[3];
+            uint32_t header_size = (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA)
+               ? 5*sizeof(uint32_t) : 2*sizeof(uint32_t);
             uint32_t client;
             uint32_t load_frame_count;
             size_t load_ptr;
@@ -1606,8 +1747,8 @@ static bool netplay_get_cmd(netplay_t *netplay,
              * too many places. */
 
             /* Check the payload size */
-            if ((cmd == NETPLAY_CMD_LOAD_SAVESTATE &&
-                 (cmd_size < 2*sizeof(uint32_t) || cmd_size > netplay->zbuffer_size + 2*sizeof(uint32_t))) ||
+            if ((cmd != NETPLAY_CMD_RESET &&
+                 (cmd_size < header_size || cmd_size > netplay->zbuffer_size + header_size)) ||
                 (cmd == NETPLAY_CMD_RESET && cmd_size != sizeof(uint32_t)))
             {
                RARCH_ERR("CMD_LOAD_SAVESTATE received an unexpected payload size.\n");
@@ -1645,8 +1786,11 @@ static bool netplay_get_cmd(netplay_t *netplay,
             }
 
             /* Now we switch based on whether we're loading a state or resetting */
-            if (cmd == NETPLAY_CMD_LOAD_SAVESTATE)
+            if (cmd != NETPLAY_CMD_RESET)
             {
+               uint8_t *dest  = (uint8_t*)netplay->buffer[load_ptr].state;
+               size_t dest_size = netplay->state_size;
+
                RECV(&isize, sizeof(isize))
                {
                   RARCH_ERR("CMD_LOAD_SAVESTATE failed to receive inflated size.\n");
@@ -1660,12 +1804,44 @@ static bool netplay_get_cmd(netplay_t *netplay,
                   return netplay_cmd_nak(netplay, connection);
                }
 
-               RECV(netplay->zbuffer, cmd_size - 2*sizeof(uint32_t))
+               if (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA)
+               {
+                  RECV(delta_header, sizeof(delta_header))
+                  {
+                     RARCH_ERR("CMD_LOAD_SAVESTATE_DELTA failed to receive delta header.\n");
+                     return netplay_cmd_nak(netplay, connection);
+                  }
+                  delta_header[0] = ntohl(delta_header[0]);
+                  delta_header[1] = ntohl(delta_header[1]);
+                  delta_header[2] = ntohl(delta_header[2]);
+
+                  /* Decompress aside, the base is checked below */
+                  dest      = netplay->delta_buffer;
+                  dest_size = netplay->delta_buffer_size;
+               }
+
+               RECV(netplay->zbuffer, cmd_size - header_size)
                {
                   RARCH_ERR("CMD_LOAD_SAVESTATE failed to receive savestate.\n");
                   return netplay_cmd_nak(netplay, connection);
                }
 
+               if (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA &&
+                     (!dest || !netplay->delta_base_valid ||
+                      delta_header[0] != netplay->delta_base_frame ||
+                      delta_header[1] != netplay->delta_base_crc ||
+                      delta_header[2] > dest_size))
+               {
+                  /* We don't hold the state it was made against, drop it and
+                   * fall back to a full state */
+                  RARCH_WARN("[netplay] Savestate delta against frame %u "
+                        "doesn't match our base, requesting full state.\n",
+                        delta_header[0]);
+                  if (!netplay_cmd_request_full_savestate(netplay, connection))
+                     return false;
+                  break;
+               }
+
                /* And decompress it */
                switch (connection->compression_supported)
                {
@@ -1676,13 +1852,26 @@ static bool netplay_get_cmd(netplay_t *netplay,
                      ctrans = &netplay->compress_nil;
                }
                ctrans->decompression_backend->set_in(ctrans->decompression_stream,
-                  netplay->zbuffer, cmd_size - 2*sizeof(uint32_t));
+                  netplay->zbuffer, cmd_size - header_size);
                ctrans->decompression_backend->set_out(ctrans->decompression_stream,
-                  (uint8_t*)netplay->buffer[load_ptr].state,
-                  (unsigned)netplay->state_size);
+                  dest, (unsigned)dest_size);
                ctrans->decompression_backend->trans(ctrans->decompression_stream,
                   true, &rd, &wn, NULL);
 
+               if (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA &&
+                     (wn != delta_header[2] ||
+                      !netplay_delta_state_apply(netplay,
+                         (uint8_t*)netplay->buffer[load_ptr].state, wn)))
+               {
+                  RARCH_ERR("CMD_LOAD_SAVESTATE_DELTA received a malformed delta.\n");
+                  return netplay_cmd_nak(netplay, connection);
+               }
+
+               /* This is the new base for deltas in either direction */
+               netplay_delta_state_set_base(netplay,
+                  netplay->buffer[load_ptr].state, load_frame_count);
+               connection->delta_base_ok = connection->delta_supported;
+
                /* Force a rewind to the relevant frame */
                netplay->force_rewind = true;
             }
@@ -1846,17 +2035,20 @@ shrt:
 int netplay_poll_net_input(netplay_t *netplay, bool block)
 {
    bool had_input = false;
-   int max_fd = 0;
+   bool waited    = false;
+   bool active    = false;
    size_t i;
 
    for (i = 0; i < netplay->connections_size; i++)
    {
-      struct netplay_connection *connection = &netplay->connections[i];
-      if (connection->active && connection->fd >= max_fd)
-         max_fd = connection->fd + 1;
+      if (netplay->connections[i].active)
+      {
+         active = true;
+         break;
+      }
    }
 
-   if (max_fd == 0)
+   if (!active)
       return 0;
 
    netplay->timeout_cnt = 0;
@@ -1867,11 +2059,23 @@ int netplay_poll_net_input(netplay_t *netplay, bool block)
 
       netplay->timeout_cnt++;
 
-      /* Read input from each connection */
+      /* Find out which connections have anything for us, unless we've just
+       * waited for exactly that */
+      if (!waited && netplay_event_wait(netplay, 0) < 0)
+         return -1;
+      waited = false;
+
+      /* Read input from each connection that has data, either on the socket
+       * or already buffered */
       for (i = 0; i < netplay->connections_size; i++)
       {
          struct netplay_connection *connection = &netplay->connections[i];
-         if (connection->active && !netplay_get_cmd(netplay, connection, &had_input))
+         if (!connection->active)
+            continue;
+         if (!connection->readable &&
+             !netplay_recv_pending(&connection->recv_packet_buffer))
+            continue;
+         if (!netplay_get_cmd(netplay, connection, &had_input))
             netplay_hangup(netplay, connection);
       }
 
@@ -1886,20 +2090,9 @@ int netplay_poll_net_input(netplay_t *netplay, bool block)
          /* If we're supposed to block but we didn't have enough input, wait for it */
          if (!had_input)
          {
-            fd_set fds;
-            struct timeval tv = {0};
-            tv.tv_usec = RETRY_MS * 1000;
-
-            FD_ZERO(&fds);
-            for (i = 0; i < netplay->connections_size; i++)
-            {
-               struct netplay_connection *connection = &netplay->connections[i];
-               if (connection->active)
-                  FD_SET(connection->fd, &fds);
-            }
-
-            if (socket_select(max_fd, &fds, NULL, NULL, &tv) < 0)
+            if (netplay_event_wait(netplay, RETRY_MS) < 0)
                return -1;
+            waited = true;
 
             RARCH_LOG("Network is stalling at frame %u, count %u of %d ...\n",
                   netplay->run_frame_count, netplay->timeout_cnt, MAX_RETRIES);
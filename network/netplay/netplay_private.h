@@ -89,12 +89,19 @@ typedef uint32_t client_bitmap_t;
 
 /* Compression protocols supported */
 #define NETPLAY_COMPRESSION_ZLIB (1<<0)
+/* Not a compression protocol of its own: the peer understands
+ * LOAD_SAVESTATE_DELTA, which is compressed like LOAD_SAVESTATE */
+#define NETPLAY_COMPRESSION_DELTA (1<<1)
 #if HAVE_ZLIB
-#define NETPLAY_COMPRESSION_SUPPORTED NETPLAY_COMPRESSION_ZLIB
+#define NETPLAY_COMPRESSION_SUPPORTED \
+   (NETPLAY_COMPRESSION_ZLIB | NETPLAY_COMPRESSION_DELTA)
 #else
-#define NETPLAY_COMPRESSION_SUPPORTED 0
+#define NETPLAY_COMPRESSION_SUPPORTED NETPLAY_COMPRESSION_DELTA
 #endif
 
+/* Granularity of savestate deltas */
+#define NETPLAY_DELTA_BLOCK_SIZE 64
+
 enum netplay_cmd
 {
    /* Basic commands */
@@ -166,6 +173,9 @@ enum netplay_cmd
    /* Sends over cheats enabled on client (unsupported) */
    NETPLAY_CMD_CHEATS         = 0x0047,
 
+   /* Send a savestate as a delta against the last transferred one */
+   NETPLAY_CMD_LOAD_SAVESTATE_DELTA = 0x0048,
+
    /* Misc. commands */
 
    /* Sends multiple config requests over,
@@ -179,6 +189,7 @@ enum netplay_cmd
 };
 
 #define NETPLAY_CMD_SYNC_BIT_PAUSED    (1U<<31)
+#define NETPLAY_CMD_REQUEST_SAVESTATE_BIT_FULL (1U<<0)
 #define NETPLAY_CMD_PLAY_BIT_SLAVE     (1U<<31)
 #define NETPLAY_CMD_MODE_BIT_YOU       (1U<<31)
 #define NETPLAY_CMD_MODE_BIT_PLAYING   (1U<<30)
@@ -298,6 +309,10 @@ struct delta_frame
    /* The CRC-32 of the serialized state if we've calculated it, else 0 */
    uint32_t crc;
 
+   /* Set if a replay didn't serialize this frame, so state is left over from
+    * an older simulation of it and must be neither loaded nor checked */
+   bool state_skipped;
+
    /* The resolved input, i.e., what's actually going to the core. One input
     * per device. */
    netplay_input_state_t resolved_input[MAX_INPUT_DEVICES];
@@ -324,6 +339,27 @@ struct socket_buffer
    size_t read;
 };
 
+/* A piece of data to be sent with netplay_sendv */
+struct netplay_send_chunk
+{
+   const void *data;
+   size_t len;
+};
+
+/* Maximum size of an input packet, in words */
+#define NETPLAY_INPUT_PACKET_WORDS 16
+
+/* An input packet in netplay->input_broadcast */
+struct netplay_input_packet
+{
+   /* Offset and size in words */
+   size_t offset;
+   size_t words;
+
+   /* Client the input belongs to */
+   uint32_t client_num;
+};
+
 /* Each connection gets a connection struct */
 struct netplay_connection
 {
@@ -333,6 +369,9 @@ struct netplay_connection
    /* fd associated with this connection */
    int fd;
 
+   /* Did the last netplay_event_wait report data waiting on fd? */
+   bool readable;
+
    /* Address of peer */
    struct sockaddr_storage addr;
 
@@ -359,6 +398,11 @@ struct netplay_connection
    /* What compression does this peer support? */
    uint32_t compression_supported;
 
+   /* Does this peer understand savestate deltas, and does it hold the same
+    * last transferred state as we do? */
+   bool delta_supported;
+   bool delta_base_ok;
+
    /* Is this player paused? */
    bool paused;
 
@@ -394,6 +438,9 @@ struct netplay
    /* TCP connection for listening (server only) */
    int listen_fd;
 
+   /* epoll instance watching our connections, or -1 to use select() */
+   int event_fd;
+
    /* Our client number */
    uint32_t self_client_num;
 
@@ -405,6 +452,11 @@ struct netplay
    size_t connections_size;
    struct netplay_connection one_connection; /* Client only */
 
+   /* This frame's input packets, encoded once for all connections */
+   uint32_t input_broadcast[(MAX_CLIENTS + 1) * NETPLAY_INPUT_PACKET_WORDS];
+   struct netplay_input_packet input_packets[MAX_CLIENTS + 1];
+   size_t input_packets_count;
+
    /* Bitmap of clients with input devices */
    uint32_t connected_players;
 
@@ -459,6 +511,20 @@ struct netplay
    uint8_t *zbuffer;
    size_t zbuffer_size;
 
+   /* The last savestate sent to or received from our peers, which savestate
+    * deltas are made against, and a buffer for the deltas themselves */
+   uint8_t *delta_base;
+   uint32_t delta_base_frame;
+   uint32_t delta_base_crc;
+   bool delta_base_valid;
+   uint8_t *delta_buffer;
+   size_t delta_buffer_size;
+
+   /* Savestate transfer statistics */
+   uint64_t savestate_bytes_sent;
+   uint32_t savestate_sends;
+   uint32_t savestate_delta_sends;
+
    /* The size of our packet buffers */
    size_t packet_buffer_size;
 
@@ -541,6 +607,11 @@ struct netplay
    int frame_run_time_ptr;
    retro_time_t frame_run_time_sum, frame_run_time_avg;
 
+   /* Rollback statistics */
+   uint32_t rollbacks;
+   uint64_t rollback_frames, rollback_serialized;
+   retro_time_t rollback_run_time, rollback_serialize_time, rollback_crc_time;
+
    /* Latency frames and limits */
    unsigned input_latency_frames;
 
@@ -613,6 +684,18 @@ bool netplay_send(struct socket_buffer *sbuf, int sockfd, const void *buf,
  */
 bool netplay_send_flush(struct socket_buffer *sbuf, int sockfd, bool block);
 
+/**
+ * netplay_sendv
+ *
+ * Queue the given chunks for sending and flush without blocking. Data
+ * already queued and the new chunks go out in a single vectored send where
+ * supported, so only what the socket doesn't take is copied into the buffer.
+ *
+ * Returns false only on socket failures, true otherwise.
+ */
+bool netplay_sendv(struct socket_buffer *sbuf, int sockfd,
+   const struct netplay_send_chunk *chunks, size_t count);
+
 /**
  * netplay_recv
  *
@@ -639,6 +722,13 @@ void netplay_recv_reset(struct socket_buffer *sbuf);
  */
 void netplay_recv_flush(struct socket_buffer *sbuf);
 
+/**
+ * netplay_recv_pending
+ *
+ * Is there received data in the buffer that hasn't been read yet?
+ */
+bool netplay_recv_pending(struct socket_buffer *sbuf);
+
 
 /***************************************************************
  * NETPLAY-DELTA.C
@@ -685,6 +775,45 @@ netplay_input_state_t netplay_input_state_for(netplay_input_state_t *list,
  */
 uint32_t netplay_expected_input_size(netplay_t *netplay, uint32_t devices);
 
+/**
+ * netplay_delta_state_init
+ *
+ * Allocate the buffers used for savestate deltas. Failure only disables
+ * deltas.
+ */
+void netplay_delta_state_init(netplay_t *netplay);
+
+/**
+ * netplay_delta_state_set_base
+ *
+ * Remember a savestate that was just sent to or received from our peers as
+ * the base for future deltas.
+ */
+void netplay_delta_state_set_base(netplay_t *netplay, const void *state,
+      uint32_t frame);
+
+/**
+ * netplay_delta_state_encode
+ *
+ * Encode a savestate as a block delta against the base into
+ * netplay->delta_buffer.
+ *
+ * Returns: The size of the delta, or 0 if there is no base or the delta
+ * would not be smaller than the state itself.
+ */
+size_t netplay_delta_state_encode(netplay_t *netplay, const uint8_t *state);
+
+/**
+ * netplay_delta_state_apply
+ *
+ * Rebuild a savestate from the base and a delta held in
+ * netplay->delta_buffer. The delta is validated before anything is written.
+ *
+ * Returns: True on success, false if the delta is malformed.
+ */
+bool netplay_delta_state_apply(netplay_t *netplay, uint8_t *state,
+      size_t delta_size);
+
 
 /***************************************************************
  * NETPLAY-DISCOVERY.C
@@ -698,6 +827,51 @@ uint32_t netplay_expected_input_size(netplay_t *netplay, uint32_t devices);
 bool netplay_lan_ad_server(netplay_t *netplay);
 
 
+/***************************************************************
+ * NETPLAY-EVENT.C
+ **************************************************************/
+
+/**
+ * netplay_event_init
+ *
+ * Start tracking the readiness of our connections.
+ */
+void netplay_event_init(netplay_t *netplay);
+
+/**
+ * netplay_event_deinit
+ *
+ * Stop tracking readiness.
+ */
+void netplay_event_deinit(netplay_t *netplay);
+
+/**
+ * netplay_event_add
+ *
+ * Start watching a newly activated connection.
+ */
+void netplay_event_add(netplay_t *netplay,
+      struct netplay_connection *connection);
+
+/**
+ * netplay_event_remove
+ *
+ * Stop watching a connection. Must be called before its socket is closed.
+ */
+void netplay_event_remove(netplay_t *netplay,
+      struct netplay_connection *connection);
+
+/**
+ * netplay_event_wait
+ *
+ * Wait up to timeout_ms for any connection to become readable, and set the
+ * readable flag of every connection accordingly.
+ *
+ * Returns the number of readable connections, or -1 on error.
+ */
+int netplay_event_wait(netplay_t *netplay, unsigned timeout_ms);
+
+
 /***************************************************************
  * NETPLAY-FRONTEND.C
  **************************************************************/
@@ -833,6 +1007,14 @@ void netplay_delayed_state_change(netplay_t *netplay);
 bool netplay_send_cur_input(netplay_t *netplay,
    struct netplay_connection *connection);
 
+/**
+ * netplay_send_cur_input_all
+ *
+ * Send the current input frame to every connected peer, hanging up on those
+ * that fail.
+ */
+void netplay_send_cur_input_all(netplay_t *netplay);
+
 /**
  * netplay_send_raw_cmd
  *
@@ -868,6 +1050,14 @@ bool netplay_cmd_crc(netplay_t *netplay, struct delta_frame *delta);
  */
 bool netplay_cmd_request_savestate(netplay_t *netplay);
 
+/**
+ * netplay_cmd_request_full_savestate
+ *
+ * Ask a peer for a complete savestate, because a delta could not be applied.
+ */
+bool netplay_cmd_request_full_savestate(netplay_t *netplay,
+      struct netplay_connection *connection);
+
 /**
  * netplay_cmd_mode
  *
@@ -500,6 +500,9 @@ bool netplay_resolve_input(netplay_t *netplay, size_t sim_ptr, bool resim)
 static void netplay_handle_frame_hash(netplay_t *netplay,
       struct delta_frame *delta)
 {
+   if (delta->state_skipped)
+      return;
+
    if (netplay->is_server)
    {
       if (netplay->check_frames &&
@@ -536,6 +539,24 @@ static void netplay_handle_frame_hash(netplay_t *netplay,
    }
 }
 
+/**
+ * netplay_replay_needs_state
+ *
+ * Whether a frame being replayed has to be serialized. Frames whose input is
+ * confirmed by every peer can never be rolled back to again, so their state is
+ * only needed if its CRC is to be checked.
+ */
+static bool netplay_replay_needs_state(netplay_t *netplay,
+      struct delta_frame *delta)
+{
+   if (netplay->replay_frame_count >= netplay->unread_frame_count)
+      return true;
+   if (delta->crc)
+      return true;
+   return netplay->check_frames &&
+      delta->frame % abs(netplay->check_frames) == 0;
+}
+
 /**
  * netplay_sync_pre_frame
  * @netplay              : pointer to netplay object
@@ -716,6 +737,7 @@ bool netplay_sync_pre_frame(netplay_t *netplay)
             goto process;
          }
 
+         netplay_event_add(netplay, connection);
          netplay_handshake_init_send(netplay, connection);
 
       }
@@ -826,6 +848,11 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
        netplay->replay_frame_count < netplay->run_frame_count)
    {
       retro_ctx_serialize_info_t serial_info;
+      retro_time_t run_time       = 0;
+      retro_time_t serialize_time = 0;
+      retro_time_t crc_time       = 0;
+      uint32_t replayed           = 0;
+      uint32_t serialized         = 0;
 
       /* Replay frames. */
       netplay->is_replay = true;
@@ -852,14 +879,15 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
       serial_info.data_const = netplay->buffer[netplay->replay_ptr].state;
       serial_info.size       = netplay->state_size;
 
-      if (!core_unserialize(&serial_info))
+      if (netplay->buffer[netplay->replay_ptr].state_skipped ||
+          !core_unserialize(&serial_info))
       {
          RARCH_ERR("Netplay savestate loading failed: Prepare for desync!\n");
       }
 
       while (netplay->replay_frame_count < netplay->run_frame_count)
       {
-         retro_time_t start, tm;
+         retro_time_t start, tm, now;
 
          struct delta_frame *ptr = &netplay->buffer[netplay->replay_ptr];
          serial_info.data       = ptr->state;
@@ -868,18 +896,36 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
 
          start = cpu_features_get_time_usec();
 
-         /* Remember the current state */
-         memset(serial_info.data, 0, serial_info.size);
-         core_serialize(&serial_info);
-         if (netplay->replay_frame_count < netplay->unread_frame_count)
-            netplay_handle_frame_hash(netplay, ptr);
+         /* Remember the current state, if anything can still use it */
+         if (netplay_replay_needs_state(netplay, ptr))
+         {
+            memset(serial_info.data, 0, serial_info.size);
+            core_serialize(&serial_info);
+            ptr->state_skipped = false;
+            serialized++;
+
+            now             = cpu_features_get_time_usec();
+            serialize_time += now - start;
+
+            if (netplay->replay_frame_count < netplay->unread_frame_count)
+            {
+               netplay_handle_frame_hash(netplay, ptr);
+               crc_time += cpu_features_get_time_usec() - now;
+            }
+         }
+         else
+            ptr->state_skipped = true;
 
          /* Re-simulate this frame's input */
          netplay_resolve_input(netplay, netplay->replay_ptr, true);
 
+         now = cpu_features_get_time_usec();
          autosave_lock();
          core_run();
          autosave_unlock();
+         run_time += cpu_features_get_time_usec() - now;
+         replayed++;
+
          netplay->replay_ptr = NEXT_PTR(netplay->replay_ptr);
          netplay->replay_frame_count++;
 
@@ -912,6 +958,20 @@ void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
       /* Average our time */
       netplay->frame_run_time_avg = netplay->frame_run_time_sum / NETPLAY_FRAME_RUN_TIME_WINDOW;
 
+      netplay->rollbacks++;
+      netplay->rollback_frames         += replayed;
+      netplay->rollback_serialized     += serialized;
+      netplay->rollback_run_time       += run_time;
+      netplay->rollback_serialize_time += serialize_time;
+      netplay->rollback_crc_time       += crc_time;
+      /* Totals are logged when netplay is freed */
+#ifdef DEBUG_NETPLAY_STEPS
+      RARCH_LOG("[netplay] Rollback of %u frames (%u serialized): "
+            "emulation %u us, serialization %u us, CRC %u us.\n",
+            replayed, serialized, (unsigned)run_time,
+            (unsigned)serialize_time, (unsigned)crc_time);
+#endif
+
       if (netplay->unread_frame_count < netplay->run_frame_count)
       {
          netplay->other_ptr = netplay->unread_ptr;
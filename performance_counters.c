@@ -15,6 +15,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #ifdef _WIN32
@@ -24,6 +25,11 @@
 #endif
 
 #include <compat/strl.h>
+#include <streams/file_stream.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "performance_counters.h"
 
@@ -41,6 +47,65 @@ static struct retro_perf_counter *perf_counters_libretro[MAX_COUNTERS];
 static unsigned perf_ptr_rarch;
 static unsigned perf_ptr_libretro;
 
+/* Events kept per thread, must be a power of two. */
+#define PROFILE_RING_SIZE    16384
+/* Oldest events skipped on export, the owning thread
+ * may be overwriting them while the ring is read. */
+#define PROFILE_RING_MARGIN  256
+#define PROFILE_MAX_THREADS  8
+/* Frames kept for the rolling percentiles. */
+#define PROFILE_WINDOW       256
+
+typedef struct rarch_profile_event
+{
+   retro_time_t time;
+   uint8_t stage;
+   uint8_t begin;
+} rarch_profile_event_t;
+
+typedef struct rarch_profile_ring
+{
+   rarch_profile_event_t events[PROFILE_RING_SIZE];
+   retro_time_t start[RARCH_PROFILE_STAGE_LAST];
+   retro_perf_tick_t ticks[RARCH_PROFILE_STAGE_LAST];
+   /* Only grown by the owning thread, summed up under
+    * rarch_profile_lock. */
+   retro_perf_tick_t call_cnt[RARCH_PROFILE_STAGE_LAST];
+   retro_perf_tick_t total[RARCH_PROFILE_STAGE_LAST];
+   retro_time_t frame_total[RARCH_PROFILE_STAGE_LAST];
+   /* Share of frame_total already in the window, guarded
+    * by rarch_profile_lock. */
+   retro_time_t frame_folded[RARCH_PROFILE_STAGE_LAST];
+   /* Only ever advanced by the owning thread. */
+   volatile unsigned head;
+} rarch_profile_ring_t;
+
+static const char *rarch_profile_stage_names[RARCH_PROFILE_STAGE_LAST] = {
+   "frame",
+   "input_poll",
+   "core_run",
+   "runahead",
+   "audio_flush",
+   "video_frame",
+   "menu",
+   "task_gather"
+};
+
+static struct retro_perf_counter rarch_profile_counters[RARCH_PROFILE_STAGE_LAST];
+/* Ring totals already added to rarch_profile_counters. */
+static struct retro_perf_counter rarch_profile_summed[RARCH_PROFILE_STAGE_LAST];
+static rarch_profile_ring_t *rarch_profile_rings[PROFILE_MAX_THREADS];
+static unsigned rarch_profile_ring_count;
+static retro_time_t rarch_profile_window[RARCH_PROFILE_STAGE_LAST][PROFILE_WINDOW];
+static unsigned rarch_profile_frames;
+static bool rarch_profile_ready;
+#ifdef HAVE_THREADS
+static slock_t *rarch_profile_lock;
+#ifdef HAVE_THREAD_STORAGE
+static sthread_tls_t rarch_profile_tls;
+#endif
+#endif
+
 struct retro_perf_counter **retro_get_perf_counter_rarch(void)
 {
    return perf_counters_rarch;
@@ -105,11 +170,47 @@ static void log_counters(struct retro_perf_counter **counters, unsigned num)
    }
 }
 
+/* Adds what every ring counted since the last call to the
+ * registered counters, so a reset from the menu sticks.
+ * Caller holds rarch_profile_lock. */
+static void rarch_profile_sum_counters(void)
+{
+   unsigned i, j;
+
+   for (i = 0; i < RARCH_PROFILE_STAGE_LAST; i++)
+   {
+      retro_perf_tick_t call_cnt = 0;
+      retro_perf_tick_t total    = 0;
+
+      for (j = 0; j < rarch_profile_ring_count; j++)
+      {
+         call_cnt += rarch_profile_rings[j]->call_cnt[i];
+         total    += rarch_profile_rings[j]->total[i];
+      }
+
+      rarch_profile_counters[i].call_cnt += call_cnt - rarch_profile_summed[i].call_cnt;
+      rarch_profile_counters[i].total    += total    - rarch_profile_summed[i].total;
+      rarch_profile_summed[i].call_cnt    = call_cnt;
+      rarch_profile_summed[i].total       = total;
+   }
+}
+
 void rarch_perf_log(void)
 {
    if (!rarch_ctl(RARCH_CTL_IS_PERFCNT_ENABLE, NULL))
       return;
 
+   if (rarch_profile_ready)
+   {
+#ifdef HAVE_THREADS
+      slock_lock(rarch_profile_lock);
+#endif
+      rarch_profile_sum_counters();
+#ifdef HAVE_THREADS
+      slock_unlock(rarch_profile_lock);
+#endif
+   }
+
    RARCH_LOG("[PERF]: Performance counters (RetroArch):\n");
    log_counters(perf_counters_rarch, perf_ptr_rarch);
 }
@@ -120,6 +221,285 @@ void retro_perf_log(void)
    log_counters(perf_counters_libretro, perf_ptr_libretro);
 }
 
+static rarch_profile_ring_t *rarch_profile_new_ring(void)
+{
+   rarch_profile_ring_t *ring = NULL;
+
+#ifdef HAVE_THREADS
+   slock_lock(rarch_profile_lock);
+#endif
+   if (rarch_profile_ring_count < PROFILE_MAX_THREADS)
+   {
+      ring = (rarch_profile_ring_t*)calloc(1, sizeof(*ring));
+      if (ring)
+         rarch_profile_rings[rarch_profile_ring_count++] = ring;
+   }
+#ifdef HAVE_THREADS
+   slock_unlock(rarch_profile_lock);
+#endif
+
+   return ring;
+}
+
+/* Returns the event ring of the calling thread, creating it
+ * on first use. Without thread-local storage only a single
+ * ring exists and the stages are expected to be entered from
+ * the main thread. */
+static rarch_profile_ring_t *rarch_profile_get_ring(void)
+{
+   rarch_profile_ring_t *ring = NULL;
+
+   if (!rarch_profile_ready)
+      return NULL;
+
+#if defined(HAVE_THREADS) && defined(HAVE_THREAD_STORAGE)
+   ring = (rarch_profile_ring_t*)sthread_tls_get(&rarch_profile_tls);
+   if (!ring)
+   {
+      ring = rarch_profile_new_ring();
+      if (ring)
+         sthread_tls_set(&rarch_profile_tls, ring);
+   }
+#else
+   ring = rarch_profile_rings[0];
+#endif
+
+   return ring;
+}
+
+static void rarch_profile_init(void)
+{
+   unsigned i;
+
+#ifdef HAVE_THREADS
+   rarch_profile_lock = slock_new();
+   if (!rarch_profile_lock)
+      return;
+#ifdef HAVE_THREAD_STORAGE
+   if (!sthread_tls_create(&rarch_profile_tls))
+      return;
+#endif
+#endif
+
+   for (i = 0; i < RARCH_PROFILE_STAGE_LAST; i++)
+   {
+      rarch_profile_counters[i].ident = rarch_profile_stage_names[i];
+      rarch_perf_register(&rarch_profile_counters[i]);
+   }
+
+#if !defined(HAVE_THREADS) || !defined(HAVE_THREAD_STORAGE)
+   if (!rarch_profile_new_ring())
+      return;
+#endif
+
+   rarch_profile_ready = true;
+}
+
+static void rarch_profile_push(rarch_profile_ring_t *ring,
+      enum rarch_profile_stage stage, bool begin, retro_time_t now)
+{
+   rarch_profile_event_t *ev = &ring->events[
+      ring->head & (PROFILE_RING_SIZE - 1)];
+
+   ev->time  = now;
+   ev->stage = (uint8_t)stage;
+   ev->begin = begin;
+   ring->head++;
+}
+
+void rarch_profile_begin(enum rarch_profile_stage stage)
+{
+   rarch_profile_ring_t *ring = NULL;
+   retro_time_t now;
+
+   if (!rarch_ctl(RARCH_CTL_IS_PERFCNT_ENABLE, NULL))
+      return;
+   if (!(ring = rarch_profile_get_ring()))
+      return;
+
+   now                = cpu_features_get_time_usec();
+   ring->start[stage] = now;
+   ring->ticks[stage] = cpu_features_get_perf_counter();
+   rarch_profile_push(ring, stage, true, now);
+}
+
+void rarch_profile_end(enum rarch_profile_stage stage)
+{
+   rarch_profile_ring_t *ring = NULL;
+   retro_perf_tick_t ticks;
+   retro_time_t now;
+
+   if (!rarch_ctl(RARCH_CTL_IS_PERFCNT_ENABLE, NULL))
+      return;
+   if (!(ring = rarch_profile_get_ring()) || !ring->start[stage])
+      return;
+
+   now   = cpu_features_get_time_usec();
+   ticks = cpu_features_get_perf_counter();
+
+   ring->call_cnt[stage]++;
+   ring->total[stage]       += ticks - ring->ticks[stage];
+   ring->frame_total[stage] += now - ring->start[stage];
+   ring->start[stage]        = 0;
+   rarch_profile_push(ring, stage, false, now);
+}
+
+void rarch_profile_frame(void)
+{
+   unsigned i, j;
+   unsigned slot;
+
+   if (!rarch_ctl(RARCH_CTL_IS_PERFCNT_ENABLE, NULL))
+      return;
+
+   if (!rarch_profile_ready)
+   {
+      rarch_profile_init();
+      rarch_profile_begin(RARCH_PROFILE_FRAME);
+      return;
+   }
+
+   rarch_profile_end(RARCH_PROFILE_FRAME);
+
+   /* Stages may run on other threads (e.g. tasks), fold what
+    * every ring gathered since the last frame into the one just
+    * closed. The rings are never cleared from here, the owning
+    * thread may be adding to them. */
+   slot = rarch_profile_frames & (PROFILE_WINDOW - 1);
+   for (i = 0; i < RARCH_PROFILE_STAGE_LAST; i++)
+      rarch_profile_window[i][slot] = 0;
+
+#ifdef HAVE_THREADS
+   slock_lock(rarch_profile_lock);
+#endif
+   for (j = 0; j < rarch_profile_ring_count; j++)
+   {
+      rarch_profile_ring_t *ring = rarch_profile_rings[j];
+
+      for (i = 0; i < RARCH_PROFILE_STAGE_LAST; i++)
+      {
+         retro_time_t frame_total       = ring->frame_total[i];
+
+         rarch_profile_window[i][slot] += frame_total - ring->frame_folded[i];
+         ring->frame_folded[i]          = frame_total;
+      }
+   }
+   rarch_profile_sum_counters();
+#ifdef HAVE_THREADS
+   slock_unlock(rarch_profile_lock);
+#endif
+
+   rarch_profile_frames++;
+   rarch_profile_begin(RARCH_PROFILE_FRAME);
+}
+
+static int rarch_profile_time_cmp(const void *a, const void *b)
+{
+   retro_time_t x = *(const retro_time_t*)a;
+   retro_time_t y = *(const retro_time_t*)b;
+   return (x > y) - (x < y);
+}
+
+size_t rarch_profile_get_stats(char *s, size_t len)
+{
+   unsigned i;
+   retro_time_t sorted[PROFILE_WINDOW];
+   size_t pos = 0;
+   unsigned n = rarch_profile_frames < PROFILE_WINDOW
+      ? rarch_profile_frames : PROFILE_WINDOW;
+
+   if (!n || !len)
+      return 0;
+
+   pos = strlcpy(s, "Frame Profiler (p50 / p99 ms):\n", len);
+
+   for (i = 0; i < RARCH_PROFILE_STAGE_LAST && pos < len; i++)
+   {
+      retro_time_t p50, p99;
+
+      memcpy(sorted, rarch_profile_window[i], n * sizeof(*sorted));
+      qsort(sorted, n, sizeof(*sorted), rarch_profile_time_cmp);
+
+      p99 = sorted[(n * 99) / 100];
+      /* Skip stages which did not run inside the window. */
+      if (!p99)
+         continue;
+      p50 = sorted[n / 2];
+
+      pos += snprintf(s + pos, len - pos, " -%s: %.2f / %.2f\n",
+            rarch_profile_stage_names[i],
+            p50 / 1000.0, p99 / 1000.0);
+   }
+
+   if (pos >= len)
+      pos = len - 1;
+
+   return pos;
+}
+
+bool rarch_profile_export(const char *path)
+{
+   unsigned j;
+   const char *sep = "";
+   RFILE *file     = NULL;
+
+   if (!rarch_profile_ready || !path || !*path)
+      return false;
+
+   file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+   if (!file)
+   {
+      RARCH_ERR("[PERF]: Failed to open trace file \"%s\".\n", path);
+      return false;
+   }
+
+   filestream_printf(file, "{\"traceEvents\":[\n");
+
+#ifdef HAVE_THREADS
+   slock_lock(rarch_profile_lock);
+#endif
+   for (j = 0; j < rarch_profile_ring_count; j++)
+   {
+      const rarch_profile_ring_t *ring = rarch_profile_rings[j];
+      unsigned head  = ring->head;
+      unsigned first = 0;
+      unsigned i;
+
+      if (head > PROFILE_RING_SIZE - PROFILE_RING_MARGIN)
+         first = head - (PROFILE_RING_SIZE - PROFILE_RING_MARGIN);
+
+      for (i = first; i != head; i++)
+      {
+         const rarch_profile_event_t *ev =
+            &ring->events[i & (PROFILE_RING_SIZE - 1)];
+
+         if (ev->stage >= RARCH_PROFILE_STAGE_LAST)
+            continue;
+
+         filestream_printf(file,
+               "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%lld,"
+               "\"pid\":1,\"tid\":%u}",
+               sep,
+               rarch_profile_stage_names[ev->stage],
+               ev->begin ? 'B' : 'E',
+               (long long)ev->time,
+               j);
+         sep = ",\n";
+      }
+   }
+#ifdef HAVE_THREADS
+   slock_unlock(rarch_profile_lock);
+#endif
+
+   filestream_printf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+   filestream_close(file);
+
+   RARCH_LOG("[PERF]: Frame profile written to \"%s\".\n", path);
+   return true;
+}
+
 void rarch_timer_tick(rarch_timer_t *timer)
 {
    if (!timer)
@@ -89,6 +89,69 @@ void rarch_perf_register(struct retro_perf_counter *perf);
  **/
 #define performance_counter_stop_plus(is_perfcnt_enable, perf) performance_counter_stop_internal(is_perfcnt_enable, perf)
 
+enum rarch_profile_stage
+{
+   RARCH_PROFILE_FRAME = 0,
+   RARCH_PROFILE_INPUT_POLL,
+   RARCH_PROFILE_CORE_RUN,
+   RARCH_PROFILE_RUNAHEAD,
+   RARCH_PROFILE_AUDIO_FLUSH,
+   RARCH_PROFILE_VIDEO_FRAME,
+   RARCH_PROFILE_MENU,
+   RARCH_PROFILE_TASK_GATHER,
+   RARCH_PROFILE_STAGE_LAST
+};
+
+/**
+ * rarch_profile_begin:
+ * @stage              : main loop stage being entered
+ *
+ * Opens a profiler scope for @stage on the calling thread.
+ * Does nothing unless performance counters are enabled.
+ **/
+void rarch_profile_begin(enum rarch_profile_stage stage);
+
+/**
+ * rarch_profile_end:
+ * @stage              : main loop stage being left
+ *
+ * Closes the profiler scope opened by rarch_profile_begin().
+ **/
+void rarch_profile_end(enum rarch_profile_stage stage);
+
+/**
+ * rarch_profile_frame:
+ *
+ * Marks a frame boundary. Closes the previous frame scope,
+ * pushes the per-stage totals of that frame into the rolling
+ * window used for percentiles and opens a new frame scope.
+ * Must be called from the main thread once per runloop iteration.
+ **/
+void rarch_profile_frame(void);
+
+/**
+ * rarch_profile_get_stats:
+ * @s                  : output buffer
+ * @len                : size of @s
+ *
+ * Writes rolling p50/p99 timings per stage into @s.
+ *
+ * Returns: number of characters written, 0 if there is
+ * nothing to report yet.
+ **/
+size_t rarch_profile_get_stats(char *s, size_t len);
+
+/**
+ * rarch_profile_export:
+ * @path               : destination file
+ *
+ * Dumps the recorded scopes of every thread as Chrome
+ * trace-event JSON (chrome://tracing, Perfetto).
+ *
+ * Returns: true on success.
+ **/
+bool rarch_profile_export(const char *path);
+
 void rarch_timer_tick(rarch_timer_t *timer);
 
 bool rarch_timer_is_running(rarch_timer_t *timer);
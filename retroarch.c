@@ -2642,6 +2642,8 @@ static enum runloop_state runloop_check_state(
 
          iter.action               = action;
 
+         rarch_profile_begin(RARCH_PROFILE_MENU);
+
          if (!menu_driver_iterate(&iter))
             rarch_menu_running_finished();
 
@@ -2660,6 +2662,8 @@ static enum runloop_state runloop_check_state(
                audio_driver_menu_sample();
          }
 
+         rarch_profile_end(RARCH_PROFILE_MENU);
+
          old_input                 = current_input;
 
          if (!focused)
@@ -3220,6 +3224,8 @@ int runloop_iterate(unsigned *sleep_ms)
    settings_t *settings                         = config_get_ptr();
    unsigned max_users                           = *(input_driver_get_uint(INPUT_ACTION_MAX_USERS));
 
+   rarch_profile_frame();
+
    if (runloop_frame_time.callback)
    {
       /* Updates frame timing if frame timing callback is in use by the core.
@@ -3302,10 +3308,21 @@ int runloop_iterate(unsigned *sleep_ms)
 #ifdef HAVE_RUNAHEAD
    /* Run Ahead Feature replaces the call to core_run in this loop */
    if (settings->bools.run_ahead_enabled && settings->uints.run_ahead_frames > 0)
-      run_ahead(settings->uints.run_ahead_frames, settings->bools.run_ahead_secondary_instance);
+   {
+      rarch_profile_begin(RARCH_PROFILE_RUNAHEAD);
+      run_ahead(settings->uints.run_ahead_frames,
+            settings->bools.run_ahead_secondary_instance,
+            settings->bools.run_ahead_state_ring,
+            settings->bools.run_ahead_secondary_threaded);
+      rarch_profile_end(RARCH_PROFILE_RUNAHEAD);
+   }
    else
 #endif
+   {
+      rarch_profile_begin(RARCH_PROFILE_CORE_RUN);
       core_run();
+      rarch_profile_end(RARCH_PROFILE_CORE_RUN);
+   }
 
 #ifdef HAVE_CHEEVOS
    if (runloop_check_cheevos())
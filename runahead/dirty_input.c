@@ -1,6 +1,7 @@
 #include <stdlib.h>
 
 #include <boolean.h>
+#include <retro_miscellaneous.h>
 
 #include "../core.h"
 #include "../dynamic.h"
@@ -17,9 +18,18 @@ typedef struct InputListElement_t
    unsigned port;
    unsigned device;
    unsigned index;
+   /* Bit n set if state[n] was queried by the core */
+   uint64_t queried;
    int16_t state[36];
 } InputListElement;
 
+/* Copy of the current input, read by a secondary core
+ * running on another thread */
+static InputListElement *input_snapshot    = NULL;
+static unsigned input_snapshot_count       = 0;
+static unsigned input_snapshot_capacity    = 0;
+static bool input_snapshot_missed          = false;
+
 extern struct retro_core_t current_core;
 extern struct retro_callbacks retro_ctx;
 
@@ -29,6 +39,118 @@ static function_t retro_reset_callback_original = NULL;
 static LoadStateFunction retro_unserialize_callback_original = NULL;
 static retro_input_state_t input_state_callback_original;
 
+bool input_state_peek_dirty(void)
+{
+   unsigned i, id;
+
+   if (!input_state_callback_original || !input_state_list)
+      return true;
+
+   for (i = 0; i < (unsigned)input_state_list->size; i++)
+   {
+      InputListElement *element =
+         (InputListElement*)input_state_list->data[i];
+
+      for (id = 0; id < ARRAY_SIZE(element->state); id++)
+      {
+         if (!(element->queried & ((uint64_t)1 << id)))
+            continue;
+
+         if (input_state_callback_original(element->port,
+                  element->device, element->index, id)
+               != element->state[id])
+            return true;
+      }
+   }
+
+   return false;
+}
+
+void input_state_snapshot(void)
+{
+   unsigned i, id;
+
+   input_snapshot_count  = 0;
+   input_snapshot_missed = false;
+
+   if (!input_state_callback_original || !input_state_list)
+      return;
+
+   if ((unsigned)input_state_list->size > input_snapshot_capacity)
+   {
+      InputListElement *elements = (InputListElement*)realloc(input_snapshot,
+            input_state_list->size * sizeof(*elements));
+
+      if (!elements)
+         return;
+
+      input_snapshot          = elements;
+      input_snapshot_capacity = input_state_list->size;
+   }
+
+   for (i = 0; i < (unsigned)input_state_list->size; i++)
+   {
+      const InputListElement *element =
+         (const InputListElement*)input_state_list->data[i];
+      InputListElement *copy = &input_snapshot[input_snapshot_count++];
+
+      *copy = *element;
+
+      for (id = 0; id < ARRAY_SIZE(copy->state); id++)
+         if (copy->queried & ((uint64_t)1 << id))
+            copy->state[id] = input_state_callback_original(
+                  copy->port, copy->device, copy->index, id);
+   }
+}
+
+int16_t input_state_snapshot_get(unsigned port,
+      unsigned device, unsigned index, unsigned id)
+{
+   unsigned i;
+
+   for (i = 0; i < input_snapshot_count; i++)
+   {
+      const InputListElement *element = &input_snapshot[i];
+
+      if (     element->port   == port
+            && element->device == device
+            && element->index  == index
+            && id < ARRAY_SIZE(element->state)
+            && (element->queried & ((uint64_t)1 << id)))
+         return element->state[id];
+   }
+
+   input_snapshot_missed = true;
+   return 0;
+}
+
+bool input_state_snapshot_is_stale(void)
+{
+   unsigned i, id;
+
+   if (input_snapshot_missed || !input_state_list)
+      return true;
+
+   for (i = 0; i < (unsigned)input_state_list->size; i++)
+   {
+      const InputListElement *element =
+         (const InputListElement*)input_state_list->data[i];
+
+      for (id = 0; id < ARRAY_SIZE(element->state); id++)
+      {
+         if (!(element->queried & ((uint64_t)1 << id)))
+            continue;
+
+         if (input_state_snapshot_get(element->port,
+                  element->device, element->index, id)
+               != element->state[id])
+            return true;
+      }
+   }
+
+   return input_snapshot_missed;
+}
+
 static void reset_hook(void);
 static bool unserialze_hook(const void *buf, size_t size);
 
@@ -43,6 +165,10 @@ static void* InputListElementConstructor(void)
 static void input_state_destory(void)
 {
    mylist_destroy(&input_state_list);
+   free(input_snapshot);
+   input_snapshot          = NULL;
+   input_snapshot_count    = 0;
+   input_snapshot_capacity = 0;
 }
 
 static void input_state_set_last(unsigned port, unsigned device,
@@ -63,6 +189,8 @@ static void input_state_set_last(unsigned port, unsigned device,
             && element->device == device && element->index == index)
       {
          element->state[id] = value;
+         if (id < ARRAY_SIZE(element->state))
+            element->queried |= (uint64_t)1 << id;
          return;
       }
    }
@@ -73,6 +201,8 @@ static void input_state_set_last(unsigned port, unsigned device,
    element->device    = device;
    element->index     = index;
    element->state[id] = value;
+   if (id < ARRAY_SIZE(element->state))
+      element->queried |= (uint64_t)1 << id;
 }
 
 static int16_t input_state_get_last(unsigned port,
@@ -1,6 +1,8 @@
 #ifndef __DIRTY_INPUT_H___
 #define __DIRTY_INPUT_H___
 
+#include <stdint.h>
+
 #include "retro_common_api.h"
 #include "boolean.h"
 
@@ -10,6 +12,21 @@ extern bool input_is_dirty;
 void add_input_state_hook(void);
 void remove_input_state_hook(void);
 
+/* Compares the current input against everything the core queried
+ * during its last frame, without running it. Input must have been
+ * polled already. */
+bool input_state_peek_dirty(void);
+
+/* Takes a copy of the current input for everything the core queried
+ * during its last frame. The copy can be read from another thread
+ * while the main core runs. */
+void input_state_snapshot(void);
+int16_t input_state_snapshot_get(unsigned port,
+      unsigned device, unsigned index, unsigned id);
+
+/* True if the main core saw different input than the snapshot. */
+bool input_state_snapshot_is_stale(void);
+
 RETRO_END_DECLS
 
 #endif
@@ -13,10 +13,19 @@
 #include "../dynamic.h"
 #include "../audio/audio_driver.h"
 #include "../gfx/video_driver.h"
+#include "../input/input_driver.h"
+#include "../performance_counters.h"
+#include "../retroarch.h"
+
+#ifdef HAVE_NETWORKING
+#include "../network/netplay/netplay.h"
+#endif
 
 static bool runahead_create(void);
 static bool runahead_save_state(void);
 static bool runahead_load_state(void);
+static bool runahead_save_state_index(int index);
+static bool runahead_load_state_index(int index);
 static bool runahead_load_state_secondary(void);
 static bool runahead_run_secondary(void);
 static void runahead_suspend_audio(void);
@@ -77,11 +86,9 @@ static void runahead_save_state_list_destroy(void)
    mylist_destroy(&runahead_save_state_list);
 }
 
-#if 0
 static void runahead_save_state_list_rotate(void)
 {
    int i;
-   void *element;
    void *firstElement;
    firstElement = runahead_save_state_list->data[0];
    for (i = 1; i < runahead_save_state_list->size; i++)
@@ -90,7 +97,6 @@ static void runahead_save_state_list_rotate(void)
    runahead_save_state_list->data[runahead_save_state_list->size - 1] =
       firstElement;
 }
-#endif
 
 /* Hooks - Hooks to cleanup, and add dirty input hooks */
 
@@ -172,6 +178,8 @@ static bool runahead_video_driver_is_active   = true;
 static bool runahead_available                = true;
 static bool runahead_secondary_core_available = true;
 static bool runahead_force_input_dirty        = true;
+static bool runahead_state_ring_valid         = false;
+static bool runahead_secondary_state_valid    = false;
 static uint64_t runahead_last_frame_count     = 0;
 
 static void runahead_clear_variables(void)
@@ -181,6 +189,8 @@ static void runahead_clear_variables(void)
    runahead_available                = true;
    runahead_secondary_core_available = true;
    runahead_force_input_dirty        = true;
+   runahead_state_ring_valid         = false;
+   runahead_secondary_state_valid    = false;
    runahead_last_frame_count         = 0;
 }
 
@@ -198,7 +208,217 @@ static void runahead_check_for_gui(void)
    runahead_last_frame_count = frame_count;
 }
 
-void run_ahead(int runahead_count, bool useSecondary)
+/* Single instance with a ring of savestates.
+ *
+ * Entry n of the save state list holds the state n frames after the
+ * last real frame, up to the frame being displayed. Between calls the
+ * core is put back at the last real frame, so savestates, rewind,
+ * cheevos, SRAM and the other run ahead modes never see a state that
+ * was only emulated ahead. While input stays the same, the frames
+ * emulated ahead are still valid, so only one new frame has to be run.
+ * When it changes, we emulate ahead again from the last real frame,
+ * refilling the ring on the way. */
+static void run_ahead_state_ring(int runahead_count)
+{
+   int frame_number;
+   bool rollback = runahead_force_input_dirty || !runahead_state_ring_valid;
+
+   /* A reset or savestate load replaced the emulated state,
+    * the ring does not lead up to it anymore. */
+   if (input_is_dirty)
+   {
+      runahead_state_ring_valid = false;
+      rollback                  = true;
+   }
+
+   if (runahead_save_state_list->size != runahead_count + 1)
+   {
+      mylist_resize(runahead_save_state_list, runahead_count + 1, true);
+      runahead_state_ring_valid = false;
+      rollback                  = true;
+   }
+
+   input_poll();
+
+   if (!rollback)
+      rollback = input_state_peek_dirty();
+
+   if (!rollback)
+   {
+      /* The next real frame becomes entry 0, the oldest entry
+       * is reused for the new frame being displayed. */
+      runahead_save_state_list_rotate();
+
+      if (!runahead_load_state_index(runahead_count - 1))
+         return;
+
+      core_run_no_input_polling();
+
+      if (!runahead_save_state_index(runahead_count))
+         return;
+   }
+   else
+   {
+      for (frame_number = 0; frame_number < runahead_count; frame_number++)
+      {
+         runahead_suspend_audio();
+         runahead_suspend_video();
+         core_run_no_input_polling();
+         runahead_resume_video();
+         runahead_resume_audio();
+
+         if (!runahead_save_state_index(frame_number))
+            return;
+      }
+
+      core_run_no_input_polling();
+
+      if (!runahead_save_state_index(runahead_count))
+         return;
+
+      runahead_state_ring_valid = true;
+   }
+
+   if (!runahead_load_state_index(0))
+      return;
+
+   input_is_dirty             = false;
+   runahead_force_input_dirty = false;
+}
+
+#if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
+static struct retro_perf_counter runahead_secondary_thread = {0};
+static struct retro_perf_counter runahead_join_wait        = {0};
+static struct retro_perf_counter runahead_overlap          = {0};
+
+/* Secondary instance on its own thread.
+ *
+ * The save state list keeps the state after the previous real frame.
+ * When input changes, the secondary core starts from that state on a
+ * worker thread, emulating this frame and the ones after it with the
+ * new input while the main core produces the real frame. Both are
+ * joined before the secondary core runs the frame to be displayed. */
+static void run_ahead_secondary_threaded(int runahead_count)
+{
+   bool okay      = false;
+   bool resync    = true;
+   bool speculate = false;
+   bool *perfcnt  = NULL;
+
+   rarch_ctl(RARCH_CTL_GET_PERFCNT, &perfcnt);
+
+   input_poll();
+
+   /* Anything but changed input (reset, savestate load, menu)
+    * makes the stored state useless. */
+   if (     !input_is_dirty
+         && !runahead_force_input_dirty
+         && runahead_secondary_state_valid)
+   {
+      speculate = input_state_peek_dirty();
+      resync    = speculate;
+   }
+
+   if (speculate)
+   {
+      if (!runahead_load_state_secondary())
+         return;
+
+      input_state_snapshot();
+
+      if (!secondary_core_run_async((unsigned)runahead_count))
+      {
+         runahead_secondary_core_available = false;
+         return;
+      }
+   }
+
+   runahead_suspend_video();
+   core_run_input_polled();
+   runahead_resume_video();
+
+   okay = runahead_save_state();
+
+   /* The main core may have queried input the peek did not
+    * cover, or been reset, as in the serial path. */
+   if (!speculate && input_is_dirty)
+      resync = true;
+
+   if (speculate)
+   {
+      retro_perf_tick_t wait_start = cpu_features_get_perf_counter();
+      retro_perf_tick_t run_ticks  = secondary_core_wait();
+      retro_perf_tick_t wait_ticks = cpu_features_get_perf_counter()
+         - wait_start;
+
+      /* Time spent emulating ahead vs. time the main thread had to
+       * wait for it; the difference ran in parallel with the main core. */
+      if (*perfcnt)
+      {
+         performance_counter_init(runahead_secondary_thread,
+               "runahead_secondary_thread");
+         performance_counter_init(runahead_join_wait, "runahead_join_wait");
+         performance_counter_init(runahead_overlap, "runahead_overlap");
+
+         runahead_join_wait.total        += wait_ticks;
+         runahead_join_wait.call_cnt++;
+         runahead_secondary_thread.total += run_ticks;
+         runahead_secondary_thread.call_cnt++;
+         runahead_overlap.total          += run_ticks > wait_ticks
+            ? run_ticks - wait_ticks : 0;
+         runahead_overlap.call_cnt++;
+      }
+
+      /* The main core saw other input than we speculated with. */
+      if (!input_state_snapshot_is_stale())
+         resync = false;
+   }
+
+   /* RunAhead has been disabled due to save state failure */
+   if (!okay)
+      return;
+
+   runahead_secondary_state_valid = true;
+
+   if (resync)
+   {
+      unsigned frame_count;
+
+      if (!runahead_load_state_secondary())
+         return;
+
+      for (frame_count = 0; frame_count <
+            (unsigned)(runahead_count - 1); frame_count++)
+      {
+         runahead_suspend_video();
+         runahead_suspend_audio();
+         set_hard_disable_audio();
+         okay = runahead_run_secondary();
+         unset_hard_disable_audio();
+         runahead_resume_audio();
+         runahead_resume_video();
+
+         if (!okay)
+            return;
+      }
+   }
+
+   runahead_suspend_audio();
+   set_hard_disable_audio();
+   okay = runahead_run_secondary();
+   unset_hard_disable_audio();
+   runahead_resume_audio();
+
+   if (!okay)
+      return;
+
+   input_is_dirty             = false;
+   runahead_force_input_dirty = false;
+}
+#endif
+
+void run_ahead(int runahead_count, bool useSecondary,
+      bool useStateRing, bool useThreads)
 {
    int frame_number        = 0;
    bool last_frame         = false;
@@ -230,6 +450,35 @@ void run_ahead(int runahead_count, bool useSecondary)
 
    runahead_check_for_gui();
 
+#ifdef HAVE_NETWORKING
+   /* Netplay has to see every real frame go through core_run. */
+   if (netplay_driver_ctl(RARCH_NETPLAY_CTL_IS_ENABLED, NULL))
+      useStateRing = false;
+#endif
+
+   if (useStateRing && !useSecondary)
+   {
+      run_ahead_state_ring(runahead_count);
+      return;
+   }
+
+   runahead_state_ring_valid = false;
+
+#if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
+   if (useSecondary && useThreads && runahead_secondary_core_available)
+   {
+      struct retro_hw_render_callback *hwr = video_driver_get_hw_context();
+
+      /* Hardware rendered cores need the context on the main thread. */
+      if (!hwr || hwr->context_type == RETRO_HW_CONTEXT_NONE)
+      {
+         run_ahead_secondary_threaded(runahead_count);
+         return;
+      }
+   }
+   runahead_secondary_state_valid = false;
+#endif
+
    if (!useSecondary || !have_dynamic || !runahead_secondary_core_available)
    {
       /* TODO: multiple savestates for higher performance 
@@ -275,7 +524,7 @@ void run_ahead(int runahead_count, bool useSecondary)
    }
    else
    {
-#if HAVE_DYNAMIC
+#if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
       bool okay = false;
 
       /* run main core with video suspended */
@@ -359,13 +608,18 @@ static bool runahead_create(void)
 }
 
 static bool runahead_save_state(void)
+{
+   return runahead_save_state_index(0);
+}
+
+static bool runahead_save_state_index(int index)
 {
    bool okay                                  = false;
    retro_ctx_serialize_info_t *serialize_info;
    if (!runahead_save_state_list)
       return false;
    serialize_info =
-      (retro_ctx_serialize_info_t*)runahead_save_state_list->data[0];
+      (retro_ctx_serialize_info_t*)runahead_save_state_list->data[index];
    set_fast_savestate();
    okay = core_serialize(serialize_info);
    unset_fast_savestate();
@@ -378,10 +632,15 @@ static bool runahead_save_state(void)
 }
 
 static bool runahead_load_state(void)
+{
+   return runahead_load_state_index(0);
+}
+
+static bool runahead_load_state_index(int index)
 {
    bool okay                                  = false;
    retro_ctx_serialize_info_t *serialize_info = (retro_ctx_serialize_info_t*)
-      runahead_save_state_list->data[0];
+      runahead_save_state_list->data[index];
    bool last_dirty                            = input_is_dirty;
 
    set_fast_savestate();
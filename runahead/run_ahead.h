@@ -10,7 +10,8 @@ RETRO_BEGIN_DECLS
 
 void runahead_destroy(void);
 
-void run_ahead(int runAheadCount, bool useSecondary);
+void run_ahead(int runAheadCount, bool useSecondary,
+      bool useStateRing, bool useThreads);
 
 bool want_fast_savestate(void);
 bool get_hard_disable_audio(void);
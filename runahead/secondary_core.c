@@ -14,13 +14,24 @@
 #include <dynamic/dylib.h>
 #include <file/file_path.h>
 #include <streams/file_stream.h>
+#include <features/features_cpu.h>
+#include <string/stdstring.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 
 #include "mem_util.h"
+#include "dirty_input.h"
 
 #include "../core.h"
 #include "../dynamic.h"
 #include "../paths.h"
 #include "../content.h"
+#include "../configuration.h"
+#include "../msg_hash.h"
+#include "../retroarch.h"
+#include "../managers/core_option_manager.h"
 
 #include "secondary_core.h"
 
@@ -31,6 +42,17 @@ static dylib_t secondary_module;
 static struct retro_core_t secondary_core;
 static struct retro_callbacks secondary_callbacks;
 
+#ifdef HAVE_THREADS
+static sthread_t *secondary_thread;
+static slock_t *secondary_lock;
+static scond_t *secondary_cond;
+static unsigned secondary_thread_frames;
+static bool secondary_thread_busy;
+static bool secondary_thread_quit;
+#endif
+static bool secondary_async;
+static retro_perf_tick_t secondary_run_ticks;
+
 extern retro_ctx_load_content_info_t *load_content_info;
 extern enum rarch_core_type last_core_type;
 extern struct retro_callbacks retro_ctx;
@@ -275,9 +297,158 @@ bool secondary_core_create(void)
 
 static bool has_variable_update;
 
+/* What the secondary core may ask for while it runs ahead off the
+ * main thread. rarch_environment_cb() is not safe to call then: it
+ * touches driver state and the core option update flag the main core
+ * polls at the same time. So the read-only queries are answered from
+ * a copy taken on the main thread, everything else is ignored. */
+struct secondary_variable
+{
+   size_t key;
+   size_t value;
+};
+
+static struct secondary_variable *secondary_variables;
+static size_t secondary_variables_count;
+static size_t secondary_variables_capacity;
+static char *secondary_variables_buf;
+static size_t secondary_variables_buf_size;
+static bool secondary_env_overscan;
+#ifdef HAVE_LANGEXTRA
+static unsigned secondary_env_language;
+#endif
+
+static void secondary_environment_snapshot(void)
+{
+   size_t i;
+   size_t len                  = 0;
+   size_t pos                  = 0;
+   core_option_manager_t *opts = NULL;
+   settings_t *settings        = config_get_ptr();
+
+   secondary_env_overscan    = !settings->bools.video_crop_overscan;
+#ifdef HAVE_LANGEXTRA
+   secondary_env_language    = *msg_hash_get_uint(MSG_HASH_USER_LANGUAGE);
+#endif
+   secondary_variables_count = 0;
+
+   rarch_ctl(RARCH_CTL_CORE_OPTIONS_LIST_GET, &opts);
+   if (!opts)
+      return;
+
+   for (i = 0; i < opts->size; i++)
+   {
+      if (string_is_empty(opts->opts[i].key) || !opts->opts[i].vals)
+         continue;
+      len += strlen(opts->opts[i].key) + 1;
+      len += strlen(core_option_manager_get_val(opts, i)) + 1;
+   }
+
+   if (opts->size > secondary_variables_capacity)
+   {
+      struct secondary_variable *vars = (struct secondary_variable*)
+         realloc(secondary_variables, opts->size * sizeof(*vars));
+      if (!vars)
+         return;
+      secondary_variables          = vars;
+      secondary_variables_capacity = opts->size;
+   }
+
+   if (len > secondary_variables_buf_size)
+   {
+      char *buf = (char*)realloc(secondary_variables_buf, len);
+      if (!buf)
+         return;
+      secondary_variables_buf      = buf;
+      secondary_variables_buf_size = len;
+   }
+
+   for (i = 0; i < opts->size; i++)
+   {
+      struct secondary_variable *var = NULL;
+      const char *key                = opts->opts[i].key;
+      const char *value              = NULL;
+
+      if (string_is_empty(key) || !opts->opts[i].vals)
+         continue;
+
+      value      = core_option_manager_get_val(opts, i);
+      var        = &secondary_variables[secondary_variables_count++];
+      var->key   = pos;
+      strcpy(secondary_variables_buf + pos, key);
+      pos       += strlen(key) + 1;
+      var->value = pos;
+      strcpy(secondary_variables_buf + pos, value);
+      pos       += strlen(value) + 1;
+   }
+}
+
+static bool rarch_environment_secondary_core_async(unsigned cmd, void *data)
+{
+   switch (cmd)
+   {
+      case RETRO_ENVIRONMENT_GET_VARIABLE:
+         {
+            size_t i;
+            struct retro_variable *var = (struct retro_variable*)data;
+
+            if (!var)
+               return false;
+
+            var->value = NULL;
+            for (i = 0; i < secondary_variables_count; i++)
+            {
+               if (string_is_equal(secondary_variables_buf
+                        + secondary_variables[i].key, var->key))
+               {
+                  var->value = secondary_variables_buf
+                     + secondary_variables[i].value;
+                  break;
+               }
+            }
+         }
+         break;
+
+      case RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE:
+         /* Left pending for the next frame run on the main thread */
+         *(bool*)data = false;
+         break;
+
+      case RETRO_ENVIRONMENT_GET_OVERSCAN:
+         *(bool*)data = secondary_env_overscan;
+         break;
+
+      case RETRO_ENVIRONMENT_GET_CAN_DUPE:
+         *(bool*)data = true;
+         break;
+
+#ifdef HAVE_LANGEXTRA
+      case RETRO_ENVIRONMENT_GET_LANGUAGE:
+         *(unsigned*)data = secondary_env_language;
+         break;
+#endif
+
+      case RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE:
+         /* Nothing of these frames is presented */
+         if (data)
+            *(int*)data = 8;
+         break;
+
+      default:
+         return false;
+   }
+
+   return true;
+}
+
 static bool rarch_environment_secondary_core_hook(unsigned cmd, void *data)
 {
-   bool result = rarch_environment_cb(cmd, data);
+   bool result;
+
+   if (secondary_async)
+      return rarch_environment_secondary_core_async(cmd, data);
+
+   result = rarch_environment_cb(cmd, data);
    if (cmd == RETRO_ENVIRONMENT_GET_VARIABLE_UPDATE && has_variable_update)
    {
       bool *bool_p = (bool*)data;
@@ -304,6 +475,172 @@ bool secondary_core_run_no_input_polling(void)
    return true;
 }
 
+/* Callbacks used while running ahead off the main thread:
+ * output is dropped and input comes from the snapshot. */
+static void secondary_video_null(const void *data, unsigned width,
+      unsigned height, size_t pitch)
+{
+}
+
+static void secondary_audio_sample_null(int16_t left, int16_t right)
+{
+}
+
+static size_t secondary_audio_sample_batch_null(
+      const int16_t *data, size_t frames)
+{
+   return frames;
+}
+
+static void secondary_input_poll_null(void)
+{
+}
+
+static void secondary_run_frames(unsigned frames)
+{
+   retro_perf_tick_t start = cpu_features_get_perf_counter();
+
+   while (frames--)
+      secondary_core.retro_run();
+
+   secondary_run_ticks = cpu_features_get_perf_counter() - start;
+}
+
+#ifdef HAVE_THREADS
+static void secondary_thread_loop(void *data)
+{
+   slock_lock(secondary_lock);
+
+   for (;;)
+   {
+      unsigned frames;
+
+      while (!secondary_thread_busy && !secondary_thread_quit)
+         scond_wait(secondary_cond, secondary_lock);
+
+      if (secondary_thread_quit)
+         break;
+
+      frames = secondary_thread_frames;
+      slock_unlock(secondary_lock);
+
+      secondary_run_frames(frames);
+
+      slock_lock(secondary_lock);
+      secondary_thread_busy = false;
+      scond_signal(secondary_cond);
+   }
+
+   slock_unlock(secondary_lock);
+}
+
+static bool secondary_thread_init(void)
+{
+   if (secondary_thread)
+      return true;
+
+   secondary_lock = slock_new();
+   secondary_cond = scond_new();
+
+   if (secondary_lock && secondary_cond)
+      secondary_thread = sthread_create(secondary_thread_loop, NULL);
+
+   if (secondary_thread)
+      return true;
+
+   if (secondary_lock)
+      slock_free(secondary_lock);
+   if (secondary_cond)
+      scond_free(secondary_cond);
+   secondary_lock = NULL;
+   secondary_cond = NULL;
+   return false;
+}
+
+static void secondary_thread_deinit(void)
+{
+   if (!secondary_thread)
+      return;
+
+   slock_lock(secondary_lock);
+   secondary_thread_quit = true;
+   scond_signal(secondary_cond);
+   slock_unlock(secondary_lock);
+
+   sthread_join(secondary_thread);
+   slock_free(secondary_lock);
+   scond_free(secondary_cond);
+
+   secondary_thread      = NULL;
+   secondary_lock        = NULL;
+   secondary_cond        = NULL;
+   secondary_thread_busy = false;
+   secondary_thread_quit = false;
+}
+#endif
+
+bool secondary_core_run_async(unsigned frames)
+{
+   if (!secondary_module)
+   {
+      if (!secondary_core_create())
+         return false;
+   }
+
+   secondary_core.retro_set_video_refresh(secondary_video_null);
+   secondary_core.retro_set_audio_sample(secondary_audio_sample_null);
+   secondary_core.retro_set_audio_sample_batch(
+         secondary_audio_sample_batch_null);
+   secondary_core.retro_set_input_state(input_state_snapshot_get);
+   secondary_core.retro_set_input_poll(secondary_input_poll_null);
+
+   secondary_environment_snapshot();
+   secondary_async = true;
+
+#ifdef HAVE_THREADS
+   if (secondary_thread_init())
+   {
+      slock_lock(secondary_lock);
+      secondary_thread_frames = frames;
+      secondary_thread_busy   = true;
+      scond_signal(secondary_cond);
+      slock_unlock(secondary_lock);
+      return true;
+   }
+#endif
+
+   secondary_run_frames(frames);
+   secondary_async = false;
+   return true;
+}
+
+retro_perf_tick_t secondary_core_wait(void)
+{
+#ifdef HAVE_THREADS
+   if (secondary_thread)
+   {
+      slock_lock(secondary_lock);
+      while (secondary_thread_busy)
+         scond_wait(secondary_cond, secondary_lock);
+      slock_unlock(secondary_lock);
+   }
+#endif
+
+   secondary_async = false;
+
+   if (secondary_module)
+   {
+      secondary_core.retro_set_video_refresh(secondary_callbacks.frame_cb);
+      secondary_core.retro_set_audio_sample(secondary_callbacks.sample_cb);
+      secondary_core.retro_set_audio_sample_batch(
+            secondary_callbacks.sample_batch_cb);
+      secondary_core.retro_set_input_state(secondary_callbacks.state_cb);
+      secondary_core.retro_set_input_poll(secondary_callbacks.poll_cb);
+   }
+
+   return secondary_run_ticks;
+}
+
 bool secondary_core_deserialize(const void *buffer, int size)
 {
    if (!secondary_module)
@@ -319,6 +656,16 @@ bool secondary_core_deserialize(const void *buffer, int size)
 
 void secondary_core_destroy(void)
 {
+#ifdef HAVE_THREADS
+   secondary_thread_deinit();
+#endif
+
+   FREE(secondary_variables);
+   FREE(secondary_variables_buf);
+   secondary_variables_count    = 0;
+   secondary_variables_capacity = 0;
+   secondary_variables_buf_size = 0;
+
    if (secondary_module)
    {
       /* unload game from core */
@@ -364,6 +711,14 @@ bool secondary_core_deserialize(const void *buffer, int size)
 {
    return false;
 }
+bool secondary_core_run_async(unsigned frames)
+{
+   return false;
+}
+retro_perf_tick_t secondary_core_wait(void)
+{
+   return 0;
+}
 void secondary_core_destroy(void)
 {
    /* do nothing */
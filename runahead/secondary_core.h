@@ -5,6 +5,7 @@
 #include <boolean.h>
 
 #include <retro_common_api.h>
+#include <libretro.h>
 
 #include "../core_type.h"
 
@@ -12,6 +13,12 @@ RETRO_BEGIN_DECLS
 
 bool secondary_core_run_no_input_polling(void);
 bool secondary_core_deserialize(const void *buffer, int size);
+
+/* Runs frames with no audio/video output on a worker thread, reading
+ * input from the dirty_input snapshot. secondary_core_wait() joins it,
+ * restores the regular callbacks and returns the ticks spent running. */
+bool secondary_core_run_async(unsigned frames);
+retro_perf_tick_t secondary_core_wait(void);
 void secondary_core_destroy(void);
 void set_last_core_type(enum rarch_core_type type);
 void remember_controller_port_device(long port, long device);
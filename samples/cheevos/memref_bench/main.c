@@ -0,0 +1,319 @@
+/* Replays RAM snapshots against achievement conditions and compares the
+ * per-frame cost of reading every operand through the memory lookup with
+ * the shared memory references latched once per frame.
+ *
+ *    cheevos_memref_bench [memaddrs.txt [snapshots.bin [ram_size]]]
+ *
+ * memaddrs.txt holds one achievement MemAddr per line, as found in the
+ * sets served by retroachievements.org. snapshots.bin is a sequence of
+ * raw system RAM dumps of ram_size bytes each (64 KiB by default). When
+ * they are not given, a synthetic set and random snapshots are used.
+ *
+ * var.c and cond.c are compiled into this file; the frontend entry points
+ * they reference are stubbed below. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../../cheevos/var.c"
+#include "../../../cheevos/cond.c"
+
+#define MAX_CONDS      65536
+#define GEN_CONDS      4000
+#define GEN_HOT_ADDRS  600
+#define GEN_SNAPSHOTS  64
+#define FRAMES         20000
+
+static uint8_t *bench_ram;
+static size_t bench_ram_size = 0x10000;
+static rarch_system_info_t bench_system;
+
+static cheevos_cond_t bench_conds[MAX_CONDS];
+static unsigned bench_num_conds;
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/* Frontend stubs */
+
+#ifndef RARCH_INTERNAL
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...) { }
+#endif
+void cheevos_log(const char *fmt, ...) { }
+
+rarch_system_info_t *runloop_get_system_info(void)
+{
+   return &bench_system;
+}
+
+bool core_get_memory(retro_ctx_memory_info_t *info)
+{
+   info->data = NULL;
+   info->size = 0;
+
+   if (info->id == RETRO_MEMORY_SYSTEM_RAM)
+   {
+      info->data = bench_ram;
+      info->size = bench_ram_size;
+   }
+
+   return true;
+}
+
+/* Condition sets */
+
+static void bench_parse(const char *memaddr)
+{
+   while (*memaddr && bench_num_conds < MAX_CONDS)
+   {
+      const char *start = memaddr;
+
+      cheevos_cond_parse(&bench_conds[bench_num_conds++], &memaddr);
+
+      if (memaddr == start)
+         break;
+
+      while (*memaddr == '_' || *memaddr == 'S')
+         memaddr++;
+   }
+}
+
+static bool bench_load_memaddrs(const char *path)
+{
+   char line[8192];
+   FILE *file = fopen(path, "r");
+
+   if (!file)
+      return false;
+
+   while (fgets(line, sizeof(line), file))
+   {
+      line[strcspn(line, "\r\n")] = '\0';
+      bench_parse(line);
+   }
+
+   fclose(file);
+   return true;
+}
+
+static void bench_generate_memaddrs(void)
+{
+   static const char *prefixes[] = {
+      "0xM", "0xN", "0xO", "0xP", "0xQ", "0xR", "0xS", "0xT",
+      "0xL", "0xU", "0xH", "0x ", "0xX", "d0xH", "d0x ", "b0xH"
+   };
+   static const char *ops[] = { "=", "<", "<=", ">", ">=", "!=" };
+   unsigned hot[GEN_HOT_ADDRS];
+   unsigned i;
+
+   for (i = 0; i < GEN_HOT_ADDRS; i++)
+      hot[i] = (unsigned)(rand() % (bench_ram_size - 4));
+
+   for (i = 0; i < GEN_CONDS; i++)
+   {
+      char memaddr[64];
+
+      if (rand() & 1)
+         snprintf(memaddr, sizeof(memaddr), "%s%04x%s%u",
+               prefixes[rand() % 16], hot[rand() % GEN_HOT_ADDRS],
+               ops[rand() % 6], (unsigned)(rand() % 256));
+      else
+         snprintf(memaddr, sizeof(memaddr), "%s%04x%s%s%04x",
+               prefixes[rand() % 16], hot[rand() % GEN_HOT_ADDRS],
+               ops[rand() % 6],
+               prefixes[rand() % 16], hot[rand() % GEN_HOT_ADDRS]);
+
+      bench_parse(memaddr);
+   }
+}
+
+/* Replay */
+
+static unsigned bench_test(void)
+{
+   unsigned i;
+   unsigned hits = 0;
+
+   for (i = 0; i < bench_num_conds; i++)
+   {
+      cheevos_cond_t *cond = bench_conds + i;
+      unsigned sval        = cheevos_var_get_value(&cond->source);
+      unsigned tval        = cheevos_var_get_value(&cond->target);
+      int result           = 0;
+
+      switch (cond->op)
+      {
+         case CHEEVOS_COND_OP_EQUALS:
+            result = sval == tval;
+            break;
+         case CHEEVOS_COND_OP_LESS_THAN:
+            result = sval < tval;
+            break;
+         case CHEEVOS_COND_OP_LESS_THAN_OR_EQUAL:
+            result = sval <= tval;
+            break;
+         case CHEEVOS_COND_OP_GREATER_THAN:
+            result = sval > tval;
+            break;
+         case CHEEVOS_COND_OP_GREATER_THAN_OR_EQUAL:
+            result = sval >= tval;
+            break;
+         case CHEEVOS_COND_OP_NOT_EQUAL_TO:
+            result = sval != tval;
+            break;
+      }
+
+      hits = hits * 31 + result;
+   }
+
+   return hits;
+}
+
+static void bench_set_memrefs(bool enable)
+{
+   unsigned i;
+
+   cheevos_var_reset_memrefs();
+
+   for (i = 0; i < bench_num_conds; i++)
+   {
+      cheevos_var_t *vars[2];
+      unsigned j;
+
+      vars[0] = &bench_conds[i].source;
+      vars[1] = &bench_conds[i].target;
+
+      for (j = 0; j < 2; j++)
+      {
+         vars[j]->previous = 0;
+         vars[j]->memref   = -1;
+
+         if (enable && vars[j]->type != CHEEVOS_VAR_TYPE_VALUE_COMP)
+            vars[j]->memref = cheevos_var_add_memref(vars[j]);
+      }
+   }
+}
+
+static double bench_run(const uint8_t *snapshots, unsigned num_snapshots,
+      bool memrefs, unsigned *checksum)
+{
+   unsigned frame;
+   uint64_t elapsed = 0;
+
+   bench_set_memrefs(memrefs);
+   *checksum = 0;
+
+   for (frame = 0; frame < FRAMES; frame++)
+   {
+      uint64_t start;
+
+      memcpy(bench_ram,
+            snapshots + (frame % num_snapshots) * bench_ram_size,
+            bench_ram_size);
+
+      start = now_ns();
+
+      if (memrefs)
+         cheevos_var_update_memrefs();
+
+      *checksum = *checksum * 17 + bench_test();
+      elapsed  += now_ns() - start;
+   }
+
+   return elapsed / (double)FRAMES / 1000.0;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i;
+   unsigned sum_lookup, sum_memrefs;
+   double us_lookup, us_memrefs;
+   uint8_t *snapshots     = NULL;
+   unsigned num_snapshots = GEN_SNAPSHOTS;
+
+   srand(1);
+
+   if (argc > 3)
+      bench_ram_size = strtoul(argv[3], NULL, 0);
+
+   bench_ram = (uint8_t*)calloc(1, bench_ram_size + 4);
+
+   if (argc > 1)
+   {
+      if (!bench_load_memaddrs(argv[1]))
+      {
+         fprintf(stderr, "could not read %s\n", argv[1]);
+         return 1;
+      }
+   }
+   else
+      bench_generate_memaddrs();
+
+   if (argc > 2)
+   {
+      FILE *file = fopen(argv[2], "rb");
+      long size;
+
+      if (!file)
+      {
+         fprintf(stderr, "could not read %s\n", argv[2]);
+         return 1;
+      }
+
+      fseek(file, 0, SEEK_END);
+      size          = ftell(file);
+      fseek(file, 0, SEEK_SET);
+      num_snapshots = (unsigned)(size / bench_ram_size);
+
+      if (num_snapshots == 0)
+      {
+         fprintf(stderr, "%s is smaller than one snapshot\n", argv[2]);
+         return 1;
+      }
+
+      snapshots = (uint8_t*)malloc(num_snapshots * bench_ram_size);
+      fread(snapshots, bench_ram_size, num_snapshots, file);
+      fclose(file);
+   }
+   else
+   {
+      snapshots = (uint8_t*)malloc(num_snapshots * bench_ram_size);
+
+      for (i = 0; i < num_snapshots * bench_ram_size; i++)
+         snapshots[i] = (uint8_t)(rand() >> 7);
+   }
+
+   /* Patch against the bench RAM so every operand gets a bank. */
+   for (i = 0; i < bench_num_conds; i++)
+   {
+      if (bench_conds[i].source.type != CHEEVOS_VAR_TYPE_VALUE_COMP)
+         cheevos_var_patch_addr(&bench_conds[i].source,
+               CHEEVOS_CONSOLE_NONE);
+      if (bench_conds[i].target.type != CHEEVOS_VAR_TYPE_VALUE_COMP)
+         cheevos_var_patch_addr(&bench_conds[i].target,
+               CHEEVOS_CONSOLE_NONE);
+   }
+
+   us_lookup  = bench_run(snapshots, num_snapshots, false, &sum_lookup);
+   us_memrefs = bench_run(snapshots, num_snapshots, true, &sum_memrefs);
+
+   printf("%u conditions, %u memory references, %u snapshots\n",
+         bench_num_conds, cheevos_memrefs.count, num_snapshots);
+   printf("lookup per read: %8.2f us/frame (checksum %08x)\n",
+         us_lookup, sum_lookup);
+   printf("memory refs:     %8.2f us/frame (checksum %08x)\n",
+         us_memrefs, sum_memrefs);
+
+   cheevos_var_reset_memrefs();
+   free(snapshots);
+   free(bench_ram);
+
+   return sum_lookup == sum_memrefs ? 0 : 1;
+}
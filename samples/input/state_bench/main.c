@@ -0,0 +1,167 @@
+/* Measures input_state() throughput the way cores call it: every
+ * frame, input_poll() is followed by each port querying all joypad
+ * buttons and both analog sticks, a few times over.
+ *
+ * input_driver.c is compiled into this file so that a synthetic
+ * input driver can be installed without the rest of the frontend;
+ * the frontend entry points it references are stubbed below. */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "../../../input/input_driver.c"
+
+#include "../../../list_special.h"
+#include "../../../tasks/tasks_internal.h"
+
+#define FRAMES          200000
+#define PORTS           4
+#define QUERIES         3
+
+static settings_t bench_settings;
+static struct retro_keybind bench_binds[MAX_USERS][RARCH_BIND_LIST_END];
+static uint16_t bench_pad[MAX_USERS];
+
+static uint64_t now_ns(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/* Synthetic input driver */
+
+static void bench_input_poll(void *data)
+{
+   unsigned i;
+   for (i = 0; i < MAX_USERS; i++)
+      bench_pad[i] = (uint16_t)(bench_pad[i] * 31 + 7 + i);
+}
+
+static int16_t bench_input_state(void *data,
+      rarch_joypad_info_t joypad_info,
+      const struct retro_keybind **binds,
+      unsigned port, unsigned device, unsigned idx, unsigned id)
+{
+   switch (device)
+   {
+      case RETRO_DEVICE_JOYPAD:
+         if (id < RARCH_BIND_LIST_END && binds[port][id].valid)
+            return (bench_pad[port] >> (id & 15)) & 1;
+         break;
+      case RETRO_DEVICE_ANALOG:
+         return (int16_t)(bench_pad[port] * (idx * 2 + id + 1));
+   }
+
+   return 0;
+}
+
+static const input_driver_t bench_input = {
+   NULL, bench_input_poll, bench_input_state, NULL,
+   NULL, NULL, NULL, "bench",
+   NULL, NULL, NULL, NULL, NULL, NULL, NULL
+};
+
+/* Frontend stubs */
+
+#ifndef RARCH_INTERNAL
+void RARCH_LOG(const char *fmt, ...) { }
+void RARCH_LOG_OUTPUT(const char *msg, ...) { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...) { }
+#endif
+bool bsv_movie_is_playback_on(void) { return false; }
+bool bsv_movie_is_playback_off(void) { return false; }
+bool bsv_movie_get_input(int16_t *bsv_data) { return false; }
+bool bsv_movie_ctl(enum bsv_ctl_state state, void *data) { return false; }
+settings_t *config_get_ptr(void) { return &bench_settings; }
+bool driver_ctl(enum driver_ctl_state state, void *data) { return false; }
+bool rarch_ctl(enum rarch_ctl_state state, void *data) { return false; }
+void rarch_profile_begin(enum rarch_profile_stage stage) { }
+void rarch_profile_end(enum rarch_profile_stage stage) { }
+const char *file_path_str(enum file_path_enum enum_idx) { return ""; }
+const char *msg_hash_to_str(enum msg_hash_enums msg) { return ""; }
+const char *char_list_new_special(enum string_list_type type, void *data)
+{ return NULL; }
+bool input_autoconfigure_connect(const char *name, const char *display_name,
+      const char *driver, unsigned idx, unsigned vid, unsigned pid)
+{ return false; }
+void input_autoconfigure_joypad_reindex_devices(void) { }
+const struct input_key_map input_config_key_map[] = { { NULL, RETROK_UNKNOWN } };
+void input_keymaps_translate_rk_to_str(enum retro_key key, char *buf, size_t size)
+{ *buf = '\0'; }
+input_mapper_t *input_mapper_new(void) { return NULL; }
+void input_mapper_free(input_mapper_t *handle) { }
+void input_mapper_poll(input_mapper_t *handle) { }
+void input_mapper_state(input_mapper_t *handle, int16_t *ret,
+      unsigned port, unsigned device, unsigned idx, unsigned id) { }
+#if defined(__linux__) && !defined(ANDROID)
+input_driver_t input_linuxraw;
+input_device_driver_t linuxraw_joypad;
+#endif
+input_driver_t input_null;
+input_device_driver_t null_joypad;
+
+int main(void)
+{
+   unsigned i, j, frame;
+   uint64_t t0, t1, calls = 0;
+   int64_t sum            = 0;
+
+   for (i = 0; i < MAX_USERS; i++)
+   {
+      for (j = 0; j < RARCH_BIND_LIST_END; j++)
+         bench_binds[i][j].valid = j <= RETRO_DEVICE_ID_JOYPAD_R3;
+      libretro_input_binds[i] = bench_binds[i];
+
+      /* Default, identity remapping */
+      for (j = 0; j < RARCH_CUSTOM_BIND_LIST_END; j++)
+         bench_settings.uints.input_remap_ids[i][j] = j;
+   }
+
+   bench_settings.bools.input_remap_binds_enable = true;
+
+   bench_settings.uints.input_turbo_period     = 6;
+   bench_settings.uints.input_turbo_duty_cycle = 3;
+
+   current_input          = &bench_input;
+   input_driver_max_users = PORTS;
+
+   t0 = now_ns();
+
+   for (frame = 0; frame < FRAMES; frame++)
+   {
+      unsigned port, q;
+
+      input_poll();
+
+      for (q = 0; q < QUERIES; q++)
+      {
+         for (port = 0; port < PORTS; port++)
+         {
+            for (i = 0; i <= RETRO_DEVICE_ID_JOYPAD_R3; i++)
+               sum += input_state(port, RETRO_DEVICE_JOYPAD, 0, i);
+
+            for (i = 0; i < 2; i++)
+            {
+               sum += input_state(port, RETRO_DEVICE_ANALOG, i,
+                     RETRO_DEVICE_ID_ANALOG_X);
+               sum += input_state(port, RETRO_DEVICE_ANALOG, i,
+                     RETRO_DEVICE_ID_ANALOG_Y);
+            }
+
+            calls += RETRO_DEVICE_ID_JOYPAD_R3 + 1 + 4;
+         }
+      }
+   }
+
+   t1 = now_ns();
+
+   printf("%u frames, %u ports, %u queries per frame\n",
+         FRAMES, PORTS, QUERIES);
+   printf("input_state: %.1f M calls/s (%.1f ns/call, checksum %lld)\n",
+         calls / ((t1 - t0) / 1e3),
+         (double)(t1 - t0) / calls, (long long)sum);
+
+   return 0;
+}
@@ -64,10 +64,10 @@ int main(int argc, char *argv[])
 
    task_queue_init(false /* threaded enable */, main_msg_queue_push);
 
-   core_info_init_list(core_info_dir, core_dir, exts, true);
+   core_info_init_list(core_info_dir, core_dir, NULL, exts, true);
 
    task_push_dbscan(playlist_dir, db_dir, input_dir, true,
-         true, main_db_cb);
+         true, 0, main_db_cb);
 
    while (loop_active)
       task_queue_check();
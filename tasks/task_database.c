@@ -23,9 +23,13 @@
 #include <lists/dir_list.h>
 #include <file/file_path.h>
 #include <encodings/crc32.h>
+#include <features/features_cpu.h>
 #include <streams/file_stream.h>
 #include <streams/chd_stream.h>
 #include <streams/interface_stream.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 #include "tasks_internal.h"
 
 #include "../core_info.h"
@@ -43,6 +47,25 @@
 #define COLLECTION_SIZE                99999
 #endif
 
+/* Read size used when hashing content. */
+#define DB_CRC_CHUNK_SIZE              (256 * 1024)
+/* Regions at least this large are hashed on several threads. */
+#define DB_CRC_PARALLEL_MIN            (64 * 1024 * 1024)
+#define DB_CRC_MAX_THREADS             4
+
+/* Database scan workers, and how many files they may be ahead. */
+#define DB_SCAN_MAX_THREADS            16
+#define DB_SCAN_WINDOW                 64
+
+typedef struct db_crc_region
+{
+   const char *name;
+   uint64_t offset;
+   uint64_t size;
+   uint32_t crc;
+   bool ok;
+} db_crc_region_t;
+
 typedef struct database_state_handle
 {
    uint32_t crc;
@@ -53,15 +76,76 @@ typedef struct database_state_handle
    char archive_name[511];
    char serial[4096];
    database_info_list_t *info;
+   database_info_index_cache_t *index_cache;
    struct string_list *list;
 } database_state_handle_t;
 
+/* What identifying one file yields: the lookup type
+ * plus whichever of crc / archive crc / serial it set. */
+typedef struct db_scan_result
+{
+   enum database_type type;
+   int rv;
+   bool has_crc;
+   bool has_archive_crc;
+   bool has_serial;
+   uint32_t crc;
+   uint32_t archive_crc;
+   char serial[4096];
+} db_scan_result_t;
+
+#ifdef HAVE_THREADS
+enum db_scan_job_state
+{
+   DB_SCAN_JOB_EMPTY = 0,
+   DB_SCAN_JOB_PENDING,
+   DB_SCAN_JOB_BUSY,
+   DB_SCAN_JOB_DONE
+};
+
+typedef struct db_scan_job
+{
+   enum db_scan_job_state state;
+   char *path;
+   db_scan_result_t result;
+} db_scan_job_t;
+
+/* Identifies files ahead of the lookup stage.
+ *
+ * The task thread hands out paths in list order into a ring of
+ * DB_SCAN_WINDOW jobs, which bounds how far the workers read
+ * ahead. Workers hash / detect serials, and the task thread
+ * collects results in order and does the database lookups and
+ * playlist writes on its own, so those stay single-writer. */
+typedef struct db_scan_pipeline
+{
+   slock_t *lock;
+   scond_t *cond_work;
+   scond_t *cond_done;
+   sthread_t *workers[DB_SCAN_MAX_THREADS];
+   unsigned num_workers;
+   bool quit;
+
+   db_scan_job_t jobs[DB_SCAN_WINDOW];
+   size_t submitted;  /* next list index to hand out */
+   size_t claimed;    /* next list index a worker picks up */
+   size_t consumed;   /* next list index the task thread collects */
+
+   size_t files_done;
+   retro_time_t start_time;
+} db_scan_pipeline_t;
+#endif
+
 typedef struct db_handle
 {
    bool is_directory;
    bool scan_started;
    bool show_hidden_files;
    unsigned status;
+   unsigned scan_threads;
+#ifdef HAVE_THREADS
+   db_scan_pipeline_t *pipeline;
+#endif
    char *playlist_directory;
    char *content_database_path;
    char *fullpath;
@@ -340,13 +424,18 @@ static int task_database_chd_get_serial(const char *name, char* serial)
 
 static int intfstream_get_crc(intfstream_t *fd, uint32_t *crc)
 {
-   int64_t read = 0;
-   uint32_t acc = 0;
-   uint8_t buffer[4096];
+   int64_t read    = 0;
+   uint32_t acc    = 0;
+   uint8_t *buffer = (uint8_t*)malloc(DB_CRC_CHUNK_SIZE);
+
+   if (!buffer)
+      return 0;
 
-   while ((read = intfstream_read(fd, buffer, sizeof(buffer))) > 0)
+   while ((read = intfstream_read(fd, buffer, DB_CRC_CHUNK_SIZE)) > 0)
       acc = encoding_crc32(acc, buffer, (size_t)read);
 
+   free(buffer);
+
    if (read < 0)
       return 0;
 
@@ -355,63 +444,128 @@ static int intfstream_get_crc(intfstream_t *fd, uint32_t *crc)
    return 1;
 }
 
+static void task_database_crc_region(void *data)
+{
+   db_crc_region_t *region = (db_crc_region_t*)data;
+   uint64_t remaining      = region->size;
+   uint8_t *buffer         = NULL;
+   RFILE *fd               = filestream_open(region->name,
+         RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   region->crc = 0;
+   region->ok  = false;
+
+   if (!fd)
+      return;
+
+   buffer = (uint8_t*)malloc(DB_CRC_CHUNK_SIZE);
+
+   if (buffer && filestream_seek(fd, (int64_t)region->offset,
+            RETRO_VFS_SEEK_POSITION_START) != -1)
+   {
+      while (remaining)
+      {
+         int64_t chunk = (int64_t)MIN(remaining, DB_CRC_CHUNK_SIZE);
+
+         if (filestream_read(fd, buffer, chunk) != chunk)
+            break;
+
+         region->crc = encoding_crc32(region->crc, buffer, (size_t)chunk);
+         remaining  -= (uint64_t)chunk;
+      }
+
+      region->ok = (remaining == 0);
+   }
+
+   free(buffer);
+   filestream_close(fd);
+}
+
 static bool intfstream_file_get_crc(const char *name,
       uint64_t offset, size_t size, uint32_t *crc)
 {
-   int rv;
-   intfstream_t *fd  = intfstream_open_file(name,
+   unsigned i;
+   db_crc_region_t regions[DB_CRC_MAX_THREADS];
+   unsigned num_regions = 1;
+   uint64_t length      = size;
+   uint32_t acc         = 0;
+   int64_t file_size    = -1;
+   RFILE *fd            = filestream_open(name,
          RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
-   uint8_t *data     = NULL;
-   int64_t file_size = -1;
 
    if (!fd)
       return 0;
 
-   if (intfstream_seek(fd, 0, SEEK_END) == -1)
-      goto error;
+   file_size = filestream_get_size(fd);
+   filestream_close(fd);
 
-   file_size = intfstream_tell(fd);
+   if (file_size < 0)
+      return 0;
 
-   if (intfstream_seek(fd, 0, SEEK_SET) == -1)
-      goto error;
+   /* Hash the whole file unless a sub-range was asked for,
+    * in which case all of it has to be there. */
+   if (offset == 0 && length >= (uint64_t)file_size)
+      length = (uint64_t)file_size;
+   else if (offset + length > (uint64_t)file_size)
+      return 0;
 
-   if (file_size < 0)
-      goto error;
+#ifdef HAVE_THREADS
+   /* Large disc images are split into contiguous regions
+    * hashed concurrently, then merged with crc32_combine. */
+   if (length >= DB_CRC_PARALLEL_MIN)
+   {
+      num_regions = cpu_features_get_core_amount();
+      if (num_regions > DB_CRC_MAX_THREADS)
+         num_regions = DB_CRC_MAX_THREADS;
+      if (num_regions < 1)
+         num_regions = 1;
+   }
+#endif
 
-   if (offset != 0 || size < (uint64_t) file_size)
+   for (i = 0; i < num_regions; i++)
    {
-      if (intfstream_seek(fd, (int64_t)offset, SEEK_SET) == -1)
-         goto error;
+      uint64_t part     = length / num_regions;
 
-      data = (uint8_t*)malloc(size);
+      regions[i].name   = name;
+      regions[i].offset = offset + part * i;
+      regions[i].size   = (i == num_regions - 1)
+         ? length - part * i : part;
+   }
 
-      if (intfstream_read(fd, data, size) != (int64_t) size)
-         goto error;
+#ifdef HAVE_THREADS
+   if (num_regions > 1)
+   {
+      sthread_t *threads[DB_CRC_MAX_THREADS] = {NULL};
 
-      intfstream_close(fd);
-      free(fd);
-      fd = intfstream_open_memory(data, RETRO_VFS_FILE_ACCESS_READ,
-            RETRO_VFS_FILE_ACCESS_HINT_NONE, size);
+      for (i = 1; i < num_regions; i++)
+         threads[i] = sthread_create(task_database_crc_region, &regions[i]);
 
-      if (!fd)
-         goto error;
-   }
+      task_database_crc_region(&regions[0]);
 
-   rv = intfstream_get_crc(fd, crc);
-   intfstream_close(fd);
-   free(fd);
-   free(data);
-   return rv;
+      for (i = 1; i < num_regions; i++)
+      {
+         /* Fall back to hashing on this thread if
+          * the worker could not be started. */
+         if (threads[i])
+            sthread_join(threads[i]);
+         else
+            task_database_crc_region(&regions[i]);
+      }
+   }
+   else
+#endif
+      task_database_crc_region(&regions[0]);
 
-error:
-   if (fd)
+   for (i = 0; i < num_regions; i++)
    {
-      intfstream_close(fd);
-      free(fd);
+      if (!regions[i].ok)
+         return 0;
+      acc = (i == 0) ? regions[i].crc
+         : encoding_crc32_combine(acc, regions[i].crc, regions[i].size);
    }
-   if (data)
-      free(data);
-   return 0;
+
+   *crc = acc;
+   return 1;
 }
 
 static int task_database_cue_get_crc(const char *name, uint32_t *crc)
@@ -503,7 +657,7 @@ static bool task_database_chd_get_crc(const char *name, uint32_t *crc)
 }
 
 static void task_database_cue_prune(database_info_handle_t *db,
-      const char *name)
+      size_t start, const char *name)
 {
    size_t i;
    char       *path = (char *)malloc(PATH_MAX_LENGTH + 1);
@@ -515,7 +669,7 @@ static void task_database_cue_prune(database_info_handle_t *db,
 
    while (cue_next_file(fd, name, path, PATH_MAX_LENGTH))
    {
-      for (i = db->list_ptr; i < db->list->size; ++i)
+      for (i = start; i < db->list->size; ++i)
       {
          if (db->list->elems[i].data
                && !strcmp(path, db->list->elems[i].data))
@@ -536,7 +690,8 @@ end:
    free(path);
 }
 
-static void gdi_prune(database_info_handle_t *db, const char *name)
+static void gdi_prune(database_info_handle_t *db,
+      size_t start, const char *name)
 {
    size_t i;
    char       *path = (char *)malloc(PATH_MAX_LENGTH + 1);
@@ -548,7 +703,7 @@ static void gdi_prune(database_info_handle_t *db, const char *name)
 
    while (gdi_next_file(fd, name, path, PATH_MAX_LENGTH))
    {
-      for (i = db->list_ptr; i < db->list->size; ++i)
+      for (i = start; i < db->list->size; ++i)
       {
          if (db->list->elems[i].data && !strcmp(path, db->list->elems[i].data))
          {
@@ -608,71 +763,358 @@ static enum msg_file_type extension_to_file_type(const char *ext)
    return FILE_TYPE_NONE;
 }
 
-static int task_database_iterate_playlist(
-      database_state_handle_t *db_state,
-      database_info_handle_t *db, const char *name)
+/* Works out how a file should be looked up. Only touches
+ * the file itself, so it is safe to run on a scan worker. */
+static void task_database_identify(const char *name,
+      db_scan_result_t *result)
 {
+   result->type            = DATABASE_TYPE_ITERATE;
+   result->rv              = 1;
+   result->has_crc         = false;
+   result->has_archive_crc = false;
+   result->has_serial      = false;
+   result->crc             = 0;
+   result->archive_crc     = 0;
+   result->serial[0]       = '\0';
+
    switch (extension_to_file_type(path_get_extension(name)))
    {
       case FILE_TYPE_COMPRESSED:
 #ifdef HAVE_COMPRESSION
-         database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
+         result->type            = DATABASE_TYPE_CRC_LOOKUP;
+         result->has_archive_crc = true;
          /* first check crc of archive itself */
-         return intfstream_file_get_crc(name,
-               0, SIZE_MAX, &db_state->archive_crc);
-#else
-         break;
+         result->rv              = intfstream_file_get_crc(name,
+               0, SIZE_MAX, &result->archive_crc);
 #endif
+         break;
       case FILE_TYPE_CUE:
-         task_database_cue_prune(db, name);
-         db_state->serial[0] = '\0';
-         if (task_database_cue_get_serial(name, db_state->serial))
-            database_info_set_type(db, DATABASE_TYPE_SERIAL_LOOKUP);
+         result->has_serial = true;
+         if (task_database_cue_get_serial(name, result->serial))
+            result->type    = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
-            return task_database_cue_get_crc(name, &db_state->crc);
+            result->type    = DATABASE_TYPE_CRC_LOOKUP;
+            result->has_crc = true;
+            result->rv      = task_database_cue_get_crc(name, &result->crc);
          }
          break;
       case FILE_TYPE_GDI:
-         gdi_prune(db, name);
-         db_state->serial[0] = '\0';
+         result->has_serial = true;
          /* There are no serial databases, so don't bother with
             serials at the moment */
-         if (0 && task_database_gdi_get_serial(name, db_state->serial))
-            database_info_set_type(db, DATABASE_TYPE_SERIAL_LOOKUP);
+         if (0 && task_database_gdi_get_serial(name, result->serial))
+            result->type    = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
-            return task_database_gdi_get_crc(name, &db_state->crc);
+            result->type    = DATABASE_TYPE_CRC_LOOKUP;
+            result->has_crc = true;
+            result->rv      = task_database_gdi_get_crc(name, &result->crc);
          }
          break;
       /* Consider Wii WBFS files similar to ISO files. */
       case FILE_TYPE_WBFS:
       case FILE_TYPE_ISO:
-         db_state->serial[0] = '\0';
-         intfstream_file_get_serial(name, 0, SIZE_MAX, db_state->serial);
-         database_info_set_type(db, DATABASE_TYPE_SERIAL_LOOKUP);
+         result->has_serial = true;
+         intfstream_file_get_serial(name, 0, SIZE_MAX, result->serial);
+         result->type       = DATABASE_TYPE_SERIAL_LOOKUP;
          break;
       case FILE_TYPE_CHD:
-         db_state->serial[0] = '\0';
-         if (task_database_chd_get_serial(name, db_state->serial))
-            database_info_set_type(db, DATABASE_TYPE_SERIAL_LOOKUP);
+         result->has_serial = true;
+         if (task_database_chd_get_serial(name, result->serial))
+            result->type    = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
-            return task_database_chd_get_crc(name, &db_state->crc);
+            result->type    = DATABASE_TYPE_CRC_LOOKUP;
+            result->has_crc = true;
+            result->rv      = task_database_chd_get_crc(name, &result->crc);
          }
          break;
       case FILE_TYPE_LUTRO:
-         database_info_set_type(db, DATABASE_TYPE_ITERATE_LUTRO);
+         result->type = DATABASE_TYPE_ITERATE_LUTRO;
          break;
       default:
-         database_info_set_type(db, DATABASE_TYPE_CRC_LOOKUP);
-         return intfstream_file_get_crc(name, 0, SIZE_MAX, &db_state->crc);
+         result->type    = DATABASE_TYPE_CRC_LOOKUP;
+         result->has_crc = true;
+         result->rv      = intfstream_file_get_crc(name,
+               0, SIZE_MAX, &result->crc);
+         break;
    }
+}
 
-   return 1;
+#ifdef HAVE_THREADS
+/* With workers hashing ahead, tracks referenced by a cue / gdi
+ * sheet have to be dropped before they are handed out, rather
+ * than when the task thread reaches the sheet. */
+static void task_database_prune_list(database_info_handle_t *db)
+{
+   size_t i;
+
+   for (i = 0; i < db->list->size; i++)
+   {
+      const char *name = db->list->elems[i].data;
+
+      if (!name)
+         continue;
+
+      switch (extension_to_file_type(path_get_extension(name)))
+      {
+         case FILE_TYPE_CUE:
+            task_database_cue_prune(db, i, name);
+            break;
+         case FILE_TYPE_GDI:
+            gdi_prune(db, i, name);
+            break;
+         default:
+            break;
+      }
+   }
+}
+
+static void task_database_scan_worker(void *data)
+{
+   db_scan_pipeline_t *pipe = (db_scan_pipeline_t*)data;
+
+   slock_lock(pipe->lock);
+
+   for (;;)
+   {
+      db_scan_job_t *job = NULL;
+
+      while (!pipe->quit && pipe->claimed == pipe->submitted)
+         scond_wait(pipe->cond_work, pipe->lock);
+
+      if (pipe->quit)
+         break;
+
+      job        = &pipe->jobs[pipe->claimed % DB_SCAN_WINDOW];
+      job->state = DB_SCAN_JOB_BUSY;
+      pipe->claimed++;
+
+      slock_unlock(pipe->lock);
+
+      /* Archive members and pruned entries are
+       * handled by the task thread. */
+      if (job->path && !path_contains_compressed_file(job->path))
+         task_database_identify(job->path, &job->result);
+      else
+         job->result.rv = 0;
+
+      slock_lock(pipe->lock);
+      job->state = DB_SCAN_JOB_DONE;
+      pipe->files_done++;
+      scond_broadcast(pipe->cond_done);
+   }
+
+   slock_unlock(pipe->lock);
+}
+
+static void task_database_scan_pipeline_free(db_scan_pipeline_t *pipe)
+{
+   unsigned i;
+
+   if (!pipe)
+      return;
+
+   if (pipe->lock)
+   {
+      slock_lock(pipe->lock);
+      pipe->quit = true;
+      if (pipe->cond_work)
+         scond_broadcast(pipe->cond_work);
+      slock_unlock(pipe->lock);
+   }
+
+   for (i = 0; i < pipe->num_workers; i++)
+      sthread_join(pipe->workers[i]);
+
+   for (i = 0; i < DB_SCAN_WINDOW; i++)
+      free(pipe->jobs[i].path);
+
+   if (pipe->cond_done)
+      scond_free(pipe->cond_done);
+   if (pipe->cond_work)
+      scond_free(pipe->cond_work);
+   if (pipe->lock)
+      slock_free(pipe->lock);
+
+   free(pipe);
+}
+
+static db_scan_pipeline_t *task_database_scan_pipeline_new(unsigned threads)
+{
+   unsigned i;
+   db_scan_pipeline_t *pipe = (db_scan_pipeline_t*)
+      calloc(1, sizeof(*pipe));
+
+   if (!pipe)
+      return NULL;
+
+   pipe->lock       = slock_new();
+   pipe->cond_work  = scond_new();
+   pipe->cond_done  = scond_new();
+   pipe->start_time = cpu_features_get_time_usec();
+
+   if (!pipe->lock || !pipe->cond_work || !pipe->cond_done)
+      goto error;
+
+   for (i = 0; i < threads; i++)
+   {
+      pipe->workers[i] = sthread_create(task_database_scan_worker, pipe);
+      if (!pipe->workers[i])
+         break;
+      pipe->num_workers++;
+   }
+
+   if (pipe->num_workers == 0)
+      goto error;
+
+   return pipe;
+
+error:
+   task_database_scan_pipeline_free(pipe);
+   return NULL;
+}
+
+/* Hands out list entries until the window is full.
+ * Must be called with the pipeline lock held. */
+static void task_database_scan_pipeline_fill(db_scan_pipeline_t *pipe,
+      const struct string_list *list)
+{
+   bool added = false;
+
+   while (pipe->submitted < list->size
+         && pipe->submitted < pipe->consumed + DB_SCAN_WINDOW)
+   {
+      db_scan_job_t *job = &pipe->jobs[pipe->submitted % DB_SCAN_WINDOW];
+      const char *path   = list->elems[pipe->submitted].data;
+
+      free(job->path);
+      job->path  = path ? strdup(path) : NULL;
+      job->state = DB_SCAN_JOB_PENDING;
+      pipe->submitted++;
+      added      = true;
+   }
+
+   if (added)
+      scond_broadcast(pipe->cond_work);
+}
+
+/* Waits for the identification of list entry 'index' and
+ * copies it out. Results for entries that were skipped over
+ * (pruned, archive members) are discarded on the way. */
+static bool task_database_scan_pipeline_fetch(db_scan_pipeline_t *pipe,
+      const struct string_list *list, size_t index,
+      db_scan_result_t *result)
+{
+   bool found = false;
+
+   slock_lock(pipe->lock);
+
+   task_database_scan_pipeline_fill(pipe, list);
+
+   while (pipe->consumed <= index && pipe->consumed < pipe->submitted)
+   {
+      db_scan_job_t *job = &pipe->jobs[pipe->consumed % DB_SCAN_WINDOW];
+
+      while (job->state != DB_SCAN_JOB_DONE)
+         scond_wait(pipe->cond_done, pipe->lock);
+
+      if (pipe->consumed == index)
+      {
+         memcpy(result, &job->result, sizeof(*result));
+         found = true;
+      }
+
+      job->state = DB_SCAN_JOB_EMPTY;
+      pipe->consumed++;
+   }
+
+   task_database_scan_pipeline_fill(pipe, list);
+
+   slock_unlock(pipe->lock);
+
+   return found;
+}
+
+static void task_database_scan_pipeline_progress(db_scan_pipeline_t *pipe,
+      retro_task_t *task, size_t total)
+{
+   char title[128];
+   size_t done;
+   retro_time_t elapsed;
+
+   slock_lock(pipe->lock);
+   done    = pipe->files_done;
+   slock_unlock(pipe->lock);
+
+   elapsed = cpu_features_get_time_usec() - pipe->start_time;
+
+   snprintf(title, sizeof(title),
+         "%s " STRING_REP_USIZE "/" STRING_REP_USIZE " (%.1f files/s)",
+         msg_hash_to_str(MSG_SCANNING), done, total,
+         elapsed > 0 ? (double)done * 1000000.0 / elapsed : 0.0);
+
+   task_free_title(task);
+   task_set_title(task, strdup(title));
+}
+#endif
+
+static int task_database_iterate_playlist(
+      db_handle_t *_db,
+      database_state_handle_t *db_state,
+      database_info_handle_t *db, const char *name)
+{
+   db_scan_result_t *result = (db_scan_result_t*)malloc(sizeof(*result));
+   bool identified          = false;
+   bool pruned              = false;
+   int rv                   = 1;
+
+   if (!result)
+      return 0;
+
+#ifdef HAVE_THREADS
+   /* The whole list was pruned before the workers started */
+   pruned = _db->pipeline != NULL;
+#endif
+
+   if (!pruned)
+   {
+      switch (extension_to_file_type(path_get_extension(name)))
+      {
+         case FILE_TYPE_CUE:
+            task_database_cue_prune(db, db->list_ptr, name);
+            break;
+         case FILE_TYPE_GDI:
+            gdi_prune(db, db->list_ptr, name);
+            break;
+         default:
+            break;
+      }
+   }
+
+#ifdef HAVE_THREADS
+   if (_db->pipeline)
+      identified = task_database_scan_pipeline_fetch(_db->pipeline,
+            db->list, db->list_ptr, result);
+#endif
+
+   if (!identified)
+      task_database_identify(name, result);
+
+   if (result->has_archive_crc)
+      db_state->archive_crc = result->archive_crc;
+   if (result->has_crc)
+      db_state->crc         = result->crc;
+   if (result->has_serial)
+      strlcpy(db_state->serial, result->serial, sizeof(db_state->serial));
+
+   database_info_set_type(db, result->type);
+   rv = result->rv;
+
+   free(result);
+
+   return rv;
 }
 
 static int database_info_list_iterate_end_no_match(
@@ -744,7 +1186,7 @@ static int task_database_iterate_next(database_info_handle_t *db)
 }
 
 static int database_info_list_iterate_new(database_state_handle_t *db_state,
-      const char *query)
+      enum database_type type)
 {
    const char *new_database = database_info_get_current_name(db_state);
 
@@ -757,7 +1199,18 @@ static int database_info_list_iterate_new(database_state_handle_t *db_state,
       database_info_list_free(db_state->info);
       free(db_state->info);
    }
-   db_state->info = database_info_list_new(new_database, query);
+
+   if (!db_state->index_cache)
+      db_state->index_cache = database_info_index_cache_new();
+
+   /* Only the matching entries are loaded, through the
+    * per-database hash indexes kept for the whole scan. */
+   if (type == DATABASE_TYPE_SERIAL_LOOKUP)
+      db_state->info = database_info_list_new_serial(db_state->index_cache,
+            new_database, db_state->serial);
+   else
+      db_state->info = database_info_list_new_crc(db_state->index_cache,
+            new_database, db_state->crc, db_state->archive_crc);
    return 0;
 }
 
@@ -906,10 +1359,6 @@ static int task_database_iterate_crc_lookup(
 
    if (db_state->entry_index == 0)
    {
-      char query[50];
-
-      query[0] = '\0';
-
       /* don't scan files that can't be in this database */
       if (!(path_contains_compressed_file(name) &&
          core_info_database_match_archive_member(
@@ -918,11 +1367,7 @@ static int task_database_iterate_crc_lookup(
          db_state->list->elems[db_state->list_index].data, name))
          return database_info_list_iterate_next(db_state);
 
-      snprintf(query, sizeof(query),
-            "{crc:or(b\"%08X\",b\"%08X\")}",
-            db_state->crc, db_state->archive_crc);
-
-      database_info_list_iterate_new(db_state, query);
+      database_info_list_iterate_new(db_state, DATABASE_TYPE_CRC_LOOKUP);
    }
 
    if (db_state->info)
@@ -1042,21 +1487,7 @@ static int task_database_iterate_serial_lookup(
       return database_info_list_iterate_end_no_match(db, db_state, name);
 
    if (db_state->entry_index == 0)
-   {
-      char query[50];
-      char *serial_buf =
-         bin_to_hex_alloc((uint8_t*)db_state->serial, strlen(db_state->serial) * sizeof(uint8_t));
-
-      if (!serial_buf)
-         return 1;
-
-      query[0] = '\0';
-
-      snprintf(query, sizeof(query), "{'serial': b'%s'}", serial_buf);
-      database_info_list_iterate_new(db_state, query);
-
-      free(serial_buf);
-   }
+      database_info_list_iterate_new(db_state, DATABASE_TYPE_SERIAL_LOOKUP);
 
    if (db_state->info)
    {
@@ -1111,7 +1542,7 @@ static int task_database_iterate(
    switch (database_info_get_type(db))
    {
       case DATABASE_TYPE_ITERATE:
-         return task_database_iterate_playlist(db_state, db, name);
+         return task_database_iterate_playlist(_db, db_state, db, name);
       case DATABASE_TYPE_ITERATE_ARCHIVE:
          return task_database_iterate_playlist_archive(_db, db_state, db, name);
       case DATABASE_TYPE_ITERATE_LUTRO:
@@ -1230,6 +1661,13 @@ static void task_database_handler(retro_task_t *task)
                }
             }
          }
+#ifdef HAVE_THREADS
+         if (db->scan_threads > 0 && dbinfo->list->size > 1)
+         {
+            task_database_prune_list(dbinfo);
+            db->pipeline = task_database_scan_pipeline_new(db->scan_threads);
+         }
+#endif
          dbinfo->status = DATABASE_STATUS_ITERATE_START;
          break;
       case DATABASE_STATUS_ITERATE_START:
@@ -1238,6 +1676,13 @@ static void task_database_handler(retro_task_t *task)
          dbstate->list_index  = 0;
          dbstate->entry_index = 0;
          task_database_iterate_start(dbinfo, name);
+         task_set_progress(task, (int8_t)((dbinfo->list_ptr * 100)
+                  / dbinfo->list->size));
+#ifdef HAVE_THREADS
+         if (db->pipeline)
+            task_database_scan_pipeline_progress(db->pipeline,
+                  task, dbinfo->list->size);
+#endif
          break;
       case DATABASE_STATUS_ITERATE:
          if (task_database_iterate(db, dbstate, dbinfo) == 0)
@@ -1283,6 +1728,8 @@ task_finished:
    {
       if (dbstate->list)
          dir_list_free(dbstate->list);
+      database_info_index_cache_free(dbstate->index_cache);
+      dbstate->index_cache = NULL;
    }
 
    if (db)
@@ -1295,6 +1742,9 @@ task_finished:
          free(db->fullpath);
       if (db->state.buf)
          free(db->state.buf);
+#ifdef HAVE_THREADS
+      task_database_scan_pipeline_free(db->pipeline);
+#endif
 
       if (db->handle)
          database_info_free(db->handle);
@@ -1305,16 +1755,37 @@ task_finished:
       free(dbinfo);
 }
 
+static bool task_database_finder(retro_task_t *task, void *user_data)
+{
+   return task->handler == task_database_handler;
+}
+
 bool task_push_dbscan(
       const char *playlist_directory,
       const char *content_database,
       const char *fullpath,
       bool directory,
       bool show_hidden_files,
+      unsigned scan_threads,
       retro_task_callback_t cb)
 {
-   retro_task_t *t      = (retro_task_t*)calloc(1, sizeof(*t));
-   db_handle_t *db      = (db_handle_t*)calloc(1, sizeof(db_handle_t));
+   task_finder_data_t find_data;
+   retro_task_t *t      = NULL;
+   db_handle_t *db      = NULL;
+
+   /* Bulk tasks may run side by side on the threaded queue, and
+    * two scans would rewrite the same playlists concurrently. */
+   find_data.func       = task_database_finder;
+   find_data.userdata   = NULL;
+
+   if (task_queue_find(&find_data))
+   {
+      RARCH_LOG("[database] Content scan already in progress.\n");
+      return false;
+   }
+
+   t                    = (retro_task_t*)calloc(1, sizeof(*t));
+   db                   = (db_handle_t*)calloc(1, sizeof(db_handle_t));
 
    if (!t || !db)
       goto error;
@@ -1323,8 +1794,10 @@ bool task_push_dbscan(
    t->state                  = db;
    t->callback               = cb;
    t->title                  = strdup(msg_hash_to_str(MSG_PREPARING_FOR_CONTENT_SCAN));
+   t->priority               = TASK_PRIORITY_BULK;
 
    db->show_hidden_files     = show_hidden_files;
+   db->scan_threads          = MIN(scan_threads, DB_SCAN_MAX_THREADS);
    db->is_directory          = directory;
    db->playlist_directory    = NULL;
    db->fullpath              = strdup(fullpath);
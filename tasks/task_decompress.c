@@ -340,6 +340,7 @@ bool task_push_decompress(
 
    t->state       = s;
    t->handler     = task_decompress_handler;
+   t->priority    = TASK_PRIORITY_BULK;
 
    if (!string_is_empty(subdir))
    {
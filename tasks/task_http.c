@@ -297,6 +297,7 @@ static void* task_push_http_transfer_generic(
    t->progress_cb          = http_transfer_progress_cb;
    t->user_data            = user_data;
    t->progress             = -1;
+   t->priority             = TASK_PRIORITY_IO;
 
    if (user_data != NULL)
       s = ((file_transfer_t*)user_data)->path;
@@ -21,16 +21,23 @@
 
 #ifdef _WIN32
 #include <direct.h>
+#ifndef _XBOX
+#include <windows.h>
+#endif
 #else
 #include <unistd.h>
 #endif
 #include <errno.h>
 
 #include <compat/strl.h>
+#include <encodings/utf.h>
+#include <features/features_cpu.h>
 #include <retro_assert.h>
+#include <retro_endianness.h>
 #include <lists/string_list.h>
 #include <streams/interface_stream.h>
 #include <streams/file_stream.h>
+#include <streams/trans_stream.h>
 #include <rthreads/rthreads.h>
 #include <file/file_path.h>
 #include <retro_miscellaneous.h>
@@ -54,6 +61,31 @@
 #include "tasks_internal.h"
 
 #define SAVE_STATE_CHUNK 4096
+#define AUTOSAVE_BLOCK_SIZE 4096
+
+/* Block-wise passes made before an autosave gives up waiting for the
+ * SRAM to settle and copies it in one go. */
+#define AUTOSAVE_SETTLE_PASSES 4
+
+/* Compressed savestates start with a header holding the magic, the
+ * chunk size and the uncompressed state size, all little endian.
+ * The state follows as independently deflated chunks, each prefixed
+ * with its compressed size, so both saving and loading progress one
+ * chunk per task iteration. */
+#define SAVE_STATE_COMPRESSED_MAGIC       "#RZIPv\x01#"
+#define SAVE_STATE_COMPRESSED_MAGIC_SIZE  8
+#define SAVE_STATE_COMPRESSED_HEADER_SIZE 20
+#define SAVE_STATE_COMPRESSED_CHUNK       (128 * 1024)
+#define SAVE_STATE_COMPRESSED_CHUNK_MAX   (16 * 1024 * 1024)
+/* Upper bound on the uncompressed size when the core does not
+ * report a serialization size to check the header against. */
+#define SAVE_STATE_COMPRESSED_SIZE_MAX    (256 * 1024 * 1024)
+#define SAVE_STATE_COMPRESSED_LEVEL       1
+#define SAVE_STATE_COMPRESSED_BOUND(size) \
+   ((size) + ((size) >> 12) + ((size) >> 14) + ((size) >> 25) + 13)
+
+/* Number of idle savestate buffers kept around for reuse. */
+#define SAVE_STATE_POOL_SIZE 2
 
 static struct string_list *task_save_files = NULL;
 
@@ -80,6 +112,10 @@ struct sram_block
 typedef struct
 {
    intfstream_t *file;
+   const struct trans_stream_backend *backend;
+   void *stream;
+   uint8_t *chunk;
+   uint32_t chunk_size;
    char path[PATH_MAX_LENGTH];
    void *data;
    void *undo_data;
@@ -87,6 +123,7 @@ typedef struct
    ssize_t undo_size;
    ssize_t written;
    ssize_t bytes_read;
+   size_t max_size;
    bool load_to_backup_buffer;
    bool autoload;
    bool autosave;
@@ -95,6 +132,7 @@ typedef struct
    int state_slot;
    bool thumbnail_enable;
    bool has_valid_framebuffer;
+   bool compressed;
 } save_task_state_t;
 
 typedef save_task_state_t load_task_data_t;
@@ -107,6 +145,18 @@ static struct save_state_buf undo_save_buf;
  * Can be restored with undo_load_state(). */
 static struct save_state_buf undo_load_buf;
 
+/* Idle savestate buffers, reused by the next save or load instead
+ * of allocating a fresh buffer for every state. */
+static struct
+{
+   void *data;
+   size_t size;
+} save_state_pool[SAVE_STATE_POOL_SIZE];
+
+#ifdef HAVE_THREADS
+static slock_t *save_state_pool_lock = NULL;
+#endif
+
 #ifdef HAVE_THREADS
 typedef struct autosave autosave_t;
 
@@ -125,14 +175,193 @@ struct autosave
    void *buffer;
    const void *retro_buffer;
    const char *path;
+   char tmp_path[PATH_MAX_LENGTH];
    slock_t *lock;
    slock_t *cond_lock;
    scond_t *cond;
    sthread_t *thread;
+
+   /* Metrics, reported when the autosave is freed. */
+   unsigned writes;
+   uint64_t bytes_written;
+   uint64_t blocks_copied;
+   retro_time_t lock_time_max;
+   retro_time_t lock_time_total;
 };
 
 static struct autosave_st autosave_state;
 
+/**
+ * autosave_snapshot:
+ * @save            : pointer to autosave object
+ *
+ * Brings the autosave buffer up to date with the core's SRAM one
+ * block at a time, so the core is only ever held up for the compare
+ * and copy of a single block. A block changed after it was compared
+ * is picked up on the next pass, so the buffer is only known to hold
+ * a consistent image after a pass that found nothing to copy.
+ *
+ * Returns: number of blocks that changed since the last pass.
+ **/
+static size_t autosave_snapshot(autosave_t *save)
+{
+   size_t offset;
+   size_t dirty                = 0;
+   uint8_t *buffer             = (uint8_t*)save->buffer;
+   const uint8_t *retro_buffer = (const uint8_t*)save->retro_buffer;
+
+   for (offset = 0; offset < save->bufsize; offset += AUTOSAVE_BLOCK_SIZE)
+   {
+      retro_time_t start, held;
+      size_t len = save->bufsize - offset;
+
+      if (len > AUTOSAVE_BLOCK_SIZE)
+         len = AUTOSAVE_BLOCK_SIZE;
+
+      slock_lock(save->lock);
+      start = cpu_features_get_time_usec();
+      if (memcmp(buffer + offset, retro_buffer + offset, len))
+      {
+         memcpy(buffer + offset, retro_buffer + offset, len);
+         dirty++;
+      }
+      held  = cpu_features_get_time_usec() - start;
+      slock_unlock(save->lock);
+
+      save->lock_time_total += held;
+      if (held > save->lock_time_max)
+         save->lock_time_max = held;
+   }
+
+   save->blocks_copied += dirty;
+   return dirty;
+}
+
+/**
+ * autosave_sync:
+ * @save            : pointer to autosave object
+ *
+ * Runs block-wise snapshot passes until one of them finds the SRAM
+ * unchanged, which leaves a consistent image in the autosave buffer.
+ * If the core keeps writing for AUTOSAVE_SETTLE_PASSES passes, the
+ * whole buffer is copied under a single lock hold instead.
+ *
+ * Returns: number of blocks that changed since the last sync.
+ **/
+static size_t autosave_sync(autosave_t *save)
+{
+   unsigned pass;
+   size_t dirty = autosave_snapshot(save);
+   size_t total = dirty;
+
+   for (pass = 0; dirty && pass < AUTOSAVE_SETTLE_PASSES; pass++)
+      total += (dirty = autosave_snapshot(save));
+
+   if (dirty)
+   {
+      retro_time_t start, held;
+
+      slock_lock(save->lock);
+      start = cpu_features_get_time_usec();
+      memcpy(save->buffer, save->retro_buffer, save->bufsize);
+      held  = cpu_features_get_time_usec() - start;
+      slock_unlock(save->lock);
+
+      save->lock_time_total += held;
+      if (held > save->lock_time_max)
+         save->lock_time_max = held;
+   }
+
+   return total;
+}
+
+/**
+ * autosave_replace:
+ * @save            : pointer to autosave object
+ *
+ * Moves the temporary file over the save file.
+ *
+ * Returns: true (1) if successful, otherwise false (0).
+ **/
+static bool autosave_replace(autosave_t *save)
+{
+#if defined(_WIN32) && !defined(_XBOX)
+   /* rename() does not replace an existing file on Windows, and
+    * deleting the save first would lose it if the move then failed. */
+   bool ret = false;
+#if defined(_WIN32_WINNT) && _WIN32_WINNT < 0x0500
+   char *tmp_path  = utf8_to_local_string_alloc(save->tmp_path);
+   char *path      = utf8_to_local_string_alloc(save->path);
+
+   if (tmp_path && path)
+      ret = MoveFileExA(tmp_path, path,
+            MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+   wchar_t *tmp_path = utf8_to_utf16_string_alloc(save->tmp_path);
+   wchar_t *path     = utf8_to_utf16_string_alloc(save->path);
+
+   if (tmp_path && path)
+      ret = MoveFileExW(tmp_path, path,
+            MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#endif
+
+   free(tmp_path);
+   free(path);
+   return ret;
+#else
+   if (filestream_rename(save->tmp_path, save->path) == 0)
+      return true;
+#ifdef _WIN32
+   /* No MoveFileEx here, replace the file by hand. */
+   filestream_delete(save->path);
+   return filestream_rename(save->tmp_path, save->path) == 0;
+#else
+   return false;
+#endif
+#endif
+}
+
+/**
+ * autosave_write:
+ * @save            : pointer to autosave object
+ *
+ * Writes the autosave buffer to a temporary file next to the save
+ * file and renames it over the save file, so an interrupted write
+ * never leaves a truncated save behind.
+ *
+ * Returns: true (1) if successful, otherwise false (0).
+ **/
+static bool autosave_write(autosave_t *save)
+{
+   bool failed        = false;
+   intfstream_t *file = intfstream_open_file(save->tmp_path,
+         RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   failed |= ((size_t)intfstream_write(file, save->buffer, save->bufsize) != save->bufsize);
+   failed |= (intfstream_flush(file) != 0);
+   failed |= (intfstream_close(file) != 0);
+   free(file);
+
+   if (failed)
+   {
+      filestream_delete(save->tmp_path);
+      return false;
+   }
+
+   if (!autosave_replace(save))
+   {
+      filestream_delete(save->tmp_path);
+      return false;
+   }
+
+   save->writes++;
+   save->bytes_written += save->bufsize;
+   return true;
+}
+
 /**
  * autosave_thread:
  * @data            : pointer to autosave object
@@ -146,42 +375,23 @@ static void autosave_thread(void *data)
 
    while (!save->quit)
    {
-      bool differ;
-
-      slock_lock(save->lock);
-      differ = string_is_not_equal_fast(save->buffer, save->retro_buffer,
-            save->bufsize);
-      if (differ)
-         memcpy(save->buffer, save->retro_buffer, save->bufsize);
-      slock_unlock(save->lock);
+      size_t dirty = autosave_sync(save);
 
-      if (differ)
+      if (dirty)
       {
-         /* Should probably deal with this more elegantly. */
-         intfstream_t *file = intfstream_open_file(save->path,
-               RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
-
-         if (file)
+         /* Avoid spamming down stderr ... */
+         if (first_log)
          {
-            bool failed = false;
-
-            /* Avoid spamming down stderr ... */
-            if (first_log)
-            {
-               RARCH_LOG("Autosaving SRAM to \"%s\", will continue to check every %u seconds ...\n",
-                     save->path, save->interval);
-               first_log = false;
-            }
-            else
-               RARCH_LOG("SRAM changed ... autosaving ...\n");
-
-            failed |= ((size_t)intfstream_write(file, save->buffer, save->bufsize) != save->bufsize);
-            failed |= (intfstream_flush(file) != 0);
-            failed |= (intfstream_close(file) != 0);
-            free(file);
-            if (failed)
-               RARCH_WARN("Failed to autosave SRAM. Disk might be full.\n");
+            RARCH_LOG("Autosaving SRAM to \"%s\", will continue to check every %u seconds ...\n",
+                  save->path, save->interval);
+            first_log = false;
          }
+         else
+            RARCH_LOG("SRAM changed (%u blocks) ... autosaving ...\n",
+                  (unsigned)dirty);
+
+         if (!autosave_write(save))
+            RARCH_WARN("Failed to autosave SRAM. Disk might be full.\n");
       }
 
       slock_lock(save->cond_lock);
@@ -223,6 +433,14 @@ static autosave_t *autosave_new(const char *path,
    handle->buffer                = malloc(size);
    handle->retro_buffer          = data;
    handle->path                  = path;
+   handle->writes                = 0;
+   handle->bytes_written         = 0;
+   handle->blocks_copied         = 0;
+   handle->lock_time_max         = 0;
+   handle->lock_time_total       = 0;
+
+   strlcpy(handle->tmp_path, path, sizeof(handle->tmp_path));
+   strlcat(handle->tmp_path, ".tmp", sizeof(handle->tmp_path));
 
    if (!handle->buffer)
       goto error;
@@ -260,6 +478,14 @@ static void autosave_free(autosave_t *handle)
    slock_free(handle->cond_lock);
    scond_free(handle->cond);
 
+   RARCH_LOG("Autosave \"%s\": %u writes, %llu bytes written, "
+         "%llu blocks copied, lock held %lld usec total / %lld usec max.\n",
+         handle->path, handle->writes,
+         (unsigned long long)handle->bytes_written,
+         (unsigned long long)handle->blocks_copied,
+         (long long)handle->lock_time_total,
+         (long long)handle->lock_time_max);
+
    if (handle->buffer)
       free(handle->buffer);
    handle->buffer = NULL;
@@ -377,6 +603,300 @@ void autosave_unlock(void)
 #endif
 }
 
+/**
+ * save_state_buffer_acquire:
+ * @size : minimum size of the buffer
+ *
+ * Takes a buffer of at least @size bytes from the savestate
+ * buffer pool, or allocates a new one.
+ *
+ * Returns: the buffer, or NULL if out of memory.
+ **/
+static void *save_state_buffer_acquire(size_t size)
+{
+   unsigned i;
+   void *data = NULL;
+
+#ifdef HAVE_THREADS
+   slock_lock(save_state_pool_lock);
+#endif
+
+   for (i = 0; i < SAVE_STATE_POOL_SIZE; i++)
+   {
+      if (save_state_pool[i].data && save_state_pool[i].size >= size)
+      {
+         data                    = save_state_pool[i].data;
+         save_state_pool[i].data = NULL;
+         save_state_pool[i].size = 0;
+         break;
+      }
+   }
+
+#ifdef HAVE_THREADS
+   slock_unlock(save_state_pool_lock);
+#endif
+
+   if (!data)
+      data = malloc(size);
+
+   return data;
+}
+
+/**
+ * save_state_buffer_release:
+ * @data : buffer to release, may be NULL
+ * @size : usable size of @data
+ *
+ * Returns a savestate buffer to the pool. When the pool is full the
+ * smallest buffer is freed.
+ **/
+static void save_state_buffer_release(void *data, size_t size)
+{
+   unsigned i;
+   unsigned smallest = 0;
+
+   if (!data)
+      return;
+
+#ifdef HAVE_THREADS
+   slock_lock(save_state_pool_lock);
+#endif
+
+   for (i = 0; i < SAVE_STATE_POOL_SIZE; i++)
+   {
+      if (!save_state_pool[i].data)
+      {
+         smallest = i;
+         break;
+      }
+
+      if (save_state_pool[i].size < save_state_pool[smallest].size)
+         smallest = i;
+   }
+
+   if (!save_state_pool[smallest].data
+         || save_state_pool[smallest].size < size)
+   {
+      void *evicted                  = save_state_pool[smallest].data;
+      save_state_pool[smallest].data = data;
+      save_state_pool[smallest].size = size;
+      data                           = evicted;
+   }
+
+#ifdef HAVE_THREADS
+   slock_unlock(save_state_pool_lock);
+#endif
+
+   if (data)
+      free(data);
+}
+
+static void save_state_buffers_free(void)
+{
+   unsigned i;
+
+#ifdef HAVE_THREADS
+   slock_lock(save_state_pool_lock);
+#endif
+
+   for (i = 0; i < SAVE_STATE_POOL_SIZE; i++)
+   {
+      if (save_state_pool[i].data)
+         free(save_state_pool[i].data);
+      save_state_pool[i].data = NULL;
+      save_state_pool[i].size = 0;
+   }
+
+#ifdef HAVE_THREADS
+   slock_unlock(save_state_pool_lock);
+#endif
+}
+
+/**
+ * task_save_state_free_stream:
+ * @state : the state associated with the task
+ *
+ * Releases the compression stream and chunk buffer, if any.
+ **/
+static void task_save_state_free_stream(save_task_state_t *state)
+{
+   if (state->stream)
+      state->backend->stream_free(state->stream);
+   if (state->chunk)
+      free(state->chunk);
+
+   state->backend = NULL;
+   state->stream  = NULL;
+   state->chunk   = NULL;
+}
+
+#ifdef HAVE_ZLIB
+/**
+ * task_save_compressed_begin:
+ * @state : the state associated with the task
+ *
+ * Writes the compressed savestate header and sets up the deflate
+ * stream.
+ *
+ * Returns: true (1) if successful, otherwise false (0).
+ **/
+static bool task_save_compressed_begin(save_task_state_t *state)
+{
+   uint8_t header[SAVE_STATE_COMPRESSED_HEADER_SIZE];
+   uint32_t chunk_size = swap_if_big32(SAVE_STATE_COMPRESSED_CHUNK);
+   uint64_t size       = swap_if_big64((uint64_t)state->size);
+
+   state->backend      = trans_stream_get_zlib_deflate_backend();
+   state->stream       = state->backend->stream_new();
+   state->chunk_size   = SAVE_STATE_COMPRESSED_BOUND(
+         SAVE_STATE_COMPRESSED_CHUNK);
+   state->chunk        = (uint8_t*)malloc(state->chunk_size + 4);
+
+   if (!state->stream || !state->chunk)
+      return false;
+
+   state->backend->define(state->stream, "level",
+         SAVE_STATE_COMPRESSED_LEVEL);
+
+   memcpy(header, SAVE_STATE_COMPRESSED_MAGIC,
+         SAVE_STATE_COMPRESSED_MAGIC_SIZE);
+   memcpy(header + 8,  &chunk_size, 4);
+   memcpy(header + 12, &size, 8);
+
+   return intfstream_write(state->file, header, sizeof(header))
+      == sizeof(header);
+}
+
+/**
+ * task_save_compressed_chunk:
+ * @state : the state associated with the task
+ * @len   : number of state bytes to compress
+ *
+ * Deflates the next @len bytes of the state and writes them out
+ * prefixed with their compressed size.
+ *
+ * Returns: true (1) if successful, otherwise false (0).
+ **/
+static bool task_save_compressed_chunk(save_task_state_t *state,
+      uint32_t len)
+{
+   uint32_t rd                 = 0;
+   uint32_t wn                 = 0;
+   uint32_t chunk_len          = 0;
+   enum trans_stream_error err = TRANS_STREAM_ERROR_NONE;
+
+   state->backend->set_in(state->stream,
+         (const uint8_t*)state->data + state->written, len);
+   state->backend->set_out(state->stream, state->chunk + 4,
+         state->chunk_size);
+
+   if (!state->backend->trans(state->stream, true, &rd, &wn, &err)
+         || err != TRANS_STREAM_ERROR_NONE || rd != len)
+      return false;
+
+   chunk_len = swap_if_big32(wn);
+   memcpy(state->chunk, &chunk_len, 4);
+
+   return intfstream_write(state->file, state->chunk, wn + 4)
+      == (int64_t)(wn + 4);
+}
+
+/**
+ * task_load_compressed_begin:
+ * @state : the state associated with the task
+ *
+ * Checks whether the file is a compressed savestate and, if so, reads
+ * its header and sets up the inflate stream. The file is left at the
+ * first chunk.
+ *
+ * Returns: true (1) if the file is a valid compressed savestate,
+ * otherwise false (0) and the file is rewound.
+ **/
+static bool task_load_compressed_begin(save_task_state_t *state)
+{
+   uint8_t header[SAVE_STATE_COMPRESSED_HEADER_SIZE];
+   uint32_t chunk_size;
+   uint64_t size;
+
+   if (intfstream_read(state->file, header, sizeof(header))
+         != sizeof(header)
+         || memcmp(header, SAVE_STATE_COMPRESSED_MAGIC,
+            SAVE_STATE_COMPRESSED_MAGIC_SIZE))
+   {
+      intfstream_rewind(state->file);
+      return false;
+   }
+
+   memcpy(&chunk_size, header + 8, 4);
+   memcpy(&size, header + 12, 8);
+   chunk_size = swap_if_big32(chunk_size);
+   size       = swap_if_big64(size);
+
+   /* The size comes straight from the file, don't let it pick
+    * the size of the state buffer unchecked. */
+   if (chunk_size == 0 || chunk_size > SAVE_STATE_COMPRESSED_CHUNK_MAX
+         || size > (state->max_size ? (uint64_t)state->max_size
+            : (uint64_t)SAVE_STATE_COMPRESSED_SIZE_MAX)
+         || (ssize_t)size < 0 || (uint64_t)(ssize_t)size != size)
+   {
+      intfstream_rewind(state->file);
+      return false;
+   }
+
+   state->compressed = true;
+   state->size       = (ssize_t)size;
+   state->chunk_size = chunk_size;
+   state->backend    = trans_stream_get_zlib_inflate_backend();
+   state->stream     = state->backend->stream_new();
+   state->chunk      = (uint8_t*)malloc(
+         SAVE_STATE_COMPRESSED_BOUND(chunk_size));
+
+   return true;
+}
+
+/**
+ * task_load_compressed_chunk:
+ * @state : the state associated with the task
+ * @len   : number of state bytes the chunk holds
+ *
+ * Reads the next chunk and inflates it straight into the state
+ * buffer.
+ *
+ * Returns: number of state bytes decompressed, -1 on error.
+ **/
+static ssize_t task_load_compressed_chunk(save_task_state_t *state,
+      uint32_t len)
+{
+   uint32_t rd                 = 0;
+   uint32_t wn                 = 0;
+   uint32_t chunk_len          = 0;
+   enum trans_stream_error err = TRANS_STREAM_ERROR_NONE;
+
+   if (!state->stream || !state->chunk)
+      return -1;
+
+   if (intfstream_read(state->file, &chunk_len, 4) != 4)
+      return -1;
+
+   chunk_len = swap_if_big32(chunk_len);
+
+   if (chunk_len > SAVE_STATE_COMPRESSED_BOUND(state->chunk_size)
+         || intfstream_read(state->file, state->chunk, chunk_len)
+         != (int64_t)chunk_len)
+      return -1;
+
+   state->backend->set_in(state->stream, state->chunk, chunk_len);
+   state->backend->set_out(state->stream,
+         (uint8_t*)state->data + state->bytes_read, len);
+
+   if (!state->backend->trans(state->stream, true, &rd, &wn, &err)
+         || err != TRANS_STREAM_ERROR_NONE)
+      return -1;
+
+   return wn;
+}
+#endif
+
 /**
  * undo_load_state:
  * Revert to the state before a state was loaded.
@@ -532,8 +1052,13 @@ static void task_save_handler_finished(retro_task_t *task,
 
    task_set_finished(task, true);
 
-   intfstream_close(state->file);
-   free(state->file);
+   if (state->file)
+   {
+      intfstream_close(state->file);
+      free(state->file);
+   }
+
+   task_save_state_free_stream(state);
 
    if (!task_get_error(task) && task_get_cancelled(task))
       task_set_error(task, strdup("Task canceled"));
@@ -547,7 +1072,7 @@ static void task_save_handler_finished(retro_task_t *task,
    {
       if (state->undo_save && state->data == undo_save_buf.data)
          undo_save_buf.data = NULL;
-      free(state->data);
+      save_state_buffer_release(state->data, state->size);
       state->data = NULL;
    }
 
@@ -573,13 +1098,34 @@ static void task_save_handler(retro_task_t *task)
 
       if (!state->file)
          return;
+
+#ifdef HAVE_ZLIB
+      if (state->compressed && !task_save_compressed_begin(state))
+         task_save_state_free_stream(state);
+#endif
    }
 
-   remaining       = MIN(state->size - state->written, SAVE_STATE_CHUNK);
-   written         = (int)intfstream_write(state->file,
-         (uint8_t*)state->data + state->written, remaining);
+#ifdef HAVE_ZLIB
+   if (state->compressed)
+   {
+      remaining    = MIN(state->size - state->written,
+            SAVE_STATE_COMPRESSED_CHUNK);
+      written      = 0;
 
-   state->written += written;
+      if (state->stream
+            && task_save_compressed_chunk(state, (uint32_t)remaining))
+         written   = (int)remaining;
+   }
+   else
+#endif
+   {
+      remaining    = MIN(state->size - state->written, SAVE_STATE_CHUNK);
+      written      = (int)intfstream_write(state->file,
+            (uint8_t*)state->data + state->written, remaining);
+   }
+
+   if (written > 0)
+      state->written += written;
 
    task_set_progress(task, (state->written / (float)state->size) * 100);
 
@@ -665,6 +1211,9 @@ static bool task_push_undo_save_state(const char *path, void *data, size_t size)
    state->undo_save              = true;
    state->state_slot             = settings->ints.state_slot;
    state->has_valid_framebuffer  = video_driver_cached_frame_has_valid_framebuffer();
+#ifdef HAVE_ZLIB
+   state->compressed             = settings->bools.savestate_file_compression;
+#endif
 
    task->type                    = TASK_TYPE_BLOCKING;
    task->state                   = state;
@@ -720,6 +1269,8 @@ static void task_load_handler_finished(retro_task_t *task,
       free(state->file);
    }
 
+   task_save_state_free_stream(state);
+
    if (!task_get_error(task) && task_get_cancelled(task))
       task_set_error(task, strdup("Task canceled"));
 
@@ -731,6 +1282,28 @@ static void task_load_handler_finished(retro_task_t *task,
    free(state);
 }
 
+#ifndef HAVE_ZLIB
+/**
+ * task_load_is_compressed:
+ * @state : the state associated with the task
+ *
+ * Checks for the compressed savestate magic and rewinds the file.
+ *
+ * Returns: true (1) if the file is a compressed savestate.
+ **/
+static bool task_load_is_compressed(save_task_state_t *state)
+{
+   uint8_t magic[SAVE_STATE_COMPRESSED_MAGIC_SIZE];
+   bool ret = intfstream_read(state->file, magic, sizeof(magic))
+         == sizeof(magic)
+      && !memcmp(magic, SAVE_STATE_COMPRESSED_MAGIC,
+            SAVE_STATE_COMPRESSED_MAGIC_SIZE);
+
+   intfstream_rewind(state->file);
+   return ret;
+}
+#endif
+
 /**
  * task_load_handler:
  * @task : the task being worked on
@@ -751,26 +1324,56 @@ static void task_load_handler(retro_task_t *task)
       if (!state->file)
          goto error;
 
-      if (intfstream_seek(state->file, 0, SEEK_END) != 0)
+#ifdef HAVE_ZLIB
+      if (!task_load_compressed_begin(state))
+#else
+      if (task_load_is_compressed(state))
+      {
+         RARCH_ERR("[State]: \"%s\" is compressed, this build "
+               "cannot read compressed savestates.\n", state->path);
+         task_set_error(task,
+               strdup(msg_hash_to_str(MSG_FAILED_TO_LOAD_STATE)));
          goto error;
+      }
+      else
+#endif
+      {
+         if (intfstream_seek(state->file, 0, SEEK_END) != 0)
+            goto error;
 
-      state->size = intfstream_tell(state->file);
+         state->size = intfstream_tell(state->file);
 
-      if (state->size < 0)
-         goto error;
+         if (state->size < 0)
+            goto error;
 
-      intfstream_rewind(state->file);
+         intfstream_rewind(state->file);
+      }
 
-      state->data = malloc(state->size + 1);
+      state->data = save_state_buffer_acquire(state->size + 1);
 
       if (!state->data)
          goto error;
    }
 
-   remaining          = MIN(state->size - state->bytes_read, SAVE_STATE_CHUNK);
-   bytes_read         = intfstream_read(state->file,
-         (uint8_t*)state->data + state->bytes_read, remaining);
-   state->bytes_read += bytes_read;
+#ifdef HAVE_ZLIB
+   if (state->compressed)
+   {
+      remaining       = MIN(state->size - state->bytes_read,
+            state->chunk_size);
+      bytes_read      = task_load_compressed_chunk(state,
+            (uint32_t)remaining);
+   }
+   else
+#endif
+   {
+      remaining       = MIN(state->size - state->bytes_read,
+            SAVE_STATE_CHUNK);
+      bytes_read      = intfstream_read(state->file,
+            (uint8_t*)state->data + state->bytes_read, remaining);
+   }
+
+   if (bytes_read > 0)
+      state->bytes_read += bytes_read;
 
    if (state->size > 0)
       task_set_progress(task, (state->bytes_read / (float)state->size) * 100);
@@ -795,7 +1398,7 @@ static void task_load_handler(retro_task_t *task)
       else
          task_set_error(task, strdup(msg_hash_to_str(MSG_FAILED_TO_LOAD_STATE)));
 
-      free(state->data);
+      save_state_buffer_release(state->data, state->size);
       state->data = NULL;
       task_load_handler_finished(task, state);
       return;
@@ -885,19 +1488,14 @@ static void content_load_state_cb(void *task_data,
       /* If we were previously backing up a file, let go of it first */
       if (undo_save_buf.data)
       {
-         free(undo_save_buf.data);
+         save_state_buffer_release(undo_save_buf.data, undo_save_buf.size);
          undo_save_buf.data = NULL;
       }
 
-      undo_save_buf.data = malloc(size);
-      if (!undo_save_buf.data)
-         goto error;
-
-      memcpy(undo_save_buf.data, buf, size);
+      undo_save_buf.data = buf;
       undo_save_buf.size = size;
       strlcpy(undo_save_buf.path, load_data->path, sizeof(undo_save_buf.path));
 
-      free(buf);
       free(load_data);
       return;
    }
@@ -983,7 +1581,7 @@ static void content_load_state_cb(void *task_data,
    if (!ret)
       goto error;
 
-   free(buf);
+   save_state_buffer_release(buf, size);
    free(load_data);
 
    return;
@@ -992,7 +1590,9 @@ error:
    RARCH_ERR("%s \"%s\".\n",
          msg_hash_to_str(MSG_FAILED_TO_LOAD_STATE),
          load_data->path);
-   if (buf)
+   if (buf && size > 0)
+      save_state_buffer_release(buf, size);
+   else if (buf)
       free(buf);
    free(load_data);
 }
@@ -1039,6 +1639,9 @@ static void task_push_save_state(const char *path, void *data, size_t size, bool
    state->thumbnail_enable = settings->bools.savestate_thumbnail_enable;
    state->state_slot       = settings->ints.state_slot;
    state->has_valid_framebuffer  = video_driver_cached_frame_has_valid_framebuffer();
+#ifdef HAVE_ZLIB
+   state->compressed       = settings->bools.savestate_file_compression;
+#endif
 
    task->type              = TASK_TYPE_BLOCKING;
    task->state             = state;
@@ -1052,8 +1655,7 @@ static void task_push_save_state(const char *path, void *data, size_t size, bool
    return;
 
 error:
-   if (data)
-      free(data);
+   save_state_buffer_release(data, size);
    if (state)
       free(state);
    if (task)
@@ -1104,6 +1706,7 @@ static void task_push_load_and_save_state(const char *path, void *data,
 
    strlcpy(state->path, path, sizeof(state->path));
    state->load_to_backup_buffer = load_to_backup_buffer;
+   state->max_size   = size;
    state->undo_size  = size;
    state->undo_data  = data;
    state->autosave   = autosave;
@@ -1125,8 +1728,7 @@ static void task_push_load_and_save_state(const char *path, void *data,
    return;
 
 error:
-   if (data)
-      free(data);
+   save_state_buffer_release(data, size);
    if (state)
       free(state);
    if (task)
@@ -1157,7 +1759,7 @@ bool content_save_state(const char *path, bool save_to_disk, bool autosave)
    if (info.size == 0)
       return false;
 
-   data = malloc(info.size);
+   data = save_state_buffer_acquire(info.size);
 
    if (!data)
       return false;
@@ -1196,26 +1798,18 @@ bool content_save_state(const char *path, bool save_to_disk, bool autosave)
          /* If we were holding onto an old state already, clean it up first */
          if (undo_load_buf.data)
          {
-            free(undo_load_buf.data);
+            save_state_buffer_release(undo_load_buf.data, undo_load_buf.size);
             undo_load_buf.data = NULL;
          }
 
-         undo_load_buf.data = malloc(info.size);
-         if (!undo_load_buf.data)
-         {
-            free(data);
-            return false;
-         }
-
-         memcpy(undo_load_buf.data, data, info.size);
-         free(data);
+         undo_load_buf.data = data;
          undo_load_buf.size = info.size;
          strlcpy(undo_load_buf.path, path, sizeof(undo_load_buf.path));
       }
    }
    else
    {
-      free(data);
+      save_state_buffer_release(data, info.size);
       RARCH_ERR("%s \"%s\".\n",
             msg_hash_to_str(MSG_FAILED_TO_SAVE_STATE_TO),
             path);
@@ -1237,6 +1831,7 @@ bool content_save_state(const char *path, bool save_to_disk, bool autosave)
 bool content_load_state(const char *path,
       bool load_to_backup_buffer, bool autoload)
 {
+   retro_ctx_size_info_t info;
    retro_task_t       *task     = (retro_task_t*)calloc(1, sizeof(*task));
    save_task_state_t *state     = (save_task_state_t*)calloc(1, sizeof(*state));
    settings_t *settings         = config_get_ptr();
@@ -1244,7 +1839,11 @@ bool content_load_state(const char *path,
    if (!task || !state)
       goto error;
 
+   info.size                    = 0;
+   core_serialize_size(&info);
+
    strlcpy(state->path, path, sizeof(state->path));
+   state->max_size              = info.size;
    state->load_to_backup_buffer = load_to_backup_buffer;
    state->autoload              = autoload;
    state->state_slot            = settings->ints.state_slot;
@@ -1309,9 +1908,31 @@ bool content_reset_savestate_backups(void)
    undo_load_buf.path[0] = '\0';
    undo_load_buf.size    = 0;
 
+   save_state_buffers_free();
+
+#ifdef HAVE_THREADS
+   if (save_state_pool_lock)
+      slock_free(save_state_pool_lock);
+   save_state_pool_lock = NULL;
+#endif
+
    return true;
 }
 
+/**
+ * content_init_savestate_buffers:
+ *
+ * Sets up the savestate buffer pool. Must be called from the
+ * main thread before any savestate task is queued.
+ **/
+void content_init_savestate_buffers(void)
+{
+#ifdef HAVE_THREADS
+   if (!save_state_pool_lock)
+      save_state_pool_lock = slock_new();
+#endif
+}
+
 bool content_undo_load_buf_is_empty(void)
 {
    return undo_load_buf.data == NULL || undo_load_buf.size == 0;
@@ -130,6 +130,7 @@ bool task_push_dbscan(
       const char *content_database,
       const char *fullpath,
       bool directory, bool show_hidden_files,
+      unsigned scan_threads,
       retro_task_callback_t cb);
 #endif
 
@@ -0,0 +1,416 @@
+/*  RetroArch - A frontend for libretro.
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Netplay host load test: connects a number of spectators to a netplay host,
+ * drains everything the host sends them, and reports the host's frame rate
+ * and CPU time per frame. */
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include "compat/getopt.h"
+#include "net/net_socket.h"
+
+/* Only for #defines */
+#include "../../network/netplay/netplay_private.h"
+
+struct spectator
+{
+   int fd;
+   unsigned char *buf;
+   size_t bufsz, used;
+};
+
+static struct spectator *spectators;
+static unsigned spectator_count = 16;
+
+/* The host's newest frame, as seen through its input */
+static uint32_t host_frame;
+static uint64_t bytes_received;
+
+/* Usage statement */
+void usage()
+{
+   fprintf(stderr,
+      "Use: ranetload [options]\n"
+      "Options:\n"
+      "    -H|--host <address>:    Netplay host. Defaults to localhost.\n"
+      "    -P|--port <port>:       Netplay port. Defaults to 55435.\n"
+      "    -n|--spectators <n>:    Number of spectators to connect. Defaults\n"
+      "                            to 16.\n"
+      "    -d|--duration <secs>:   How long to measure for. Defaults to 10.\n"
+      "    -p|--pid <pid>:         Process ID of the host, to report its CPU\n"
+      "                            time per frame.\n"
+      "\n");
+}
+
+static double now(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* CPU time of a process in seconds, from /proc/<pid>/stat */
+static double process_cpu(int pid)
+{
+   char path[64], stat[1024], *fields;
+   unsigned long utime, stime;
+   ssize_t len;
+   int fd;
+
+   snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+   if ((fd = open(path, O_RDONLY)) < 0)
+      return -1.0;
+   len = read(fd, stat, sizeof(stat) - 1);
+   close(fd);
+   if (len <= 0)
+      return -1.0;
+   stat[len] = '\0';
+
+   /* Skip past the command name, which may contain spaces */
+   if (!(fields = strrchr(stat, ')')))
+      return -1.0;
+   if (sscanf(fields + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+            &utime, &stime) != 2)
+      return -1.0;
+
+   return (double)(utime + stime) / sysconf(_SC_CLK_TCK);
+}
+
+static double self_cpu(void)
+{
+   struct rusage ru;
+   getrusage(RUSAGE_SELF, &ru);
+   return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 +
+      ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+}
+
+static bool recv_cmd(int sock, uint32_t *cmd, uint32_t *cmd_size,
+      uint32_t *payload, size_t payload_size)
+{
+   if (!socket_receive_all_blocking(sock, cmd, sizeof(uint32_t)) ||
+       !socket_receive_all_blocking(sock, cmd_size, sizeof(uint32_t)))
+      return false;
+   *cmd      = ntohl(*cmd);
+   *cmd_size = ntohl(*cmd_size);
+   if (*cmd_size > payload_size)
+      return false;
+   return socket_receive_all_blocking(sock, payload, *cmd_size);
+}
+
+static bool send_cmd(int sock, uint32_t cmd, const void *payload,
+      uint32_t cmd_size)
+{
+   uint32_t adj_cmd[2];
+   adj_cmd[0] = htonl(cmd);
+   adj_cmd[1] = htonl(cmd_size);
+   return socket_send_all_blocking(sock, adj_cmd, sizeof(adj_cmd), true) &&
+      socket_send_all_blocking(sock, payload, cmd_size, true);
+}
+
+/* Go through the handshake as a spectator, like ranetplayer does */
+static bool handshake(struct spectator *spec, unsigned num)
+{
+   uint32_t cmd, cmd_size, payload[1024];
+
+   /* Header, which we can only echo if there's no password */
+   if (!socket_receive_all_blocking(spec->fd, payload, 6*sizeof(uint32_t)))
+      return false;
+   if (payload[3])
+   {
+      fprintf(stderr, "Password required but unsupported.\n");
+      return false;
+   }
+   if (!socket_send_all_blocking(spec->fd, payload, 6*sizeof(uint32_t), true))
+      return false;
+
+   /* Nickname */
+   memset(payload, 0, NETPLAY_NICK_LEN);
+   snprintf((char *) payload, NETPLAY_NICK_LEN, "RANetload%u", num);
+   if (!send_cmd(spec->fd, NETPLAY_CMD_NICK, payload, NETPLAY_NICK_LEN) ||
+       !recv_cmd(spec->fd, &cmd, &cmd_size, payload, sizeof(payload)))
+      return false;
+
+   /* Echo the INFO */
+   if (!recv_cmd(spec->fd, &cmd, &cmd_size, payload, sizeof(payload)) ||
+       cmd != NETPLAY_CMD_INFO ||
+       !send_cmd(spec->fd, cmd, payload, cmd_size))
+      return false;
+
+   /* And wait for SYNC, after which we're spectating */
+   return recv_cmd(spec->fd, &cmd, &cmd_size, payload, sizeof(payload));
+}
+
+/* Read whatever is waiting and process every complete command */
+static bool drain(struct spectator *spec)
+{
+   size_t pos = 0;
+   ssize_t recvd;
+
+   if (spec->bufsz - spec->used < 4096)
+   {
+      spec->bufsz *= 2;
+      spec->buf = (unsigned char *) realloc(spec->buf, spec->bufsz);
+      if (!spec->buf)
+      {
+         perror("realloc");
+         exit(1);
+      }
+   }
+
+   recvd = recv(spec->fd, (char *) spec->buf + spec->used,
+         spec->bufsz - spec->used, 0);
+   if (recvd <= 0)
+      return false;
+   spec->used     += recvd;
+   bytes_received += recvd;
+
+   while (spec->used - pos >= 2*sizeof(uint32_t))
+   {
+      uint32_t hdr[4], cmd, cmd_size;
+
+      memcpy(hdr, spec->buf + pos, 2*sizeof(uint32_t));
+      cmd      = ntohl(hdr[0]);
+      cmd_size = ntohl(hdr[1]);
+      if (spec->used - pos - 2*sizeof(uint32_t) < cmd_size)
+         break;
+
+      /* The host's own input, or lack thereof, tells us its frame */
+      if ((cmd == NETPLAY_CMD_INPUT   && cmd_size >= 2*sizeof(uint32_t)) ||
+          (cmd == NETPLAY_CMD_NOINPUT && cmd_size >= sizeof(uint32_t)))
+      {
+         memcpy(hdr + 2, spec->buf + pos + 2*sizeof(uint32_t),
+               (cmd == NETPLAY_CMD_INPUT ? 2 : 1) * sizeof(uint32_t));
+         if ((cmd == NETPLAY_CMD_NOINPUT || ntohl(hdr[3]) == 0) &&
+             ntohl(hdr[2]) > host_frame)
+            host_frame = ntohl(hdr[2]);
+      }
+
+      pos += 2*sizeof(uint32_t) + cmd_size;
+   }
+
+   memmove(spec->buf, spec->buf + pos, spec->used - pos);
+   spec->used -= pos;
+   return true;
+}
+
+int main(int argc, char **argv)
+{
+   struct pollfd *pfds;
+   struct addrinfo *addr;
+   unsigned i;
+   int pid = 0;
+   double duration = 10.0;
+   double start, next_report, host_cpu_start = 0, self_cpu_start;
+   uint32_t start_frame, report_frame;
+   double report_time, report_cpu = 0;
+   const char *host = "localhost";
+   int port = RARCH_DEFAULT_PORT;
+
+   const struct option opt[] = {
+      {"host",       1, NULL, 'H'},
+      {"port",       1, NULL, 'P'},
+      {"spectators", 1, NULL, 'n'},
+      {"duration",   1, NULL, 'd'},
+      {"pid",        1, NULL, 'p'}
+   };
+
+   while (1)
+   {
+      int c;
+
+      c = getopt_long(argc, argv, "H:P:n:d:p:", opt, NULL);
+      if (c == -1)
+         break;
+
+      switch (c)
+      {
+         case 'H':
+            host = optarg;
+            break;
+
+         case 'P':
+            port = atoi(optarg);
+            break;
+
+         case 'n':
+            spectator_count = atoi(optarg);
+            break;
+
+         case 'd':
+            duration = atof(optarg);
+            break;
+
+         case 'p':
+            pid = atoi(optarg);
+            break;
+
+         default:
+            usage();
+            return 1;
+      }
+   }
+
+   if (!spectator_count || duration <= 0)
+   {
+      usage();
+      return 1;
+   }
+
+   spectators = (struct spectator *) calloc(spectator_count, sizeof(*spectators));
+   pfds       = (struct pollfd *) calloc(spectator_count, sizeof(*pfds));
+   if (!spectators || !pfds)
+   {
+      perror("calloc");
+      return 1;
+   }
+
+   /* Connect everyone first, so the host can accept them in one go */
+   for (i = 0; i < spectator_count; i++)
+   {
+      struct spectator *spec = &spectators[i];
+
+      if ((spec->fd = socket_init((void **) &addr, port, host,
+                  SOCKET_TYPE_STREAM)) < 0)
+      {
+         perror("socket");
+         return 1;
+      }
+      if (socket_connect(spec->fd, addr, false) < 0)
+      {
+         perror("connect");
+         return 1;
+      }
+      freeaddrinfo_retro(addr);
+
+      spec->bufsz = 65536;
+      spec->buf   = (unsigned char *) malloc(spec->bufsz);
+      if (!spec->buf)
+      {
+         perror("malloc");
+         return 1;
+      }
+   }
+
+   for (i = 0; i < spectator_count; i++)
+   {
+      if (!handshake(&spectators[i], i))
+      {
+         fprintf(stderr, "Handshake of spectator %u failed.\n", i);
+         return 1;
+      }
+      pfds[i].fd     = spectators[i].fd;
+      pfds[i].events = POLLIN;
+   }
+
+   /* Let the first frames set host_frame before we start measuring */
+   while (!host_frame)
+   {
+      if (poll(pfds, spectator_count, 1000) <= 0)
+      {
+         fprintf(stderr, "The host is not sending any input.\n");
+         return 1;
+      }
+      for (i = 0; i < spectator_count; i++)
+         if ((pfds[i].revents & (POLLIN|POLLHUP|POLLERR)) &&
+             !drain(&spectators[i]))
+            return 1;
+   }
+
+   printf("%u spectators connected\n", spectator_count);
+
+   start          = report_time = now();
+   next_report    = start + 1.0;
+   start_frame    = report_frame = host_frame;
+   bytes_received = 0;
+   self_cpu_start = self_cpu();
+   if (pid)
+      host_cpu_start = report_cpu = process_cpu(pid);
+
+   while (now() - start < duration)
+   {
+      int ready = poll(pfds, spectator_count, 100);
+      if (ready < 0)
+      {
+         perror("poll");
+         return 1;
+      }
+
+      for (i = 0; i < spectator_count && ready > 0; i++)
+      {
+         if (!(pfds[i].revents & (POLLIN|POLLHUP|POLLERR)))
+            continue;
+         ready--;
+         if (!drain(&spectators[i]))
+         {
+            fprintf(stderr, "Spectator %u was disconnected.\n", i);
+            return 1;
+         }
+      }
+
+      if (now() >= next_report)
+      {
+         double t      = now();
+         uint32_t done = host_frame - report_frame;
+
+         printf("%6.1f fps", done / (t - report_time));
+         if (pid && done)
+         {
+            double cpu = process_cpu(pid);
+            printf(", host %7.1f us/frame", (cpu - report_cpu) * 1e6 / done);
+            report_cpu = cpu;
+         }
+         printf("\n");
+
+         report_time  = t;
+         report_frame = host_frame;
+         next_report += 1.0;
+      }
+   }
+
+   {
+      double elapsed = now() - start;
+      uint32_t done  = host_frame - start_frame;
+
+      printf("\n%u spectators, %u frames in %.1f s (%.1f fps), "
+            "%.1f bytes/frame per spectator\n",
+            spectator_count, done, elapsed, done / elapsed,
+            done ? (double) bytes_received / done / spectator_count : 0.0);
+      if (done)
+      {
+         if (pid)
+            printf("host CPU: %.1f us/frame\n",
+                  (process_cpu(pid) - host_cpu_start) * 1e6 / done);
+         printf("ranetload CPU: %.1f us/frame\n",
+               (self_cpu() - self_cpu_start) * 1e6 / done);
+      }
+   }
+
+   for (i = 0; i < spectator_count; i++)
+   {
+      socket_close(spectators[i].fd);
+      free(spectators[i].buf);
+   }
+   free(spectators);
+   free(pfds);
+
+   return 0;
+}